@@ -0,0 +1,1325 @@
+/**
+  ******************************************************************************
+  * @addtogroup     : host
+  * @{
+  * @file           : storage_bench.c
+  * @brief          : benchmark of the measurement log on the simulated AT25QF641B.
+  * Each wake-up of the MFM is simulated: boot with restore of the log, write of a
+  * measurement, background erase during the LoRa transmission, deep power-down and
+  * switch off of vSys. Backup registers are lost, the FRAM state is corrupted and the
+  * supply is lost during erase or write at intervals to run the recovery paths.
+  * All measurements are checked when read back, rollups are compared with rollups
+  * calculated from the written measurements. The mirror on the simulated SD card is
+  * read back with FatFs at each swap of the card, the offload of the measurement memory
+  * to the SD card is compared with the dataflash.
+  * The SPI bytes, commands, time and energy of each operation are reported.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  * @}
+  ******************************************************************************
+  */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <setjmp.h>
+#include <math.h>
+
+#include "main.h"
+#include "sys_app.h"
+#include "timer_if.h"
+#include "common/common.h"
+#include "common/crc16.h"
+#include "dataflash/dataflash_functions.h"
+#include "measurement.h"
+#include "measurementStaging.h"
+#include "keyValueStore.h"
+#include "rollup.h"
+#include "sdMirror.h"
+#include "sdOffload.h"
+#include "CommConfig.h"
+#include "app_fatfs.h"
+#include "I2CMaster/SensorRegister.h"
+
+#include "at25qf641b_sim.h"
+#include "platform_sim.h"
+#include "sd_sim.h"
+
+#define BENCH_START_TIME          ( 1700000000UL )  //timestamp of measurement ID 0
+#define BENCH_MEASUREMENT_PERIOD  ( 900 )           //s, time between measurements
+#define BENCH_RANGE_LENGTH        ( 64 )            //measurements of a range read
+#define BENCH_PACK_BUFFER_SIZE    ( 222 )           //maximum LoRa payload
+
+const uint8_t eraseCompleteMeasurementMemory( void ); //override of CommConfig.c, not in measurement.h
+
+/**
+ * @brief operations of the benchmark
+ */
+typedef enum
+{
+  BENCH_BOOT_WARM = 0,    //restore with backup registers
+  BENCH_BOOT_COLD,        //restore with FRAM checkpoint, backup registers lost
+  BENCH_BOOT_SCAN,        //restore with search of the dataflash, backup registers lost and FRAM corrupted
+  BENCH_WRITE,
+  BENCH_PRE_ERASE,
+  BENCH_IDLE,             //LoRa transmission, background erase and deep power-down
+  BENCH_FINISH_ERASE,
+  BENCH_READ,
+  BENCH_READ_RANGE,
+  BENCH_FIND_TIME,
+  BENCH_PACK,
+  BENCH_ERASE_ALL,        //erase of the complete measurement memory
+  BENCH_KEY_VALUE_WRITE,  //write or delete of a key, the first access after boot rebuilds the index
+  BENCH_KEY_VALUE_READ,
+  BENCH_ROLLUP,           //aggregation of the latest measurement, a closed window writes the rollup
+  BENCH_SD_MIRROR,        //append of a batch of measurements to the SD card
+  BENCH_SD_OFFLOAD,       //offload of the complete measurement memory to the SD card
+  BENCH_NUMBER_OF_OPERATIONS
+}ENUM_benchOperation;
+
+static const char * operationName[BENCH_NUMBER_OF_OPERATIONS] =
+{
+  [BENCH_BOOT_WARM]     = "boot warm",
+  [BENCH_BOOT_COLD]     = "boot cold",
+  [BENCH_BOOT_SCAN]     = "boot scan",
+  [BENCH_WRITE]         = "write",
+  [BENCH_PRE_ERASE]     = "pre-erase",
+  [BENCH_IDLE]          = "idle",
+  [BENCH_FINISH_ERASE]  = "finish erase",
+  [BENCH_READ]          = "read",
+  [BENCH_READ_RANGE]    = "read range",
+  [BENCH_FIND_TIME]     = "find time",
+  [BENCH_PACK]          = "pack",
+  [BENCH_ERASE_ALL]     = "erase all",
+  [BENCH_KEY_VALUE_WRITE] = "kv write",
+  [BENCH_KEY_VALUE_READ]  = "kv read",
+  [BENCH_ROLLUP]        = "rollup",
+  [BENCH_SD_MIRROR]     = "SD mirror",
+  [BENCH_SD_OFFLOAD]    = "SD offload",
+};
+
+/**
+ * @brief totals of an operation
+ */
+typedef struct
+{
+  uint64_t count;
+  uint64_t spiBytes;
+  uint64_t chipSelects;
+  uint64_t statusReads;
+  uint64_t reads;
+  uint64_t programs;
+  uint64_t erases;
+  uint64_t others;
+  uint64_t time;          //ns
+  double energy;          //J
+  uint64_t framWrites;
+}struct_benchResult;
+
+/**
+ * @brief settings of the benchmark
+ */
+typedef struct
+{
+  uint64_t wakes;             //number of measurements written
+  uint32_t coldInterval;      //wakes between loss of backup registers, 0 = never
+  uint32_t framInterval;      //wakes between corruption of FRAM state, 0 = never
+  uint32_t readInterval;      //wakes between read operations, 0 = never
+  uint32_t powerLossInterval; //wakes between power loss during background erase, 0 = never
+  uint32_t writeLossInterval; //wakes between power loss during the write of a measurement, 0 = never
+  uint32_t eraseInterval;     //wakes between erase of the complete measurement memory, 0 = never
+  uint32_t keyValueInterval;  //wakes between writes of the key-value store, 0 = never
+  uint32_t idleTime;          //ms, time between write and switch off of vSys
+  uint8_t verify;             //write verify of measurement log
+  uint8_t staging;            //measurements staged in FRAM before programming dataflash
+  uint16_t rollupWindow;      //minutes of the rollup window, 0 = no rollups
+  uint8_t sdMirrorBatch;      //measurements collected before the SD card is written, 0 = no mirror
+  uint32_t cardSwapInterval;  //wakes between swap of the SD card, 0 = never
+  bool offload;               //offload of the measurement memory to the SD card at the end
+  const char * imagePath;
+  bool log;
+}struct_benchSettings;
+
+static struct_benchResult result[BENCH_NUMBER_OF_OPERATIONS];
+static struct_simStatistics snapshotFlash;
+static struct_platformStatistics snapshotPlatform;
+static uint64_t snapshotTime;
+static uint64_t failures = 0;
+static uint32_t firmwareWear[3];    //minimum, maximum and average erase cycles of the wear journal
+
+static uint32_t expectedNext;       //next measurement ID expected in a range read
+static jmp_buf powerFailJump;       //return to the wake loop when the supply is lost during a write
+
+static uint8_t keyValueExpected[KEY_VALUE_NUMBER_OF_KEYS][KEY_VALUE_MAX_LENGTH];
+static uint16_t keyValueExpectedLength[KEY_VALUE_NUMBER_OF_KEYS];  //0 = key not available
+static int keyValueTornKey = -1;    //key of a write interrupted by power loss, the old or new value is valid
+static uint8_t keyValueTorn[KEY_VALUE_MAX_LENGTH];
+static uint16_t keyValueTornLength;
+
+static uint32_t sdCardNextMeasurementId = UINT32_MAX; //measurement ID after the last block of the previous card, UINT32_MAX = no card
+static uint32_t sdCardMeasurements = 0;  //measurements read back from all cards
+static uint32_t sdCards = 0;             //cards read back with a mirror file
+
+/**
+ * @fn void createMeasurement(uint32_t, struct_MFM_sensorModuleData*, struct_MFM_baseData*)
+ * @brief helper function to create the measurement of an ID, the data changes slowly as real sensors
+ * and the size changes sometimes to force key-frames.
+ *
+ * @param id : measurement ID
+ * @param sensorModuleData : sensor data
+ * @param baseData : base data
+ */
+static void createMeasurement( uint32_t id, struct_MFM_sensorModuleData * sensorModuleData, struct_MFM_baseData * baseData )
+{
+  memset(sensorModuleData, 0, sizeof(*sensorModuleData));
+  memset(baseData, 0, sizeof(*baseData));
+
+  sensorModuleData->sensorModuleSlotId = id % MEASUREMENT_NUMBER_OF_SLOTS + 1;
+  sensorModuleData->sensorModuleTypeId = 1;
+  sensorModuleData->sensorModuleProtocolId = 2;
+  sensorModuleData->sensorModuleDataSize = (id % MEASUREMENT_NUMBER_OF_SLOTS == 2) ? MAX_SENSOR_DATASIZE : 8;
+
+  if( id % 97 == 5 )
+  {
+    sensorModuleData->sensorModuleDataSize = 4;
+  }
+
+  for( int i = 0; i < sensorModuleData->sensorModuleDataSize; i++ )
+  {
+    sensorModuleData->sensorModuleData[i] = (uint8_t)(((id / MEASUREMENT_NUMBER_OF_SLOTS) >> (i % 5)) + i);
+  }
+
+  baseData->messageType = 1;
+  baseData->batteryStateEos = (id / 600) & 0xFF;
+  baseData->diagnosticBits = 3;
+  memset(baseData->spare, 0xFF, sizeof(baseData->spare));
+}
+
+/**
+ * @fn bool checkMeasurement(const STRUCT_measurementData*, uint32_t)
+ * @brief helper function to compare a read measurement with the written measurement
+ *
+ * @param measurement : read measurement
+ * @param id : expected measurement ID
+ * @return true = equal
+ */
+static bool checkMeasurement( const STRUCT_measurementData * measurement, uint32_t id )
+{
+  struct_MFM_sensorModuleData sensorModuleData;
+  struct_MFM_baseData baseData;
+
+  createMeasurement(id, &sensorModuleData, &baseData);
+
+  return measurement->measurementId == id &&
+         measurement->timestamp == BENCH_START_TIME + id * BENCH_MEASUREMENT_PERIOD &&
+         measurement->sensorModuleData.sensorModuleSlotId == sensorModuleData.sensorModuleSlotId &&
+         measurement->sensorModuleData.sensorModuleDataSize == sensorModuleData.sensorModuleDataSize &&
+         memcmp(measurement->sensorModuleData.sensorModuleData, sensorModuleData.sensorModuleData, sensorModuleData.sensorModuleDataSize) == 0 &&
+         memcmp(&measurement->MFM_baseData, &baseData, sizeof(measurement->MFM_baseData)) == 0;
+}
+
+/**
+ * @fn void fail(const char*, uint32_t)
+ * @brief helper function to report a failed check
+ *
+ * @param text : description
+ * @param id : measurement ID
+ */
+static void fail( const char * text, uint32_t id )
+{
+  failures++;
+
+  if( failures <= 20 )
+  {
+    fprintf(stderr, "FAIL: %s, measurement %u\n", text, id);
+  }
+}
+
+/**
+ * @fn void beginOperation(void)
+ * @brief helper function to take a snapshot of the statistics at the start of an operation
+ *
+ */
+static void beginOperation( void )
+{
+  snapshotFlash = *getStatisticsFlashSim();
+  snapshotPlatform = *getStatisticsPlatformSim();
+  snapshotTime = getTimeFlashSim();
+}
+
+/**
+ * @fn void endOperation(ENUM_benchOperation)
+ * @brief helper function to add the statistics since \ref beginOperation to an operation
+ *
+ * @param operation : operation
+ */
+static void endOperation( ENUM_benchOperation operation )
+{
+  const struct_simStatistics * flash = getStatisticsFlashSim();
+  struct_benchResult * total = &result[operation];
+  uint64_t commands[256];
+  uint64_t allCommands = 0;
+
+  for( int i = 0; i < 256; i++ )
+  {
+    commands[i] = flash->commands[i] - snapshotFlash.commands[i];
+    allCommands += commands[i];
+  }
+
+  total->count++;
+  total->spiBytes += flash->spiBytes - snapshotFlash.spiBytes;
+  total->chipSelects += flash->chipSelects - snapshotFlash.chipSelects;
+  total->statusReads += commands[0x05] + commands[0x35];
+  total->reads += commands[0x03] + commands[0x0B];
+  total->programs += commands[0x02];
+  total->erases += commands[0x20] + commands[0x52] + commands[0xD8] + commands[0x60] + commands[0xC7];
+  total->others += allCommands - (commands[0x05] + commands[0x35] + commands[0x03] + commands[0x0B] + commands[0x02] +
+                                  commands[0x20] + commands[0x52] + commands[0xD8] + commands[0x60] + commands[0xC7]);
+  total->time += getTimeFlashSim() - snapshotTime;
+  total->energy += flash->energy - snapshotFlash.energy;
+  total->framWrites += getStatisticsPlatformSim()->framWrites - snapshotPlatform.framWrites;
+}
+
+/**
+ * @fn int8_t rangeCallback(const STRUCT_measurementData*, void*)
+ * @brief callback of range read, each measurement is checked
+ *
+ * @param measurement : read measurement
+ * @param context : not used
+ * @return 0 = continue, -1 = stop
+ */
+static int8_t rangeCallback( const STRUCT_measurementData * measurement, void * context )
+{
+  UNUSED(context);
+
+  if( checkMeasurement(measurement, expectedNext) == false )
+  {
+    fail("range read mismatch", expectedNext);
+    return -1;
+  }
+
+  expectedNext++;
+
+  return 0;
+}
+
+/**
+ * @fn bool checkPackedRecords(const uint8_t*, int32_t, uint32_t, uint16_t, const char*)
+ * @brief helper function to compare the records of a packed block with the written measurements
+ *
+ * @param buffer : packed records
+ * @param length : bytes of the packed records
+ * @param first : measurement ID of the first record
+ * @param numberOfRecords : number of records
+ * @param text : description of a failure
+ * @return true = equal
+ */
+static bool checkPackedRecords( const uint8_t * buffer, int32_t length, uint32_t first, uint16_t numberOfRecords, const char * text )
+{
+  int32_t offset = 0;
+
+  for( uint16_t i = 0; i < numberOfRecords; i++ )
+  {
+    const STRUCT_measurementRecord * record = (const STRUCT_measurementRecord *)&buffer[offset];
+    struct_MFM_sensorModuleData sensorModuleData;
+    struct_MFM_baseData baseData;
+
+    createMeasurement(first + i, &sensorModuleData, &baseData);
+
+    if( offset + (int32_t)MEASUREMENT_RECORD_HEADER_SIZE > length || offset + record->length > length ||
+        record->timestamp != BENCH_START_TIME + (first + i) * BENCH_MEASUREMENT_PERIOD ||
+        record->sensorModuleDataSize != sensorModuleData.sensorModuleDataSize ||
+        memcmp(record->sensorModuleData, sensorModuleData.sensorModuleData, sensorModuleData.sensorModuleDataSize) != 0 )
+    {
+      fail(text, first + i);
+      return false;
+    }
+
+    offset += record->length;
+  }
+
+  return offset == length;
+}
+
+/**
+ * @fn void runReadOperations(uint32_t)
+ * @brief helper function to run the read operations of the log and check the results
+ *
+ * @param random : random value
+ */
+static void runReadOperations( uint32_t random )
+{
+  uint32_t oldest = getOldestMeasurementId();
+  uint32_t latest = getLatestMeasurementId();
+  uint32_t id;
+  uint32_t end;
+  uint32_t found;
+  STRUCT_measurementData measurement;
+  uint8_t buffer[BENCH_PACK_BUFFER_SIZE];
+  uint32_t first;
+  uint32_t next;
+  uint16_t numberOfRecords;
+  int32_t length;
+
+  if( latest <= oldest )
+  {
+    return;
+  }
+
+  id = oldest + random % (latest - oldest);
+
+  //one measurement
+  beginOperation();
+  if( readMeasurement(id, (uint8_t*)&measurement, sizeof(measurement)) != 0 || checkMeasurement(&measurement, id) == false )
+  {
+    fail("read mismatch", id);
+  }
+  endOperation(BENCH_READ);
+
+  //range
+  end = id + BENCH_RANGE_LENGTH < latest ? id + BENCH_RANGE_LENGTH : latest;
+  expectedNext = id;
+  beginOperation();
+  if( readMeasurementRange(id, end, rangeCallback, NULL) != 0 || expectedNext != end )
+  {
+    fail("range read incomplete", expectedNext);
+  }
+  endOperation(BENCH_READ_RANGE);
+
+  //time search, between two measurements
+  beginOperation();
+  if( findMeasurementByTime(BENCH_START_TIME + id * BENCH_MEASUREMENT_PERIOD - BENCH_MEASUREMENT_PERIOD / 2, &found) != 0 || found != id )
+  {
+    fail("find by time", id);
+  }
+  endOperation(BENCH_FIND_TIME);
+
+  //pack for uplink
+  beginOperation();
+  length = packMeasurementBlock(0, id, latest, buffer, sizeof(buffer), &first, &next, &numberOfRecords);
+  endOperation(BENCH_PACK);
+
+  if( length <= 0 || first != id || next != first + numberOfRecords )
+  {
+    fail("pack", id);
+  }
+  else
+  {
+    checkPackedRecords(buffer, length, first, numberOfRecords, "pack record mismatch");
+  }
+}
+
+/**
+ * @fn void checkKeyValue(int)
+ * @brief helper function to read a key of the key-value store and compare it with the expected value
+ *
+ * @param key : key
+ */
+static void checkKeyValue( int key )
+{
+  uint8_t value[KEY_VALUE_MAX_LENGTH];
+  uint16_t length = sizeof(value);
+  int8_t read = readKeyValue(key, value, &length);
+
+  if( read < 0 )
+  {
+    fail("key-value read", key);
+    return;
+  }
+
+  //write interrupted by power loss, the new value is valid when all its bytes were programmed
+  if( key == keyValueTornKey )
+  {
+    keyValueTornKey = -1;
+
+    if( length == keyValueTornLength && memcmp(value, keyValueTorn, length) == 0 )
+    {
+      memcpy(keyValueExpected[key], keyValueTorn, length);
+      keyValueExpectedLength[key] = length;
+    }
+  }
+
+  if( length != keyValueExpectedLength[key] || memcmp(value, keyValueExpected[key], length) != 0 )
+  {
+    fail("key-value mismatch", key);
+  }
+}
+
+/**
+ * @fn void runKeyValueOperations(uint32_t)
+ * @brief helper function to write or delete a random key of the key-value store and read back another key
+ *
+ * @param random : random value
+ */
+static void runKeyValueOperations( uint32_t random )
+{
+  int key = random % KEY_VALUE_NUMBER_OF_KEYS;
+  uint16_t length = 1 + (random >> 4) % KEY_VALUE_MAX_LENGTH;
+  uint8_t value[KEY_VALUE_MAX_LENGTH];
+  int8_t result;
+
+  for( int i = 0; i < length; i++ )
+  {
+    value[i] = (uint8_t)(random >> (i % 24)) + i;
+  }
+
+  //value is old or new after power loss during the write
+  if( keyValueTornKey != -1 )
+  {
+    checkKeyValue(keyValueTornKey);
+  }
+  keyValueTornKey = key;
+  keyValueTornLength = (random >> 12) % 8 == 0 ? 0 : length;
+  memcpy(keyValueTorn, value, keyValueTornLength);
+
+  beginOperation();
+  result = keyValueTornLength ? writeKeyValue(key, value, length) : deleteKeyValue(key);
+  endOperation(BENCH_KEY_VALUE_WRITE);
+
+  keyValueTornKey = -1;
+
+  if( result != 0 )
+  {
+    fail("key-value write", key);
+  }
+  else
+  {
+    memcpy(keyValueExpected[key], value, keyValueTornLength);
+    keyValueExpectedLength[key] = keyValueTornLength;
+  }
+
+  beginOperation();
+  checkKeyValue((random >> 20) % KEY_VALUE_NUMBER_OF_KEYS);
+  endOperation(BENCH_KEY_VALUE_READ);
+}
+
+/**
+ * @fn void powerFail(void)
+ * @brief callback of the simulation when the supply is lost during a page program, the MCU stops as well.
+ *
+ */
+static void powerFail( void )
+{
+  longjmp(powerFailJump, 1);
+}
+
+/**
+ * @fn void printUsage(const char*)
+ * @brief helper function to print the options
+ *
+ * @param name : program name
+ */
+static void printUsage( const char * name )
+{
+  printf("usage: %s [options]\n", name);
+  printf("  -n <wakes>     number of measurements written (default 1000000)\n");
+  printf("  -c <interval>  wakes between loss of backup registers, 0 = never (default 1000)\n");
+  printf("  -f <interval>  wakes between corruption of FRAM state, 0 = never (default 10000)\n");
+  printf("  -r <interval>  wakes between read operations, 0 = never (default 100)\n");
+  printf("  -p <interval>  wakes between power loss during background erase, 0 = never (default 0)\n");
+  printf("  -w <interval>  wakes between power loss during the write of a measurement, 0 = never (default 0)\n");
+  printf("  -e <interval>  wakes between erase of the complete measurement memory, 0 = never (default 0)\n");
+  printf("  -k <interval>  wakes between writes of the key-value store, 0 = never (default 0)\n");
+  printf("  -t <ms>        idle time between write and switch off of vSys (default 1500)\n");
+  printf("  -s <Hz>        SPI clock (default 1000000)\n");
+  printf("  -v <level>     write verify, 0 = none .. 3 = full (default %d)\n", MEASUREMENT_VERIFY_DEFAULT);
+  printf("  -g <records>   measurements staged in FRAM, 1 = none .. %d (default %d)\n", MEASUREMENT_STAGING_MAX, MEASUREMENT_STAGING_DEFAULT);
+  printf("  -u <minutes>   rollup window, 0 = no rollups .. %d (default 0)\n", ROLLUP_WINDOW_MAX);
+  printf("  -d <batch>     measurements mirrored on the SD card in one batch, 0 = no mirror .. %d (default 0)\n", SD_MIRROR_BATCH_MAX);
+  printf("  -m <interval>  wakes between swap of the SD card, 0 = never (default 0)\n");
+  printf("  -o             offload of the measurement memory to the SD card at the end\n");
+  printf("  -i <file>      image file of dataflash, kept between runs (default none)\n");
+  printf("  -l             print log of firmware\n");
+}
+
+/**
+ * @fn void printReport(const struct_benchSettings*, uint64_t)
+ * @brief helper function to print the results
+ *
+ * @param settings : settings of the run
+ * @param wakes : number of wakes done
+ */
+static void printReport( const struct_benchSettings * settings, uint64_t wakes )
+{
+  static const char * stateName[SIM_NUMBER_OF_STATES] = { "off", "deep power-down", "standby", "active", "program", "erase" };
+  const struct_simStatistics * flash = getStatisticsFlashSim();
+  const struct_platformStatistics * platform = getStatisticsPlatformSim();
+  const struct_simConfig * config = getConfigFlashSim();
+  uint32_t measurementBlocks = NUMBER_PAGES_FOR_MEASUREMENTS / NUMBER_OF_PAGES_IN_4K_BLOCK_DATAFLASH;
+  uint32_t minimumErase = UINT32_MAX;
+  uint32_t maximumErase = 0;
+  uint64_t totalErase = 0;
+  uint32_t reservedErase = 0;
+
+  printf("\nAT25QF641B storage benchmark\n");
+  printf("  wakes %llu, SPI %u Hz, chip select %u us, verify %u, staging %u\n", (unsigned long long)wakes, config->spiFrequency, config->chipSelectTime / 1000, settings->verify, settings->staging);
+  printf("  log: oldest %u, latest %u, measurements %u\n", getOldestMeasurementId(), getLatestMeasurementId(), getNumberOfMeasures());
+
+  printf("\n%-14s %10s %10s %8s %8s %8s %8s %8s %8s %10s %11s %6s\n",
+         "operation", "count", "SPI bytes", "CS", "status", "read", "program", "erase", "other", "time ms", "energy uJ", "FRAM");
+
+  for( int i = 0; i < BENCH_NUMBER_OF_OPERATIONS; i++ )
+  {
+    const struct_benchResult * total = &result[i];
+    double count = total->count;
+
+    if( total->count == 0 )
+    {
+      continue;
+    }
+
+    printf("%-14s %10llu %10.1f %8.2f %8.2f %8.2f %8.2f %8.3f %8.2f %10.3f %11.3f %6.2f\n", operationName[i], (unsigned long long)total->count,
+           total->spiBytes / count, total->chipSelects / count, total->statusReads / count, total->reads / count, total->programs / count,
+           total->erases / count, total->others / count, total->time / count / 1e6, total->energy / count * 1e6, total->framWrites / count);
+  }
+  printf("(average per operation)\n");
+
+  printf("\ndataflash totals\n");
+  printf("  SPI bytes %llu, transactions %llu, read bytes %llu, programmed bytes %llu, erased 4K blocks %llu\n",
+         (unsigned long long)flash->spiBytes, (unsigned long long)flash->chipSelects, (unsigned long long)flash->readBytes,
+         (unsigned long long)flash->programBytes, (unsigned long long)flash->erasedBlocks);
+  printf("  suspends %llu, resumes %llu, torn operations %llu, rejected %llu, reprogrammed bytes %llu, violations %llu\n",
+         (unsigned long long)flash->suspends, (unsigned long long)flash->resumes, (unsigned long long)flash->tornOperations,
+         (unsigned long long)flash->rejected, (unsigned long long)flash->reprogrammed, (unsigned long long)flash->violations);
+  printf("  energy %.3f J, %.3f uJ per wake\n", flash->energy, wakes ? flash->energy / wakes * 1e6 : 0.0);
+
+  for( int i = SIM_STATE_DPD; i < SIM_NUMBER_OF_STATES; i++ )
+  {
+    double energy = (double)config->voltage * config->current[i] * flash->stateTime[i] * 1e-9;
+
+    printf("  %-16s %12.3f s %10.3f J\n", stateName[i], flash->stateTime[i] / 1e9, energy);
+  }
+
+  printf("\ncommands\n");
+  for( int i = 0; i < 256; i++ )
+  {
+    if( flash->commands[i] != 0 )
+    {
+      printf("  0x%02X %12llu\n", i, (unsigned long long)flash->commands[i]);
+    }
+  }
+
+  for( uint32_t block = 0; block < NUMBER_4K_BLOCK_DATAFLASH; block++ )
+  {
+    uint32_t count = getEraseCountFlashSim(block);
+
+    if( block < measurementBlocks )
+    {
+      minimumErase = count < minimumErase ? count : minimumErase;
+      maximumErase = count > maximumErase ? count : maximumErase;
+      totalErase += count;
+    }
+    else
+    {
+      reservedErase = count > reservedErase ? count : reservedErase;
+    }
+  }
+
+  printf("\nwear of measurement blocks\n");
+  printf("  erase cycles min %u, max %u, average %.2f, reserved blocks max %u\n", minimumErase, maximumErase, (double)totalErase / measurementBlocks, reservedErase);
+  printf("  log wraps %.2f\n", (double)totalErase / measurementBlocks);
+  printf("  wear journal of firmware: min %u, max %u, average %u\n", firmwareWear[0], firmwareWear[1], firmwareWear[2]);
+
+  if( maximumErase > 0 )
+  {
+    double wakesToEndurance = (double)wakes * ENDURANCE_FLASH_SIM / maximumErase;
+
+    printf("  endurance of %u cycles reached after %.3g wakes, %.1f years at %u s interval\n", ENDURANCE_FLASH_SIM, wakesToEndurance,
+           wakesToEndurance * BENCH_MEASUREMENT_PERIOD / (365.25 * 24 * 3600), BENCH_MEASUREMENT_PERIOD);
+  }
+
+  if( settings->sdMirrorBatch != 0 )
+  {
+    const struct_sdSimStatistics * sd = getStatisticsSdSim();
+    uint64_t appends = result[BENCH_SD_MIRROR].count;
+
+    printf("\nSD mirror: batch %u, cards %llu, swaps %llu, measurements read back %u, next measurement %u\n", settings->sdMirrorBatch,
+           (unsigned long long)sdCards, (unsigned long long)sd->swaps, sdCardMeasurements, getSdMirrorMeasurementId());
+    printf("  initializations %llu, read commands %llu (%llu sectors), write commands %llu (%llu sectors)\n",
+           (unsigned long long)sd->initializations, (unsigned long long)sd->readCommands, (unsigned long long)sd->sectorsRead,
+           (unsigned long long)sd->writeCommands, (unsigned long long)sd->sectorsWritten);
+    printf("  time %.3f s, %.3f ms per append, %.3f ms per wake\n", sd->time / 1e9, appends ? sd->time / 1e6 / appends : 0.0,
+           wakes ? sd->time / 1e6 / wakes : 0.0);
+  }
+
+  printf("\nFRAM log state: writes %llu (%.2f per wake), bytes %llu, reads %llu\n", (unsigned long long)platform->framWrites,
+         wakes ? (double)platform->framWrites / wakes : 0.0, (unsigned long long)platform->framWriteBytes, (unsigned long long)platform->framReads);
+}
+
+/**
+ * @fn void verifyLog(void)
+ * @brief helper function to read back the complete log and check all measurements
+ *
+ */
+static void verifyLog( void )
+{
+  uint32_t oldest = getOldestMeasurementId();
+  uint32_t latest = getLatestMeasurementId();
+  STRUCT_measurementData measurement;
+
+  setVsysPlatformSim(true);
+
+  expectedNext = oldest;
+  if( readMeasurementRange(oldest, latest, rangeCallback, NULL) != 0 || expectedNext != latest )
+  {
+    fail("verify of complete log", expectedNext);
+  }
+
+  if( oldest > 0 && readMeasurement(oldest - 1, (uint8_t*)&measurement, sizeof(measurement)) == 0 )
+  {
+    fail("overwritten measurement readable", oldest - 1);
+  }
+
+  //key-value store
+  invalidateKeyValueIndex();
+  for( int key = 0; key < KEY_VALUE_NUMBER_OF_KEYS; key++ )
+  {
+    checkKeyValue(key);
+  }
+
+  setVsysPlatformSim(false);
+}
+
+/**
+ * @fn bool decodeBenchValues(const struct_MFM_sensorModuleData*, float*)
+ * @brief helper function to decode the values of a written measurement like the rollup aggregation, the bench writes pressure sensor data
+ *
+ * @param sensorModuleData : sensor data
+ * @param values : destination of ROLLUP_NUMBER_OF_VALUES values
+ * @return true = values valid
+ */
+static bool decodeBenchValues( const struct_MFM_sensorModuleData * sensorModuleData, float * values )
+{
+  structDataPressureSensor data;
+
+  if( sensorModuleData->sensorModuleDataSize < sizeof(data) - sizeof(data.dataLength) )
+  {
+    return false;
+  }
+
+  memcpy(&data, &sensorModuleData->sensorModuleDataSize, sizeof(data));
+  values[0] = data.pressure1;
+  values[1] = data.temperature1;
+  values[2] = data.pressure2;
+  values[3] = data.temperature2;
+
+  for( int i = 0; i < ROLLUP_NUMBER_OF_VALUES; i++ )
+  {
+    if( isfinite(values[i]) == false )
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @fn void checkRollups(const struct_benchSettings*)
+ * @brief helper function to read all rollups and compare them with the rollups calculated from the written measurements.
+ * The windows of a slot follow in time, each window is aggregated once.
+ *
+ * @param settings : settings of the run
+ */
+static void checkRollups( const struct_benchSettings * settings )
+{
+  uint32_t windowEnd[MEASUREMENT_NUMBER_OF_SLOTS] = { 0 };
+  uint32_t numberOfRollups = 0;
+  STRUCT_rollupRecord rollup;
+
+  if( settings->rollupWindow == 0 )
+  {
+    return;
+  }
+
+  setVsysPlatformSim(true);
+
+  for( uint32_t rollupId = getOldestRollupId(); rollupId < getLatestRollupId(); rollupId++ )
+  {
+    struct_MFM_sensorModuleData sensorModuleData;
+    struct_MFM_baseData baseData;
+    float values[ROLLUP_NUMBER_OF_VALUES];
+    float minimum[ROLLUP_NUMBER_OF_VALUES];
+    float maximum[ROLLUP_NUMBER_OF_VALUES];
+    float sum[ROLLUP_NUMBER_OF_VALUES] = { 0 };
+    uint16_t count = 0;
+
+    if( readRollup(rollupId, (uint8_t*)&rollup, sizeof(rollup)) != 0 )
+    {
+      fail("rollup not readable", rollupId);
+      continue;
+    }
+
+    numberOfRollups++;
+
+    //time restarts with the measurement IDs after an erase of the measurement memory
+    if( (settings->eraseInterval == 0 && rollup.windowStart < windowEnd[rollup.slotId - 1]) || rollup.windowMinutes != settings->rollupWindow ||
+        rollup.windowStart % (rollup.windowMinutes * 60) != 0 )
+    {
+      fail("rollup window", rollupId);
+    }
+    windowEnd[rollup.slotId - 1] = rollup.windowStart + rollup.windowMinutes * 60;
+
+    //measurements of the window, erased measurements are not known
+    if( settings->eraseInterval != 0 || rollup.windowStart < BENCH_START_TIME )
+    {
+      continue;
+    }
+
+    for( uint32_t id = (rollup.windowStart - BENCH_START_TIME + BENCH_MEASUREMENT_PERIOD - 1) / BENCH_MEASUREMENT_PERIOD;
+         BENCH_START_TIME + id * BENCH_MEASUREMENT_PERIOD < windowEnd[rollup.slotId - 1]; id++ )
+    {
+      createMeasurement(id, &sensorModuleData, &baseData);
+
+      if( sensorModuleData.sensorModuleSlotId != rollup.slotId || decodeBenchValues(&sensorModuleData, values) == false )
+      {
+        continue;
+      }
+
+      for( int i = 0; i < ROLLUP_NUMBER_OF_VALUES; i++ )
+      {
+        minimum[i] = count == 0 || values[i] < minimum[i] ? values[i] : minimum[i];
+        maximum[i] = count == 0 || values[i] > maximum[i] ? values[i] : maximum[i];
+        sum[i] += values[i];
+      }
+      count++;
+    }
+
+    if( rollup.count != count || rollup.numberOfValues != ROLLUP_NUMBER_OF_VALUES )
+    {
+      fail("rollup count", rollupId);
+      continue;
+    }
+
+    for( int i = 0; i < ROLLUP_NUMBER_OF_VALUES; i++ )
+    {
+      if( rollup.minimum[i] != minimum[i] || rollup.maximum[i] != maximum[i] || rollup.mean[i] != sum[i] / count )
+      {
+        fail("rollup values", rollupId);
+        break;
+      }
+    }
+  }
+
+  setVsysPlatformSim(false);
+
+  printf("\nrollups: window %u minutes, oldest %u, latest %u, checked %u\n", settings->rollupWindow, getOldestRollupId(), getLatestRollupId(), numberOfRollups);
+}
+
+/**
+ * @fn void checkSdCard(const struct_benchSettings*)
+ * @brief helper function to read back the mirror file of the SD card with FatFs and check the header, blocks and records.
+ * The measurements continue the previous card, a block can repeat measurements of the previous block.
+ *
+ * @param settings : settings of the run
+ */
+static void checkSdCard( const struct_benchSettings * settings )
+{
+  static uint8_t block[SD_MIRROR_BLOCK_SIZE];
+  const struct_dumpBlockHeader * blockHeader = (const struct_dumpBlockHeader *)block;
+  struct_sdMirrorHeader header;
+  uint32_t expectedId;
+  uint16_t crc;
+  UINT bytes;
+
+  if( settings->sdMirrorBatch == 0 )
+  {
+    return;
+  }
+
+  if( f_mount(&USERFatFs, USERPath, 1) != FR_OK )
+  {
+    fail("SD card mount", 0);
+    return;
+  }
+
+  if( f_open(&USERFile, SD_MIRROR_FILE_NAME, FA_READ) != FR_OK )
+  {
+    //no batch written on this card
+    f_mount(NULL, USERPath, 0);
+    return;
+  }
+
+  if( f_read(&USERFile, block, SD_MIRROR_SECTOR_SIZE, &bytes) != FR_OK || bytes != SD_MIRROR_SECTOR_SIZE )
+  {
+    fail("SD mirror header read", 0);
+  }
+  else
+  {
+    memcpy(&header, block, sizeof(header));
+
+    if( memcmp(header.magic, SD_MIRROR_MAGIC, sizeof(header.magic)) != 0 ||
+        header.crc != calculateCRC_CCITT((uint8_t*)&header, sizeof(header) - sizeof(header.crc)) ||
+        (FSIZE_t)header.numberOfSectors * SD_MIRROR_SECTOR_SIZE != f_size(&USERFile) ||
+        header.writeSector > header.numberOfSectors || header.writeSector % SD_MIRROR_BLOCK_SECTORS != 0 )
+    {
+      fail("SD mirror header", header.nextMeasurementId);
+    }
+    else
+    {
+      if( settings->eraseInterval == 0 && sdCardNextMeasurementId != UINT32_MAX && header.firstMeasurementId != sdCardNextMeasurementId )
+      {
+        fail("SD mirror continues previous card", header.firstMeasurementId);
+      }
+
+      expectedId = header.firstMeasurementId;
+      sdCards++;
+
+      for( uint32_t sector = SD_MIRROR_BLOCK_SECTORS; sector < header.writeSector; sector += SD_MIRROR_BLOCK_SECTORS )
+      {
+        if( f_lseek(&USERFile, (FSIZE_t)sector * SD_MIRROR_SECTOR_SIZE) != FR_OK ||
+            f_read(&USERFile, block, sizeof(block), &bytes) != FR_OK || bytes != sizeof(block) )
+        {
+          fail("SD mirror block read", expectedId);
+          break;
+        }
+
+        if( blockHeader->length + sizeof(struct_dumpBlockHeader) + sizeof(crc) > sizeof(block) )
+        {
+          fail("SD mirror block length", expectedId);
+          break;
+        }
+
+        memcpy(&crc, &block[sizeof(struct_dumpBlockHeader) + blockHeader->length], sizeof(crc));
+
+        if( blockHeader->sync != DUMP_BLOCK_SYNC || blockHeader->sequence != sector / SD_MIRROR_BLOCK_SECTORS - 1 ||
+            crc != calculateCRC_CCITT(block, sizeof(struct_dumpBlockHeader) + blockHeader->length) )
+        {
+          fail("SD mirror block", expectedId);
+          break;
+        }
+
+        //no gap, measurements of the previous block are repeated after power loss, all IDs restart after erase
+        if( (settings->eraseInterval == 0 && blockHeader->firstMeasurementId > expectedId) ||
+            checkPackedRecords(&block[sizeof(struct_dumpBlockHeader)], blockHeader->length, blockHeader->firstMeasurementId,
+                               blockHeader->numberOfRecords, "SD mirror record mismatch") == false )
+        {
+          fail("SD mirror records", expectedId);
+          break;
+        }
+
+        expectedId = blockHeader->firstMeasurementId + blockHeader->numberOfRecords;
+        sdCardMeasurements += blockHeader->numberOfRecords;
+      }
+
+      if( expectedId != header.nextMeasurementId )
+      {
+        fail("SD mirror next measurement", expectedId);
+      }
+
+      sdCardNextMeasurementId = header.nextMeasurementId;
+    }
+  }
+
+  f_close(&USERFile);
+  f_mount(NULL, USERPath, 0);
+}
+
+/**
+ * @fn void checkSdOffload(const struct_benchSettings*)
+ * @brief helper function to offload the measurement memory to the SD card and compare the file with the dataflash
+ *
+ * @param settings : settings of the run
+ */
+static void checkSdOffload( const struct_benchSettings * settings )
+{
+  static uint8_t buffer[SD_OFFLOAD_BUFFER_SIZE];
+  const uint8_t * memory = getMemoryFlashSim();
+  struct_sdOffloadHeader header;
+  uint32_t address = 0;
+  uint32_t bytes;
+  uint32_t milliseconds;
+  int8_t status;
+  UINT length;
+
+  if( settings->offload == false )
+  {
+    return;
+  }
+
+  setVsysPlatformSim(true);
+
+  beginOperation();
+  do
+  {
+    status = offloadMeasurementMemoryToSd(&address);
+  }while( status == 0 );
+  endOperation(BENCH_SD_OFFLOAD);
+
+  setVsysPlatformSim(false);
+
+  if( status != 1 )
+  {
+    fail("SD offload", address);
+    return;
+  }
+
+  //the image is taken after the measurements staged in FRAM are programmed
+  if( getStagedRecordCount() != 0 )
+  {
+    fail("SD offload staged records", getStagedRecordCount());
+  }
+
+  if( f_mount(&USERFatFs, USERPath, 1) != FR_OK || f_open(&USERFile, SD_OFFLOAD_FILE_NAME, FA_READ) != FR_OK )
+  {
+    fail("SD offload file", 0);
+    f_mount(NULL, USERPath, 0);
+    return;
+  }
+
+  if( f_read(&USERFile, buffer, SD_OFFLOAD_SECTOR_SIZE, &length) != FR_OK || length != SD_OFFLOAD_SECTOR_SIZE )
+  {
+    fail("SD offload header read", 0);
+  }
+  else
+  {
+    memcpy(&header, buffer, sizeof(header));
+
+    if( memcmp(header.magic, SD_OFFLOAD_MAGIC, sizeof(header.magic)) != 0 ||
+        header.crc != calculateCRC_CCITT((uint8_t*)&header, sizeof(header) - sizeof(header.crc)) ||
+        header.imageSize != MEASUREMENT_MEMEORY_SIZE || header.imageOffset == 0 || header.imageOffset > SD_OFFLOAD_BUFFER_SIZE ||
+        header.oldestMeasurementId != getOldestMeasurementId() || header.latestMeasurementId != getLatestMeasurementId() )
+    {
+      fail("SD offload header", header.latestMeasurementId);
+    }
+    else if( f_lseek(&USERFile, header.imageOffset) != FR_OK )
+    {
+      fail("SD offload seek", 0);
+    }
+    else
+    {
+      for( address = 0; address < header.imageSize; address += sizeof(buffer) )
+      {
+        if( f_read(&USERFile, buffer, sizeof(buffer), &length) != FR_OK || length != sizeof(buffer) ||
+            memcmp(buffer, &memory[address], sizeof(buffer)) != 0 )
+        {
+          fail("SD offload image differs from dataflash", address);
+          break;
+        }
+      }
+    }
+  }
+
+  f_close(&USERFile);
+  f_mount(NULL, USERPath, 0);
+
+  getSdOffloadResult(&bytes, &milliseconds);
+
+  printf("\nSD offload: %u bytes in %u ms, %.2f MB/s\n", bytes, milliseconds, milliseconds ? bytes / 1e3 / milliseconds : 0.0);
+}
+
+/**
+ * @fn void checkWear(const struct_benchSettings*)
+ * @brief helper function to compare the erase cycles of the wear journal with the erase counters of the simulation.
+ * Without power loss every erase is counted by both, a block erased again after power loss is counted once by the journal.
+ *
+ * @param settings : settings of the run
+ */
+static void checkWear( const struct_benchSettings * settings )
+{
+  uint32_t measurementBlocks = NUMBER_PAGES_FOR_MEASUREMENTS / NUMBER_OF_PAGES_IN_4K_BLOCK_DATAFLASH;
+  uint32_t minimumErase = UINT32_MAX;
+  uint32_t maximumErase = 0;
+  uint64_t totalErase = 0;
+
+  setVsysPlatformSim(true);
+
+  if( getMeasurementWear(&firmwareWear[0], &firmwareWear[1], &firmwareWear[2]) != 0 )
+  {
+    fail("wear journal", 0);
+  }
+
+  setVsysPlatformSim(false);
+
+  for( uint32_t block = 0; block < measurementBlocks; block++ )
+  {
+    uint32_t count = getEraseCountFlashSim(block);
+
+    minimumErase = count < minimumErase ? count : minimumErase;
+    maximumErase = count > maximumErase ? count : maximumErase;
+    totalErase += count;
+  }
+
+  if( settings->powerLossInterval == 0 && settings->writeLossInterval == 0 && settings->imagePath == NULL &&
+      (firmwareWear[0] != minimumErase || firmwareWear[1] != maximumErase || firmwareWear[2] != (totalErase + measurementBlocks / 2) / measurementBlocks) )
+  {
+    fail("wear journal differs from erase counters", firmwareWear[1]);
+  }
+}
+
+int main( int argc, char * argv[] )
+{
+  struct_benchSettings settings =
+  {
+    .wakes = 1000000,
+    .coldInterval = 1000,
+    .framInterval = 10000,
+    .readInterval = 100,
+    .powerLossInterval = 0,
+    .writeLossInterval = 0,
+    .eraseInterval = 0,
+    .keyValueInterval = 0,
+    .idleTime = 1500,
+    .verify = MEASUREMENT_VERIFY_DEFAULT,
+    .staging = MEASUREMENT_STAGING_DEFAULT,
+    .rollupWindow = 0,
+    .sdMirrorBatch = 0,
+    .cardSwapInterval = 0,
+    .offload = false,
+    .imagePath = NULL,
+    .log = false,
+  };
+  struct_simConfig config;
+  uint64_t wake;
+  volatile uint32_t expectedLatest = 0; //volatile, used after the longjmp of a simulated power failure
+  volatile bool writeTorn = false;
+  volatile uint32_t random = 1;
+  int option;
+
+  getDefaultConfigFlashSim(&config);
+
+  while( (option = getopt(argc, argv, "n:c:f:r:p:w:e:k:t:s:v:g:u:d:m:oi:lh")) != -1 )
+  {
+    switch( option )
+    {
+      case 'n': settings.wakes = strtoull(optarg, NULL, 0); break;
+      case 'c': settings.coldInterval = strtoul(optarg, NULL, 0); break;
+      case 'f': settings.framInterval = strtoul(optarg, NULL, 0); break;
+      case 'r': settings.readInterval = strtoul(optarg, NULL, 0); break;
+      case 'p': settings.powerLossInterval = strtoul(optarg, NULL, 0); break;
+      case 'w': settings.writeLossInterval = strtoul(optarg, NULL, 0); break;
+      case 'e': settings.eraseInterval = strtoul(optarg, NULL, 0); break;
+      case 'k': settings.keyValueInterval = strtoul(optarg, NULL, 0); break;
+      case 't': settings.idleTime = strtoul(optarg, NULL, 0); break;
+      case 's': config.spiFrequency = strtoul(optarg, NULL, 0); break;
+      case 'v': settings.verify = strtoul(optarg, NULL, 0); break;
+      case 'g': settings.staging = strtoul(optarg, NULL, 0); break;
+      case 'u': settings.rollupWindow = strtoul(optarg, NULL, 0); break;
+      case 'd': settings.sdMirrorBatch = strtoul(optarg, NULL, 0); break;
+      case 'm': settings.cardSwapInterval = strtoul(optarg, NULL, 0); break;
+      case 'o': settings.offload = true; break;
+      case 'i': settings.imagePath = optarg; break;
+      case 'l': settings.log = true; break;
+      default:
+        printUsage(argv[0]);
+        return option == 'h' ? 0 : 2;
+    }
+  }
+
+  if( setRollupLogWindow(settings.rollupWindow) != 0 )
+  {
+    fprintf(stderr, "rollup window %u out of range\n", settings.rollupWindow);
+    return 2;
+  }
+
+  if( init_flashSim(settings.imagePath, &config) != 0 )
+  {
+    fprintf(stderr, "image file %s not usable\n", settings.imagePath);
+    return 2;
+  }
+
+  if( init_sdSim() != 0 )
+  {
+    fprintf(stderr, "SD card simulation not available\n");
+    return 2;
+  }
+
+  init_platformSim();
+  setLogPlatformSim(settings.log);
+
+  for( wake = 0; wake < settings.wakes; wake++ )
+  {
+    struct_MFM_sensorModuleData sensorModuleData;
+    struct_MFM_baseData baseData;
+    ENUM_benchOperation boot = BENCH_BOOT_WARM;
+    bool powerLoss = settings.powerLossInterval != 0 && wake % settings.powerLossInterval == settings.powerLossInterval - 1;
+    bool writeLoss = settings.writeLossInterval != 0 && wake % settings.writeLossInterval == settings.writeLossInterval / 2;
+    bool keyValue = settings.keyValueInterval != 0 && wake % settings.keyValueInterval == 0;
+    uint32_t id;
+    SysTime_t sysTime = { 0 };
+
+    random = random * 1103515245 + 12345;
+
+    if( wake == 0 || (settings.coldInterval != 0 && wake % settings.coldInterval == 0) )
+    {
+      boot = BENCH_BOOT_COLD;
+    }
+
+    if( settings.framInterval != 0 && wake % settings.framInterval == settings.framInterval / 2 )
+    {
+      corruptFramPlatformSim(random >> 8);
+      boot = BENCH_BOOT_SCAN;
+    }
+
+    resetBackupPlatformSim(boot != BENCH_BOOT_WARM);
+
+    //MCU is switched on by the RTC, vSys is switched on for the sensor measurement
+    setVsysPlatformSim(true);
+
+    beginOperation();
+    init_dataflash();
+    restoreLatestMeasurementId();
+    restoreRollupLog();
+    invalidateKeyValueIndex(); //RAM is lost in off mode
+    endOperation(boot);
+
+    setMeasurementLogVerify(settings.verify);
+    setMeasurementLogStaging(settings.staging);
+    setRollupLogWindow(settings.rollupWindow);
+
+    //an interrupted write is restored when all its bytes were programmed before power off
+    if( writeTorn && getLatestMeasurementId() == expectedLatest + 1 )
+    {
+      expectedLatest++;
+    }
+    writeTorn = false;
+
+    if( wake != 0 && getLatestMeasurementId() != expectedLatest )
+    {
+      fail("restore of latest measurement", getLatestMeasurementId());
+    }
+
+    id = getLatestMeasurementId();
+    sysTime.Seconds = BENCH_START_TIME + id * BENCH_MEASUREMENT_PERIOD;
+    SysTimeSet(sysTime);
+    createMeasurement(id, &sensorModuleData, &baseData);
+
+    if( writeLoss && keyValue == false )
+    {
+      //supply lost during one of the page programs of the write
+      setProgramPowerFailFlashSim((random >> 8) % 2, (random >> 12) % 1000, powerFail);
+    }
+
+    if( setjmp(powerFailJump) != 0 )
+    {
+      setVsysPlatformSim(false);
+      writeTorn = true;
+      continue;
+    }
+
+    beginOperation();
+    if( writeNewMeasurement(0, &sensorModuleData, &baseData) != 0 )
+    {
+      fail("write", id);
+    }
+    endOperation(BENCH_WRITE);
+
+    if( settings.rollupWindow != 0 )
+    {
+      //supply can also be lost during the rollup
+      beginOperation();
+      if( updateRollup(sensorModuleData.sensorModuleSlotId) < 0 )
+      {
+        fail("rollup", id);
+      }
+      endOperation(BENCH_ROLLUP);
+    }
+
+    setProgramPowerFailFlashSim(0, 0, NULL); //write had less page programs
+
+    if( settings.sdMirrorBatch != 0 )
+    {
+      int8_t blocks;
+
+      beginOperation();
+      blocks = mirrorMeasurementsToSd(settings.sdMirrorBatch);
+      if( blocks < 0 )
+      {
+        fail("SD mirror", id);
+      }
+      else if( blocks > 0 )
+      {
+        endOperation(BENCH_SD_MIRROR);
+      }
+    }
+
+    beginOperation();
+    preEraseMeasurementBlock();
+    endOperation(BENCH_PRE_ERASE);
+
+    expectedLatest = getLatestMeasurementId();
+
+    if( powerLoss )
+    {
+      //supply lost during LoRa transmission, background erase is torn
+      runPlatformSim(10);
+      setVsysPlatformSim(false);
+      continue;
+    }
+
+    beginOperation();
+    runPlatformSim(settings.idleTime);
+    endOperation(BENCH_IDLE);
+
+    if( settings.readInterval != 0 && wake % settings.readInterval == 0 )
+    {
+      runReadOperations(random >> 4);
+    }
+
+    beginOperation();
+    finishPreEraseMeasurementBlock();
+    endOperation(BENCH_FINISH_ERASE);
+
+    if( keyValue )
+    {
+      if( writeLoss )
+      {
+        //supply lost during one of the page programs of the key-value write
+        setProgramPowerFailFlashSim((random >> 8) % 3, (random >> 12) % 1000, powerFail);
+      }
+
+      runKeyValueOperations(random >> 3);
+
+      setProgramPowerFailFlashSim(0, 0, NULL);
+    }
+
+    if( settings.eraseInterval != 0 && wake % settings.eraseInterval == settings.eraseInterval - 1 )
+    {
+      beginOperation();
+      eraseCompleteMeasurementMemory();
+      endOperation(BENCH_ERASE_ALL);
+
+      expectedLatest = getLatestMeasurementId();
+    }
+
+    setVsysPlatformSim(false);
+
+    if( settings.cardSwapInterval != 0 && wake % settings.cardSwapInterval == settings.cardSwapInterval - 1 )
+    {
+      //service visit, the card is read back and replaced by an empty card
+      checkSdCard(&settings);
+      swapCardSdSim();
+    }
+
+    if( settings.wakes >= 10 && (wake + 1) % (settings.wakes / 10) == 0 )
+    {
+      fprintf(stderr, "wake %llu, latest %u, failures %llu\n", (unsigned long long)(wake + 1), expectedLatest, (unsigned long long)failures);
+    }
+  }
+
+  verifyLog();
+
+  checkWear(&settings);
+
+  checkRollups(&settings);
+
+  checkSdCard(&settings);
+
+  checkSdOffload(&settings);
+
+  printReport(&settings, wake);
+
+  deinit_flashSim();
+  deinit_sdSim();
+
+  if( failures != 0 || getStatisticsFlashSim()->violations != 0 )
+  {
+    printf("\nFAILED: %llu failures, %llu violations\n", (unsigned long long)failures, (unsigned long long)getStatisticsFlashSim()->violations);
+    return 1;
+  }
+
+  printf("\nPASSED\n");
+
+  return 0;
+}
@@ -0,0 +1,13 @@
+/**
+  ******************************************************************************
+  * @file           : cmsis_compiler.h
+  * @brief          : host replacement of cmsis_compiler.h, needed by stm32_timer.h
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  ******************************************************************************
+  */
+#ifndef HOST_CMSIS_COMPILER_H_
+#define HOST_CMSIS_COMPILER_H_
+
+#endif /* HOST_CMSIS_COMPILER_H_ */
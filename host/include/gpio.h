@@ -0,0 +1,15 @@
+/**
+  ******************************************************************************
+  * @file           : gpio.h
+  * @brief          : host replacement of gpio.h
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  ******************************************************************************
+  */
+#ifndef HOST_GPIO_H_
+#define HOST_GPIO_H_
+
+#include "main.h"
+
+#endif /* HOST_GPIO_H_ */
@@ -0,0 +1,55 @@
+/**
+  ******************************************************************************
+  * @file           : main.h
+  * @brief          : host replacement of main.h, only the HAL parts used by the
+  *                   dataflash and measurement code are defined.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  ******************************************************************************
+  */
+#ifndef HOST_MAIN_H_
+#define HOST_MAIN_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <assert.h>
+
+/* as stm32wlxx_hal_conf.h of the firmware, full assert is not used */
+#ifdef USE_FULL_ASSERT
+#define assert_param(expr)  ((expr) ? (void)0U : assert_failed((uint8_t *)__FILE__, __LINE__))
+void assert_failed(uint8_t *file, uint32_t line);
+#else
+#define assert_param(expr)  ((void)0U)
+#endif /* USE_FULL_ASSERT */
+
+#define UNUSED(X)           (void)X
+#define __weak              __attribute__((weak))
+#define __NOP()             ((void)0)
+
+#define GPIOA               ( 0x48000000UL )
+#define GPIO_PIN_4          ( (uint16_t)0x0010 )
+#define GPIO_PIN_5          ( (uint16_t)0x0020 )
+#define GPIO_PIN_6          ( (uint16_t)0x0040 )
+#define GPIO_PIN_7          ( (uint16_t)0x0080 )
+
+typedef enum
+{
+  HAL_OK       = 0x00,
+  HAL_ERROR    = 0x01,
+  HAL_BUSY     = 0x02,
+  HAL_TIMEOUT  = 0x03
+} HAL_StatusTypeDef;
+
+typedef struct
+{
+  uint32_t deviceId;  //not used
+} SPI_HandleTypeDef;
+
+uint32_t HAL_GetTick(void);
+
+#endif /* HOST_MAIN_H_ */
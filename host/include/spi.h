@@ -0,0 +1,17 @@
+/**
+  ******************************************************************************
+  * @file           : spi.h
+  * @brief          : host replacement of spi.h
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  ******************************************************************************
+  */
+#ifndef HOST_SPI_H_
+#define HOST_SPI_H_
+
+#include "main.h"
+
+extern SPI_HandleTypeDef hspi1;
+
+#endif /* HOST_SPI_H_ */
@@ -0,0 +1,15 @@
+/**
+  ******************************************************************************
+  * @file           : stm32wlxx_hal.h
+  * @brief          : host replacement of stm32wlxx_hal.h, included by the FatFs configuration.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  ******************************************************************************
+  */
+#ifndef HOST_STM32WLXX_HAL_H_
+#define HOST_STM32WLXX_HAL_H_
+
+#include "main.h"
+
+#endif /* HOST_STM32WLXX_HAL_H_ */
@@ -0,0 +1,32 @@
+/**
+  ******************************************************************************
+  * @file           : sys_app.h
+  * @brief          : host replacement of sys_app.h, APP_LOG is printed when
+  *                   logging is enabled with setLogPlatformSim().
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  ******************************************************************************
+  */
+#ifndef HOST_SYS_APP_H_
+#define HOST_SYS_APP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define VLEVEL_OFF    0
+#define VLEVEL_ALWAYS 0
+#define VLEVEL_L      1
+#define VLEVEL_M      2
+#define VLEVEL_H      3
+
+#define TS_OFF        0
+#define TS_ON         1
+
+void logPlatformSim(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+#define APP_LOG(TS,VL,...)   do{ logPlatformSim(__VA_ARGS__); }while(0)
+#define APP_PRINTF(...)      do{ logPlatformSim(__VA_ARGS__); }while(0)
+
+#endif /* HOST_SYS_APP_H_ */
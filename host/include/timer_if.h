@@ -0,0 +1,15 @@
+/**
+  ******************************************************************************
+  * @file           : timer_if.h
+  * @brief          : host wrapper, the timer interface of the firmware is used.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  ******************************************************************************
+  */
+#ifndef HOST_TIMER_IF_H_
+#define HOST_TIMER_IF_H_
+
+#include "../../src/Core/Inc/timer_if.h"
+
+#endif /* HOST_TIMER_IF_H_ */
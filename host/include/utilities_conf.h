@@ -0,0 +1,19 @@
+/**
+  ******************************************************************************
+  * @file           : utilities_conf.h
+  * @brief          : host replacement of utilities_conf.h, there are no interrupts on the host.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  ******************************************************************************
+  */
+#ifndef HOST_UTILITIES_CONF_H_
+#define HOST_UTILITIES_CONF_H_
+
+#include "utilities_def.h"
+
+#define UTILS_INIT_CRITICAL_SECTION()
+#define UTILS_ENTER_CRITICAL_SECTION()
+#define UTILS_EXIT_CRITICAL_SECTION()
+
+#endif /* HOST_UTILITIES_CONF_H_ */
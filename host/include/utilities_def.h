@@ -0,0 +1,15 @@
+/**
+  ******************************************************************************
+  * @file           : utilities_def.h
+  * @brief          : host wrapper, the task and event definitions of the firmware are used.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  ******************************************************************************
+  */
+#ifndef HOST_UTILITIES_DEF_H_
+#define HOST_UTILITIES_DEF_H_
+
+#include "../../src/Core/Inc/utilities_def.h"
+
+#endif /* HOST_UTILITIES_DEF_H_ */
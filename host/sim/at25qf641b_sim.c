@@ -0,0 +1,934 @@
+/**
+  ******************************************************************************
+  * @addtogroup     : host
+  * @{
+  * @file           : at25qf641b_sim.c
+  * @brief          : simulation of the AT25QF641B dataflash on SPI command level.
+  * The commands of standardflash.c used by the firmware are simulated: read array,
+  * page program, 4K/32K/64K/chip erase, status, deep power-down and erase/program suspend.
+  * Program and erase take time, the busy bit is set until the operation is finished.
+  * The energy of each power state and the erase cycles of each 4K block are counted.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  * @}
+  ******************************************************************************
+  */
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "cmd_defs.h"
+#include "at25qf641b_sim.h"
+
+#define STATUS_BUSY_SIM         ( 1 << 0 )  //status register byte 1
+#define STATUS_WEL_SIM          ( 1 << 1 )  //status register byte 1
+#define STATUS_SUS_SIM          ( 1 << 7 )  //status register byte 2
+
+#define MANUFACTURER_ID_SIM     ( 0x1F )
+#define DEVICE_ID_SIM           ( 0x16 )    //ID of resume from deep power-down and read ID
+
+#define MAX_VIOLATION_LOG_SIM   ( 20 )      //number of violations printed
+
+#define SIZE_IMAGE_SIM          ( SIZE_FLASH_SIM + NUMBER_4K_BLOCK_FLASH_SIM * sizeof(uint32_t) ) //memory and erase counters
+
+/**
+ * @brief internal operations of the dataflash, the busy bit is set during the operation
+ */
+typedef enum
+{
+  OPERATION_NONE = 0,
+  OPERATION_PROGRAM,
+  OPERATION_ERASE,
+  OPERATION_SUSPEND,      //erase or program is being suspended, takes tSUS
+}ENUM_operation;
+
+typedef struct
+{
+  ENUM_operation type;
+  uint32_t address;       //program: page address, erase: start address of block
+  uint32_t length;        //program: number of bytes, erase: size of block
+  uint32_t offset;        //program: offset of first byte in page
+  uint64_t duration;      //ns, total time of operation
+  uint64_t end;           //ns, time operation is finished
+  uint64_t remaining;     //ns, remaining time of suspended operation
+  uint8_t data[PAGE_SIZE_FLASH_SIM];
+}struct_operation;
+
+static struct_simConfig config;
+static struct_simStatistics statistics;
+
+static uint8_t * memory = NULL;       //image of the dataflash memory
+static uint32_t * eraseCount = NULL;  //erase cycles of each 4K block, stored behind the memory in the image
+static int imageFile = -1;
+
+static uint64_t now = 0;              //ns, simulation time
+static bool powered = true;
+static bool selected = false;
+static bool clocking = false;         //bytes are transferred, used for the active state
+static bool deepPowerDown = false;
+static bool writeEnabled = false;
+static bool suspended = false;
+static uint64_t readyAfterResume = 0; //ns, end of tRES1
+static bool logViolations = true;
+
+static struct_operation active;       //operation in progress
+static struct_operation suspendedOperation;
+
+//power failure during a page program
+static uint32_t powerFailPrograms;    //page programs before the program which is torn
+static uint32_t powerFailPermille;    //part of the program time done at power off
+static void (*powerFailCallback)( void ) = NULL;
+
+//state of the current transaction
+static uint8_t opcode;
+static uint32_t position;             //byte position in transaction
+static uint32_t address;
+static bool ignored;                  //transaction is ignored by the dataflash
+static struct_operation pending;      //program data collected during the transaction
+
+/**
+ * @fn void violation(const char*)
+ * @brief helper function to count a command which is not allowed, the first violations are printed
+ *
+ * @param text : description of the violation
+ */
+static void violation( const char * text )
+{
+  statistics.violations++;
+
+  if( logViolations && statistics.violations <= MAX_VIOLATION_LOG_SIM )
+  {
+    fprintf(stderr, "AT25QF641B: violation at %.3f ms, opcode 0x%02X: %s\n", now / 1e6, opcode, text);
+  }
+}
+
+/**
+ * @fn ENUM_simState getState(void)
+ * @brief helper function to get the power state of the dataflash
+ *
+ * @return power state
+ */
+static ENUM_simState getState( void )
+{
+  if( powered == false )
+  {
+    return SIM_STATE_OFF;
+  }
+
+  if( active.type == OPERATION_PROGRAM )
+  {
+    return SIM_STATE_PROGRAM;
+  }
+
+  if( active.type == OPERATION_ERASE || active.type == OPERATION_SUSPEND )
+  {
+    return SIM_STATE_ERASE;
+  }
+
+  if( clocking )
+  {
+    return SIM_STATE_ACTIVE;
+  }
+
+  if( deepPowerDown )
+  {
+    return SIM_STATE_DPD;
+  }
+
+  return SIM_STATE_STANDBY;
+}
+
+/**
+ * @fn void account(uint64_t)
+ * @brief helper function to count the time and energy of the current state
+ *
+ * @param time : ns
+ */
+static void account( uint64_t time )
+{
+  ENUM_simState state = getState();
+
+  statistics.stateTime[state] += time;
+  statistics.energy += (double)config.voltage * config.current[state] * time * 1e-9;
+}
+
+/**
+ * @fn void programMemory(const struct_operation*, uint32_t)
+ * @brief helper function to program bytes of a page program, bits can only be cleared
+ *
+ * @param operation : page program
+ * @param length : number of bytes to program from the start of the operation
+ */
+static void programMemory( const struct_operation * operation, uint32_t length )
+{
+  for( uint32_t i = 0; i < length; i++ )
+  {
+    uint32_t location = operation->address + ((operation->offset + i) % PAGE_SIZE_FLASH_SIM); //wraps within the page
+
+    if( memory[location] != 0xFF && operation->data[i] != 0xFF )
+    {
+      statistics.reprogrammed++;
+    }
+
+    memory[location] &= operation->data[i];
+  }
+}
+
+/**
+ * @fn void eraseMemory(const struct_operation*, uint32_t)
+ * @brief helper function to erase a block, each 4K block in the block gets one erase cycle
+ *
+ * @param operation : erase
+ * @param length : number of bytes to erase from the start of the block
+ */
+static void eraseMemory( const struct_operation * operation, uint32_t length )
+{
+  memset(&memory[operation->address], 0xFF, length);
+
+  for( uint32_t block = operation->address / BLOCK_4K_SIZE_FLASH_SIM; block < (operation->address + operation->length) / BLOCK_4K_SIZE_FLASH_SIM; block++ )
+  {
+    eraseCount[block]++;
+    statistics.erasedBlocks++;
+  }
+}
+
+/**
+ * @fn void completeOperation(void)
+ * @brief helper function to finish the active operation
+ *
+ */
+static void completeOperation( void )
+{
+  switch( active.type )
+  {
+    case OPERATION_PROGRAM:
+      programMemory(&active, active.length);
+      statistics.programBytes += active.length;
+      writeEnabled = false;
+      break;
+
+    case OPERATION_ERASE:
+      eraseMemory(&active, active.length);
+      writeEnabled = false;
+      break;
+
+    case OPERATION_SUSPEND:
+      suspended = true;
+      break;
+
+    default:
+      break;
+  }
+
+  active.type = OPERATION_NONE;
+}
+
+/**
+ * @fn void advanceFlashSim(uint64_t)
+ * @brief function to advance the simulation time, a busy operation is finished when its time has passed
+ *
+ * @param time : ns
+ */
+void advanceFlashSim( uint64_t time )
+{
+  while( active.type != OPERATION_NONE && active.end <= now + time )
+  {
+    uint64_t step = active.end - now;
+
+    account(step);
+    now += step;
+    time -= step;
+    completeOperation();
+  }
+
+  account(time);
+  now += time;
+}
+
+/**
+ * @fn uint64_t getTimeFlashSim(void)
+ * @brief function to get the simulation time
+ *
+ * @return ns
+ */
+uint64_t getTimeFlashSim( void )
+{
+  return now;
+}
+
+/**
+ * @fn void startOperation(struct_operation*, uint64_t)
+ * @brief helper function to start a program or erase, the busy bit is set
+ *
+ * @param operation : operation to start
+ * @param duration : ns
+ */
+static void startOperation( struct_operation * operation, uint64_t duration )
+{
+  if( writeEnabled == false )
+  {
+    statistics.rejected++;
+    return;
+  }
+
+  active = *operation;
+  active.duration = duration;
+  active.end = now + duration;
+}
+
+/**
+ * @fn bool isInSuspendedBlock(uint32_t)
+ * @brief helper function to check an address is in the block of a suspended operation
+ *
+ * @param location : address
+ * @return true = address is not accessible
+ */
+static bool isInSuspendedBlock( uint32_t location )
+{
+  if( suspended == false )
+  {
+    return false;
+  }
+
+  if( suspendedOperation.type == OPERATION_PROGRAM )
+  {
+    return location / PAGE_SIZE_FLASH_SIM == suspendedOperation.address / PAGE_SIZE_FLASH_SIM;
+  }
+
+  return location >= suspendedOperation.address && location < suspendedOperation.address + suspendedOperation.length;
+}
+
+/**
+ * @fn void startErase(uint32_t, uint64_t)
+ * @brief helper function to start an erase of a block
+ *
+ * @param size : size of block
+ * @param duration : ns
+ */
+static void startErase( uint32_t size, uint64_t duration )
+{
+  struct_operation operation = { .type = OPERATION_ERASE, .address = (address % SIZE_FLASH_SIM) & ~(size - 1), .length = size };
+
+  if( position != 4 )
+  {
+    violation("erase with wrong number of address bytes");
+    return;
+  }
+
+  if( suspended )
+  {
+    violation("erase during suspend");
+    return;
+  }
+
+  startOperation(&operation, duration);
+}
+
+/**
+ * @fn void getDefaultConfigFlashSim(struct_simConfig*)
+ * @brief function to get the default configuration. The SPI clock is PCLK2 / 2 of the MSI at 2MHz,
+ * times and currents are typical values of the AT25QF641B datasheet, approximations for the model.
+ *
+ * @param config : configuration
+ */
+void getDefaultConfigFlashSim( struct_simConfig * config )
+{
+  memset(config, 0, sizeof(*config));
+
+  config->spiFrequency = 1000000;
+  config->chipSelectTime = 300000;       //I2C write to I/O expander at 100kHz
+  config->delayLoopTime = 5000;          //loop with volatile counter at 2MHz
+  config->pageProgramTime = 400000;
+  config->erase4kTime = 45000000;
+  config->erase32kTime = 120000000;
+  config->erase64kTime = 150000000;
+  config->chipEraseTime = 20000000000ULL;
+  config->suspendTime = 20000;
+  config->resumeDpdTime = 3000;
+  config->voltage = 3.3f;
+  config->current[SIM_STATE_OFF] = 0.0f;
+  config->current[SIM_STATE_DPD] = 2e-6f;
+  config->current[SIM_STATE_STANDBY] = 14e-6f;
+  config->current[SIM_STATE_ACTIVE] = 4e-3f;
+  config->current[SIM_STATE_PROGRAM] = 10e-3f;
+  config->current[SIM_STATE_ERASE] = 10e-3f;
+}
+
+/**
+ * @fn int8_t init_flashSim(const char*, const struct_simConfig*)
+ * @brief function to initialize the simulation. With an image file the memory and erase counters are
+ * kept in the file (mmap), a new file is erased. Without file the memory is erased.
+ *
+ * @param imagePath : path of image file, NULL = no file
+ * @param simConfig : configuration, NULL = default
+ * @return 0 = successful, -1 = file error, -2 = memory error
+ */
+int8_t init_flashSim( const char * imagePath, const struct_simConfig * simConfig )
+{
+  struct stat fileStatus;
+  bool erase = true;
+
+  deinit_flashSim();
+
+  if( simConfig != NULL )
+  {
+    config = *simConfig;
+  }
+  else
+  {
+    getDefaultConfigFlashSim(&config);
+  }
+
+  if( imagePath != NULL )
+  {
+    imageFile = open(imagePath, O_RDWR | O_CREAT, 0644);
+
+    if( imageFile < 0 || fstat(imageFile, &fileStatus) != 0 )
+    {
+      return -1;
+    }
+
+    erase = fileStatus.st_size != SIZE_IMAGE_SIM;
+
+    if( erase && ftruncate(imageFile, SIZE_IMAGE_SIM) != 0 )
+    {
+      return -1;
+    }
+
+    memory = mmap(NULL, SIZE_IMAGE_SIM, PROT_READ | PROT_WRITE, MAP_SHARED, imageFile, 0);
+  }
+  else
+  {
+    memory = mmap(NULL, SIZE_IMAGE_SIM, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  }
+
+  if( memory == MAP_FAILED )
+  {
+    memory = NULL;
+    return -2;
+  }
+
+  eraseCount = (uint32_t *)&memory[SIZE_FLASH_SIM];
+
+  if( erase )
+  {
+    memset(memory, 0xFF, SIZE_FLASH_SIM);
+    memset(eraseCount, 0, NUMBER_4K_BLOCK_FLASH_SIM * sizeof(uint32_t));
+  }
+
+  memset(&statistics, 0, sizeof(statistics));
+  memset(&active, 0, sizeof(active));
+  now = 0;
+  powered = true;
+  selected = false;
+  deepPowerDown = false;
+  writeEnabled = false;
+  suspended = false;
+
+  return 0;
+}
+
+/**
+ * @fn void deinit_flashSim(void)
+ * @brief function to end the simulation, the image file is written.
+ *
+ */
+void deinit_flashSim( void )
+{
+  if( memory != NULL )
+  {
+    munmap(memory, SIZE_IMAGE_SIM);
+    memory = NULL;
+    eraseCount = NULL;
+  }
+
+  if( imageFile >= 0 )
+  {
+    close(imageFile);
+    imageFile = -1;
+  }
+}
+
+/**
+ * @fn void setPowerFlashSim(bool)
+ * @brief function to switch the supply of the dataflash. A program or erase in progress at power off
+ * is torn: only the part until power off is done, a partly erased block keeps the rest of its data.
+ *
+ * @param on : true = supply on, false = supply off
+ */
+void setPowerFlashSim( bool on )
+{
+  if( on == powered )
+  {
+    return;
+  }
+
+  if( on == false )
+  {
+    struct_operation * torn = active.type == OPERATION_NONE || active.type == OPERATION_SUSPEND ? &suspendedOperation : &active;
+    bool isTorn = active.type == OPERATION_PROGRAM || active.type == OPERATION_ERASE || suspended || active.type == OPERATION_SUSPEND;
+
+    if( isTorn )
+    {
+      uint64_t left = torn == &active ? active.end - now : torn->remaining;
+      uint64_t done = torn->duration - left;
+
+      if( torn->type == OPERATION_PROGRAM )
+      {
+        programMemory(torn, (uint32_t)(torn->length * done / torn->duration));
+      }
+      else
+      {
+        uint32_t length = (uint32_t)(torn->length * done / torn->duration);
+        eraseMemory(torn, length - length % PAGE_SIZE_FLASH_SIM);
+      }
+
+      statistics.tornOperations++;
+    }
+
+    active.type = OPERATION_NONE;
+    suspended = false;
+    deepPowerDown = false;
+    writeEnabled = false;
+    selected = false;
+  }
+
+  powered = on;
+}
+
+/**
+ * @fn bool getPowerFlashSim(void)
+ * @brief function to get the supply state
+ *
+ * @return true = supply on
+ */
+bool getPowerFlashSim( void )
+{
+  return powered;
+}
+
+/**
+ * @fn bool isBusyFlashSim(void)
+ * @brief function to check a program or erase is in progress or suspended
+ *
+ * @return true = busy or suspended
+ */
+bool isBusyFlashSim( void )
+{
+  return active.type != OPERATION_NONE || suspended;
+}
+
+/**
+ * @fn void setProgramPowerFailFlashSim(uint32_t, uint32_t, void(*)(void))
+ * @brief function to switch off the supply during a page program, the program is torn.
+ * The callback is called after the supply is off and must not return to the firmware, the MCU lost its supply too.
+ *
+ * @param programs : number of page programs before the program which is torn
+ * @param permille : part of the program time done before power off, 0 - 999
+ * @param callback : function called at power off, NULL = no power failure
+ */
+void setProgramPowerFailFlashSim( uint32_t programs, uint32_t permille, void (*callback)( void ) )
+{
+  powerFailPrograms = programs;
+  powerFailPermille = permille < 1000 ? permille : 999;
+  powerFailCallback = callback;
+}
+
+/**
+ * @fn void checkProgramPowerFail(void)
+ * @brief helper function to switch off the supply during the page program which is just started
+ *
+ */
+static void checkProgramPowerFail( void )
+{
+  void (*callback)( void ) = powerFailCallback;
+
+  if( callback == NULL || active.type != OPERATION_PROGRAM || powerFailPrograms-- != 0 )
+  {
+    return;
+  }
+
+  powerFailCallback = NULL;
+
+  advanceFlashSim(active.duration * powerFailPermille / 1000);
+  setPowerFlashSim(false);
+
+  callback();
+}
+
+/**
+ * @fn void selectFlashSim(void)
+ * @brief function to activate the chip select, a transaction is started
+ *
+ */
+void selectFlashSim( void )
+{
+  advanceFlashSim(config.chipSelectTime);
+
+  selected = true;
+  position = 0;
+  address = 0;
+  ignored = false;
+  pending.length = 0;
+
+  if( powered )
+  {
+    statistics.chipSelects++;
+  }
+}
+
+/**
+ * @fn bool isAccepted(uint8_t)
+ * @brief helper function to check a command is accepted in the current state
+ *
+ * @param command : opcode
+ * @return true = command is executed, false = command is ignored
+ */
+static bool isAccepted( uint8_t command )
+{
+  bool busy = active.type != OPERATION_NONE;
+
+  if( now < readyAfterResume )
+  {
+    violation("command within tRES1 after resume from deep power-down");
+    return false;
+  }
+
+  if( deepPowerDown )
+  {
+    if( command != CMD_STANDARDFLASH_RESUME_FROM_DPD )
+    {
+      violation("command in deep power-down");
+      return false;
+    }
+    return true;
+  }
+
+  if( busy )
+  {
+    if( command == CMD_STANDARDFLASH_READ_SRB1 || command == CMD_STANDARDFLASH_READ_SRB2 )
+    {
+      return true;
+    }
+
+    if( command == CMD_STANDARDFLASH_ERASE_PROGRAM_SUSPEND && active.type != OPERATION_SUSPEND )
+    {
+      return true;
+    }
+
+    violation("command while busy");
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * @fn uint8_t exchangeByte(uint8_t)
+ * @brief helper function to process one byte of a transaction
+ *
+ * @param txByte : byte from host
+ * @return byte to host
+ */
+static uint8_t exchangeByte( uint8_t txByte )
+{
+  uint8_t rxByte = 0xFF;
+  uint32_t dataStart = opcode == CMD_STANDARDFLASH_READ_ARRAY_HF ? 5 : 4; //fast read has a dummy byte
+
+  if( position == 0 )
+  {
+    opcode = txByte;
+    statistics.commands[opcode]++;
+    ignored = isAccepted(opcode) == false;
+  }
+  else if( ignored == false )
+  {
+    if( position <= 3 )
+    {
+      address = (address << 8) | txByte;
+    }
+
+    switch( opcode )
+    {
+      case CMD_STANDARDFLASH_READ_SRB1:
+        rxByte = (active.type != OPERATION_NONE ? STATUS_BUSY_SIM : 0) | (writeEnabled ? STATUS_WEL_SIM : 0);
+        break;
+
+      case CMD_STANDARDFLASH_READ_SRB2:
+        rxByte = suspended ? STATUS_SUS_SIM : 0;
+        break;
+
+      case CMD_STANDARDFLASH_READ_MID:
+      {
+        static const uint8_t id[] = { MANUFACTURER_ID_SIM, 0x88, 0x01 };
+        rxByte = position <= sizeof(id) ? id[position - 1] : 0xFF;
+        break;
+      }
+
+      case CMD_STANDARDFLASH_READ_ID:
+        rxByte = position == 4 ? MANUFACTURER_ID_SIM : (position == 5 ? DEVICE_ID_SIM : 0xFF);
+        break;
+
+      case CMD_STANDARDFLASH_RESUME_FROM_DPD:
+        rxByte = position >= 4 ? DEVICE_ID_SIM : 0xFF;
+        break;
+
+      case CMD_STANDARDFLASH_READ_ARRAY_LF:
+      case CMD_STANDARDFLASH_READ_ARRAY_HF:
+        if( position >= dataStart )
+        {
+          uint32_t location = (address + position - dataStart) % SIZE_FLASH_SIM;
+
+          if( isInSuspendedBlock(location) )
+          {
+            violation("read of suspended block");
+          }
+
+          rxByte = memory[location];
+          statistics.readBytes++;
+        }
+        break;
+
+      case CMD_STANDARDFLASH_BYTE_PAGE_PROGRAM:
+        if( position >= 4 )
+        {
+          //only the last page size of bytes is programmed
+          pending.data[pending.length % PAGE_SIZE_FLASH_SIM] = txByte;
+          pending.length++;
+        }
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  position++;
+
+  return rxByte;
+}
+
+/**
+ * @fn void transferFlashSim(const uint8_t*, uint8_t*, uint32_t)
+ * @brief function to transfer bytes of a transaction, the time of each byte is simulated
+ *
+ * @param txData : bytes to send, NULL = 0xFF is send
+ * @param rxData : buffer for received bytes, NULL = not used
+ * @param length : number of bytes
+ */
+void transferFlashSim( const uint8_t * txData, uint8_t * rxData, uint32_t length )
+{
+  uint64_t byteTime = 8000000000ULL / config.spiFrequency;
+
+  for( uint32_t i = 0; i < length; i++ )
+  {
+    uint8_t rxByte = 0xFF;
+
+    clocking = true;
+    advanceFlashSim(byteTime);
+    clocking = false;
+
+    if( selected && powered )
+    {
+      statistics.spiBytes++;
+      rxByte = exchangeByte(txData != NULL ? txData[i] : 0xFF);
+    }
+    else if( i == 0 )
+    {
+      violation(selected ? "transfer without supply" : "transfer without chip select");
+    }
+
+    if( rxData != NULL )
+    {
+      rxData[i] = rxByte;
+    }
+  }
+}
+
+/**
+ * @fn void deselectFlashSim(void)
+ * @brief function to deactivate the chip select, the command of the transaction is executed
+ *
+ */
+void deselectFlashSim( void )
+{
+  if( selected && powered && ignored == false && position > 0 )
+  {
+    switch( opcode )
+    {
+      case CMD_STANDARDFLASH_WRITE_ENABLE:
+        writeEnabled = true;
+        break;
+
+      case CMD_STANDARDFLASH_WRITE_DISABLE:
+        writeEnabled = false;
+        break;
+
+      case CMD_STANDARDFLASH_BYTE_PAGE_PROGRAM:
+        if( position > 4 )
+        {
+          uint32_t length = pending.length > PAGE_SIZE_FLASH_SIM ? PAGE_SIZE_FLASH_SIM : pending.length;
+
+          pending.type = OPERATION_PROGRAM;
+          pending.address = (address % SIZE_FLASH_SIM) & ~(PAGE_SIZE_FLASH_SIM - 1);
+          pending.offset = (address + pending.length - length) % PAGE_SIZE_FLASH_SIM;
+          pending.length = length;
+
+          if( isInSuspendedBlock(pending.address) || (suspended && suspendedOperation.type == OPERATION_PROGRAM) )
+          {
+            violation("program of suspended block");
+          }
+          else
+          {
+            startOperation(&pending, (uint64_t)config.pageProgramTime * (16 + length) / (16 + PAGE_SIZE_FLASH_SIM));
+            checkProgramPowerFail();
+          }
+        }
+        break;
+
+      case CMD_STANDARDFLASH_BLOCK_ERASE_4K:
+        startErase(BLOCK_4K_SIZE_FLASH_SIM, config.erase4kTime);
+        break;
+
+      case CMD_STANDARDFLASH_BLOCK_ERASE_32K:
+        startErase(0x8000, config.erase32kTime);
+        break;
+
+      case CMD_STANDARDFLASH_BLOCK_ERASE_64K:
+        startErase(0x10000, config.erase64kTime);
+        break;
+
+      case CMD_STANDARDFLASH_CHIP_ERASE1:
+      case CMD_STANDARDFLASH_CHIP_ERASE2:
+        address = 0;
+        position = 4;
+        startErase(SIZE_FLASH_SIM, config.chipEraseTime);
+        break;
+
+      case CMD_STANDARDFLASH_DEEP_POWER_DOWN:
+        deepPowerDown = true;
+        break;
+
+      case CMD_STANDARDFLASH_RESUME_FROM_DPD:
+        if( deepPowerDown )
+        {
+          deepPowerDown = false;
+          readyAfterResume = now + config.resumeDpdTime;
+        }
+        break;
+
+      case CMD_STANDARDFLASH_ERASE_PROGRAM_SUSPEND:
+        if( active.type == OPERATION_PROGRAM || active.type == OPERATION_ERASE )
+        {
+          suspendedOperation = active;
+          suspendedOperation.remaining = active.end - now;
+          active.type = OPERATION_SUSPEND;
+          active.end = now + config.suspendTime;
+          statistics.suspends++;
+        }
+        break;
+
+      case CMD_STANDARDFLASH_ERASE_PROGRAM_RESUME:
+        if( suspended )
+        {
+          active = suspendedOperation;
+          active.end = now + suspendedOperation.remaining;
+          suspended = false;
+          statistics.resumes++;
+        }
+        break;
+
+      case CMD_STANDARDFLASH_WRITE_SRB1:
+      case CMD_STANDARDFLASH_WRITE_SRB2:
+        writeEnabled = false; //protection bits are not simulated
+        break;
+
+      case CMD_STANDARDFLASH_READ_SRB1:
+      case CMD_STANDARDFLASH_READ_SRB2:
+      case CMD_STANDARDFLASH_READ_MID:
+      case CMD_STANDARDFLASH_READ_ID:
+      case CMD_STANDARDFLASH_READ_ARRAY_LF:
+      case CMD_STANDARDFLASH_READ_ARRAY_HF:
+        break;
+
+      default:
+        violation("command not simulated");
+        break;
+    }
+  }
+
+  selected = false;
+
+  advanceFlashSim(config.chipSelectTime);
+}
+
+/**
+ * @fn void delayFlashSim(uint32_t)
+ * @brief function to simulate the time of SPI_Delay()
+ *
+ * @param loops : number of loops
+ */
+void delayFlashSim( uint32_t loops )
+{
+  advanceFlashSim((uint64_t)loops * config.delayLoopTime);
+}
+
+/**
+ * @fn const struct_simStatistics getStatisticsFlashSim*(void)
+ * @brief function to get the statistics
+ *
+ * @return pointer to statistics
+ */
+const struct_simStatistics * getStatisticsFlashSim( void )
+{
+  return &statistics;
+}
+
+/**
+ * @fn const struct_simConfig getConfigFlashSim*(void)
+ * @brief function to get the configuration
+ *
+ * @return pointer to configuration
+ */
+const struct_simConfig * getConfigFlashSim( void )
+{
+  return &config;
+}
+
+/**
+ * @fn uint32_t getEraseCountFlashSim(uint32_t)
+ * @brief function to get the number of erase cycles of a 4K block
+ *
+ * @param block : 4K block number
+ * @return erase cycles
+ */
+uint32_t getEraseCountFlashSim( uint32_t block )
+{
+  return block < NUMBER_4K_BLOCK_FLASH_SIM ? eraseCount[block] : 0;
+}
+
+/**
+ * @fn const uint8_t getMemoryFlashSim*(void)
+ * @brief function to get the memory of the dataflash, for checks without SPI traffic
+ *
+ * @return pointer to memory
+ */
+const uint8_t * getMemoryFlashSim( void )
+{
+  return memory;
+}
+
+/**
+ * @fn void setViolationLogFlashSim(bool)
+ * @brief function to enable printing of violations
+ *
+ * @param enable : true = print the first violations
+ */
+void setViolationLogFlashSim( bool enable )
+{
+  logViolations = enable;
+}
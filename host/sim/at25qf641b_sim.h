@@ -0,0 +1,98 @@
+/**
+  ******************************************************************************
+  * @file           : at25qf641b_sim.h
+  * @brief          : Header for at25qf641b_sim.c file.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  ******************************************************************************
+  */
+#ifndef SIM_AT25QF641B_SIM_H_
+#define SIM_AT25QF641B_SIM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SIZE_FLASH_SIM              ( 0x800000UL )  //64Mbit
+#define PAGE_SIZE_FLASH_SIM         ( 0x100 )
+#define BLOCK_4K_SIZE_FLASH_SIM     ( 0x1000 )
+#define NUMBER_4K_BLOCK_FLASH_SIM   ( SIZE_FLASH_SIM / BLOCK_4K_SIZE_FLASH_SIM )
+#define ENDURANCE_FLASH_SIM         ( 100000 )      //erase cycles of a block
+
+/**
+ * @brief power states of the dataflash, used for the energy model
+ */
+typedef enum
+{
+  SIM_STATE_OFF = 0,      //supply is off
+  SIM_STATE_DPD,          //deep power-down
+  SIM_STATE_STANDBY,      //chip select high, no operation
+  SIM_STATE_ACTIVE,       //chip select low, SPI transfer
+  SIM_STATE_PROGRAM,      //page program busy
+  SIM_STATE_ERASE,        //erase busy
+  SIM_NUMBER_OF_STATES
+}ENUM_simState;
+
+/**
+ * @brief timing, current and bus settings of the simulation
+ */
+typedef struct
+{
+  uint32_t spiFrequency;        //Hz, SPI clock
+  uint32_t chipSelectTime;      //ns, time of one chip select change, the chip select is on the I2C I/O expander
+  uint32_t delayLoopTime;       //ns, time of one loop of SPI_Delay()
+  uint32_t pageProgramTime;     //ns, program time of a full page
+  uint32_t erase4kTime;         //ns
+  uint32_t erase32kTime;        //ns
+  uint32_t erase64kTime;        //ns
+  uint64_t chipEraseTime;       //ns
+  uint32_t suspendTime;         //ns, tSUS
+  uint32_t resumeDpdTime;       //ns, tRES1, no commands are accepted during this time
+  float voltage;                //V
+  float current[SIM_NUMBER_OF_STATES]; //A, current of each state
+}struct_simConfig;
+
+/**
+ * @brief statistics of the simulation, all counters only increase
+ */
+typedef struct
+{
+  uint64_t spiBytes;            //bytes clocked on the bus while selected
+  uint64_t chipSelects;         //number of transactions
+  uint64_t commands[256];       //transactions per opcode
+  uint64_t readBytes;           //data bytes of read array
+  uint64_t programBytes;        //data bytes of page program
+  uint64_t erasedBlocks;        //4K blocks erased, 32K/64K/chip erase count all 4K blocks
+  uint64_t suspends;
+  uint64_t resumes;
+  uint64_t tornOperations;      //program or erase interrupted by power off
+  uint64_t rejected;            //program or erase without write enable
+  uint64_t reprogrammed;        //bytes programmed again without erase
+  uint64_t violations;          //command not allowed in current state, see log
+  uint64_t stateTime[SIM_NUMBER_OF_STATES]; //ns
+  double energy;                //J
+}struct_simStatistics;
+
+void getDefaultConfigFlashSim( struct_simConfig * config );
+int8_t init_flashSim( const char * imagePath, const struct_simConfig * config );
+void deinit_flashSim( void );
+
+void selectFlashSim( void );
+void transferFlashSim( const uint8_t * txData, uint8_t * rxData, uint32_t length );
+void deselectFlashSim( void );
+void delayFlashSim( uint32_t loops );
+
+void advanceFlashSim( uint64_t time );
+uint64_t getTimeFlashSim( void );
+void setPowerFlashSim( bool on );
+bool getPowerFlashSim( void );
+void setProgramPowerFailFlashSim( uint32_t programs, uint32_t permille, void (*callback)( void ) );
+bool isBusyFlashSim( void );
+
+const struct_simStatistics * getStatisticsFlashSim( void );
+const struct_simConfig * getConfigFlashSim( void );
+uint32_t getEraseCountFlashSim( uint32_t block );
+const uint8_t * getMemoryFlashSim( void );
+void setViolationLogFlashSim( bool enable );
+
+#endif /* SIM_AT25QF641B_SIM_H_ */
@@ -0,0 +1,539 @@
+/**
+  ******************************************************************************
+  * @addtogroup     : host
+  * @{
+  * @file           : platform_sim.c
+  * @brief          : host replacement of the platform functions used by the dataflash
+  *                   and measurement code: tick, timer server, sequencer, system time,
+  *                   backup registers, FRAM measurement log state and vSys.
+  *                   All time is the simulation time of the dataflash simulation.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  * @}
+  ******************************************************************************
+  */
+#include <stdarg.h>
+#include <time.h>
+
+#include "main.h"
+#include "sys_app.h"
+#include "timer_if.h"
+#include "stm32_seq.h"
+#include "common/common.h"
+#include "FRAM/FRAM_functions.h"
+
+#include "at25qf641b_sim.h"
+#include "platform_sim.h"
+
+#define NUMBER_OF_TASKS_SIM   ( 32 )
+
+static struct_platformStatistics statistics;
+static bool logEnabled = false;
+static bool vSys = false;
+
+static UTIL_TIMER_Object_t * timerList = NULL;  //running timers
+
+static void (*taskFunction[NUMBER_OF_TASKS_SIM])( void );
+static UTIL_SEQ_bm_t taskSet = 0;
+static UTIL_SEQ_bm_t taskPaused = 0;
+static UTIL_SEQ_bm_t eventSet = 0;
+
+static uint32_t systemTimeSeconds = 0;
+static uint32_t backupRegister[32];
+static bool backupReset = true;
+
+static uint8_t framMeasurementLog[MAX_SIZE_MEASUREMENT_LOG];
+static uint8_t framMeasurementStaging[MAX_SIZE_MEASUREMENT_STAGING];
+static uint8_t framRollupState[MAX_SIZE_ROLLUP_STATE];
+static uint8_t framSdMirrorState[MAX_SIZE_SD_MIRROR_STATE];
+
+/**
+ * @fn void init_platformSim(void)
+ * @brief function to initialize the platform, vSys is off, backup registers and FRAM are cleared.
+ *
+ */
+void init_platformSim( void )
+{
+  memset(&statistics, 0, sizeof(statistics));
+  memset(taskFunction, 0, sizeof(taskFunction));
+  memset(backupRegister, 0, sizeof(backupRegister));
+  memset(framMeasurementLog, 0, sizeof(framMeasurementLog));
+  memset(framMeasurementStaging, 0, sizeof(framMeasurementStaging));
+  memset(framRollupState, 0, sizeof(framRollupState));
+  memset(framSdMirrorState, 0, sizeof(framSdMirrorState));
+  timerList = NULL;
+  taskSet = 0;
+  taskPaused = 0;
+  eventSet = 0;
+  backupReset = true;
+
+  setVsysPlatformSim(false);
+}
+
+/**
+ * @fn void logPlatformSim(const char*, ...)
+ * @brief function to print the log of the firmware, APP_LOG()
+ *
+ * @param format : printf format
+ */
+void logPlatformSim( const char * format, ... )
+{
+  va_list arguments;
+
+  if( logEnabled )
+  {
+    va_start(arguments, format);
+    vprintf(format, arguments);
+    va_end(arguments);
+  }
+}
+
+/**
+ * @fn void setLogPlatformSim(bool)
+ * @brief function to enable the log of the firmware
+ *
+ * @param enable : true = print log
+ */
+void setLogPlatformSim( bool enable )
+{
+  logEnabled = enable;
+}
+
+#ifdef USE_FULL_ASSERT
+/**
+ * @brief reports the file and line of a failed assert_param, the simulation is stopped
+ */
+void assert_failed(uint8_t *file, uint32_t line)
+{
+  fprintf(stderr, "assert failed: %s:%u\n", (const char *)file, line);
+  abort();
+}
+#endif /* USE_FULL_ASSERT */
+
+/**
+ * @brief tick in ms of the simulation time
+ */
+uint32_t HAL_GetTick(void)
+{
+  return (uint32_t)(getTimeFlashSim() / 1000000);
+}
+
+/*
+ * timer server, timers expire in runPlatformSim()
+ */
+UTIL_TIMER_Status_t UTIL_TIMER_Create( UTIL_TIMER_Object_t *TimerObject, uint32_t PeriodValue, UTIL_TIMER_Mode_t Mode, void ( *Callback )( void *), void *Argument)
+{
+  if( TimerObject == NULL || Callback == NULL )
+  {
+    return UTIL_TIMER_INVALID_PARAM;
+  }
+
+  memset(TimerObject, 0, sizeof(*TimerObject));
+  TimerObject->ReloadValue = PeriodValue;
+  TimerObject->Mode = Mode;
+  TimerObject->Callback = Callback;
+  TimerObject->argument = Argument;
+
+  return UTIL_TIMER_OK;
+}
+
+UTIL_TIMER_Status_t UTIL_TIMER_Stop( UTIL_TIMER_Object_t *TimerObject )
+{
+  UTIL_TIMER_Object_t ** next = &timerList;
+
+  while( *next != NULL )
+  {
+    if( *next == TimerObject )
+    {
+      *next = TimerObject->Next;
+      break;
+    }
+    next = &(*next)->Next;
+  }
+
+  TimerObject->IsRunning = 0;
+  TimerObject->Next = NULL;
+
+  return UTIL_TIMER_OK;
+}
+
+UTIL_TIMER_Status_t UTIL_TIMER_Start( UTIL_TIMER_Object_t *TimerObject )
+{
+  UTIL_TIMER_Stop(TimerObject);
+
+  TimerObject->Timestamp = HAL_GetTick() + TimerObject->ReloadValue;
+  TimerObject->IsRunning = 1;
+  TimerObject->Next = timerList;
+  timerList = TimerObject;
+
+  return UTIL_TIMER_OK;
+}
+
+UTIL_TIMER_Status_t UTIL_TIMER_SetPeriod(UTIL_TIMER_Object_t *TimerObject, uint32_t NewPeriodValue)
+{
+  TimerObject->ReloadValue = NewPeriodValue;
+
+  return UTIL_TIMER_OK;
+}
+
+UTIL_TIMER_Status_t UTIL_TIMER_StartWithPeriod( UTIL_TIMER_Object_t *TimerObject, uint32_t PeriodValue)
+{
+  UTIL_TIMER_SetPeriod(TimerObject, PeriodValue);
+
+  return UTIL_TIMER_Start(TimerObject);
+}
+
+uint32_t UTIL_TIMER_IsRunning( UTIL_TIMER_Object_t *TimerObject )
+{
+  return TimerObject->IsRunning;
+}
+
+UTIL_TIMER_Time_t UTIL_TIMER_GetCurrentTime(void)
+{
+  return HAL_GetTick();
+}
+
+UTIL_TIMER_Time_t UTIL_TIMER_GetElapsedTime(UTIL_TIMER_Time_t past )
+{
+  return HAL_GetTick() - past;
+}
+
+/*
+ * sequencer, tasks are executed in runPlatformSim()
+ */
+void UTIL_SEQ_RegTask( UTIL_SEQ_bm_t TaskId_bm, uint32_t Flags, void (*Task)( void ) )
+{
+  UNUSED(Flags);
+
+  for( int i = 0; i < NUMBER_OF_TASKS_SIM; i++ )
+  {
+    if( TaskId_bm & (1UL << i) )
+    {
+      taskFunction[i] = Task;
+    }
+  }
+}
+
+void UTIL_SEQ_SetTask( UTIL_SEQ_bm_t TaskId_bm , uint32_t Task_Prio )
+{
+  UNUSED(Task_Prio);
+
+  taskSet |= TaskId_bm;
+}
+
+void UTIL_SEQ_PauseTask( UTIL_SEQ_bm_t TaskId_bm )
+{
+  taskPaused |= TaskId_bm;
+}
+
+void UTIL_SEQ_ResumeTask( UTIL_SEQ_bm_t TaskId_bm )
+{
+  taskPaused &= ~TaskId_bm;
+}
+
+void UTIL_SEQ_SetEvt( UTIL_SEQ_bm_t EvtId_bm )
+{
+  eventSet |= EvtId_bm;
+}
+
+void UTIL_SEQ_ClrEvt( UTIL_SEQ_bm_t EvtId_bm )
+{
+  eventSet &= ~EvtId_bm;
+}
+
+void UTIL_SEQ_WaitEvt( UTIL_SEQ_bm_t EvtId_bm )
+{
+  //there are no interrupts on the host, the event is already set
+  eventSet &= ~EvtId_bm;
+}
+
+void UTIL_SEQ_Run( UTIL_SEQ_bm_t Mask_bm )
+{
+  UTIL_SEQ_bm_t ready;
+
+  while( (ready = taskSet & ~taskPaused & Mask_bm) != 0 )
+  {
+    int i = __builtin_ctz(ready);
+
+    taskSet &= ~(1UL << i);
+
+    if( taskFunction[i] != NULL )
+    {
+      statistics.tasks++;
+      taskFunction[i]();
+    }
+  }
+}
+
+/**
+ * @fn void runPlatformSim(uint32_t)
+ * @brief function to let the platform run, the sequencer tasks are executed and the timers expire.
+ * This is the idle time of the firmware, e.g. waiting on a LoRa transmission.
+ *
+ * @param time : ms
+ */
+void runPlatformSim( uint32_t time )
+{
+  uint32_t end = HAL_GetTick() + time;
+
+  while( true )
+  {
+    UTIL_TIMER_Object_t * first = NULL;
+
+    UTIL_SEQ_Run(~0U);
+
+    for( UTIL_TIMER_Object_t * timer = timerList; timer != NULL; timer = timer->Next )
+    {
+      if( first == NULL || (int32_t)(timer->Timestamp - first->Timestamp) < 0 )
+      {
+        first = timer;
+      }
+    }
+
+    if( first == NULL || (int32_t)(first->Timestamp - end) > 0 )
+    {
+      break;
+    }
+
+    if( (int32_t)(first->Timestamp - HAL_GetTick()) > 0 )
+    {
+      advanceFlashSim((uint64_t)(first->Timestamp - HAL_GetTick()) * 1000000);
+    }
+
+    if( first->Mode == UTIL_TIMER_PERIODIC )
+    {
+      UTIL_TIMER_Start(first);
+    }
+    else
+    {
+      UTIL_TIMER_Stop(first);
+    }
+
+    statistics.timers++;
+    first->Callback(first->argument);
+  }
+
+  if( (int32_t)(end - HAL_GetTick()) > 0 )
+  {
+    advanceFlashSim((uint64_t)(end - HAL_GetTick()) * 1000000);
+  }
+}
+
+/*
+ * system time, in seconds, set by the application
+ */
+SysTime_t SysTimeGet( void )
+{
+  SysTime_t sysTime = { .Seconds = systemTimeSeconds, .SubSeconds = 0 };
+
+  return sysTime;
+}
+
+void SysTimeSet( SysTime_t sysTime )
+{
+  systemTimeSeconds = sysTime.Seconds;
+}
+
+void SysTimeLocalTime( const uint32_t timestamp, struct tm *localtime )
+{
+  time_t seconds = timestamp;
+
+  gmtime_r(&seconds, localtime);
+}
+
+uint32_t SysTimeToMs( SysTime_t sysTime )
+{
+  return sysTime.Seconds * 1000 + sysTime.SubSeconds;
+}
+
+/*
+ * backup registers, lost with resetBackupPlatformSim()
+ */
+bool getResetBackup(void)
+{
+  return backupReset;
+}
+
+uint32_t getResetSource(void)
+{
+  return 0;
+}
+
+void writeBackupRegister(ENUM_backupRegister backupRegisterId, uint32_t value)
+{
+  backupRegister[backupRegisterId] = value;
+}
+
+uint32_t readBackupRegister(ENUM_backupRegister backupRegisterId)
+{
+  return backupRegister[backupRegisterId];
+}
+
+/**
+ * @fn void resetBackupPlatformSim(bool)
+ * @brief function to simulate a boot, the backup registers are kept or lost
+ *
+ * @param lost : true = backup domain is reset, false = backup registers are kept
+ */
+void resetBackupPlatformSim( bool lost )
+{
+  if( lost )
+  {
+    memset(backupRegister, 0, sizeof(backupRegister));
+  }
+
+  backupReset = lost;
+}
+
+/*
+ * FRAM, only the measurement log, rollup and SD mirror state
+ */
+const void saveMeasurementLogState( uint16_t offset, const void *pSource, size_t length )
+{
+  assert_param( offset + length <= MAX_SIZE_MEASUREMENT_LOG );
+
+  memcpy(&framMeasurementLog[offset], pSource, length);
+
+  statistics.framWrites++;
+  statistics.framWriteBytes += length;
+}
+
+const void restoreMeasurementLogState( uint16_t offset, void *pDest, size_t length )
+{
+  assert_param( offset + length <= MAX_SIZE_MEASUREMENT_LOG );
+
+  memcpy(pDest, &framMeasurementLog[offset], length);
+
+  statistics.framReads++;
+  statistics.framReadBytes += length;
+}
+
+const void saveMeasurementStaging( uint16_t offset, const void *pSource, size_t length )
+{
+  assert_param( offset + length <= MAX_SIZE_MEASUREMENT_STAGING );
+
+  memcpy(&framMeasurementStaging[offset], pSource, length);
+
+  statistics.framWrites++;
+  statistics.framWriteBytes += length;
+}
+
+const void restoreMeasurementStaging( uint16_t offset, void *pDest, size_t length )
+{
+  assert_param( offset + length <= MAX_SIZE_MEASUREMENT_STAGING );
+
+  memcpy(pDest, &framMeasurementStaging[offset], length);
+
+  statistics.framReads++;
+  statistics.framReadBytes += length;
+}
+
+const void saveRollupState( const void *pSource, size_t length )
+{
+  assert_param( length <= MAX_SIZE_ROLLUP_STATE );
+
+  memcpy(framRollupState, pSource, length);
+
+  statistics.framWrites++;
+  statistics.framWriteBytes += length;
+}
+
+const void restoreRollupState( void *pDest, size_t length )
+{
+  assert_param( length <= MAX_SIZE_ROLLUP_STATE );
+
+  memcpy(pDest, framRollupState, length);
+
+  statistics.framReads++;
+  statistics.framReadBytes += length;
+}
+
+const void saveSdMirrorState( const void *pSource, size_t length )
+{
+  assert_param( length <= MAX_SIZE_SD_MIRROR_STATE );
+
+  memcpy(framSdMirrorState, pSource, length);
+
+  statistics.framWrites++;
+  statistics.framWriteBytes += length;
+}
+
+const void restoreSdMirrorState( void *pDest, size_t length )
+{
+  assert_param( length <= MAX_SIZE_SD_MIRROR_STATE );
+
+  memcpy(pDest, framSdMirrorState, length);
+
+  statistics.framReads++;
+  statistics.framReadBytes += length;
+}
+
+/**
+ * @fn void corruptFramPlatformSim(uint32_t)
+ * @brief function to corrupt one byte of the measurement log state in FRAM
+ *
+ * @param seed : selects the byte and bits
+ */
+void corruptFramPlatformSim( uint32_t seed )
+{
+  framMeasurementLog[seed % MAX_SIZE_MEASUREMENT_LOG] ^= (uint8_t)(seed >> 8) | 0x01;
+}
+
+/*
+ * vSys, supply of the dataflash
+ */
+
+/**
+ * @fn void setVsysPlatformSim(bool)
+ * @brief function to switch vSys, the supply of the dataflash
+ *
+ * @param on : true = on
+ */
+void setVsysPlatformSim( bool on )
+{
+  vSys = on;
+  setPowerFlashSim(on);
+}
+
+/**
+ * @brief override of weak function, vSys is switched on when off and back to previous state,
+ * as setup_io_for_SPI_devices() of the board.
+ */
+const void setup_io_for_dataflash(bool state)
+{
+  static bool vSysState = false;
+
+  if( state == true )
+  {
+    vSysState = vSys;
+
+    if( vSysState == false )
+    {
+      setVsysPlatformSim(true);
+    }
+  }
+  else if( vSysState == false )
+  {
+    setVsysPlatformSim(false);
+  }
+}
+
+/**
+ * @brief override of weak function, supply state of the dataflash
+ */
+const bool get_supply_state_for_dataflash(void)
+{
+  return vSys;
+}
+
+/**
+ * @fn const struct_platformStatistics getStatisticsPlatformSim*(void)
+ * @brief function to get the statistics
+ *
+ * @return pointer to statistics
+ */
+const struct_platformStatistics * getStatisticsPlatformSim( void )
+{
+  return &statistics;
+}
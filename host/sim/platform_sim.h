@@ -0,0 +1,37 @@
+/**
+  ******************************************************************************
+  * @file           : platform_sim.h
+  * @brief          : Header for platform_sim.c file.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  ******************************************************************************
+  */
+#ifndef SIM_PLATFORM_SIM_H_
+#define SIM_PLATFORM_SIM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief statistics of the simulated platform
+ */
+typedef struct
+{
+  uint64_t framWrites;      //writes of measurement log state
+  uint64_t framWriteBytes;
+  uint64_t framReads;       //reads of measurement log state
+  uint64_t framReadBytes;
+  uint64_t tasks;           //sequencer tasks executed
+  uint64_t timers;          //timer callbacks
+}struct_platformStatistics;
+
+void init_platformSim( void );
+void runPlatformSim( uint32_t time );
+void setVsysPlatformSim( bool on );
+void resetBackupPlatformSim( bool lost );
+void corruptFramPlatformSim( uint32_t seed );
+void setLogPlatformSim( bool enable );
+const struct_platformStatistics * getStatisticsPlatformSim( void );
+
+#endif /* SIM_PLATFORM_SIM_H_ */
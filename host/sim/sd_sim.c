@@ -0,0 +1,251 @@
+/**
+  ******************************************************************************
+  * @addtogroup     : host
+  * @{
+  * @file           : sd_sim.c
+  * @brief          : simulation of the SD card in SPI mode as a RAM disk below FatFs.
+  *                   Replaces diskio.c and the USER driver of the firmware, the card is
+  *                   formatted with f_mkfs. The time of the commands is added to the
+  *                   simulation time, see the timing constants in sd_sim.h. The card programs
+  *                   a write after the transfer, as the driver the next command waits on the card.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  * @}
+  ******************************************************************************
+  */
+#include "main.h"
+#include "app_fatfs.h"
+
+#include "at25qf641b_sim.h"
+#include "sd_sim.h"
+
+#define SD_SIM_SECTOR_SIZE        ( 512 )
+#define SD_SIM_COMMAND_BYTES      ( 8 )     //command, argument, CRC and response
+
+FATFS USERFatFs;
+FIL USERFile;
+char USERPath[4] = "";
+
+static struct_sdSimStatistics statistics;
+static uint8_t * card = NULL;
+static bool cardInitialized = false;
+static uint64_t busyEnd = 0;        //ns, end of programming of the last write
+
+/**
+ * @fn void addTime(uint32_t, uint32_t)
+ * @brief helper function to add the time of a command to the simulation time
+ *
+ * @param bytes : bytes on the SPI bus
+ * @param busyTime : ns, access or programming time of the card
+ */
+static void addTime( uint32_t bytes, uint32_t busyTime )
+{
+  uint64_t time = (uint64_t)bytes * 8 * 1000000000ULL / SD_SIM_SPI_FREQUENCY + busyTime;
+
+  statistics.time += time;
+  advanceFlashSim(time);
+}
+
+/**
+ * @fn void waitReady(void)
+ * @brief helper function to wait until the card finished the programming of the last write
+ *
+ */
+static void waitReady( void )
+{
+  uint64_t now = getTimeFlashSim();
+
+  if( busyEnd > now )
+  {
+    statistics.time += busyEnd - now;
+    advanceFlashSim(busyEnd - now);
+  }
+}
+
+/**
+ * @fn int8_t formatCard(void)
+ * @brief helper function to format the card as a new card
+ *
+ * @return 0 = successful, -1 = format failed
+ */
+static int8_t formatCard( void )
+{
+  static uint8_t work[_MAX_SS];
+  struct_sdSimStatistics saved = statistics;
+  FRESULT fres;
+
+  memset(card, 0xFF, (size_t)SD_SIM_SECTORS * SD_SIM_SECTOR_SIZE);
+
+  fres = f_mkfs(USERPath, FM_ANY | FM_SFD, SD_SIM_CLUSTER_SIZE, work, sizeof(work));
+
+  statistics = saved; //format is not part of the benchmark
+  cardInitialized = false;
+  busyEnd = 0;
+
+  return fres == FR_OK ? 0 : -1;
+}
+
+/**
+ * @fn int8_t init_sdSim(void)
+ * @brief function to initialize the simulation with a new formatted card
+ *
+ * @return 0 = successful, -1 = failed
+ */
+int8_t init_sdSim( void )
+{
+  memset(&statistics, 0, sizeof(statistics));
+
+  card = malloc((size_t)SD_SIM_SECTORS * SD_SIM_SECTOR_SIZE);
+
+  if( card == NULL )
+  {
+    return -1;
+  }
+
+  return formatCard();
+}
+
+/**
+ * @fn void deinit_sdSim(void)
+ * @brief function to free the card
+ *
+ */
+void deinit_sdSim( void )
+{
+  free(card);
+  card = NULL;
+}
+
+/**
+ * @fn int8_t swapCardSdSim(void)
+ * @brief function to replace the card by a new formatted card
+ *
+ * @return 0 = successful, -1 = format failed
+ */
+int8_t swapCardSdSim( void )
+{
+  statistics.swaps++;
+
+  return formatCard();
+}
+
+/**
+ * @fn const struct_sdSimStatistics getStatisticsSdSim*(void)
+ * @brief function to get the statistics
+ *
+ * @return statistics
+ */
+const struct_sdSimStatistics * getStatisticsSdSim( void )
+{
+  return &statistics;
+}
+
+/*
+ * board, the card is powered with the SPI devices, see setup_io_for_SdCard() of the board
+ */
+const void setup_io_for_SdCard( bool state )
+{
+  if( state == false )
+  {
+    cardInitialized = false;
+  }
+}
+
+/*
+ * diskio of FatFs
+ */
+DSTATUS disk_initialize( BYTE pdrv )
+{
+  if( pdrv != 0 || card == NULL )
+  {
+    return STA_NOINIT;
+  }
+
+  if( cardInitialized == false )
+  {
+    statistics.initializations++;
+    waitReady();
+    addTime(0, SD_SIM_INIT_TIME);
+    cardInitialized = true;
+  }
+
+  return 0;
+}
+
+DSTATUS disk_status( BYTE pdrv )
+{
+  return pdrv == 0 && card != NULL ? 0 : STA_NOINIT;
+}
+
+DRESULT disk_read( BYTE pdrv, BYTE * buff, DWORD sector, UINT count )
+{
+  if( pdrv != 0 || card == NULL || sector + count > SD_SIM_SECTORS )
+  {
+    return RES_PARERR;
+  }
+
+  memcpy(buff, &card[(size_t)sector * SD_SIM_SECTOR_SIZE], (size_t)count * SD_SIM_SECTOR_SIZE);
+
+  waitReady();
+  statistics.readCommands++;
+  statistics.sectorsRead += count;
+  addTime(SD_SIM_COMMAND_BYTES + count * (SD_SIM_SECTOR_SIZE + 3), SD_SIM_READ_TIME);
+
+  return RES_OK;
+}
+
+DRESULT disk_write( BYTE pdrv, const BYTE * buff, DWORD sector, UINT count )
+{
+  if( pdrv != 0 || card == NULL || sector + count > SD_SIM_SECTORS )
+  {
+    return RES_PARERR;
+  }
+
+  memcpy(&card[(size_t)sector * SD_SIM_SECTOR_SIZE], buff, (size_t)count * SD_SIM_SECTOR_SIZE);
+
+  waitReady();
+
+  statistics.writeCommands++;
+  statistics.sectorsWritten += count;
+  addTime(SD_SIM_COMMAND_BYTES + count * (SD_SIM_SECTOR_SIZE + 4), 0);
+
+  busyEnd = getTimeFlashSim() + SD_SIM_WRITE_TIME;
+
+  return RES_OK;
+}
+
+DRESULT disk_ioctl( BYTE pdrv, BYTE cmd, void * buff )
+{
+  if( pdrv != 0 || card == NULL )
+  {
+    return RES_PARERR;
+  }
+
+  switch( cmd )
+  {
+    case CTRL_SYNC:
+      waitReady();
+      return RES_OK;
+
+    case GET_SECTOR_COUNT:
+      *(DWORD*)buff = SD_SIM_SECTORS;
+      return RES_OK;
+
+    case GET_SECTOR_SIZE:
+      *(WORD*)buff = SD_SIM_SECTOR_SIZE;
+      return RES_OK;
+
+    case GET_BLOCK_SIZE:
+      *(DWORD*)buff = 1;
+      return RES_OK;
+
+    default:
+      return RES_PARERR;
+  }
+}
+
+DWORD get_fattime( void )
+{
+  return 0;
+}
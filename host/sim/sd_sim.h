@@ -0,0 +1,42 @@
+/**
+  ******************************************************************************
+  * @file           : sd_sim.h
+  * @brief          : Header for sd_sim.c file.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  ******************************************************************************
+  */
+#ifndef SIM_SD_SIM_H_
+#define SIM_SD_SIM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SD_SIM_SECTORS            ( 128UL * 1024 )  //64MB card
+#define SD_SIM_CLUSTER_SIZE       ( 4096 )          //allocation unit of the format
+#define SD_SIM_SPI_FREQUENCY      ( 25000000 )      //Hz, SD default speed
+#define SD_SIM_INIT_TIME          ( 50000000 )      //ns, power-up and identification (CMD0, CMD8, ACMD41) in SPI mode
+#define SD_SIM_READ_TIME          ( 500000 )        //ns, access time of a read command
+#define SD_SIM_WRITE_TIME         ( 1500000 )       //ns, programming busy after a write command
+
+/**
+ * @brief statistics of the simulated SD card
+ */
+typedef struct
+{
+  uint64_t initializations; //identification of the card after power-up
+  uint64_t readCommands;
+  uint64_t writeCommands;   //single and multiple block writes
+  uint64_t sectorsRead;
+  uint64_t sectorsWritten;
+  uint64_t time;            //ns
+  uint64_t swaps;           //cards swapped
+}struct_sdSimStatistics;
+
+int8_t init_sdSim( void );
+void deinit_sdSim( void );
+int8_t swapCardSdSim( void );
+const struct_sdSimStatistics * getStatisticsSdSim( void );
+
+#endif /* SIM_SD_SIM_H_ */
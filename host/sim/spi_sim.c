@@ -0,0 +1,97 @@
+/**
+  ******************************************************************************
+  * @addtogroup     : host
+  * @{
+  * @file           : spi_sim.c
+  * @brief          : host replacement of spi_driver.c, the SPI transfers of the
+  *                   dataflash driver are send to the AT25QF641B simulation.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  * @}
+  ******************************************************************************
+  */
+#include "spi_driver.h"
+#include "at25qf641b_sim.h"
+
+SPI_HandleTypeDef hspi1;
+
+void SPI_ConfigureSingleSPIIOs()
+{
+}
+
+void SPI_ReturnToSingleSPIIOs()
+{
+}
+
+void SPI_Delay(uint32_t delayTime)
+{
+  delayFlashSim(delayTime);
+}
+
+void SPI_ExchangeStart(uint8_t *txBuffer,
+          uint32_t txNumBytes,
+          uint32_t dummyNumBytes)
+{
+  static const uint8_t dummy = 0;
+
+  // Select chip
+  selectFlashSim();
+
+  // Send each byte
+  transferFlashSim(txBuffer, NULL, txNumBytes);
+
+  // Send dummy bytes
+  for(uint32_t i = 0; i < dummyNumBytes; i++)
+    transferFlashSim(&dummy, NULL, 1);
+}
+
+void SPI_ExchangeContinue(uint8_t *rxBuffer,
+          uint32_t rxNumBytes)
+{
+  // Receive each byte
+  transferFlashSim(NULL, rxBuffer, rxNumBytes);
+}
+
+void SPI_ExchangeStop(void)
+{
+  // Deselect chip
+  deselectFlashSim();
+}
+
+void SPI_Exchange(uint8_t *txBuffer,
+          uint32_t txNumBytes,
+          uint8_t *rxBuffer,
+          uint32_t rxNumBytes,
+          uint32_t dummyNumBytes)
+{
+  SPI_ExchangeStart(txBuffer, txNumBytes, dummyNumBytes);
+  SPI_ExchangeContinue(rxBuffer, rxNumBytes);
+  SPI_ExchangeStop();
+}
+
+/*
+ * Dual and quad transfers are not used, MCU_SPI_MODE of standardflash.c is SPI.
+ * The transfer is simulated as single SPI.
+ */
+void SPI_DualExchange(uint8_t standardSPINumBytes,
+            uint8_t *txBuffer,
+            uint32_t txNumBytes,
+            uint8_t *rxBuffer,
+            uint32_t rxNumBytes,
+            uint32_t dummyNumBytes)
+{
+  UNUSED(standardSPINumBytes);
+  SPI_Exchange(txBuffer, txNumBytes, rxBuffer, rxNumBytes, dummyNumBytes);
+}
+
+void SPI_QuadExchange(uint8_t standardSPINumBytes,
+            uint8_t *txBuffer,
+            uint32_t txNumBytes,
+            uint8_t *rxBuffer,
+            uint32_t rxNumBytes,
+            uint32_t dummyNumBytes)
+{
+  UNUSED(standardSPINumBytes);
+  SPI_Exchange(txBuffer, txNumBytes, rxBuffer, rxNumBytes, dummyNumBytes);
+}
@@ -26,7 +26,10 @@
 #include "common/common.h"
 #include "common/app_types.h"
 #include "common/uart.h"
+#include "common/crc16.h"
 #include "CommConfig.h"
+#include "rollup.h"
+#include "RTC_AM1805/RTC_retention.h"
 
 #include "mainTask.h"
 
@@ -56,13 +59,16 @@
 
 static DMA_BUFFER uint8_t bufferTxConfig[SIZE_TX_BUFFER_CONFIG];
 static DMA_BUFFER uint8_t bufferRxConfig[SIZE_RX_BUFFER_CONFIG];
+static DMA_BUFFER uint8_t bufferDumpConfig[SIZE_DUMP_BUFFER_CONFIG];
 
 static UTIL_TIMER_Object_t uartConfigActive_Timer;
 static UTIL_TIMER_Time_t uartConfigActiveTime_default = 30000; //30sec
 static bool uartConfigKeepListen = false;
 
 static bool dataDump;
+static bool rollupDump;
 static bool dataErase;
+static bool dataOffload;
 static bool dataTest;
 static bool detectChangeRebootNeeded = false;
 static int currentTest;
@@ -70,6 +76,14 @@ static int currentSubTest;
 static char additionalArgumentsString[100];
 
 static uint32_t numberOffDumpRecords;
+static bool dataDumpBinary;
+static uint32_t dumpFirstMeasurementId;
+static uint32_t dumpEndMeasurementId;
+static uint16_t dumpSequence;
+static bool dumpSince;
+static uint32_t dumpSinceTimestamp;
+static uint8_t dumpSlotId;
+static bool rollupDumpBinary;
 static uint8_t loraBufferSize;
 
 static const char cmdError[]="ERROR";
@@ -86,8 +100,19 @@ static const char cmdLoraInterval[]="LoraInterval";
 static const char cmdMeasureTime[]="MeasureTime"; //todo remove
 static const char cmdSamples[]="Samples";
 static const char cmdDataDump[]="DataDump";
+static const char cmdDataDumpBinary[]="bin";
+static const char cmdDataDumpSince[]="since:";
+static const char cmdDataDumpSlot[]="slot:";
 static const char cmdAlwaysOn[]="AlwaysOn";
+static const char cmdVerify[]="Verify";
+static const char cmdStaging[]="Staging";
+static const char cmdWear[]="Wear";
+static const char cmdAirtime[]="Airtime";
+static const char cmdRollup[]="Rollup";
+static const char cmdRollupDump[]="RollupDump";
+static const char cmdSdMirror[]="SdMirror";
 static const char cmdErase[]="Erase";
+static const char cmdOffload[]="Offload";
 static const char cmdTest[]="Test";
 static const char cmdBat[]="Bat";
 static const char cmdVbus[]="Vbus";
@@ -286,7 +311,7 @@ __weak const int32_t setNumberOfSamples(int32_t sensorId, uint8_t numberOfSample
  *
  * @return total number of measures
  */
-__weak const uint8_t getNumberOfMeasures(void)
+__weak const uint32_t getNumberOfMeasures(void)
 {
 
   return 3;
@@ -336,6 +361,63 @@ __weak const void setAlwaysOn(bool state)
   return;
 }
 
+/**
+ * @brief weak function getMeasurementVerify(), can be override in application code.
+ *
+ * @return read back of measurements after writing
+ */
+__weak const uint8_t getMeasurementVerify(void)
+{
+
+  return 0;
+}
+
+/**
+ * @brief weak function setMeasurementVerify(), can be override in application code.
+ *
+ * @return 0 = successful, -1 = out of range
+ */
+__weak const int32_t setMeasurementVerify(uint8_t verify)
+{
+
+  return -1;
+}
+
+/**
+ * @brief weak function getMeasurementStaging(), can be override in application code.
+ *
+ * @return measurements collected in FRAM before programming dataflash
+ */
+__weak const uint8_t getMeasurementStaging(void)
+{
+
+  return 1;
+}
+
+/**
+ * @brief weak function setMeasurementStaging(), can be override in application code.
+ *
+ * @return 0 = successful, -1 = out of range
+ */
+__weak const int32_t setMeasurementStaging(uint8_t records)
+{
+
+  return -1;
+}
+
+/**
+ * @brief weak function getMeasurementWear(), can be override in application code.
+ *
+ * @return 0 = successful, -1 = not available
+ */
+__weak int8_t getMeasurementWear( uint32_t * minimum, uint32_t * maximum, uint32_t * average )
+{
+  *minimum = 0;
+  *maximum = 0;
+  *average = 0;
+  return -1;
+}
+
 /**
  * @brief weak function eraseCompleteMeasurementLog(), can be override in application code.
  *
@@ -358,6 +440,31 @@ __weak const int8_t eraseCompleteMeasurementBlockByBlock( uint32_t * startAddres
   return 0;
 }
 
+/**
+ * @fn const int8_t offloadMeasurementMemoryToSd(uint32_t*)
+ * @brief weak function offloadMeasurementMemoryToSd(), can be override in application
+ *
+ * @param address
+ * @return
+ */
+__weak const int8_t offloadMeasurementMemoryToSd( uint32_t * address )
+{
+  return -1;
+}
+
+/**
+ * @fn void getSdOffloadResult(uint32_t*, uint32_t*)
+ * @brief weak function getSdOffloadResult(), can be override in application
+ *
+ * @param bytes
+ * @param milliseconds
+ */
+__weak void getSdOffloadResult( uint32_t * bytes, uint32_t * milliseconds )
+{
+  *bytes = 0;
+  *milliseconds = 0;
+}
+
 /**
  * @fn uint32_t getLatestMeasurementId(void)
  * @brief weak function getLatestMeasurementId(), can be override in application code
@@ -380,6 +487,169 @@ __weak const uint32_t getOldestMeasurementId(void)
   return 0;
 }
 
+/**
+ * @fn int8_t findMeasurementByTime(uint32_t, uint32_t*)
+ * @brief weak function findMeasurementByTime(), can be override in application code
+ *
+ * @param timestamp
+ * @param measurementId
+ * @return
+ */
+__weak int8_t findMeasurementByTime( uint32_t timestamp, uint32_t * measurementId )
+{
+  return -1;
+}
+
+/**
+ * @fn int32_t packMeasurementBlock(uint8_t, uint32_t, uint32_t, uint8_t*, uint32_t, uint32_t*, uint32_t*, uint16_t*)
+ * @brief weak function packMeasurementBlock(), can be override in application code
+ *
+ * @param slotId
+ * @param measurementId
+ * @param endMeasurementId
+ * @param buffer
+ * @param bufferLength
+ * @param firstMeasurementId
+ * @param nextMeasurementId
+ * @param numberOfRecords
+ * @return
+ */
+__weak int32_t packMeasurementBlock( uint8_t slotId, uint32_t measurementId, uint32_t endMeasurementId, uint8_t * buffer, uint32_t bufferLength,
+                                     uint32_t * firstMeasurementId, uint32_t * nextMeasurementId, uint16_t * numberOfRecords )
+{
+  *firstMeasurementId = measurementId;
+  *nextMeasurementId = endMeasurementId;
+  *numberOfRecords = 0;
+  return 0;
+}
+
+/**
+ * @brief weak function getRollupWindow(), can be override in application code.
+ *
+ * @return minutes of the rollup window, 0 = no rollups
+ */
+__weak const uint16_t getRollupWindow(void)
+{
+
+  return 0;
+}
+
+/**
+ * @brief weak function setRollupWindow(), can be override in application code.
+ *
+ * @return 0 = successful, -1 = out of range
+ */
+__weak const int32_t setRollupWindow(uint16_t minutes)
+{
+
+  return -1;
+}
+
+/**
+ * @brief weak function getRollupUplink(), can be override in application code.
+ *
+ * @return true = rollups are sent by LoRa
+ */
+__weak const bool getRollupUplink(void)
+{
+
+  return false;
+}
+
+/**
+ * @brief weak function setRollupUplink(), can be override in application code.
+ *
+ * @return 0 = successful
+ */
+__weak const int32_t setRollupUplink(bool enabled)
+{
+
+  return -1;
+}
+
+/**
+ * @brief weak function getSdMirrorBatch(), can be override in application code.
+ *
+ * @return measurements collected before the SD card is written, 0 = no SD mirror
+ */
+__weak const uint8_t getSdMirrorBatch(void)
+{
+
+  return 0;
+}
+
+/**
+ * @brief weak function setSdMirrorBatch(), can be override in application code.
+ *
+ * @return 0 = successful, -1 = out of range
+ */
+__weak const int32_t setSdMirrorBatch(uint8_t batch)
+{
+
+  return -1;
+}
+
+/**
+ * @fn uint32_t getSdMirrorMeasurementId(void)
+ * @brief weak function getSdMirrorMeasurementId(), can be override in application code
+ *
+ * @return
+ */
+__weak uint32_t getSdMirrorMeasurementId(void)
+{
+  return 0;
+}
+
+/**
+ * @fn uint32_t getLatestRollupId(void)
+ * @brief weak function getLatestRollupId(), can be override in application code
+ *
+ * @return
+ */
+__weak uint32_t getLatestRollupId(void)
+{
+  return 0;
+}
+
+/**
+ * @fn uint32_t getOldestRollupId(void)
+ * @brief weak function getOldestRollupId(), can be override in application code
+ *
+ * @return
+ */
+__weak uint32_t getOldestRollupId(void)
+{
+  return 0;
+}
+
+/**
+ * @fn int8_t readRollup(uint32_t, uint8_t*, uint32_t)
+ * @brief weak function readRollup(), can be override in application code
+ *
+ * @param rollupId
+ * @param buffer
+ * @param bufferLength
+ * @return
+ */
+__weak int8_t readRollup( uint32_t rollupId, uint8_t * buffer, uint32_t bufferLength )
+{
+  return -1;
+}
+
+/**
+ * @fn int32_t printRollupData(uint32_t, uint8_t*, uint32_t)
+ * @brief weak function printRollupData(), can be override in application code
+ *
+ * @param rollupId
+ * @param buffer
+ * @param bufferLength
+ * @return
+ */
+__weak int32_t printRollupData( uint32_t rollupId, uint8_t * buffer, uint32_t bufferLength )
+{
+  return 0;
+}
+
 /**
  * @fn int32_t getSensorStatus(int32_t)
  * @brief weak function getSensorStatus(), can be override in application code
@@ -497,6 +767,21 @@ __weak const int8_t testDataflash(uint8_t test, uint32_t * status)
   return -1;
 }
 
+/**
+ * @fn void getPowerStatisticsDataflash(uint32_t*, uint32_t*, uint32_t*)
+ * @brief weak function getPowerStatisticsDataflash(), must be override in application
+ *
+ * @param enterCount
+ * @param exitCount
+ * @param timeInDeepPowerDown
+ */
+__weak void getPowerStatisticsDataflash( uint32_t * enterCount, uint32_t * exitCount, uint32_t * timeInDeepPowerDown )
+{
+  *enterCount = 0;
+  *exitCount = 0;
+  *timeInDeepPowerDown = 0;
+}
+
 /**
  * @fn const void setLedTest(int8_t)
  * @brief weak function setLedTest(), must be override in application
@@ -696,9 +981,9 @@ __weak const void setAdrAckCounter(uint32_t counter)
 }
 /**
  * @fn const uint8_t getBufferSize(void)
- * @brief function to get maximum buffer side.
+ * @brief function to get the test payload size, set by test command 99.
  *
- * @return
+ * @return test payload size, 0 is no filling
  */
 const uint8_t getBufferSize(void)
 {
@@ -717,8 +1002,18 @@ void sendLoraInterval(int arguments, const char * format, ...);
 void sendMeasureTime(int arguments, const char * format, ...); //todo remove
 void sendSamples(int arguments, const char * format, ...);
 void sendAlwaysOnState(int arguments, const char * format, ...);
+void sendVerify(int arguments, const char * format, ...);
+void sendStaging(int arguments, const char * format, ...);
+void sendWear(int arguments, const char * format, ...);
+void sendAirtime(int arguments, const char * format, ...);
+void sendRollup(int arguments, const char * format, ...);
+void sendRollupDump(int arguments, const char * format, ...);
+void sendSdMirror(int arguments, const char * format, ...);
+void sendRollupLine( uint32_t rollupId );
+void sendRollupBlock( uint32_t * rollupId, uint32_t endRollupId );
 void sendDataDump(int arguments, const char * format, ...);
 void sendDataLine( uint32_t );
+void sendDataBlock( uint32_t * measurementId, uint32_t endMeasurementId );
 void sendBatterijStatus(int arguments, const char * format, ...);
 void sendVbusStatus(int arguments, const char * format, ...);
 void sendVccStatus(int arguments, const char * format, ...);
@@ -740,7 +1035,13 @@ void rcvLoraInterval(int arguments, const char * format, ...);
 void rcvMeasureTime(int arguments, const char * format, ...); //todo remove
 void rcvSamples(int arguments, const char * format, ...);
 void rcvAlwaysOnState(int arguments, const char * format, ...);
+void rcvVerify(int arguments, const char * format, ...);
+void rcvStaging(int arguments, const char * format, ...);
+void rcvRollup(int arguments, const char * format, ...);
+void rcvSdMirror(int arguments, const char * format, ...);
 void rcvErase(int arguments, const char * format, ...);
+void rcvOffload(int arguments, const char * format, ...);
+void sendOffloadResult( void );
 void sendProgressLine( uint8_t percent, const char * command  );
 void rcvTest(int arguments, const char * format, ...);
 void rcvSave(int arguments, const char * format, ...);
@@ -815,6 +1116,48 @@ struct_commands stCommandsGet[] =
         sendAlwaysOnState,
         1,
     },
+    {
+        cmdVerify,
+        sizeof(cmdVerify) - 1,
+        sendVerify,
+        0,
+    },
+    {
+        cmdStaging,
+        sizeof(cmdStaging) - 1,
+        sendStaging,
+        0,
+    },
+    {
+        cmdWear,
+        sizeof(cmdWear) - 1,
+        sendWear,
+        0,
+    },
+    {
+        cmdAirtime,
+        sizeof(cmdAirtime) - 1,
+        sendAirtime,
+        0,
+    },
+    {
+        cmdRollup,
+        sizeof(cmdRollup) - 1,
+        sendRollup,
+        0,
+    },
+    {
+        cmdRollupDump,
+        sizeof(cmdRollupDump) - 1,
+        sendRollupDump,
+        0,
+    },
+    {
+        cmdSdMirror,
+        sizeof(cmdSdMirror) - 1,
+        sendSdMirror,
+        0,
+    },
     {
         cmdDataDump,
         sizeof(cmdDataDump) - 1,
@@ -902,12 +1245,42 @@ struct_commands stCommandsSet[] =
         rcvAlwaysOnState,
         1,
     },
+    {
+        cmdVerify,
+        sizeof(cmdVerify) - 1,
+        rcvVerify,
+        1,
+    },
+    {
+        cmdStaging,
+        sizeof(cmdStaging) - 1,
+        rcvStaging,
+        1,
+    },
+    {
+        cmdRollup,
+        sizeof(cmdRollup) - 1,
+        rcvRollup,
+        2,
+    },
+    {
+        cmdSdMirror,
+        sizeof(cmdSdMirror) - 1,
+        rcvSdMirror,
+        1,
+    },
     {
         cmdErase,
         sizeof(cmdErase) - 1,
         rcvErase,
         0,
     },
+    {
+        cmdOffload,
+        sizeof(cmdOffload) - 1,
+        rcvOffload,
+        0,
+    },
     {
         cmdTest,
         sizeof(cmdTest) - 1,
@@ -1208,7 +1581,7 @@ void configUartHandler(void)
 {
   static int step = 0;
   int8_t result;
-  static uint16_t numberOfMeasures = 0;
+  static uint32_t numberOfMeasures = 0;
   static uint32_t latestMeasurment = 0;
   static uint32_t currentMeasurement = 0;
   static uint32_t previousTimeMs = 0;
@@ -1246,17 +1619,55 @@ void configUartHandler(void)
       case 2: //wait, on special command
 
         //handling special commands
-        if( dataDump ) // data command received
+        if( dataDump && dataDumpBinary ) // binary data command received
+        {
+          latestMeasurment = getLatestMeasurementId(); //get latest measurement ID
+          currentMeasurement = getOldestMeasurementId(); //get oldest measurement ID
+
+          //start at time given by input parameter
+          if( dumpSince && findMeasurementByTime(dumpSinceTimestamp, &dumpFirstMeasurementId) != 0 )
+          {
+            dumpFirstMeasurementId = latestMeasurment; //nothing to dump
+          }
+
+          //limit range by input parameters
+          if( dumpFirstMeasurementId > currentMeasurement )
+          {
+            currentMeasurement = dumpFirstMeasurementId;
+          }
+
+          if( dumpEndMeasurementId < latestMeasurment )
+          {
+            latestMeasurment = dumpEndMeasurementId;
+          }
+
+          snprintf((char*)bufferTxConfig, sizeof(bufferTxConfig), "%s:%s,first: %lu, end: %lu, sequence: %u, slot: %u\r\n", cmdDataDump, cmdDataDumpBinary, currentMeasurement, latestMeasurment, dumpSequence, dumpSlotId);
+          uartSend_Config(bufferTxConfig, strlen((char*)bufferTxConfig));
+
+          step = 4; //go to process binary
+        }
+
+        else if( dataDump ) // data command received
         {
           numberOfMeasures = getNumberOfMeasures(); //get number of log items
           latestMeasurment = getLatestMeasurementId(); //get latest measurement ID
           currentMeasurement = getOldestMeasurementId(); //get oldest measurement ID
 
-          snprintf((char*)bufferTxConfig, sizeof(bufferTxConfig), "%s:count: %d, oldest: %lu, latest: %lu\r\n", cmdDataDump, numberOfMeasures, currentMeasurement, latestMeasurment);
+          snprintf((char*)bufferTxConfig, sizeof(bufferTxConfig), "%s:count: %lu, oldest: %lu, latest: %lu\r\n", cmdDataDump, numberOfMeasures, currentMeasurement, latestMeasurment);
           uartSend_Config(bufferTxConfig, strlen((char*)bufferTxConfig));
 
+          //check command is dump since time
+          if( dumpSince )
+          {
+            if( findMeasurementByTime(dumpSinceTimestamp, &currentMeasurement) != 0 )
+            {
+              currentMeasurement = latestMeasurment; //nothing to dump
+            }
+            numberOfMeasures = latestMeasurment - currentMeasurement;
+          }
+
           //check command is not dump  ALL
-          if( numberOffDumpRecords != DUMP_ALL )
+          else if( numberOffDumpRecords != DUMP_ALL )
           {
             if( numberOffDumpRecords < numberOfMeasures ) //check if number of measures needs to be limit by input parameter
             {
@@ -1268,6 +1679,17 @@ void configUartHandler(void)
           step = 3; //go to process
         }
 
+        else if( rollupDump ) // rollup dump command received
+        {
+          latestMeasurment = getLatestRollupId(); //get latest rollup ID
+          currentMeasurement = getOldestRollupId(); //get oldest rollup ID
+
+          snprintf((char*)bufferTxConfig, sizeof(bufferTxConfig), "%s:%soldest: %lu, latest: %lu\r\n", cmdRollupDump, rollupDumpBinary ? "bin," : "", currentMeasurement, latestMeasurment);
+          uartSend_Config(bufferTxConfig, strlen((char*)bufferTxConfig));
+
+          step = rollupDumpBinary ? 6 : 5; //go to process
+        }
+
         else if( dataErase ) //data erase command received
         {
           dataErase = false;
@@ -1275,6 +1697,13 @@ void configUartHandler(void)
           step = 10;
         }
 
+        else if( dataOffload ) //offload command received
+        {
+          dataOffload = false;
+          currentMeasurement = 0; //set address to 0 (use currentMeasurement variable)
+          step = 12;
+        }
+
         else if(dataTest)
         {
           dataTest = false;
@@ -1306,17 +1735,72 @@ void configUartHandler(void)
 
         break;
 
+      case 4:
+
+        if( currentMeasurement < latestMeasurment ) //check items need to send
+        {
+          sendDataBlock(&currentMeasurement, latestMeasurment); //send block of log items
+        }
+        else
+        { //ready
+
+          dataDump = false; //reset
+          sendOkay(1, cmdDataDump); //send ready
+          step = 2; //back to wait
+
+        }
+
+        break;
+
     ////////////////////////////////////////////////////////////////////////////////////////////
-    /// Process dataErase command
+    /// process rollupDump command, rollup IDs in measurement variables
     ////////////////////////////////////////////////////////////////////////////////////////////
 
-      case 10:
+      case 5:
 
-        result = eraseCompleteMeasurementBlockByBlock(&currentMeasurement); //erase one block
+        if( currentMeasurement < latestMeasurment ) //check items need to print
+        {
+          sendRollupLine(currentMeasurement++); //print current rollup
+        }
+        else
+        { //ready
 
-        if( result < 0 )
-        { //error
-          sendError(0,0);
+          rollupDump = false; //reset
+          sendOkay(1, cmdRollupDump); //send ready
+          step = 2; //back to wait
+
+        }
+
+        break;
+
+      case 6:
+
+        if( currentMeasurement < latestMeasurment ) //check items need to send
+        {
+          sendRollupBlock(&currentMeasurement, latestMeasurment); //send block of rollups
+        }
+        else
+        { //ready
+
+          rollupDump = false; //reset
+          sendOkay(1, cmdRollupDump); //send ready
+          step = 2; //back to wait
+
+        }
+
+        break;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////
+    /// Process dataErase command
+    ////////////////////////////////////////////////////////////////////////////////////////////
+
+      case 10:
+
+        result = eraseCompleteMeasurementBlockByBlock(&currentMeasurement); //erase one block
+
+        if( result < 0 )
+        { //error
+          sendError(0,0);
           step = 2; //back to wait
         }
         else if( result == 0 )
@@ -1341,6 +1825,48 @@ void configUartHandler(void)
 
         break;
 
+    ////////////////////////////////////////////////////////////////////////////////////////////
+    /// Process offload command
+    ////////////////////////////////////////////////////////////////////////////////////////////
+
+      case 12:
+
+        result = offloadMeasurementMemoryToSd(&currentMeasurement); //offload buffers
+
+        if( result < 0 )
+        { //error
+          sendError(0,0);
+          step = 2; //back to wait
+        }
+        else if( result == 0 )
+        { //busy
+          if( updateRate) //check update rate flag is active
+          {
+            sendProgressLine(getProgressFromAddress(currentMeasurement), cmdOffload); //send progress line
+          }
+        }
+        else
+        { //ready
+          sendProgressLine(getProgressFromAddress(currentMeasurement), cmdOffload);//send 100%
+          step = 13; //got to send result
+        }
+
+        break;
+
+      case 13:
+
+        sendOffloadResult(); //send size and speed
+        step = 14;
+
+        break;
+
+      case 14:
+
+        sendOkay(1,cmdOffload); //send ready
+        step = 2; //back to wait
+
+        break;
+
     ////////////////////////////////////////////////////////////////////////////////////////////
     /// Process test command
     ////////////////////////////////////////////////////////////////////////////////////////////
@@ -1945,8 +2471,54 @@ void sendDataDump(int arguments, const char * format, ...)
 {
   char *ptr; //dummy pointer
 
+  dataDumpBinary = false;
+  dumpSince = false;
+
   //check command has a extra argument
-  if( format[0] == '=')
+  if( format[0] == '=' && strncasecmp(&format[1], cmdDataDumpBinary, strlen(cmdDataDumpBinary)) == 0 )
+  {
+    //binary dump, optional range or start time, start sequence and slot: "bin:<first>-<end>,<sequence>,slot:<n>" or "bin:since:<unix>,<sequence>"
+    dataDumpBinary = true;
+    dumpFirstMeasurementId = 0;
+    dumpEndMeasurementId = DUMP_ALL;
+    dumpSequence = 0;
+    dumpSlotId = 0;
+    ptr = (char *)&format[1 + strlen(cmdDataDumpBinary)];
+
+    if( *ptr == ':' && strncasecmp(ptr + 1, cmdDataDumpSince, strlen(cmdDataDumpSince)) == 0 )
+    {
+      dumpSince = true;
+      dumpSinceTimestamp = strtoul(ptr + 1 + strlen(cmdDataDumpSince), &ptr, 10); //convert string to number
+    }
+    else if( *ptr == ':' )
+    {
+      dumpFirstMeasurementId = strtoul(ptr + 1, &ptr, 10); //convert string to number
+    }
+
+    if( *ptr == '-' )
+    {
+      dumpEndMeasurementId = strtoul(ptr + 1, &ptr, 10); //convert string to number
+    }
+
+    while( *ptr == ',' )
+    {
+      if( strncasecmp(ptr + 1, cmdDataDumpSlot, strlen(cmdDataDumpSlot)) == 0 )
+      {
+        dumpSlotId = strtoul(ptr + 1 + strlen(cmdDataDumpSlot), &ptr, 10); //convert string to number
+      }
+      else
+      {
+        dumpSequence = strtoul(ptr + 1, &ptr, 10); //convert string to number
+      }
+    }
+  }
+  else if( format[0] == '=' && strncasecmp(&format[1], cmdDataDumpSince, strlen(cmdDataDumpSince)) == 0 )
+  {
+    //dump measurements since unix time: "since:<unix>"
+    dumpSince = true;
+    dumpSinceTimestamp = strtoul(&format[1 + strlen(cmdDataDumpSince)], &ptr, 10); //convert string to number
+  }
+  else if( format[0] == '=')
   {
     numberOffDumpRecords = strtol(&format[1], &ptr, 10); //convert string to number
   }
@@ -1955,7 +2527,7 @@ void sendDataDump(int arguments, const char * format, ...)
     numberOffDumpRecords = DUMP_ALL;
   }
 
-  snprintf((char*)bufferTxConfig, sizeof(bufferTxConfig), "%s:%d\r\n", cmdDataDump, getNumberOfMeasures() );
+  snprintf((char*)bufferTxConfig, sizeof(bufferTxConfig), "%s:%lu\r\n", cmdDataDump, getNumberOfMeasures() );
   uartSend_Config(bufferTxConfig, strlen((char*)bufferTxConfig));
 
   dataDump = true;  //trigger dataDump in handler
@@ -1984,6 +2556,139 @@ void sendDataLine( uint32_t measurementId  )
   }
 }
 
+/**
+ * @brief send block of packed measurements to config uart, \ref struct_dumpBlockHeader.
+ *
+ * @param measurementId : ID of first measurement, updated to the ID after the block
+ * @param endMeasurementId : ID after the last measurement
+ */
+void sendDataBlock( uint32_t * measurementId, uint32_t endMeasurementId )
+{
+  struct_dumpBlockHeader * header = (struct_dumpBlockHeader *)bufferDumpConfig;
+  uint32_t firstMeasurementId;
+  uint32_t nextMeasurementId;
+  uint16_t numberOfRecords;
+  uint16_t crc;
+  int32_t length;
+
+  //pack measurements after header, keep room for CRC
+  length = packMeasurementBlock(dumpSlotId, *measurementId, endMeasurementId, &bufferDumpConfig[sizeof(struct_dumpBlockHeader)],
+                                sizeof(bufferDumpConfig) - sizeof(struct_dumpBlockHeader) - sizeof(crc), &firstMeasurementId, &nextMeasurementId, &numberOfRecords);
+
+  if( length < 0 || numberOfRecords == 0 )
+  {
+    *measurementId = endMeasurementId; //no more records available
+    return;
+  }
+
+  header->sync = DUMP_BLOCK_SYNC;
+  header->sequence = dumpSequence++;
+  header->firstMeasurementId = firstMeasurementId;
+  header->numberOfRecords = numberOfRecords;
+  header->length = length;
+  header->slotId = dumpSlotId;
+
+  crc = calculateCRC_CCITT(bufferDumpConfig, sizeof(struct_dumpBlockHeader) + length);
+  memcpy(&bufferDumpConfig[sizeof(struct_dumpBlockHeader) + length], &crc, sizeof(crc));
+
+  uartSend_Config(bufferDumpConfig, sizeof(struct_dumpBlockHeader) + length + sizeof(crc));
+
+  *measurementId = nextMeasurementId;
+}
+
+/**
+ * @brief send rollup dump to config uart, "RollupDump" as text lines or "RollupDump=bin,<sequence>" as binary blocks.
+ *
+ * @param arguments not used
+ */
+void sendRollupDump(int arguments, const char * format, ...)
+{
+  char *ptr; //dummy pointer
+
+  rollupDumpBinary = false;
+
+  if( format[0] == '=' && strncasecmp(&format[1], cmdDataDumpBinary, strlen(cmdDataDumpBinary)) == 0 )
+  {
+    rollupDumpBinary = true;
+    dumpSequence = 0;
+    ptr = (char *)&format[1 + strlen(cmdDataDumpBinary)];
+
+    if( *ptr == ',' )
+    {
+      dumpSequence = strtoul(ptr + 1, &ptr, 10); //convert string to number
+    }
+  }
+
+  rollupDump = true;  //trigger rollupDump in handler
+}
+
+/**
+ * @brief send rollup line to config uart.
+ *
+ * @param rollupId : rollup ID
+ */
+void sendRollupLine( uint32_t rollupId )
+{
+  int length = 0;
+
+  length = printRollupData( rollupId, bufferTxConfig, sizeof(bufferTxConfig) );
+
+  if( length > 0 )
+  {
+    uartSend_Config(bufferTxConfig, strlen((char*)bufferTxConfig));
+  }
+}
+
+/**
+ * @brief send block of rollup records to config uart, \ref struct_dumpBlockHeader with rollup IDs and slot 0.
+ * A block ends at a rollup that is not readable, this rollup is skipped.
+ *
+ * @param rollupId : ID of first rollup, updated to the ID after the block
+ * @param endRollupId : ID after the last rollup
+ */
+void sendRollupBlock( uint32_t * rollupId, uint32_t endRollupId )
+{
+  struct_dumpBlockHeader * header = (struct_dumpBlockHeader *)bufferDumpConfig;
+  uint32_t firstRollupId = *rollupId;
+  uint16_t numberOfRecords = 0;
+  uint16_t crc;
+  int32_t length = 0;
+
+  while( *rollupId < endRollupId && sizeof(struct_dumpBlockHeader) + length + sizeof(STRUCT_rollupRecord) + sizeof(crc) <= sizeof(bufferDumpConfig) )
+  {
+    if( readRollup(*rollupId, &bufferDumpConfig[sizeof(struct_dumpBlockHeader) + length], sizeof(STRUCT_rollupRecord)) != 0 )
+    {
+      if( numberOfRecords == 0 )
+      {
+        firstRollupId = ++(*rollupId); //skip rollup before block
+        continue;
+      }
+      break;
+    }
+
+    length += sizeof(STRUCT_rollupRecord);
+    numberOfRecords++;
+    (*rollupId)++;
+  }
+
+  if( numberOfRecords == 0 )
+  {
+    return;
+  }
+
+  header->sync = DUMP_BLOCK_SYNC;
+  header->sequence = dumpSequence++;
+  header->firstMeasurementId = firstRollupId;
+  header->numberOfRecords = numberOfRecords;
+  header->length = length;
+  header->slotId = 0;
+
+  crc = calculateCRC_CCITT(bufferDumpConfig, sizeof(struct_dumpBlockHeader) + length);
+  memcpy(&bufferDumpConfig[sizeof(struct_dumpBlockHeader) + length], &crc, sizeof(crc));
+
+  uartSend_Config(bufferDumpConfig, sizeof(struct_dumpBlockHeader) + length + sizeof(crc));
+}
+
 /**
  * @brief send batterijstatus to config uart.
  *
@@ -2148,7 +2853,17 @@ void sendTestDataflash( int test, int subTest, char * extraArguments )
   }
 
 
-  if( ( subTest == 1 && value >= 0 && value < 2048) || (subTest >= 2 && subTest <= 3 && additionalArgumentsString[0] == 0 ) )
+  if( subTest == 4 && additionalArgumentsString[0] == 0 ) //deep power-down statistics
+  {
+    uint32_t enterCount;
+    uint32_t exitCount;
+    uint32_t timeInDeepPowerDown;
+
+    getPowerStatisticsDataflash(&enterCount, &exitCount, &timeInDeepPowerDown);
+    snprintf( (char*)bufferTxConfig, sizeof(bufferTxConfig), "%s:%d,1,%lu,%lu,%lu\r\n", cmdTest, test, enterCount, exitCount, timeInDeepPowerDown);
+    uartSend_Config(bufferTxConfig, strlen((char*)bufferTxConfig));
+  }
+  else if( ( subTest == 1 && value >= 0 && value < 2048) || (subTest >= 2 && subTest <= 3 && additionalArgumentsString[0] == 0 ) )
   {
     statusRegister = (uint32_t)value;
     int8_t result = testDataflash(subTest, &statusRegister);
@@ -2392,6 +3107,216 @@ void rcvAlwaysOnState(int arguments, const char * format, ...)
 
 }
 
+/**
+ * @brief send read back setting of measurements to config uart
+ *
+ * @param arguments not used
+ */
+void sendVerify(int arguments, const char * format, ...)
+{
+
+  snprintf((char*)bufferTxConfig, sizeof(bufferTxConfig), "%s:%d\r\n", cmdVerify, getMeasurementVerify() );
+  uartSend_Config(bufferTxConfig, strlen((char*)bufferTxConfig));
+
+}
+
+/**
+ * @brief send staging setting of measurements to config uart
+ *
+ * @param arguments not used
+ */
+void sendStaging(int arguments, const char * format, ...)
+{
+
+  snprintf((char*)bufferTxConfig, sizeof(bufferTxConfig), "%s:%d\r\n", cmdStaging, getMeasurementStaging() );
+  uartSend_Config(bufferTxConfig, strlen((char*)bufferTxConfig));
+
+}
+
+/**
+ * @brief send erase cycles of the measurement blocks in dataflash to config uart, minimum, maximum and average.
+ *
+ * @param arguments not used
+ */
+void sendWear(int arguments, const char * format, ...)
+{
+  uint32_t minimum;
+  uint32_t maximum;
+  uint32_t average;
+
+  if( getMeasurementWear(&minimum, &maximum, &average) == 0 )
+  {
+    snprintf((char*)bufferTxConfig, sizeof(bufferTxConfig), "%s:%lu,%lu,%lu\r\n", cmdWear, minimum, maximum, average );
+    uartSend_Config(bufferTxConfig, strlen((char*)bufferTxConfig));
+  }
+  else
+  {
+    sendError(0,0);
+  }
+
+}
+
+/**
+ * @brief send airtime of the last uplink to config uart, airtime in ms, datarate and payload size.
+ *
+ * @param arguments not used
+ */
+void sendAirtime(int arguments, const char * format, ...)
+{
+
+  snprintf((char*)bufferTxConfig, sizeof(bufferTxConfig), "%s:%u,%u,%u\r\n", cmdAirtime, getRtcRetention()->lastTxTimeOnAir,
+           getRtcRetention()->lastTxDatarate, getRtcRetention()->lastTxSize );
+  uartSend_Config(bufferTxConfig, strlen((char*)bufferTxConfig));
+
+}
+
+/**
+ * @brief send rollup settings to config uart, window in minutes, uplink, oldest and latest rollup ID.
+ *
+ * @param arguments not used
+ */
+void sendRollup(int arguments, const char * format, ...)
+{
+
+  snprintf((char*)bufferTxConfig, sizeof(bufferTxConfig), "%s:%u,%d,%lu,%lu\r\n", cmdRollup, getRollupWindow(), getRollupUplink(), getOldestRollupId(), getLatestRollupId() );
+  uartSend_Config(bufferTxConfig, strlen((char*)bufferTxConfig));
+
+}
+
+/**
+ * @brief send SD mirror setting to config uart, batch and ID of the next measurement to write on the SD card.
+ *
+ * @param arguments not used
+ */
+void sendSdMirror(int arguments, const char * format, ...)
+{
+
+  snprintf((char*)bufferTxConfig, sizeof(bufferTxConfig), "%s:%u,%lu\r\n", cmdSdMirror, getSdMirrorBatch(), getSdMirrorMeasurementId() );
+  uartSend_Config(bufferTxConfig, strlen((char*)bufferTxConfig));
+
+}
+
+/**
+ * @brief receive read back setting of measurements from config uart.
+ *
+ * @param argument: 1: <verify> 0 = none, 1 = header, 2 = CRC, 3 = full
+ *
+ */
+void rcvVerify(int arguments, const char * format, ...)
+{
+  char *ptr; //dummy pointer
+  int verify = -1;
+
+
+  if( format[0] == '=' )
+  {
+    verify = strtol(&format[1], &ptr, 10);
+  }
+
+  if( verify >= 0 && verify <= 3 && setMeasurementVerify(verify) == 0 )
+  {
+    snprintf((char*)bufferTxConfig, sizeof(bufferTxConfig), "%s:%d\r\n", cmdVerify, getMeasurementVerify() );
+    uartSend_Config(bufferTxConfig, strlen((char*)bufferTxConfig));
+  }
+  else
+  {
+    sendError(0,0);
+  }
+
+}
+
+/**
+ * @brief receive staging setting of measurements from config uart.
+ *
+ * @param argument: 1: <records> measurements collected in FRAM before programming dataflash, 1 = no staging
+ *
+ */
+void rcvStaging(int arguments, const char * format, ...)
+{
+  char *ptr; //dummy pointer
+  int records = -1;
+
+
+  if( format[0] == '=' )
+  {
+    records = strtol(&format[1], &ptr, 10);
+  }
+
+  if( records >= 1 && records <= 16 && setMeasurementStaging(records) == 0 )
+  {
+    snprintf((char*)bufferTxConfig, sizeof(bufferTxConfig), "%s:%d\r\n", cmdStaging, getMeasurementStaging() );
+    uartSend_Config(bufferTxConfig, strlen((char*)bufferTxConfig));
+  }
+  else
+  {
+    sendError(0,0);
+  }
+
+}
+
+/**
+ * @brief receive rollup settings from config uart.
+ *
+ * @param argument: 1: <window> minutes of the rollup window 0-1440, 0 = no rollups
+ * @param argument: 2: <uplink> 1 = rollups are sent by LoRa instead of the latest measurement
+ *
+ */
+void rcvRollup(int arguments, const char * format, ...)
+{
+  char *ptr; //dummy pointer
+  int window = -1;
+  int uplink = -1;
+
+
+  if( format[0] == '=' )
+  {
+    window = strtol(&format[1], &ptr, 10);
+
+    if( *ptr == ',' )
+    {
+      uplink = strtol(ptr + 1, &ptr, 10);
+    }
+  }
+
+  if( window >= 0 && window <= 1440 && uplink >= 0 && uplink <= 1 && setRollupWindow(window) == 0 && setRollupUplink(uplink) == 0 )
+  {
+    sendRollup(0,0);
+  }
+  else
+  {
+    sendError(0,0);
+  }
+
+}
+
+/**
+ * @brief receive SD mirror setting from config uart.
+ *
+ * @param argument: 1: <batch> measurements collected before the SD card is written 0-64, 0 = no SD mirror
+ *
+ */
+void rcvSdMirror(int arguments, const char * format, ...)
+{
+  char *ptr; //dummy pointer
+  int batch = -1;
+
+
+  if( format[0] == '=' )
+  {
+    batch = strtol(&format[1], &ptr, 10);
+  }
+
+  if( batch >= 0 && batch <= 64 && setSdMirrorBatch(batch) == 0 )
+  {
+    sendSdMirror(0,0);
+  }
+  else
+  {
+    sendError(0,0);
+  }
+
+}
+
 /**
  * @brief receive erase command from config uart.
  *
@@ -2405,6 +3330,38 @@ void rcvErase(int arguments, const char * format, ...)
   dataErase = true; //trigger dataErase in handler
 }
 
+/**
+ * @brief receive offload command from config uart, the measurement memory is written to the SD card.
+ *
+ * @param argument: not used
+ *
+ */
+void rcvOffload(int arguments, const char * format, ...)
+{
+  sendProgressLine(0, cmdOffload); //send progress line
+
+  dataOffload = true; //trigger dataOffload in handler
+}
+
+/**
+ * @brief send size, time and speed of the offload to config uart.
+ *
+ */
+void sendOffloadResult( void )
+{
+  uint32_t bytes;
+  uint32_t milliseconds;
+  uint32_t kiloBytesPerSecond;
+
+  getSdOffloadResult(&bytes, &milliseconds);
+
+  kiloBytesPerSecond = milliseconds ? bytes / milliseconds : 0; //bytes per ms is kB/s
+
+  snprintf((char*)bufferTxConfig, sizeof(bufferTxConfig), "%s:%lu bytes,%lu ms,%lu.%02lu MB/s\r\n", cmdOffload, bytes, milliseconds,
+           kiloBytesPerSecond / 1000, (kiloBytesPerSecond % 1000) / 10 );
+  uartSend_Config(bufferTxConfig, strlen((char*)bufferTxConfig));
+}
+
 /**
  * @brief send progress line to config uart.
  *
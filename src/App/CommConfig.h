@@ -14,6 +14,26 @@
 
 #define SIZE_TX_BUFFER_CONFIG	250
 #define SIZE_RX_BUFFER_CONFIG	250
+#define SIZE_DUMP_BUFFER_CONFIG	1024
+
+#define DUMP_BLOCK_SYNC   0x5AA5
+
+/**
+ * Header of a block of the binary DataDump ("Get+DataDump=bin").
+ * The header is followed by length bytes of packed records (STRUCT_measurementRecord) with consecutive
+ * measurement IDs and a CRC16-CCITT over header and records.
+ * A dump of one slot ("Get+DataDump=bin,slot:<n>") precedes each record with its measurement ID (uint32_t).
+ * The binary rollup dump ("Get+RollupDump=bin") uses the same header with rollup IDs, slot 0 and records STRUCT_rollupRecord.
+ */
+typedef struct __attribute__((packed))
+{
+  uint16_t sync;                //\ref DUMP_BLOCK_SYNC
+  uint16_t sequence;            //sequence number of block, increments for each block
+  uint32_t firstMeasurementId;  //measurement ID of first record in block
+  uint16_t numberOfRecords;     //number of records in block
+  uint16_t length;              //number of bytes of records
+  uint8_t slotId;               //sensor module slot of records, 0 = all slots
+}struct_dumpBlockHeader;
 
 void uartInit_Config( void );
 void uartListen(void);
@@ -14,6 +14,7 @@
 #include "sys_app.h"
 
 #include "FRAM.h"
+#include "../common/spi_async.h"
 
 extern SPI_HandleTypeDef hspi1;
 #define HSPI_FRAM   &hspi1
@@ -133,10 +134,10 @@ const void FRAM_WriteData(uint16_t address, uint8_t *data, size_t length)
     APP_LOG(TS_OFF, VLEVEL_L, "FRAM WriteData command, SPI error: %d\r\n", statusCommand);
   }
 
-  // Send the data to be written
-  HAL_StatusTypeDef statusWrite = HAL_SPI_Transmit(HSPI_FRAM, data, length, HAL_DELAY_FRAM);
+  // Send the data to be written, long transfers with DMA
+  int8_t statusWrite = transferSpiAsync(HSPI_FRAM, data, NULL, length);
 
-  if( statusWrite != HAL_OK )
+  if( statusWrite != 0 )
   {
     APP_LOG(TS_OFF, VLEVEL_L, "FRAM WriteData data, SPI error: %d\r\n", statusWrite);
   }
@@ -171,10 +172,10 @@ const void FRAM_ReadData(uint16_t address, uint8_t *data, size_t length)
     APP_LOG(TS_OFF, VLEVEL_L, "FRAM ReadData command, SPI error: %d\r\n", statusCommand);
   }
 
-  // Read the data
-  HAL_StatusTypeDef statusRead = HAL_SPI_Receive(HSPI_FRAM, data, length, HAL_DELAY_FRAM);
+  // Read the data, long transfers with DMA
+  int8_t statusRead = transferSpiAsync(HSPI_FRAM, NULL, data, length);
 
-  if( statusRead != HAL_OK )
+  if( statusRead != 0 )
   {
     APP_LOG(TS_OFF, VLEVEL_L, "FRAM ReadData data, SPI error: %d\r\n", statusRead);
   }
@@ -16,9 +16,14 @@
 #include "FRAM.h"
 #include "FRAM_functions.h"
 
-static_assert (MAX_SIZE_OTHER_SETTINGS + MAX_SIZE_LORA_SETTINGS <= SIZE_FRAM, "FRAM area sizes not correct");
-static_assert (ADDRESS_OTHER_SETTINGS + MAX_SIZE_OTHER_SETTINGS <= ADDRESS_LORA_SETTINGS, "FRAM area OTHER SETTINGS not correct");
-static_assert (ADDRESS_LORA_SETTINGS + MAX_SIZE_LORA_SETTINGS <= SIZE_FRAM, "FRAM area LORA SETTINGS not correct");
+static_assert (MAX_SIZE_OTHER_SETTINGS + MAX_SIZE_SD_MIRROR_STATE + MAX_SIZE_ROLLUP_STATE + MAX_SIZE_MEASUREMENT_STAGING + MAX_SIZE_MEASUREMENT_LOG + MAX_SIZE_LORA_SETTINGS + MAX_SIZE_SETTINGS_SHADOW <= SIZE_FRAM, "FRAM area sizes not correct");
+static_assert (ADDRESS_OTHER_SETTINGS + MAX_SIZE_OTHER_SETTINGS <= ADDRESS_SD_MIRROR_STATE, "FRAM area OTHER SETTINGS not correct");
+static_assert (ADDRESS_SD_MIRROR_STATE + MAX_SIZE_SD_MIRROR_STATE <= ADDRESS_ROLLUP_STATE, "FRAM area SD MIRROR STATE not correct");
+static_assert (ADDRESS_ROLLUP_STATE + MAX_SIZE_ROLLUP_STATE <= ADDRESS_MEASUREMENT_STAGING, "FRAM area ROLLUP STATE not correct");
+static_assert (ADDRESS_MEASUREMENT_STAGING + MAX_SIZE_MEASUREMENT_STAGING <= ADDRESS_MEASUREMENT_LOG, "FRAM area MEASUREMENT STAGING not correct");
+static_assert (ADDRESS_MEASUREMENT_LOG + MAX_SIZE_MEASUREMENT_LOG <= ADDRESS_LORA_SETTINGS, "FRAM area MEASUREMENT LOG not correct");
+static_assert (ADDRESS_LORA_SETTINGS + MAX_SIZE_LORA_SETTINGS <= ADDRESS_SETTINGS_SHADOW, "FRAM area LORA SETTINGS not correct");
+static_assert (ADDRESS_SETTINGS_SHADOW + MAX_SIZE_SETTINGS_SHADOW <= SIZE_FRAM, "FRAM area SETTINGS SHADOW not correct");
 
 /**
  * @fn const void setup_io_for_fram(bool)
@@ -41,9 +46,9 @@ __weak const void setup_io_for_fram(bool state)
  */
 const void saveLoraSettings( const void *pSource, size_t length )
 {
-  assert_param( ADDRESS_LORA_SETTINGS + length < SIZE_FRAM);
+  assert_param( length <= MAX_SIZE_LORA_SETTINGS);
 
-  if( ADDRESS_LORA_SETTINGS + length > SIZE_FRAM)
+  if( length > MAX_SIZE_LORA_SETTINGS)
   {
     APP_LOG(TS_OFF, VLEVEL_L, "Error FRAM lora size\r\n");
     return;
@@ -58,6 +63,31 @@ const void saveLoraSettings( const void *pSource, size_t length )
   setup_io_for_fram(false);
 }
 
+/**
+ * @fn const void saveLoraSettingsPart(uint16_t, const void*, size_t)
+ * @brief function to save a part of the Lora session settings in FRAM, a group of the NVM context
+ *
+ * @param offset : offset in Lora settings area
+ * @param pSource : pointer of source data
+ * @param length : size of data to write
+ */
+const void saveLoraSettingsPart( uint16_t offset, const void *pSource, size_t length )
+{
+  assert_param( offset + length <= MAX_SIZE_LORA_SETTINGS);
+
+  if( offset + length > MAX_SIZE_LORA_SETTINGS)
+  {
+    APP_LOG(TS_OFF, VLEVEL_L, "Error FRAM lora size\r\n");
+    return;
+  }
+
+  setup_io_for_fram(true);
+
+  FRAM_WriteData(ADDRESS_LORA_SETTINGS + offset,(uint8_t*)pSource, length);
+
+  setup_io_for_fram(false);
+}
+
 /**
  * @fn const void restoreLoraSettings(const void*, size_t)
  * @brief function to restore Lora session settings in FRAM
@@ -67,9 +97,9 @@ const void saveLoraSettings( const void *pSource, size_t length )
  */
 const void restoreLoraSettings( const void *pSource, size_t length)
 {
-  assert_param( ADDRESS_LORA_SETTINGS + length < SIZE_FRAM);
+  assert_param( length <= MAX_SIZE_LORA_SETTINGS);
 
-  if( ADDRESS_LORA_SETTINGS + length > SIZE_FRAM)
+  if( length > MAX_SIZE_LORA_SETTINGS)
   {
     APP_LOG(TS_OFF, VLEVEL_L, "Error FRAM lora size\r\n");
     return;
@@ -94,10 +124,10 @@ const void restoreLoraSettings( const void *pSource, size_t length)
  */
 static const void saveFramSettings( const void *pSource, size_t length )
 {
-  static_assert (sizeof(struct_FRAM_settings) <= ADDRESS_LORA_SETTINGS, "Size struct_FRAM_settings is too large");
-  assert_param( ADDRESS_OTHER_SETTINGS + length < ADDRESS_LORA_SETTINGS);
+  static_assert (sizeof(struct_FRAM_settings) <= MAX_SIZE_OTHER_SETTINGS, "Size struct_FRAM_settings is too large");
+  assert_param( length <= MAX_SIZE_OTHER_SETTINGS);
 
-  if( ADDRESS_OTHER_SETTINGS + length > ADDRESS_LORA_SETTINGS)
+  if( length > MAX_SIZE_OTHER_SETTINGS)
   {
     APP_LOG(TS_OFF, VLEVEL_L, "Error FRAM user size\r\n");
     return;
@@ -119,10 +149,10 @@ static const void saveFramSettings( const void *pSource, size_t length )
  */
 static const void restoreFramSettings( const void *pDest, size_t length)
 {
-  static_assert (sizeof(struct_FRAM_settings) <= ADDRESS_LORA_SETTINGS, "Size struct_FRAM_settings is too large");
-  assert_param( ADDRESS_OTHER_SETTINGS + length < ADDRESS_LORA_SETTINGS);
+  static_assert (sizeof(struct_FRAM_settings) <= MAX_SIZE_OTHER_SETTINGS, "Size struct_FRAM_settings is too large");
+  assert_param( length <= MAX_SIZE_OTHER_SETTINGS);
 
-  if( ADDRESS_OTHER_SETTINGS + length > ADDRESS_LORA_SETTINGS)
+  if( length > MAX_SIZE_OTHER_SETTINGS)
   {
     APP_LOG(TS_OFF, VLEVEL_L, "Error FRAM user size\r\n");
     return;
@@ -153,7 +183,7 @@ const void saveFramSettingsStruct( struct_FRAM_settings *pSource, size_t length
 
 /**
  * @fn const void restoreFramSettingsStruct(const void*, size_t)
- * @brief restore FRAM settings struct, checks crc if not valid data is set to 0x0
+ * @brief restore FRAM settings struct, checks crc if not valid data is set to 0x0. Settings of an older protocol are converted.
  *
  * @param pSource : pointer of source data
  * @param length : size of data to write
@@ -173,12 +203,280 @@ const void restoreFramSettingsStruct( const struct_FRAM_settings *pDest, size_t
 
   if( pDest->protocolId != FRAM_SETTINGS_PROTOCOL_ID)
   {
+    struct_FRAM_settings * settings = (struct_FRAM_settings *)pDest;
+
     APP_LOG(TS_OFF, VLEVEL_L, "Warning FRAM protocolID changed\r\n");
-#if FRAM_SETTINGS_PROTOCOL_ID > 0x00
+#if FRAM_SETTINGS_PROTOCOL_ID > 0x01
 #warning make sure FRAM protocol changes are handled
 #endif
-    //implement converting for new protocol here
+
+    if( pDest->protocolId == 0x00 )
+    {
+      //protocol 0x00 had the firmware version of the sensor modules at the place of the firmware CRC and the metadata,
+      //these are cleared with the valid bits of the metadata, the modules are read again at the next measurement
+      memset(settings->sensorModuleFirmwareCrc, 0x00, sizeof(settings->sensorModuleFirmwareCrc));
+      memset(settings->sensorModuleMetadata, 0x00, sizeof(settings->sensorModuleMetadata));
+      memset(settings->spare, 0x00, sizeof(settings->spare));
+
+      for( uint8_t i = 0; i < NR_SENSOR_MODULE; i++ )
+      {
+        settings->sensorModuleSettings[i].item.sensorModuleMetadataValid = false;
+        settings->sensorModuleSettings[i].item.sensorModuleSpare = 0;
+      }
+
+      settings->protocolId = FRAM_SETTINGS_PROTOCOL_ID;
+    }
+    else
+    {
+      APP_LOG(TS_OFF, VLEVEL_L, "Error FRAM protocolID unknown, settings reset to 0x00\r\n");
+      memset(settings, 0x00, sizeof(struct_FRAM_settings));
+    }
+  }
+}
+
+/**
+ * @fn const void saveMeasurementLogState(uint16_t, const void*, size_t)
+ * @brief function to save measurement log state in FRAM
+ *
+ * @param offset : offset in measurement log area
+ * @param pSource : pointer of source data
+ * @param length : size of data to write
+ */
+const void saveMeasurementLogState( uint16_t offset, const void *pSource, size_t length )
+{
+  assert_param( offset + length <= MAX_SIZE_MEASUREMENT_LOG);
+
+  if( offset + length > MAX_SIZE_MEASUREMENT_LOG)
+  {
+    APP_LOG(TS_OFF, VLEVEL_L, "Error FRAM measurement log size\r\n");
+    return;
+  }
+
+  setup_io_for_fram(true);
+
+  FRAM_WriteData(ADDRESS_MEASUREMENT_LOG + offset,(uint8_t*)pSource, length);
+
+  setup_io_for_fram(false);
+}
+
+/**
+ * @fn const void restoreMeasurementLogState(uint16_t, void*, size_t)
+ * @brief function to restore measurement log state from FRAM
+ *
+ * @param offset : offset in measurement log area
+ * @param pDest : pointer of destination
+ * @param length : size of data to read
+ */
+const void restoreMeasurementLogState( uint16_t offset, void *pDest, size_t length )
+{
+  assert_param( offset + length <= MAX_SIZE_MEASUREMENT_LOG);
+
+  if( offset + length > MAX_SIZE_MEASUREMENT_LOG)
+  {
+    APP_LOG(TS_OFF, VLEVEL_L, "Error FRAM measurement log size\r\n");
+    return;
+  }
+
+  setup_io_for_fram(true);
+
+  FRAM_ReadData(ADDRESS_MEASUREMENT_LOG + offset,(uint8_t*)pDest, length);
+
+  setup_io_for_fram(false);
+}
+
+/**
+ * @fn const void saveMeasurementStaging(uint16_t, const void*, size_t)
+ * @brief function to save staged measurement records in FRAM
+ *
+ * @param offset : offset in measurement staging area
+ * @param pSource : pointer of source data
+ * @param length : size of data to write
+ */
+const void saveMeasurementStaging( uint16_t offset, const void *pSource, size_t length )
+{
+  assert_param( offset + length <= MAX_SIZE_MEASUREMENT_STAGING);
+
+  if( offset + length > MAX_SIZE_MEASUREMENT_STAGING)
+  {
+    APP_LOG(TS_OFF, VLEVEL_L, "Error FRAM measurement staging size\r\n");
+    return;
+  }
+
+  setup_io_for_fram(true);
+
+  FRAM_WriteData(ADDRESS_MEASUREMENT_STAGING + offset,(uint8_t*)pSource, length);
+
+  setup_io_for_fram(false);
+}
+
+/**
+ * @fn const void restoreMeasurementStaging(uint16_t, void*, size_t)
+ * @brief function to restore staged measurement records from FRAM
+ *
+ * @param offset : offset in measurement staging area
+ * @param pDest : pointer of destination
+ * @param length : size of data to read
+ */
+const void restoreMeasurementStaging( uint16_t offset, void *pDest, size_t length )
+{
+  assert_param( offset + length <= MAX_SIZE_MEASUREMENT_STAGING);
+
+  if( offset + length > MAX_SIZE_MEASUREMENT_STAGING)
+  {
+    APP_LOG(TS_OFF, VLEVEL_L, "Error FRAM measurement staging size\r\n");
+    return;
+  }
+
+  setup_io_for_fram(true);
+
+  FRAM_ReadData(ADDRESS_MEASUREMENT_STAGING + offset,(uint8_t*)pDest, length);
+
+  setup_io_for_fram(false);
+}
+
+/**
+ * @fn const void saveRollupState(const void*, size_t)
+ * @brief function to save the state of the rollup aggregation in FRAM
+ *
+ * @param pSource : pointer of source data
+ * @param length : size of data to write
+ */
+const void saveRollupState( const void *pSource, size_t length )
+{
+  assert_param( length <= MAX_SIZE_ROLLUP_STATE);
+
+  if( length > MAX_SIZE_ROLLUP_STATE)
+  {
+    APP_LOG(TS_OFF, VLEVEL_L, "Error FRAM rollup state size\r\n");
+    return;
+  }
+
+  setup_io_for_fram(true);
+
+  FRAM_WriteData(ADDRESS_ROLLUP_STATE,(uint8_t*)pSource, length);
+
+  setup_io_for_fram(false);
+}
+
+/**
+ * @fn const void restoreRollupState(void*, size_t)
+ * @brief function to restore the state of the rollup aggregation from FRAM
+ *
+ * @param pDest : pointer of destination
+ * @param length : size of data to read
+ */
+const void restoreRollupState( void *pDest, size_t length )
+{
+  assert_param( length <= MAX_SIZE_ROLLUP_STATE);
+
+  if( length > MAX_SIZE_ROLLUP_STATE)
+  {
+    APP_LOG(TS_OFF, VLEVEL_L, "Error FRAM rollup state size\r\n");
+    return;
+  }
+
+  setup_io_for_fram(true);
+
+  FRAM_ReadData(ADDRESS_ROLLUP_STATE,(uint8_t*)pDest, length);
+
+  setup_io_for_fram(false);
+}
+
+/**
+ * @fn const void saveSdMirrorState(const void*, size_t)
+ * @brief function to save the state of the SD card mirror in FRAM
+ *
+ * @param pSource : pointer of source data
+ * @param length : size of data to write
+ */
+const void saveSdMirrorState( const void *pSource, size_t length )
+{
+  assert_param( length <= MAX_SIZE_SD_MIRROR_STATE);
+
+  if( length > MAX_SIZE_SD_MIRROR_STATE)
+  {
+    APP_LOG(TS_OFF, VLEVEL_L, "Error FRAM SD mirror state size\r\n");
+    return;
+  }
+
+  setup_io_for_fram(true);
+
+  FRAM_WriteData(ADDRESS_SD_MIRROR_STATE,(uint8_t*)pSource, length);
+
+  setup_io_for_fram(false);
+}
+
+/**
+ * @fn const void restoreSdMirrorState(void*, size_t)
+ * @brief function to restore the state of the SD card mirror from FRAM
+ *
+ * @param pDest : pointer of destination
+ * @param length : size of data to read
+ */
+const void restoreSdMirrorState( void *pDest, size_t length )
+{
+  assert_param( length <= MAX_SIZE_SD_MIRROR_STATE);
+
+  if( length > MAX_SIZE_SD_MIRROR_STATE)
+  {
+    APP_LOG(TS_OFF, VLEVEL_L, "Error FRAM SD mirror state size\r\n");
+    return;
   }
+
+  setup_io_for_fram(true);
+
+  FRAM_ReadData(ADDRESS_SD_MIRROR_STATE,(uint8_t*)pDest, length);
+
+  setup_io_for_fram(false);
+}
+
+/**
+ * @fn const void saveSettingsShadow(uint16_t, const void*, size_t)
+ * @brief function to save the shadow of the MFM settings in FRAM
+ *
+ * @param offset : offset in settings shadow area
+ * @param pSource : pointer of source data
+ * @param length : size of data to write
+ */
+const void saveSettingsShadow( uint16_t offset, const void *pSource, size_t length )
+{
+  assert_param( offset + length <= MAX_SIZE_SETTINGS_SHADOW);
+
+  if( offset + length > MAX_SIZE_SETTINGS_SHADOW)
+  {
+    APP_LOG(TS_OFF, VLEVEL_L, "Error FRAM settings shadow size\r\n");
+    return;
+  }
+
+  setup_io_for_fram(true);
+
+  FRAM_WriteData(ADDRESS_SETTINGS_SHADOW + offset,(uint8_t*)pSource, length);
+
+  setup_io_for_fram(false);
+}
+
+/**
+ * @fn const void restoreSettingsShadow(void*, size_t)
+ * @brief function to restore the shadow of the MFM settings from FRAM
+ *
+ * @param pDest : pointer of destination
+ * @param length : size of data to read
+ */
+const void restoreSettingsShadow( void *pDest, size_t length )
+{
+  assert_param( length <= MAX_SIZE_SETTINGS_SHADOW);
+
+  if( length > MAX_SIZE_SETTINGS_SHADOW)
+  {
+    APP_LOG(TS_OFF, VLEVEL_L, "Error FRAM settings shadow size\r\n");
+    return;
+  }
+
+  setup_io_for_fram(true);
+
+  FRAM_ReadData(ADDRESS_SETTINGS_SHADOW,(uint8_t*)pDest, length);
+
+  setup_io_for_fram(false);
 }
 
 /**
@@ -14,12 +14,22 @@
 #define NR_SENSOR_MODULE 6
 
 #define ADDRESS_OTHER_SETTINGS 0x0000
-#define MAX_SIZE_OTHER_SETTINGS 0x0200
+#define MAX_SIZE_OTHER_SETTINGS 0x0070
+#define ADDRESS_SD_MIRROR_STATE 0x0070
+#define MAX_SIZE_SD_MIRROR_STATE 0x0010
+#define ADDRESS_ROLLUP_STATE 0x0080
+#define MAX_SIZE_ROLLUP_STATE 0x0040
+#define ADDRESS_MEASUREMENT_STAGING 0x00C0
+#define MAX_SIZE_MEASUREMENT_STAGING 0x00C0
+#define ADDRESS_MEASUREMENT_LOG 0x0180
+#define MAX_SIZE_MEASUREMENT_LOG 0x0080
 #define ADDRESS_LORA_SETTINGS 0x0200
-#define MAX_SIZE_LORA_SETTINGS 0x0600
+#define MAX_SIZE_LORA_SETTINGS 0x05C8 //LoRaMacNvmData_t is 1468 bytes with short enums of the ARM EABI, checked in lora_app.c
+#define ADDRESS_SETTINGS_SHADOW 0x07C8
+#define MAX_SIZE_SETTINGS_SHADOW 0x0038
 #define SIZE_FRAM  0x800
 
-#define FRAM_SETTINGS_PROTOCOL_ID   0x00
+#define FRAM_SETTINGS_PROTOCOL_ID   0x01 //0x01: firmware CRC and metadata of the sensor modules instead of the firmware version
 
 typedef struct __attribute__((packed))
 {
@@ -30,9 +40,22 @@ typedef struct __attribute__((packed))
 typedef struct __attribute__((packed))
 {
     uint8_t sensorModuleInitRequest:1;
-    uint8_t sensorModuleSpare:7;
+    uint8_t sensorModuleMetadataValid:1; //metadata of the sensor module is cached, see \ref struct_sensorModuleMetadata
+    uint8_t sensorModuleSpare:6;
 }struct_sensorModuleSettings;
 
+/**
+ * Metadata of a sensor module, read once after a module is found in a slot. Valid while the type read from the module
+ * and the configured number of samples are the same.
+ */
+typedef struct __attribute__((packed))
+{
+    uint16_t type;       //sensor type of the module, identity check each measurement
+    uint16_t setupTime;  //measure time of the module in ms, depends on the samples
+    uint8_t samples;     //number of samples the setup time was read with
+    uint8_t amount;      //number of sensors on the module
+}struct_sensorModuleMetadata;
+
 typedef union
 {
     uint8_t byte;
@@ -46,7 +69,8 @@ typedef struct __attribute__((packed))
     uint8_t batteryLow:1;
     uint8_t sensorModuleInitFailed_channel1:1;
     uint8_t sensorModuleInitFailed_channel2:1;
-    uint32_t spare:27;
+    uint8_t dataflashWearLimit:1;
+    uint32_t spare:26;
 }struct_diagnosticStatusBits;
 
 typedef union
@@ -62,7 +86,9 @@ typedef struct __attribute__((packed))
     uint8_t protocolId;
     uint8_t currentSensorModuleIndex; // index of active sensor 0-5
     uint32_t nextIntervalBatteryEOS;
-    struct_sensorModuleFirmwareVersion modules[NR_SENSOR_MODULE];
+    uint16_t sensorModuleFirmwareCrc[NR_SENSOR_MODULE]; //CRC of the firmware version saved in the key-value store of the dataflash
+    struct_sensorModuleMetadata sensorModuleMetadata[NR_SENSOR_MODULE]; //cached metadata, see sensorModuleMetadataValid
+    uint8_t spare[(sizeof(struct_sensorModuleFirmwareVersion) - sizeof(uint16_t) - sizeof(struct_sensorModuleMetadata)) * NR_SENSOR_MODULE]; //free, was the firmware version of the sensor modules
     uint8_t sensorModuleProtocol[NR_SENSOR_MODULE];
     uint8_t numberOfActiveSensorModules; //number of active modules 0-6, 0 = none
     UNION_sensorModuleSettings sensorModuleSettings[NR_SENSOR_MODULE];
@@ -71,11 +97,25 @@ typedef struct __attribute__((packed))
 }struct_FRAM_settings;
 
 const void saveLoraSettings( const void *pSource, size_t length );
+const void saveLoraSettingsPart( uint16_t offset, const void *pSource, size_t length );
 const void restoreLoraSettings( const void *pSource, size_t length);
 
 const void saveFramSettingsStruct( struct_FRAM_settings *pSource, size_t length );
 const void restoreFramSettingsStruct( const struct_FRAM_settings *pDest, size_t length);
 
+const void saveMeasurementLogState( uint16_t offset, const void *pSource, size_t length );
+const void restoreMeasurementLogState( uint16_t offset, void *pDest, size_t length );
+
+const void saveMeasurementStaging( uint16_t offset, const void *pSource, size_t length );
+const void restoreMeasurementStaging( uint16_t offset, void *pDest, size_t length );
+
+const void saveRollupState( const void *pSource, size_t length );
+const void restoreRollupState( void *pDest, size_t length );
+const void saveSdMirrorState( const void *pSource, size_t length );
+const void restoreSdMirrorState( void *pDest, size_t length );
+const void saveSettingsShadow( uint16_t offset, const void *pSource, size_t length );
+const void restoreSettingsShadow( void *pDest, size_t length );
+
 const int8_t testFram(uint8_t * status);
 
 #endif /* FRAM_FRAM_FUNCTIONS_H_ */
@@ -42,3 +42,27 @@ int8_t findRegIndex(uint8_t regAddress)
 
   return (index == size ? -1 : index);
 }
+
+/**
+ * @fn const float getPressureHuba(uint16_t)
+ * @brief function to get real pressure from rough Huba measurement data
+ *
+ * @param pressureData
+ * @return pressure in bar
+ */
+const float getPressureHuba(uint16_t pressureData)
+{
+  return ((pressureData - 3000) / 8000.0) * 0.6;
+}
+
+/**
+ * @fn const float getTemperatureHuba(uint8_t)
+ * @brief function to get real temperature from rough Huba measurement data
+ *
+ * @param tempData
+ * @return temperature in degree Celsius
+ */
+const float getTemperatureHuba(uint8_t tempData)
+{
+  return ((tempData * 200.0) / 255) - 50;
+}
@@ -130,5 +130,7 @@ extern const SensorReg registers[];
 
 /* Functions */
 int8_t findRegIndex(uint8_t regAddress);
+const float getPressureHuba(uint16_t pressureData);
+const float getTemperatureHuba(uint8_t tempData);
 
 #endif /* SENSORREGISTER_H_ */
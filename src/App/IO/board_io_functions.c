@@ -16,6 +16,7 @@
 
 #include "board_io.h"
 #include "board_io_functions.h"
+#include "../common/spi_bus.h"
 
 static UTIL_TIMER_Object_t AlwaysOnSwitch_Timer;
 static UTIL_TIMER_Time_t AlwaysOnSwitchOnTime = 3000; //3sec
@@ -281,37 +282,69 @@ const void setup_io_for_SPI_devices(bool state)
 /**
  * @fn const void setup_io_for_fram(bool)
  * @brief override of weak function. To enable I/O needed for FRAM
- * function detects the vSys previous state and turns ON/OFF vSys if it was off.
+ * the SPI bus is acquired, see acquireSpiBus(), and released again with state false.
  *
  * @param state
  */
 const void setup_io_for_fram(bool state)
 {
-  setup_io_for_SPI_devices(state);
+  if( state == true )
+  {
+    acquireSpiBus(SPI_BUS_FRAM);
+  }
+  else
+  {
+    releaseSpiBus();
+  }
 }
 
 /**
  * @fn const void setup_io_for_sdcard(bool)
  * @brief override of weak function. To enable I/O needed for dataflash
- * function detects the vSys previous state and turns ON/OFF vSys if it was off.
+ * the SPI bus is acquired, see acquireSpiBus(), and released again with state false.
  *
  * @param state
  */
 const void setup_io_for_dataflash(bool state)
 {
-  setup_io_for_SPI_devices(state);
+  if( state == true )
+  {
+    acquireSpiBus(SPI_BUS_DATAFLASH);
+  }
+  else
+  {
+    releaseSpiBus();
+  }
+}
+
+/**
+ * @fn const bool get_supply_state_for_dataflash(void)
+ * @brief override of weak function. To get the supply state of the dataflash, the dataflash is supplied by vSys.
+ *
+ * @return true = vSys is on, false = vSys is off
+ */
+const bool get_supply_state_for_dataflash(void)
+{
+  return readInput_board_io(EXT_IOVSYS_EN) == GPIO_PIN_SET;
 }
 
 /**
  * @fn const void setup_io_for_SdCard(bool)
  * @brief override of weak function. To enable I/O needed for SD-card
- * function detects the vSys previous state and turns ON/OFF vSys if it was off.
+ * the SPI bus is acquired, see acquireSpiBus(), and released again with state false.
  *
  * @param state
  */
 const void setup_io_for_SdCard(bool state)
 {
-  setup_io_for_SPI_devices(state);
+  if( state == true )
+  {
+    acquireSpiBus(SPI_BUS_SDCARD);
+  }
+  else
+  {
+    releaseSpiBus();
+  }
 }
 
 /**
@@ -15,14 +15,47 @@
 
 #include "eeprom_emul.h"
 
+#include "common/crc16.h"
+#include "FRAM/FRAM_functions.h"
+#include "measurement.h"
 #include "MFMconfiguration.h"
 
+#define SETTINGS_SHADOW_PROTOCOL_ID   0x00
+#define SETTINGS_SHADOW_DATA_SIZE     ( MAX_SIZE_SETTINGS_SHADOW - sizeof(struct_settingsShadowHeader) )
+
+/**
+ * @brief header of the shadow of the settings in FRAM, followed by the values of all items of \ref stVirtualEEPROM.
+ * The shadow is a copy of the virtual EEPROM, read at boot instead of the virtual EEPROM.
+ */
+typedef struct __attribute__((packed))
+{
+  uint16_t crc16;               //CRC over all fields after this field and the values
+  uint8_t protocolId;           //\ref SETTINGS_SHADOW_PROTOCOL_ID
+  uint8_t numberOfItems;        //number of items in \ref stVirtualEEPROM, other number = other layout
+  uint32_t generation;          //incremented every save, 0 = shadow not valid, a save to the virtual EEPROM is busy
+}struct_settingsShadowHeader;
+
+typedef struct __attribute__((packed))
+{
+  struct_settingsShadowHeader header;
+  uint8_t data[SETTINGS_SHADOW_DATA_SIZE];
+}struct_settingsShadow;
+
+static_assert (sizeof(struct_settingsShadow) <= MAX_SIZE_SETTINGS_SHADOW, "Size struct_settingsShadow is too large");
+
 static struct_MFMSettings MFM_settings; //settings struct in RAM
+static struct_settingsShadow settingsShadow; //copy of the settings in virtual EEPROM, to detect changed items
+static bool settingsShadowValid = false;
 static bool initAtFirstCall = true;
 static bool vAlwaysStateChanged = false;
 
 static const uint16_t defaultInterval = 60;
 static const bool defaultAlwaysOnSupplyStatus = false;
+static const uint8_t defaultMeasurementVerify = MEASUREMENT_VERIFY_DEFAULT;
+static const uint8_t defaultMeasurementStaging = MEASUREMENT_STAGING_DEFAULT;
+static const uint16_t defaultRollupWindow = 0; //no rollups, opt-in by Set+Rollup
+static const uint8_t defaultRollupUplink = 0; //latest measurement by LoRa
+static const uint8_t defaultSdMirrorBatch = 0; //no SD mirror
 static const uint16_t defaultModuleType = 0;
 static const uint16_t defaultNumberOfSamples = 10;
 static const uint16_t defaultEnabledOn = true;
@@ -36,6 +69,11 @@ struct_virtual_EEPROM_item stVirtualEEPROM[] =
 {
     { IDX_INTERVAL_LORA,                VIRTUAL_ELEMENT_SIZE_16bits,    &MFM_settings.intervalLora,                             &defaultInterval },
     { IDX_ALWAYS_ON_SUPPLY_ENABLED,     VIRTUAL_ELEMENT_SIZE_8bits,     &MFM_settings.alwaysOnSupplyEnabled,                    &defaultAlwaysOnSupplyStatus },
+    { IDX_MEASUREMENT_VERIFY,           VIRTUAL_ELEMENT_SIZE_8bits,     &MFM_settings.measurementVerify,                        &defaultMeasurementVerify },
+    { IDX_MEASUREMENT_STAGING,          VIRTUAL_ELEMENT_SIZE_8bits,     &MFM_settings.measurementStaging,                       &defaultMeasurementStaging },
+    { IDX_ROLLUP_WINDOW,                VIRTUAL_ELEMENT_SIZE_16bits,    &MFM_settings.rollupWindow,                             &defaultRollupWindow },
+    { IDX_ROLLUP_UPLINK,                VIRTUAL_ELEMENT_SIZE_8bits,     &MFM_settings.rollupUplink,                             &defaultRollupUplink },
+    { IDX_SD_MIRROR_BATCH,              VIRTUAL_ELEMENT_SIZE_8bits,     &MFM_settings.sdMirrorBatch,                            &defaultSdMirrorBatch },
 
     { IDX_SENSOR1_MODULETYPE,           VIRTUAL_ELEMENT_SIZE_16bits,    &MFM_settings.slotModuleSettings[0].moduleType,         &defaultModuleType },
     { IDX_SENSOR2_MODULETYPE,           VIRTUAL_ELEMENT_SIZE_16bits,    &MFM_settings.slotModuleSettings[1].moduleType,         &defaultModuleType },
@@ -63,6 +101,132 @@ struct_virtual_EEPROM_item stVirtualEEPROM[] =
 
 };
 
+/**
+ * @fn uint8_t getVirtualElementBytes(ENUM_virtualElementSize)
+ * @brief helper function to get the number of bytes of an element
+ *
+ * @param size : element size type
+ * @return number of bytes, 0 = unknown size
+ */
+static uint8_t getVirtualElementBytes( ENUM_virtualElementSize size )
+{
+  switch( size )
+  {
+    case VIRTUAL_ELEMENT_SIZE_8bits:
+      return 1;
+    case VIRTUAL_ELEMENT_SIZE_16bits:
+      return 2;
+    case VIRTUAL_ELEMENT_SIZE_32bits:
+      return 4;
+    default:
+      return 0;
+  }
+}
+
+/**
+ * @fn int8_t packSettingsShadow(struct_settingsShadow*)
+ * @brief helper function to copy the values of all items of \ref stVirtualEEPROM in a shadow
+ *
+ * @param shadow : destination
+ * @return 0 = successful, -1 = items do not fit in the shadow
+ */
+static int8_t packSettingsShadow( struct_settingsShadow * shadow )
+{
+  uint16_t offset = 0;
+  int item = 0;
+
+  memset(shadow, 0x00, sizeof(struct_settingsShadow));
+
+  do
+  {
+    uint8_t bytes = getVirtualElementBytes(stVirtualEEPROM[item].virtualElementSize);
+
+    if( offset + bytes > sizeof(shadow->data) )
+    {
+      return -1;
+    }
+
+    memcpy(&shadow->data[offset], stVirtualEEPROM[item].pointerToItem, bytes);
+    offset += bytes;
+  }
+  while(stVirtualEEPROM[++item].virtualAddress != IDX_LAST);
+
+  shadow->header.protocolId = SETTINGS_SHADOW_PROTOCOL_ID;
+  shadow->header.numberOfItems = item;
+
+  return 0;
+}
+
+/**
+ * @fn void writeSettingsShadow(uint32_t)
+ * @brief helper function to write \ref settingsShadow in FRAM in one write
+ *
+ * @param generation : generation of the shadow
+ */
+static void writeSettingsShadow( uint32_t generation )
+{
+  settingsShadow.header.generation = generation;
+  settingsShadow.header.crc16 = calculateCRC_CCITT(&settingsShadow.header.protocolId, sizeof(settingsShadow) - sizeof(settingsShadow.header.crc16));
+
+  saveSettingsShadow(0, &settingsShadow, sizeof(settingsShadow));
+}
+
+/**
+ * @fn void invalidateSettingsShadow(void)
+ * @brief helper function to invalidate the shadow in FRAM, before the virtual EEPROM is changed
+ *
+ */
+static void invalidateSettingsShadow( void )
+{
+  struct_settingsShadowHeader header = {0};
+
+  saveSettingsShadow(0, &header, sizeof(header));
+}
+
+/**
+ * @fn int restoreSettingsFromShadow(void)
+ * @brief helper function to restore the settings from the shadow in FRAM, read in one burst
+ *
+ * @return 0 = successful, -1 = no valid shadow
+ */
+static int restoreSettingsFromShadow( void )
+{
+  uint16_t offset = 0;
+  int item = 0;
+
+  restoreSettingsShadow(&settingsShadow, sizeof(settingsShadow));
+
+  if( settingsShadow.header.crc16 != calculateCRC_CCITT(&settingsShadow.header.protocolId, sizeof(settingsShadow) - sizeof(settingsShadow.header.crc16)) ||
+      settingsShadow.header.protocolId != SETTINGS_SHADOW_PROTOCOL_ID || settingsShadow.header.generation == 0 )
+  {
+    return -1;
+  }
+
+  //count items, other firmware with other items has another layout
+  while(stVirtualEEPROM[item].virtualAddress != IDX_LAST)
+  {
+    item++;
+  }
+
+  if( settingsShadow.header.numberOfItems != item )
+  {
+    return -1;
+  }
+
+  item = 0;
+
+  do
+  {
+    uint8_t bytes = getVirtualElementBytes(stVirtualEEPROM[item].virtualElementSize);
+
+    memcpy(stVirtualEEPROM[item].pointerToItem, &settingsShadow.data[offset], bytes);
+    offset += bytes;
+  }
+  while(stVirtualEEPROM[++item].virtualAddress != IDX_LAST);
+
+  return 0;
+}
+
 /**
  * @fn const int eraseVirtualEEPROM(void)
  * @brief function to erase Virtual Eemprom memory in flash
@@ -80,6 +244,9 @@ const int eraseVirtualEEPROM(void)
   /* lock the Flash Program Erase controller */
   HAL_FLASH_Lock();
 
+  invalidateSettingsShadow();
+  settingsShadowValid = false;
+
   if(status == EE_OK )
   {
     return 0;
@@ -121,96 +288,143 @@ uint16_t getCrcSettings(void)
 
 
 /**
- * @fn const int reloadSettingsFromVirtualEEPROM(void)
+ * @fn const int reloadSettingsFromVirtualEEPROM(bool)
  * @brief function to load setting from virtual EEPROM (flash)
- * function first check if virtual EEPROM is already initialized, if not initialization will be called first.
- * Then all settings from \ref stVirtualEEPROM will be loaded in \ref MFM_settings
+ * The settings are restored from the shadow in FRAM when it is valid, the virtual EEPROM is not read.
+ * Without the shadow the FRAM is not used, f.e. at a wake without measurement.
+ * Else function first check if virtual EEPROM is already initialized, if not initialization will be called first.
+ * Then all settings from \ref stVirtualEEPROM will be loaded in \ref MFM_settings and the shadow is written.
+ * Items that are not read get their default value, these are saved in the virtual EEPROM before the shadow is written.
  *
+ * @param useShadow : true = restore from and write the shadow in FRAM, false = only the virtual EEPROM is read
  * @return 0 = successful, -1 = read error, -2 = wrong CRC
  */
-const int reloadSettingsFromVirtualEEPROM(void)
+const int reloadSettingsFromVirtualEEPROM(bool useShadow)
 {
   int item = 0;
+  uint16_t offset = 0;
   uint16_t crc;
   EE_Status status;
+  uint8_t defaultedBytes[SETTINGS_SHADOW_DATA_SIZE] = {0}; //bytes of the items that are not read, set to 0xFF
 
   bool readError = false;
-  if( initAtFirstCall )
-  {
-    /* Unlock the Flash Program Erase controller */
-    HAL_FLASH_Unlock();
 
-    status = EE_Init(EE_FORCED_ERASE);
-    initAtFirstCall = false; //reset
-
-    /* lock the Flash Program Erase controller */
-    HAL_FLASH_Lock();
+  if( useShadow && restoreSettingsFromShadow() == 0 )
+  {
+    APP_LOG(TS_OFF, VLEVEL_H, "Settings restored from FRAM shadow, generation %lu\r\n", settingsShadow.header.generation);
+    settingsShadowValid = true;
   }
 
-  do
+  else
   {
-
-    switch( stVirtualEEPROM[item].virtualElementSize )
+    if( initAtFirstCall )
     {
-      case VIRTUAL_ELEMENT_SIZE_8bits:
-
-        status = EE_ReadVariable8bits(stVirtualEEPROM[item].virtualAddress, (uint8_t* )stVirtualEEPROM[item].pointerToItem);
-
-        break;
-
-      case VIRTUAL_ELEMENT_SIZE_16bits:
-
-        status = EE_ReadVariable16bits(stVirtualEEPROM[item].virtualAddress, (uint16_t* )stVirtualEEPROM[item].pointerToItem);
-
-        break;
-
-      case VIRTUAL_ELEMENT_SIZE_32bits:
-
-        status = EE_ReadVariable32bits(stVirtualEEPROM[item].virtualAddress, (uint32_t* )stVirtualEEPROM[item].pointerToItem);
-
-        break;
-
-      default:
-        //nothing
+      /* Unlock the Flash Program Erase controller */
+      HAL_FLASH_Unlock();
 
-        status = EE_NO_DATA;
+      status = EE_Init(EE_FORCED_ERASE);
+      initAtFirstCall = false; //reset
 
-        break;
+      /* lock the Flash Program Erase controller */
+      HAL_FLASH_Lock();
     }
 
-    if( status != EE_OK )
+    do
     {
-      APP_LOG(TS_OFF, VLEVEL_H, "Virtual eeprom error: read item %d\r\n", item);
-      readError = true;
+      uint8_t bytes = getVirtualElementBytes(stVirtualEEPROM[item].virtualElementSize);
 
-      switch (stVirtualEEPROM[item].virtualElementSize)
+      switch( stVirtualEEPROM[item].virtualElementSize )
       {
         case VIRTUAL_ELEMENT_SIZE_8bits:
 
-          memcpy(stVirtualEEPROM[item].pointerToItem, stVirtualEEPROM[item].pointerToDefault, 1);
+          status = EE_ReadVariable8bits(stVirtualEEPROM[item].virtualAddress, (uint8_t* )stVirtualEEPROM[item].pointerToItem);
 
           break;
 
         case VIRTUAL_ELEMENT_SIZE_16bits:
 
-          memcpy(stVirtualEEPROM[item].pointerToItem, stVirtualEEPROM[item].pointerToDefault, 2);
+          status = EE_ReadVariable16bits(stVirtualEEPROM[item].virtualAddress, (uint16_t* )stVirtualEEPROM[item].pointerToItem);
 
           break;
 
         case VIRTUAL_ELEMENT_SIZE_32bits:
 
-          memcpy(stVirtualEEPROM[item].pointerToItem, stVirtualEEPROM[item].pointerToDefault, 4);
+          status = EE_ReadVariable32bits(stVirtualEEPROM[item].virtualAddress, (uint32_t* )stVirtualEEPROM[item].pointerToItem);
 
           break;
 
         default:
           //nothing
 
+          status = EE_NO_DATA;
+
           break;
       }
+
+      if( status != EE_OK )
+      {
+        APP_LOG(TS_OFF, VLEVEL_H, "Virtual eeprom error: read item %d\r\n", item);
+        readError = true;
+
+        switch (stVirtualEEPROM[item].virtualElementSize)
+        {
+          case VIRTUAL_ELEMENT_SIZE_8bits:
+
+            memcpy(stVirtualEEPROM[item].pointerToItem, stVirtualEEPROM[item].pointerToDefault, 1);
+
+            break;
+
+          case VIRTUAL_ELEMENT_SIZE_16bits:
+
+            memcpy(stVirtualEEPROM[item].pointerToItem, stVirtualEEPROM[item].pointerToDefault, 2);
+
+            break;
+
+          case VIRTUAL_ELEMENT_SIZE_32bits:
+
+            memcpy(stVirtualEEPROM[item].pointerToItem, stVirtualEEPROM[item].pointerToDefault, 4);
+
+            break;
+
+          default:
+            //nothing
+
+            break;
+        }
+
+        if( offset + bytes <= sizeof(defaultedBytes) )
+        {
+          memset(&defaultedBytes[offset], 0xFF, bytes);
+        }
+      }
+
+      offset += bytes;
+    }
+    while(stVirtualEEPROM[++item].virtualAddress != IDX_LAST);
+
+    //shadow of the read settings, read at next boot
+    settingsShadowValid = false;
+    if( useShadow && packSettingsShadow(&settingsShadow) == 0 )
+    {
+      if( readError == false )
+      {
+        writeSettingsShadow(1);
+        settingsShadowValid = true;
+      }
+      else
+      {
+        //f.e. items added by a firmware update, the defaulted items differ from the shadow and are saved once,
+        //the save writes the shadow so the virtual EEPROM is not read again at next boot
+        for( offset = 0; offset < sizeof(settingsShadow.data); offset++ )
+        {
+          settingsShadow.data[offset] ^= defaultedBytes[offset];
+        }
+        settingsShadowValid = true;
+
+        saveSettingsToVirtualEEPROM();
+      }
     }
   }
-  while(stVirtualEEPROM[++item].virtualAddress != IDX_LAST);
 
   //check if error is found at reading, return error
   if( readError )
@@ -235,16 +449,32 @@ const int reloadSettingsFromVirtualEEPROM(void)
  * @fn const int saveSettingsToVirtualEEPROM(void)
  * @brief function to save setting from RAM to virtual EEPROM (flash)
  * function first check if virtual EEPROM is already initialized, if not initialization will be called first.
- * Then all settings from \ref MFM_settings will be loaded in \ref stVirtualEEPROM
+ * Then the settings from \ref MFM_settings that are changed will be loaded in \ref stVirtualEEPROM, changed items are
+ * detected with the shadow. The shadow in FRAM is not valid while the virtual EEPROM is written.
  *
  * @return 0 = successful, -1 = write error
  */
 const int saveSettingsToVirtualEEPROM(void)
 {
+  static struct_settingsShadow newShadow;
+  uint16_t offset = 0;
   int item = 0;
+  int numberOfChangedItems = 0;
   bool writeError = false;
   EE_Status status;
 
+  MFM_settings.crc = calculateCrcSettings(); //calculate CRC to save
+
+  bool shadowPacked = packSettingsShadow(&newShadow) == 0;
+
+  if( shadowPacked && settingsShadowValid && memcmp(newShadow.data, settingsShadow.data, sizeof(newShadow.data)) == 0 )
+  {
+    APP_LOG(TS_OFF, VLEVEL_H, "Virtual eeprom: no changed items\r\n");
+    return 0; //nothing changed, no write
+  }
+
+  invalidateSettingsShadow();
+
   /* Unlock the Flash Program Erase controller */
   HAL_FLASH_Unlock();
 
@@ -254,10 +484,19 @@ const int saveSettingsToVirtualEEPROM(void)
     initAtFirstCall = false; //reset
   }
 
-  MFM_settings.crc = calculateCrcSettings(); //calculate CRC to save
-
   do
   {
+    uint8_t bytes = getVirtualElementBytes(stVirtualEEPROM[item].virtualElementSize);
+
+    //skip item that is not changed
+    if( shadowPacked && settingsShadowValid && memcmp(&newShadow.data[offset], &settingsShadow.data[offset], bytes) == 0 )
+    {
+      offset += bytes;
+      continue;
+    }
+
+    offset += bytes;
+    numberOfChangedItems++;
 
     switch( stVirtualEEPROM[item].virtualElementSize )
     {
@@ -311,11 +550,23 @@ const int saveSettingsToVirtualEEPROM(void)
   /* lock the Flash Program Erase controller */
   HAL_FLASH_Lock();
 
+  APP_LOG(TS_OFF, VLEVEL_H, "Virtual eeprom: %d changed items saved\r\n", numberOfChangedItems);
+
   if( writeError ) //check on write error
   {
+    settingsShadowValid = false; //unknown items in virtual EEPROM, next save writes all items
     return -1;
   }
 
+  if( shadowPacked )
+  {
+    uint32_t generation = settingsShadowValid ? settingsShadow.header.generation + 1 : 1;
+
+    memcpy(&settingsShadow, &newShadow, sizeof(settingsShadow));
+    writeSettingsShadow(generation == 0 ? 1 : generation);
+    settingsShadowValid = true;
+  }
+
   return 0; //successful
 }
 
@@ -526,3 +777,148 @@ const bool getAlwaysOn_changed(bool reset)
   }
   return returnValue;
 }
+
+/**
+ * @fn const uint8_t getMeasurementVerify(void)
+ * @brief override function to get the read back of measurements after writing dataflash
+ *
+ * @return 0 = none, 1 = header, 2 = CRC, 3 = full
+ */
+const uint8_t getMeasurementVerify(void)
+{
+  return MFM_settings.measurementVerify;
+}
+
+/**
+ * @fn const int32_t setMeasurementVerify(uint8_t)
+ * @brief override function to set the read back of measurements after writing dataflash
+ *
+ * @param verify : 0 = none, 1 = header, 2 = CRC, 3 = full
+ * @return 0 = successful, -1 = out of range
+ */
+const int32_t setMeasurementVerify(uint8_t verify)
+{
+  if( verify > MEASUREMENT_VERIFY_FULL )
+  {
+    return -1;
+  }
+
+  MFM_settings.measurementVerify = verify;
+
+  return 0;
+}
+
+/**
+ * @fn const uint8_t getMeasurementStaging(void)
+ * @brief override function to get the number of measurements collected in FRAM before they are programmed in dataflash
+ *
+ * @return 1 = no staging, up to \ref MEASUREMENT_STAGING_MAX measurements
+ */
+const uint8_t getMeasurementStaging(void)
+{
+  return MFM_settings.measurementStaging;
+}
+
+/**
+ * @fn const int32_t setMeasurementStaging(uint8_t)
+ * @brief override function to set the number of measurements collected in FRAM before they are programmed in dataflash
+ *
+ * @param records : 1 = no staging, up to \ref MEASUREMENT_STAGING_MAX measurements
+ * @return 0 = successful, -1 = out of range
+ */
+const int32_t setMeasurementStaging(uint8_t records)
+{
+  if( records < 1 || records > MEASUREMENT_STAGING_MAX )
+  {
+    return -1;
+  }
+
+  MFM_settings.measurementStaging = records;
+
+  return 0;
+}
+
+/**
+ * @fn const uint16_t getRollupWindow(void)
+ * @brief override function to get the length of the rollup window
+ *
+ * @return minutes, 0 = no rollups
+ */
+const uint16_t getRollupWindow(void)
+{
+  return MFM_settings.rollupWindow;
+}
+
+/**
+ * @fn const int32_t setRollupWindow(uint16_t)
+ * @brief override function to set the length of the rollup window
+ *
+ * @param minutes : 0 = no rollups, up to 1440 minutes
+ * @return 0 = successful, -1 = out of range
+ */
+const int32_t setRollupWindow(uint16_t minutes)
+{
+  if( minutes > 1440 )
+  {
+    return -1;
+  }
+
+  MFM_settings.rollupWindow = minutes;
+
+  return 0;
+}
+
+/**
+ * @fn const bool getRollupUplink(void)
+ * @brief override function to get the uplink of rollups
+ *
+ * @return true = rollups are sent by LoRa instead of the latest measurement
+ */
+const bool getRollupUplink(void)
+{
+  return MFM_settings.rollupUplink == 1;
+}
+
+/**
+ * @fn const int32_t setRollupUplink(bool)
+ * @brief override function to set the uplink of rollups
+ *
+ * @param enabled : true = rollups are sent by LoRa instead of the latest measurement
+ * @return 0 = successful
+ */
+const int32_t setRollupUplink(bool enabled)
+{
+  MFM_settings.rollupUplink = enabled ? 1 : 0;
+
+  return 0;
+}
+
+/**
+ * @fn const uint8_t getSdMirrorBatch(void)
+ * @brief override function to get the number of measurements collected before they are written on the SD card
+ *
+ * @return 0 = no SD mirror, up to 64 measurements
+ */
+const uint8_t getSdMirrorBatch(void)
+{
+  return MFM_settings.sdMirrorBatch;
+}
+
+/**
+ * @fn const int32_t setSdMirrorBatch(uint8_t)
+ * @brief override function to set the number of measurements collected before they are written on the SD card
+ *
+ * @param batch : 0 = no SD mirror, up to 64 measurements
+ * @return 0 = successful, -1 = out of range
+ */
+const int32_t setSdMirrorBatch(uint8_t batch)
+{
+  if( batch > 64 )
+  {
+    return -1;
+  }
+
+  MFM_settings.sdMirrorBatch = batch;
+
+  return 0;
+}
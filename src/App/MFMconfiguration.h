@@ -30,7 +30,12 @@ typedef struct __attribute__((__packed__))
     uint16_t intervalLora;      //interval of lora sending
     bool alwaysOnSupplyEnabled; //true = alwaysOnSupply is always on, false = alwaysOnSupply is off in sleep
     struct_sensorSlotSettings slotModuleSettings[NR_OF_SLOTS];
-    uint8_t spare[154];         //reserved memory for future use
+    uint8_t measurementVerify;  //read back of measurements after writing dataflash, 0 = none, 1 = header, 2 = CRC, 3 = full
+    uint8_t measurementStaging; //measurements collected in FRAM before programming dataflash, 1 = no staging
+    uint16_t rollupWindow;      //minutes of the rollup window, 0 = no rollups
+    uint8_t rollupUplink;       //1 = rollups are sent by LoRa instead of the latest measurement
+    uint8_t sdMirrorBatch;      //measurements collected before the SD card is written, 0 = no SD mirror
+    uint8_t spare[148];         //reserved memory for future use
     uint16_t crc;               //CRC for validate the data
 }struct_MFMSettings;
 
@@ -41,6 +46,11 @@ typedef enum {
 
   IDX_INTERVAL_LORA = 100,
   IDX_ALWAYS_ON_SUPPLY_ENABLED,
+  IDX_MEASUREMENT_VERIFY,
+  IDX_MEASUREMENT_STAGING,
+  IDX_ROLLUP_WINDOW,
+  IDX_ROLLUP_UPLINK,
+  IDX_SD_MIRROR_BATCH,
 
   IDX_SENSOR1_MODULETYPE = 200,
   IDX_SENSOR2_MODULETYPE,
@@ -84,13 +94,23 @@ typedef struct {
 
 const int eraseVirtualEEPROM(void);
 const int saveSettingsToVirtualEEPROM(void);
-const int reloadSettingsFromVirtualEEPROM(void);
+const int reloadSettingsFromVirtualEEPROM(bool useShadow);
 const int32_t getSensorStatus(int32_t sensorId);
 const uint16_t getLoraInterval(void);
 const int32_t setLoraInterval(uint16_t interval);
 const uint8_t getNumberOfSamples(int32_t sensorId);
 const bool getAlwaysOn(void);
 const bool getAlwaysOn_changed(bool reset);
+const uint8_t getMeasurementVerify(void);
+const int32_t setMeasurementVerify(uint8_t verify);
+const uint8_t getMeasurementStaging(void);
+const int32_t setMeasurementStaging(uint8_t records);
+const uint16_t getRollupWindow(void);
+const int32_t setRollupWindow(uint16_t minutes);
+const bool getRollupUplink(void);
+const int32_t setRollupUplink(bool enabled);
+const uint8_t getSdMirrorBatch(void);
+const int32_t setSdMirrorBatch(uint8_t batch);
 const int32_t getSensorType(int32_t sensorId);
 const int32_t setSensorType(int32_t sensorId, uint16_t moduleType);
 
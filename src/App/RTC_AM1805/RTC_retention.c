@@ -0,0 +1,143 @@
+/**
+  ******************************************************************************
+  * @addtogroup     : App
+  * @{
+  * @file           : RTC_retention.c
+  * @brief          : retention of the state between wakes in the RAM of the AM1805.
+  * The RAM is read and written in one I2C burst, the content is validated with a CRC and the layout with the
+  * protocol ID and size. Nothing is erased or worn, the RAM is lost only with the RTC supply.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  * @}
+  ******************************************************************************
+  */
+
+#include <string.h>
+
+#include "main.h"
+#include "sys_app.h"
+
+#include "../common/crc16.h"
+#include "am1805.h"
+#include "RTC_retention.h"
+
+#define RTC_RETENTION_PROTOCOL_ID       0x01
+
+static_assert (sizeof(struct_rtcRetention) <= RTC_RETENTION_MAX_SIZE, "Size struct_rtcRetention is too large");
+
+static struct_rtcRetention rtcRetention;
+static bool rtcRetentionValid = false;
+
+/**
+ * @fn uint16_t calculateCrcRtcRetention(void)
+ * @brief helper function to calculate the CRC of the retention
+ *
+ * @return CRC
+ */
+static uint16_t calculateCrcRtcRetention( void )
+{
+  return calculateCRC_CCITT(&rtcRetention.protocolId, sizeof(rtcRetention) - sizeof(rtcRetention.crc16));
+}
+
+/**
+ * @fn const int8_t restoreRtcRetention(void)
+ * @brief function to restore the retention from the RAM of the RTC, not valid content is reset to 0x00
+ *
+ * @return 0 = successful, -1 = not valid, RTC supply was lost or other layout
+ */
+const int8_t restoreRtcRetention( void )
+{
+  am1805_ram_block_read(RTC_RETENTION_ADDRESS, (uint8_t*)&rtcRetention, sizeof(rtcRetention));
+
+  rtcRetentionValid = rtcRetention.crc16 == calculateCrcRtcRetention() &&
+                      rtcRetention.protocolId == RTC_RETENTION_PROTOCOL_ID && rtcRetention.length == sizeof(rtcRetention);
+
+  if( rtcRetentionValid == false )
+  {
+    APP_LOG(TS_OFF, VLEVEL_M, "RTC retention not valid, reset to 0x00\r\n");
+    memset(&rtcRetention, 0x00, sizeof(rtcRetention));
+    rtcRetention.protocolId = RTC_RETENTION_PROTOCOL_ID;
+    rtcRetention.length = sizeof(rtcRetention);
+    return -1;
+  }
+
+  return 0;
+}
+
+/**
+ * @fn const void saveRtcRetention(void)
+ * @brief function to save the retention in the RAM of the RTC, valid from the next wake
+ *
+ */
+const void saveRtcRetention( void )
+{
+  rtcRetention.crc16 = calculateCrcRtcRetention();
+
+  am1805_ram_block_write(RTC_RETENTION_ADDRESS, (uint8_t*)&rtcRetention, sizeof(rtcRetention));
+}
+
+/**
+ * @fn const bool isRtcRetentionValid(void)
+ * @brief function to get the retention was valid at restore
+ *
+ * @return true = valid, false = reset to 0x00
+ */
+const bool isRtcRetentionValid( void )
+{
+  return rtcRetentionValid;
+}
+
+/**
+ * @fn struct_rtcRetention getRtcRetention*(void)
+ * @brief function to get the retention, changes are saved with \ref saveRtcRetention
+ *
+ * @return pointer to retention
+ */
+struct_rtcRetention * getRtcRetention( void )
+{
+  return &rtcRetention;
+}
+
+/**
+ * @fn const void addWakeReasonRtcRetention(uint8_t)
+ * @brief function to add the reason of this wake to the history
+ *
+ * @param wakeReason : \ref struct_wakeupSource as byte
+ */
+const void addWakeReasonRtcRetention( uint8_t wakeReason )
+{
+  rtcRetention.wakeCounter++;
+  rtcRetention.wakeReasons[rtcRetention.wakeCounter % RTC_RETENTION_WAKE_HISTORY] = wakeReason;
+}
+
+/**
+ * @fn const void addAwakeTimeRtcRetention(uint32_t)
+ * @brief function to add the time of this wake to the statistics
+ *
+ * @param awakeTime : ms, time from boot until sleep
+ */
+const void addAwakeTimeRtcRetention( uint32_t awakeTime )
+{
+  rtcRetention.lastAwakeTime = awakeTime;
+
+  if( awakeTime > rtcRetention.maxAwakeTime )
+  {
+    rtcRetention.maxAwakeTime = awakeTime;
+  }
+}
+
+/**
+ * @fn const void addUplinkRtcRetention(uint32_t, int8_t, uint8_t)
+ * @brief function to keep the airtime of the last uplink, readable after the wake
+ *
+ * @param timeOnAir : ms, airtime of the uplink as calculated by the MAC
+ * @param datarate : datarate of the uplink
+ * @param size : bytes, application payload of the uplink
+ */
+const void addUplinkRtcRetention( uint32_t timeOnAir, int8_t datarate, uint8_t size )
+{
+  rtcRetention.lastTxTimeOnAir = timeOnAir > UINT16_MAX ? UINT16_MAX : timeOnAir;
+  rtcRetention.lastTxDatarate = datarate;
+  rtcRetention.lastTxSize = size;
+}
@@ -0,0 +1,50 @@
+/**
+  ******************************************************************************
+  * @file           : RTC_retention.h
+  * @brief          : Header for RTC_retention.c file.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  ******************************************************************************
+  */
+#ifndef RTC_AM1805_RTC_RETENTION_H_
+#define RTC_AM1805_RTC_RETENTION_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define RTC_RETENTION_ADDRESS           0x00  //RAM address in the AM1805, first page of 64 bytes
+#define RTC_RETENTION_MAX_SIZE          64
+#define RTC_RETENTION_WAKE_HISTORY      8     //number of wake reasons in the history
+
+/**
+ * State retained in the RAM of the AM1805 between the wakes, the RTC supply keeps the RAM powered while the processor is off.
+ * The RAM is lost with the RTC supply, FRAM keeps the values that are needed after the loss.
+ */
+typedef struct __attribute__((packed))
+{
+  uint16_t crc16;               //CRC over all fields after this field
+  uint8_t protocolId;           //\ref RTC_RETENTION_PROTOCOL_ID
+  uint8_t length;               //size of this struct, other size = other layout
+  uint8_t currentSensorModuleIndex; //index of the next sensor module 0-5
+  uint8_t numberOfSensorModule; //number of the next module relative to the active modules
+  uint16_t loraInterval;        //minutes, interval of the settings to check the wake before the settings are read, 0 = unknown, was spare
+  uint32_t wakeCounter;         //number of wakes since the RAM is valid
+  uint8_t wakeReasons[RTC_RETENTION_WAKE_HISTORY]; //\ref struct_wakeupSource of the latest wakes, latest at wakeCounter % RTC_RETENTION_WAKE_HISTORY
+  uint32_t lastAwakeTime;       //ms, time of the last wake from boot until sleep
+  uint32_t maxAwakeTime;        //ms, longest wake
+  uint32_t pendingDiagnosticBits; //diagnostic bits of wakes without FRAM write, added to FRAM at the next write
+  uint16_t lastTxTimeOnAir;     //ms, airtime of the last uplink, 0 = no uplink
+  uint8_t lastTxDatarate;       //datarate of the last uplink
+  uint8_t lastTxSize;           //bytes, application payload requested for the last uplink
+}struct_rtcRetention;
+
+const int8_t restoreRtcRetention( void );
+const void saveRtcRetention( void );
+const bool isRtcRetentionValid( void );
+struct_rtcRetention * getRtcRetention( void );
+const void addWakeReasonRtcRetention( uint8_t wakeReason );
+const void addAwakeTimeRtcRetention( uint32_t awakeTime );
+const void addUplinkRtcRetention( uint32_t timeOnAir, int8_t datarate, uint8_t size );
+
+#endif /* RTC_AM1805_RTC_RETENTION_H_ */
@@ -1344,6 +1344,50 @@ void am1805_ram_write(uint8_t ui8Address, uint8_t ui8Data)
     am1805_reg_write((ui8Address & 0x3F) | 0x40, ui8Data);
 }
 
+/**
+ * @brief Read a block from the local AM1805 RAM.
+ *
+ * @param ui8Address - RTC RAM address, the block must be in one 64 byte page of the RAM.
+ * @param pui8Values - byte-packed array where the read data will go.
+ * @param ui8NumBytes - number of bytes to read.
+ *
+ * This function reads a block from the local AM1805 RAM in one I2C transfer.
+ *
+ * @return None
+ */
+void am1805_ram_block_read(uint8_t ui8Address, uint8_t *pui8Values, uint8_t ui8NumBytes)
+{
+    assert_param( (ui8Address & 0x3F) + ui8NumBytes <= 64 );
+
+    // Load the XADDR register.
+    am1805_reg_write(AM1805_EXTENDED_ADDR, am1805_ext_address_get(ui8Address));
+
+    // Read the data.
+    am1805_reg_block_read((ui8Address & 0x3F) | 0x40, pui8Values, ui8NumBytes);
+}
+
+/**
+ * @brief Write a block to the local AM1805 RAM.
+ *
+ * @param ui8Address - RTC RAM address, the block must be in one 64 byte page of the RAM.
+ * @param pui8Values - byte-packed array of data to write.
+ * @param ui8NumBytes - number of bytes to write.
+ *
+ * This function writes a block to the local AM1805 RAM in one I2C transfer.
+ *
+ * @return None
+ */
+void am1805_ram_block_write(uint8_t ui8Address, uint8_t *pui8Values, uint8_t ui8NumBytes)
+{
+    assert_param( (ui8Address & 0x3F) + ui8NumBytes <= 64 );
+
+    // Load the XADDR register.
+    am1805_reg_write(AM1805_EXTENDED_ADDR, am1805_ext_address_get(ui8Address));
+
+    // Write the data.
+    am1805_reg_block_write((ui8Address & 0x3F) | 0x40, pui8Values, ui8NumBytes);
+}
+
 /**
  * @fn void am1805_enable_wdi_ex1_interrupt(void)
  * @brief enable the XT2 interrupt for the WDI input pin.
@@ -231,6 +231,8 @@ void am1805_autocal_set(uint8_t ui8Period);
 uint8_t am1805_ext_address_get(uint8_t ui8Address);
 uint8_t am1805_ram_read(uint8_t ui8Address);
 void am1805_ram_write(uint8_t ui8Address, uint8_t ui8Data);
+void am1805_ram_block_read(uint8_t ui8Address, uint8_t *pui8Values, uint8_t ui8NumBytes);
+void am1805_ram_block_write(uint8_t ui8Address, uint8_t *pui8Values, uint8_t ui8NumBytes);
 void am1805_enable_wdi_ex1_interrupt(void);
 void am1805_disable_wdi_ex1_interrupt(void);
 void am1805_enable_wdi_ex2_interrupt(void);
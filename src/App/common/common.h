@@ -27,6 +27,7 @@ typedef enum {
   BACKUP_REGISTER_STATUS,
   BACKUP_REGISTER_LAST_WAKEUP_TIME,
   BACKUP_REGISTER_PRODUCTIONTEST_STATE,
+  BACKUP_REGISTER_LATEST_MEASUREMENT_PAGE,
 
 } ENUM_backupRegister;
 
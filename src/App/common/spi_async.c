@@ -0,0 +1,288 @@
+/**
+  ******************************************************************************
+  * @addtogroup     : common
+  * @{
+  * @file           : spi_async.c
+  * @brief          : asynchronous SPI transfers with DMA
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  * @}
+  ******************************************************************************
+  */
+#include <string.h>
+#include "main.h"
+#include "utilities_conf.h"
+#include "utilities_def.h"
+#include "stm32_seq.h"
+#include "stm32_timer.h"
+#include "stm32_lpm.h"
+
+#include "app_types.h"
+#include "spi_async.h"
+
+static UTIL_TIMER_Object_t timeoutTimerSpi;
+static SPI_HandleTypeDef *activeSpi = NULL;       //handle of active transfer, NULL = no transfer active
+static spiAsyncCallback activeCallback = NULL;    //callback of active transfer, NULL = transfer is waited on
+static spiAsyncCallback completeCallback = NULL;  //callback to be called by the task
+static volatile int8_t transferResult = 0;
+
+/**
+ * @fn void completeTransfer(int8_t)
+ * @brief helper function to end the active transfer, called from interrupt context.
+ * The waiting function gets an event, a transfer with callback starts the task.
+ *
+ * @param result : 0 = successful, -2 = SPI error, -3 = timeout
+ */
+static void completeTransfer( int8_t result )
+{
+  UTILS_ENTER_CRITICAL_SECTION();
+
+  if( activeSpi == NULL ) //transfer already completed, by DMA or timeout
+  {
+    UTILS_EXIT_CRITICAL_SECTION();
+    return;
+  }
+
+  transferResult = result;
+
+  if( result == -3 )
+  {
+    HAL_SPI_Abort(activeSpi); //stop DMA
+  }
+
+  activeSpi = NULL;
+  completeCallback = activeCallback;
+
+  UTILS_EXIT_CRITICAL_SECTION();
+
+  UTIL_TIMER_Stop(&timeoutTimerSpi);
+  UTIL_LPM_SetStopMode((1 << CFG_LPM_SPI_Id), UTIL_LPM_ENABLE); //stop mode allowed again
+
+  if( completeCallback != NULL )
+  {
+    UTIL_SEQ_SetTask((1 << CFG_SEQ_Task_SpiTransferComplete), CFG_SEQ_Prio_0);
+  }
+  else
+  {
+    UTIL_SEQ_SetEvt(1 << CFG_SEQ_Evt_SpiTransferComplete);
+  }
+}
+
+/**
+ * @fn void onTimeoutTimerSpi(void*)
+ * @brief callback of timeout timer, the transfer is aborted.
+ *
+ * @param context : not used
+ */
+static void onTimeoutTimerSpi( void *context )
+{
+  completeTransfer(-3);
+}
+
+/**
+ * @fn void transferCompleteSpiProcess(void)
+ * @brief task to call the callback of an asynchronous transfer
+ *
+ */
+static void transferCompleteSpiProcess( void )
+{
+  spiAsyncCallback callback = completeCallback;
+
+  completeCallback = NULL;
+
+  if( callback != NULL )
+  {
+    callback(transferResult);
+  }
+}
+
+/**
+ * @fn void init_spiAsync(void)
+ * @brief function to initialize the asynchronous SPI transfers.
+ *
+ */
+void init_spiAsync(void)
+{
+  UTIL_TIMER_Create(&timeoutTimerSpi, SPI_ASYNC_TIMEOUT, UTIL_TIMER_ONESHOT, onTimeoutTimerSpi, NULL); //create timer
+  UTIL_SEQ_RegTask((1 << CFG_SEQ_Task_SpiTransferComplete), UTIL_SEQ_RFU, transferCompleteSpiProcess); //register the task at the scheduler
+}
+
+/**
+ * @fn bool isBusySpiAsync(void)
+ * @brief function to check an asynchronous transfer is active
+ *
+ * @return true = transfer active, false = no transfer active
+ */
+bool isBusySpiAsync(void)
+{
+  return activeSpi != NULL;
+}
+
+/**
+ * @fn int8_t startTransferSpiAsync(SPI_HandleTypeDef*, const uint8_t*, uint8_t*, uint16_t, spiAsyncCallback)
+ * @brief function to start a transfer with DMA, the function returns directly.
+ * The chip select must stay active until the transfer is completed.
+ * With a callback, the callback is called from a sequencer task at completion,
+ * without callback the event CFG_SEQ_Evt_SpiTransferComplete is set.
+ * Stop mode is disabled during the transfer, the CPU can sleep.
+ *
+ * @param hspi : SPI handle
+ * @param txData : data to send, NULL = receive only, 0xFF is send when receiving
+ * @param rxData : buffer for received data, NULL = send only
+ * @param length : number of bytes, must be > 0
+ * @param callback : function called at completion, NULL = no callback
+ * @return 0 = successful, -1 = argument error or transfer busy, -2 = SPI error
+ */
+int8_t startTransferSpiAsync(SPI_HandleTypeDef *hspi, const uint8_t *txData, uint8_t *rxData, uint16_t length, spiAsyncCallback callback)
+{
+  HAL_StatusTypeDef status;
+
+  assert_param( hspi != 0 );
+  assert_param( txData != 0 || rxData != 0 );
+  assert_param( length != 0 );
+
+  if( hspi == NULL || (txData == NULL && rxData == NULL) || length == 0 || activeSpi != NULL )
+  {
+    return -1;
+  }
+
+  activeSpi = hspi;
+  activeCallback = callback;
+  transferResult = 0;
+
+  UTIL_LPM_SetStopMode((1 << CFG_LPM_SPI_Id), UTIL_LPM_DISABLE); //DMA needs clocks of sleep mode
+  UTIL_TIMER_Start(&timeoutTimerSpi);
+
+  if( txData == NULL )
+  {
+    memset(rxData, 0xFF, length); //receive sends the receive buffer
+    status = HAL_SPI_Receive_DMA(hspi, rxData, length);
+  }
+  else if( rxData == NULL )
+  {
+    status = HAL_SPI_Transmit_DMA(hspi, (uint8_t*)txData, length);
+  }
+  else
+  {
+    status = HAL_SPI_TransmitReceive_DMA(hspi, (uint8_t*)txData, rxData, length);
+  }
+
+  if( status != HAL_OK )
+  {
+    UTIL_TIMER_Stop(&timeoutTimerSpi);
+    UTIL_LPM_SetStopMode((1 << CFG_LPM_SPI_Id), UTIL_LPM_ENABLE);
+    activeSpi = NULL;
+    return -2;
+  }
+
+  return 0;
+}
+
+/**
+ * @fn int8_t transferSpiAsync(SPI_HandleTypeDef*, const uint8_t*, uint8_t*, uint32_t)
+ * @brief function to do a transfer and wait until completed, the CPU sleeps in UTIL_SEQ_Idle() during the transfer.
+ * No other sequencer tasks are executed during the wait, see UTIL_SEQ_EvtIdle().
+ * Short transfers are done blocking.
+ *
+ * @param hspi : SPI handle
+ * @param txData : data to send, NULL = receive only, 0xFF is send when receiving
+ * @param rxData : buffer for received data, NULL = send only
+ * @param length : number of bytes
+ * @return 0 = successful, -1 = argument error or transfer busy, -2 = SPI error, -3 = timeout
+ */
+int8_t transferSpiAsync(SPI_HandleTypeDef *hspi, const uint8_t *txData, uint8_t *rxData, uint32_t length)
+{
+  HAL_StatusTypeDef status;
+  uint16_t size;
+  int8_t result;
+
+  while( length > 0 )
+  {
+    size = length > UINT16_MAX ? UINT16_MAX : length; //HAL size is limited to 16 bits
+
+    if( size < SPI_ASYNC_MIN_LENGTH )
+    {
+      if( txData == NULL )
+      {
+        memset(rxData, 0xFF, size);
+        status = HAL_SPI_TransmitReceive(hspi, rxData, rxData, size, SPI_ASYNC_TIMEOUT);
+      }
+      else if( rxData == NULL )
+      {
+        status = HAL_SPI_Transmit(hspi, (uint8_t*)txData, size, SPI_ASYNC_TIMEOUT);
+      }
+      else
+      {
+        status = HAL_SPI_TransmitReceive(hspi, (uint8_t*)txData, rxData, size, SPI_ASYNC_TIMEOUT);
+      }
+
+      result = status == HAL_OK ? 0 : (status == HAL_TIMEOUT ? -3 : -2);
+    }
+    else
+    {
+      result = startTransferSpiAsync(hspi, txData, rxData, size, NULL);
+
+      if( result == 0 )
+      {
+        UTIL_SEQ_WaitEvt(1 << CFG_SEQ_Evt_SpiTransferComplete);
+        result = transferResult;
+      }
+    }
+
+    if( result != 0 )
+    {
+      return result;
+    }
+
+    length -= size;
+
+    if( txData != NULL )
+    {
+      txData += size;
+    }
+
+    if( rxData != NULL )
+    {
+      rxData += size;
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief override of weak HAL function, transmit with DMA is completed
+ * @param hspi SPI handle
+ */
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+  completeTransfer(0);
+}
+
+/**
+ * @brief override of weak HAL function, receive with DMA is completed
+ * @param hspi SPI handle
+ */
+void HAL_SPI_RxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+  completeTransfer(0);
+}
+
+/**
+ * @brief override of weak HAL function, transmit and receive with DMA is completed
+ * @param hspi SPI handle
+ */
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+  completeTransfer(0);
+}
+
+/**
+ * @brief override of weak HAL function, SPI error during DMA transfer
+ * @param hspi SPI handle
+ */
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi)
+{
+  completeTransfer(-2);
+}
@@ -0,0 +1,29 @@
+/**
+  ******************************************************************************
+  * @file           : spi_async.h
+  * @brief          : Header for spi_async.c file.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  ******************************************************************************
+  */
+#ifndef COMMON_SPI_ASYNC_H_
+#define COMMON_SPI_ASYNC_H_
+
+#include "app_types.h"
+
+#define SPI_ASYNC_MIN_LENGTH    ( 16 )    //transfers shorter then this are done blocking, DMA setup takes longer
+#define SPI_ASYNC_TIMEOUT       ( 100 )   //ms, maximum time of one transfer
+
+/**
+ * @brief callback at end of an asynchronous transfer, called from a sequencer task.
+ * result : 0 = successful, -2 = SPI error, -3 = timeout
+ */
+typedef void (*spiAsyncCallback)(int8_t result);
+
+void init_spiAsync(void);
+int8_t startTransferSpiAsync(SPI_HandleTypeDef *hspi, const uint8_t *txData, uint8_t *rxData, uint16_t length, spiAsyncCallback callback);
+int8_t transferSpiAsync(SPI_HandleTypeDef *hspi, const uint8_t *txData, uint8_t *rxData, uint32_t length);
+bool isBusySpiAsync(void);
+
+#endif /* COMMON_SPI_ASYNC_H_ */
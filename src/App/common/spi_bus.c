@@ -0,0 +1,215 @@
+/**
+  ******************************************************************************
+  * @addtogroup     : common
+  * @{
+  * @file           : spi_bus.c
+  * @brief          : SPI1 bus manager for FRAM, dataflash and SD card
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  * @}
+  ******************************************************************************
+  */
+#include "main.h"
+#include "sys_app.h"
+
+#include "app_types.h"
+#include "spi_bus.h"
+
+extern SPI_HandleTypeDef hspi1;
+#define HSPI_BUS   &hspi1
+
+/**
+ * @brief SPI settings of a device
+ */
+typedef struct
+{
+  uint32_t maximumFrequency;  //Hz, maximum SPI clock of device
+  uint32_t polarity;          //SPI_POLARITY_LOW or SPI_POLARITY_HIGH
+  uint32_t phase;             //SPI_PHASE_1EDGE or SPI_PHASE_2EDGE
+}struct_spiBusProfile;
+
+static const struct_spiBusProfile spiBusProfile[SPI_BUS_NUMBER_OF_DEVICES] =
+{
+  [SPI_BUS_NONE]        = {   400000, SPI_POLARITY_LOW, SPI_PHASE_1EDGE },
+  [SPI_BUS_FRAM]        = { 20000000, SPI_POLARITY_LOW, SPI_PHASE_1EDGE }, //FM25L16B
+  [SPI_BUS_DATAFLASH]   = { 50000000, SPI_POLARITY_LOW, SPI_PHASE_1EDGE }, //AT25QF641B, read array 0x03
+  [SPI_BUS_SDCARD]      = { 25000000, SPI_POLARITY_LOW, SPI_PHASE_1EDGE }, //SD default speed
+  [SPI_BUS_SDCARD_INIT] = {   400000, SPI_POLARITY_LOW, SPI_PHASE_1EDGE }, //SD identification mode
+};
+
+static ENUM_spiBusDevice activeDevice = SPI_BUS_NONE;     //device of current SPI settings
+static ENUM_spiBusDevice deviceStack[SPI_BUS_MAX_NESTING]; //devices of nested acquisitions
+static uint8_t nesting = 0;                                //number of acquisitions
+static uint8_t rejected = 0;                               //number of rejected acquisitions inside the current nesting, their release is skipped
+
+/**
+ * @fn const void setup_io_for_SPI_devices(bool)
+ * @brief weak function to be override in application to enable the supply and I/O of the SPI devices
+ *
+ * @param state : true = enable, false = back to previous state
+ */
+__weak const void setup_io_for_SPI_devices(bool state)
+{
+  UNUSED(state);
+  __NOP();
+}
+
+/**
+ * @fn uint32_t getPrescaler(uint32_t)
+ * @brief helper function to get the lowest prescaler for a maximum SPI clock
+ *
+ * @param maximumFrequency : maximum SPI clock in Hz
+ * @return prescaler bits of CR1
+ */
+static uint32_t getPrescaler( uint32_t maximumFrequency )
+{
+  uint32_t frequency = HAL_RCC_GetPCLK2Freq() / 2;
+  uint32_t prescaler = 0;
+
+  while( frequency > maximumFrequency && prescaler < 7 )
+  {
+    frequency /= 2;
+    prescaler++;
+  }
+
+  return prescaler << SPI_CR1_BR_Pos;
+}
+
+/**
+ * @fn void applyProfile(ENUM_spiBusDevice)
+ * @brief helper function to set the SPI clock and mode of a device, skipped when already active
+ *
+ * @param device : device on the bus
+ */
+static void applyProfile( ENUM_spiBusDevice device )
+{
+  const struct_spiBusProfile *profile = &spiBusProfile[device];
+  SPI_HandleTypeDef *hspi = HSPI_BUS;
+
+  if( device == activeDevice )
+  {
+    return;
+  }
+
+  hspi->Init.BaudRatePrescaler = getPrescaler(profile->maximumFrequency);
+  hspi->Init.CLKPolarity = profile->polarity;
+  hspi->Init.CLKPhase = profile->phase;
+
+  //settings can only be changed with SPI disabled, HAL enables SPI at next transfer
+  __HAL_SPI_DISABLE(hspi);
+  MODIFY_REG(hspi->Instance->CR1, SPI_CR1_BR | SPI_CR1_CPOL | SPI_CR1_CPHA, hspi->Init.BaudRatePrescaler | hspi->Init.CLKPolarity | hspi->Init.CLKPhase);
+
+  activeDevice = device;
+}
+
+/**
+ * @fn int8_t acquireSpiBus(ENUM_spiBusDevice)
+ * @brief function to acquire the SPI bus for a device. The supply and I/O are enabled at the first acquisition,
+ * the SPI settings are only changed when another device was active.
+ * Acquisitions can be nested, a sequence of operations can be done under one acquisition.
+ * Each acquisition must be ended with \ref releaseSpiBus, also when it is rejected. The release of a rejected
+ * acquisition is skipped, so the outer acquisitions stay balanced.
+ *
+ * @param device : device on the bus
+ * @return 0 = successful, -1 = device not valid, -2 = maximum nesting reached
+ */
+int8_t acquireSpiBus(ENUM_spiBusDevice device)
+{
+  assert_param( device > SPI_BUS_NONE && device < SPI_BUS_NUMBER_OF_DEVICES );
+  assert_param( nesting < SPI_BUS_MAX_NESTING );
+
+  if( device <= SPI_BUS_NONE || device >= SPI_BUS_NUMBER_OF_DEVICES )
+  {
+    rejected++;
+    return -1;
+  }
+
+  //nested in a rejected acquisition is rejected too, releases are in reverse order of acquisitions
+  if( nesting >= SPI_BUS_MAX_NESTING || rejected > 0 )
+  {
+    APP_LOG(TS_OFF, VLEVEL_H, "SPI bus: ERROR, maximum nesting reached\r\n");
+    rejected++;
+    return -2;
+  }
+
+  if( nesting == 0 )
+  {
+    setup_io_for_SPI_devices(true);
+  }
+
+  deviceStack[nesting++] = device;
+
+  applyProfile(device);
+
+  return 0;
+}
+
+/**
+ * @fn void releaseSpiBus(void)
+ * @brief function to release the SPI bus acquired by \ref acquireSpiBus.
+ * The settings of the device of a nested acquisition are restored, at the last release the
+ * supply and I/O are back in previous state.
+ *
+ */
+void releaseSpiBus(void)
+{
+  assert_param( nesting > 0 || rejected > 0 );
+
+  //release of a rejected acquisition, the bus stays with the outer acquisition
+  if( rejected > 0 )
+  {
+    rejected--;
+    return;
+  }
+
+  if( nesting == 0 )
+  {
+    return;
+  }
+
+  nesting--;
+
+  if( nesting == 0 )
+  {
+    setup_io_for_SPI_devices(false);
+  }
+  else
+  {
+    applyProfile(deviceStack[nesting - 1]);
+  }
+}
+
+/**
+ * @fn void changeDeviceSpiBus(ENUM_spiBusDevice)
+ * @brief function to change the device of the current acquisition, used to switch between SD initialization and normal speed.
+ *
+ * @param device : device on the bus
+ */
+void changeDeviceSpiBus(ENUM_spiBusDevice device)
+{
+  assert_param( device > SPI_BUS_NONE && device < SPI_BUS_NUMBER_OF_DEVICES );
+
+  if( device <= SPI_BUS_NONE || device >= SPI_BUS_NUMBER_OF_DEVICES )
+  {
+    return;
+  }
+
+  if( nesting > 0 )
+  {
+    deviceStack[nesting - 1] = device;
+  }
+
+  applyProfile(device);
+}
+
+/**
+ * @fn ENUM_spiBusDevice getActiveDeviceSpiBus(void)
+ * @brief function to get the device of the current SPI settings
+ *
+ * @return device
+ */
+ENUM_spiBusDevice getActiveDeviceSpiBus(void)
+{
+  return activeDevice;
+}
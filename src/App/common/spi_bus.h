@@ -0,0 +1,35 @@
+/**
+  ******************************************************************************
+  * @file           : spi_bus.h
+  * @brief          : Header for spi_bus.c file.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  ******************************************************************************
+  */
+#ifndef COMMON_SPI_BUS_H_
+#define COMMON_SPI_BUS_H_
+
+#include "app_types.h"
+
+#define SPI_BUS_MAX_NESTING   ( 4 )   //maximum nested acquisitions of the bus
+
+/**
+ * @brief enumeration of devices on SPI1
+ */
+typedef enum
+{
+  SPI_BUS_NONE = 0,
+  SPI_BUS_FRAM,
+  SPI_BUS_DATAFLASH,
+  SPI_BUS_SDCARD,
+  SPI_BUS_SDCARD_INIT,      //SD card during initialization, slow clock
+  SPI_BUS_NUMBER_OF_DEVICES
+}ENUM_spiBusDevice;
+
+int8_t acquireSpiBus(ENUM_spiBusDevice device);
+void releaseSpiBus(void);
+void changeDeviceSpiBus(ENUM_spiBusDevice device);
+ENUM_spiBusDevice getActiveDeviceSpiBus(void);
+
+#endif /* COMMON_SPI_BUS_H_ */
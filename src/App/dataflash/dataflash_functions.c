@@ -5,11 +5,26 @@
  *      Author: p.kwekkeboom
  */
 
+#include "stm32_timer.h"
+#include "stm32_seq.h"
+#include "utilities_def.h"
+
 #include "spi_driver.h"
 #include "standardflash.h"
 #include "helper_functions.h"
 #include "dataflash_functions.h"
 
+#define STATUS_BUSY_DATAFLASH   ( 1 << 0 )
+#define STATUS_WEL_DATAFLASH    ( 1 << 1 )
+
+#define ERASE_TIMEOUT_4K_DATAFLASH    ( 400 )     //ms, maximum erase time of 4K block
+#define ERASE_TIMEOUT_32K_DATAFLASH   ( 1600 )    //ms, maximum erase time of 32K block
+#define ERASE_TIMEOUT_64K_DATAFLASH   ( 2000 )    //ms, maximum erase time of 64K block
+#define ERASE_TIMEOUT_CHIP_DATAFLASH  ( 100000 )  //ms, maximum erase time of chip
+
+#define DPD_IDLE_TIME_DATAFLASH       ( 100 )     //ms, idle time before deep power-down is entered
+#define DPD_RESUME_DELAY_DATAFLASH    ( 1000 )    //loops of SPI_Delay(), longer than tRES1 after resume from deep power-down
+
 static uint8_t MID[] = {0x1F, 0x88, 0x01};
 static uint8_t dataRead[MAXIMUM_BUFFER_SIZE] = {0};
 
@@ -18,6 +33,17 @@ static uint8_t writePageBuffer[PAGE_SIZE_DATAFLASH];
 static uint8_t readPageBuffer[PAGE_SIZE_DATAFLASH];
 static uint8_t block4kBuffer[BLOCK_4K_SIZE_DATAFLASH];
 
+static bool eraseBusy = false;        //erase started by startBlockErase4kDataflash() is not yet finished
+static bool eraseSuspended = false;   //erase is suspended for a read or program
+
+static UTIL_TIMER_Object_t idleTimerDataflash;
+static bool readActive = false;       //continuous read is active
+static bool deepPowerDown = false;    //dataflash is in deep power-down
+static uint32_t deepPowerDownStart;   //tick at start of deep power-down
+static uint32_t deepPowerDownEnterCount = 0;  //number of times deep power-down is entered
+static uint32_t deepPowerDownExitCount = 0;   //number of times deep power-down is left
+static uint32_t deepPowerDownTime = 0;        //ms, total time in deep power-down
+
 /**
  * @fn const void setup_io_for_dataflash(bool)
  * @brief weak function to be override in application for enable I/O for FRAM operations
@@ -30,6 +56,118 @@ __weak const void setup_io_for_dataflash(bool state)
   __NOP();
 }
 
+/**
+ * @fn const bool get_supply_state_for_dataflash(void)
+ * @brief weak function to be override in application to get the supply state of the dataflash
+ *
+ * @return true = supply is on, false = supply is off
+ */
+__weak const bool get_supply_state_for_dataflash(void)
+{
+  return true;
+}
+
+/**
+ * @fn void enableDataflash(void)
+ * @brief helper function to enable the I/O before a dataflash operation, the dataflash is resumed from deep power-down.
+ *
+ */
+static void enableDataflash( void )
+{
+  UTIL_TIMER_Stop(&idleTimerDataflash);
+
+  //enable io needed for dataflash
+  setup_io_for_dataflash(true);
+
+  if( deepPowerDown )
+  {
+    standardflashResumeFromDPD();
+    SPI_Delay(DPD_RESUME_DELAY_DATAFLASH); //wait tRES1 before next command
+
+    deepPowerDown = false;
+    deepPowerDownExitCount++;
+    deepPowerDownTime += HAL_GetTick() - deepPowerDownStart;
+  }
+}
+
+/**
+ * @fn void disableDataflash(void)
+ * @brief helper function to disable the I/O after a dataflash operation, deep power-down is entered after an idle time.
+ *
+ */
+static void disableDataflash( void )
+{
+  //disable io again
+  setup_io_for_dataflash(false);
+
+  UTIL_TIMER_Start(&idleTimerDataflash);
+}
+
+/**
+ * @fn void onIdleTimerDataflash(void*)
+ * @brief callback of idle timer, deep power-down is entered in the task, not in the interrupt.
+ *
+ * @param context : not used
+ */
+static void onIdleTimerDataflash( void *context )
+{
+  UNUSED(context);
+  UTIL_SEQ_SetTask((1 << CFG_SEQ_Task_DataflashPowerDown), CFG_SEQ_Prio_0);
+}
+
+/**
+ * @fn void powerDownDataflashProcess(void)
+ * @brief task to put the dataflash in deep power-down after the idle time.
+ * Nothing is done when the supply is off, deep power-down is retried later when an erase is busy.
+ *
+ */
+static void powerDownDataflashProcess( void )
+{
+  if( deepPowerDown || readActive || get_supply_state_for_dataflash() == false )
+  {
+    return;
+  }
+
+  if( isEraseBusyDataflash() )
+  {
+    UTIL_TIMER_Start(&idleTimerDataflash); //try again after erase
+    return;
+  }
+
+  //enable io needed for dataflash
+  setup_io_for_dataflash(true);
+
+  standardflashDPD();
+
+  //disable io again
+  setup_io_for_dataflash(false);
+
+  deepPowerDown = true;
+  deepPowerDownStart = HAL_GetTick();
+  deepPowerDownEnterCount++;
+}
+
+/**
+ * @fn void getPowerStatisticsDataflash(uint32_t*, uint32_t*, uint32_t*)
+ * @brief function to get the deep power-down statistics of the dataflash.
+ * The time in deep power-down includes the time the supply was off.
+ *
+ * @param enterCount : number of times deep power-down is entered
+ * @param exitCount : number of times deep power-down is left
+ * @param timeInDeepPowerDown : total time in deep power-down in ms
+ */
+void getPowerStatisticsDataflash( uint32_t * enterCount, uint32_t * exitCount, uint32_t * timeInDeepPowerDown )
+{
+  *enterCount = deepPowerDownEnterCount;
+  *exitCount = deepPowerDownExitCount;
+  *timeInDeepPowerDown = deepPowerDownTime;
+
+  if( deepPowerDown )
+  {
+    *timeInDeepPowerDown += HAL_GetTick() - deepPowerDownStart; //add current period
+  }
+}
+
 /**
  * @fn void standardflashWaitOnReadyWithTimeout_printResult(void)
  * @brief helper function to catch the result.
@@ -46,6 +184,85 @@ void standardflashWaitOnReadyWithTimeout_printResult(void)
 }
 
 
+/**
+ * @fn bool waitReadyDataflash(uint32_t)
+ * @brief helper function to wait until the dataflash is ready, the I/O must be enabled.
+ *
+ * @param timeout : maximum time to wait in ms
+ * @return true = ready, false = timeout
+ */
+static bool waitReadyDataflash( uint32_t timeout )
+{
+  uint32_t start = HAL_GetTick();
+
+  while( standardflashReadSRB1() & STATUS_BUSY_DATAFLASH )
+  {
+    if( HAL_GetTick() - start > timeout )
+    {
+      APP_LOG(TS_OFF, VLEVEL_H, "DATAFLASH: ERROR, timeout at Wait on ready\r\n");
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @fn void suspendErase(void)
+ * @brief helper function to suspend a background erase before a read or program, the I/O must be enabled.
+ * Reading or programming the block which is erased is not possible.
+ *
+ */
+static void suspendErase( void )
+{
+  if( eraseBusy == false )
+  {
+    return;
+  }
+
+  //check erase is already finished
+  if( (standardflashReadSRB1() & STATUS_BUSY_DATAFLASH) == 0 )
+  {
+    eraseBusy = false;
+    return;
+  }
+
+  standardflashEraseProgramSuspend();
+
+  //wait for suspend, takes a few us
+  standardflashWaitOnReadyWithTimeout_printResult();
+
+  eraseSuspended = true;
+}
+
+/**
+ * @fn void resumeErase(void)
+ * @brief helper function to resume a background erase suspended by \ref suspendErase, the I/O must be enabled.
+ *
+ */
+static void resumeErase( void )
+{
+  if( eraseSuspended )
+  {
+    standardflashEraseProgramResume();
+    eraseSuspended = false;
+  }
+}
+
+/**
+ * @fn void finishErase(void)
+ * @brief helper function to wait until a background erase is finished, the I/O must be enabled.
+ *
+ */
+static void finishErase( void )
+{
+  if( eraseBusy )
+  {
+    waitReadyDataflash(ERASE_TIMEOUT_4K_DATAFLASH);
+    eraseBusy = false;
+  }
+}
+
 /**
  * @fn int init_dataflash(void)
  * @brief function to initialize the Dataflash I/O and read the Manufacturer ID
@@ -55,8 +272,12 @@ void standardflashWaitOnReadyWithTimeout_printResult(void)
 int8_t init_dataflash(void)
 {
   int result = 0;
+
+  UTIL_TIMER_Create(&idleTimerDataflash, DPD_IDLE_TIME_DATAFLASH, UTIL_TIMER_ONESHOT, onIdleTimerDataflash, NULL); //create timer
+  UTIL_SEQ_RegTask((1 << CFG_SEQ_Task_DataflashPowerDown), UTIL_SEQ_RFU, powerDownDataflashProcess); //register the task at the scheduler
+
   //enable io needed for dataflash
-  setup_io_for_dataflash(true);
+  enableDataflash();
 
   // initialize the I/O
   SPI_ConfigureSingleSPIIOs();
@@ -77,7 +298,7 @@ int8_t init_dataflash(void)
   }
 
   //disable io needed for dataflash
-  setup_io_for_dataflash(false);
+  disableDataflash();
 
   return result;
 }
@@ -113,7 +334,9 @@ int8_t writePageInDataflash(uint32_t pageAddress, uint8_t * data, uint32_t lengt
   }
 
   //enable io needed for dataflash
-  setup_io_for_dataflash(true);
+  enableDataflash();
+
+  suspendErase();
 
   //set pageBuffer as empty value
   memset(writePageBuffer, 0xff, sizeof(writePageBuffer));
@@ -136,26 +359,67 @@ int8_t writePageInDataflash(uint32_t pageAddress, uint8_t * data, uint32_t lengt
   //wait for ready
   standardflashWaitOnReadyWithTimeout_printResult();
 
+  resumeErase();
+
   //disable io again
-  setup_io_for_dataflash(false);
+  disableDataflash();
 
   return 0;
 }
 
 /**
- * @fn int8_t writeMeasurementInDataflash(uint32_t, uint8_t*, uint32_t)
- * @brief function to write a measurement item "measurementId" in the dataflash ringbuffer.
+ * @fn int8_t programData(uint32_t, uint8_t*, uint32_t)
+ * @brief helper function to program data, the I/O must be enabled.
+ * The dataflash has no program-fail status bit, the write enable latch and the ready timeout are checked instead.
  *
- * @param measurementId number starts from 0 - 4294967296
- * @param data array of data
- * @param length of data array to write, limit to 256 (\ref PAGE_SIZE_DATAFLASH).
- * @return 0 = successful, -1 = data pointer is zero, -2 = length is zero, -3 = length is larger then one page size \ref PAGE_SIZE_DATAFLASH
+ * @param address : start address in dataflash
+ * @param data : pointer to data buffer to write
+ * @param length : length of data to write
+ * @return 0 = successful, -4 = write enable latch not set, -5 = timeout at program
+ */
+static int8_t programData(uint32_t address, uint8_t * data, uint32_t length)
+{
+  //enable write
+  standardflashWriteEnable();
+
+  //check write is enabled, otherwise the program command is ignored
+  if( (standardflashReadSRB1() & STATUS_WEL_DATAFLASH) == 0 )
+  {
+    APP_LOG(TS_OFF, VLEVEL_H, "DATAFLASH: ERROR, write not enabled at 0x%08x\r\n", address);
+    return -4;
+  }
+
+  //write data
+  standardflashBytePageProgram(address, data, length);
+
+  //wait for ready
+  if( standardflashWaitOnReadyWithTimeout() )
+  {
+    APP_LOG(TS_OFF, VLEVEL_H, "DATAFLASH: ERROR, timeout at program 0x%08x\r\n", address);
+    return -5;
+  }
+
+  return 0;
+}
+
+/**
+ * @fn int8_t writeDataInDataflash(uint32_t, uint8_t*, uint32_t)
+ * @brief function to program a part of a page in dataflash, the bytes must be erased (0xFF).
+ * Multiple parts of the same page can be programmed after each other, as long as they don't overlap.
+ * The location is read before programming to check it is erased, see \ref programDataInDataflash to program without check.
+ *
+ * @param address : start address in dataflash
+ * @param data : pointer to data buffer to write, no zero.
+ * @param length : length of data to write, must be > 0 and may not cross a page boundary.
+ * @return 0 = successful, -1 = data pointer is zero, -2 = length is zero, -3 = data crosses a page boundary, -4 = write not enabled, -5 = timeout at program
  */
-int8_t writeMeasurementInDataflash(uint32_t measurementId, uint8_t * data, uint32_t length)
+int8_t writeDataInDataflash(uint32_t address, uint8_t * data, uint32_t length)
 {
+  int8_t result;
+
   assert_param(data != 0 ); //check pointer is not zero
   assert_param(length != 0 ); //check length is not zero
-  assert_param(length <= PAGE_SIZE_DATAFLASH ); //check length is not too large
+  assert_param((address % PAGE_SIZE_DATAFLASH) + length <= PAGE_SIZE_DATAFLASH ); //check data fits in the page
 
   if( data == 0 ) //check pointer is zero
   {
@@ -167,40 +431,84 @@ int8_t writeMeasurementInDataflash(uint32_t measurementId, uint8_t * data, uint3
     return -2;
   }
 
-  if( length > PAGE_SIZE_DATAFLASH ) //check length is larger then 256
+  if( (address % PAGE_SIZE_DATAFLASH) + length > PAGE_SIZE_DATAFLASH ) //check data is not crossing a page
   {
     return -3;
   }
 
-  uint64_t pageAddress = (measurementId * PAGE_SIZE_DATAFLASH);
-  pageAddress %= MEASUREMENT_MEMEORY_SIZE;
+  //enable io needed for dataflash
+  enableDataflash();
+
+  suspendErase();
+
+  //read current content of location
+  standardflashReadArrayLowFreq(address, dataRead, length);
 
-  return writePageInDataflash((uint32_t)pageAddress, data, length);
+  //check if location is empty
+  for( uint32_t i = 0; i < length; i++ )
+  {
+    if( dataRead[i] != 0xFF )
+    {
+      APP_LOG(TS_OFF, VLEVEL_H, "Address %d is not empty.\r\n", address + i);
+      break;
+    }
+  }
+
+  result = programData(address, data, length);
+
+  resumeErase();
+
+  //disable io again
+  disableDataflash();
+
+  return result;
 }
 
 /**
- * @fn bool checkMeasurementMemoryTurnoverAndErase(uint32_t)
- * @brief function to check measurement memory is turnover and next block needs to be erased
+ * @fn int8_t programDataInDataflash(uint32_t, uint8_t*, uint32_t)
+ * @brief function to program a part of a page in dataflash without reading it first, the bytes must be erased (0xFF).
  *
- * @param measurementId
- * @return true if block is erased.
+ * @param address : start address in dataflash
+ * @param data : pointer to data buffer to write, no zero.
+ * @param length : length of data to write, must be > 0 and may not cross a page boundary.
+ * @return 0 = successful, -1 = data pointer is zero, -2 = length is zero, -3 = data crosses a page boundary, -4 = write not enabled, -5 = timeout at program
  */
-bool checkMeasurementMemoryTurnoverAndErase(uint32_t measurementId)
+int8_t programDataInDataflash(uint32_t address, uint8_t * data, uint32_t length)
 {
-  uint64_t pageAddress = (measurementId * PAGE_SIZE_DATAFLASH);
-  pageAddress %= MEASUREMENT_MEMEORY_SIZE;
+  int8_t result;
+
+  assert_param(data != 0 ); //check pointer is not zero
+  assert_param(length != 0 ); //check length is not zero
+  assert_param((address % PAGE_SIZE_DATAFLASH) + length <= PAGE_SIZE_DATAFLASH ); //check data fits in the page
 
-  //check measurementId in turnover
-  if( measurementId >= NUMBER_PAGES_FOR_MEASUREMENTS )
+  if( data == 0 ) //check pointer is zero
   {
-    //check pageAddress is first of new block
-    if( (pageAddress % 0x1000) == 0)
-    {
-      //first erase next block
-      return (blockErase4kDataflash(pageAddress) == 0);
-    }
+    return -1;
   }
-  return false;
+
+  if( length == 0 ) //check length is zero
+  {
+    return -2;
+  }
+
+  if( (address % PAGE_SIZE_DATAFLASH) + length > PAGE_SIZE_DATAFLASH ) //check data is not crossing a page
+  {
+    return -3;
+  }
+
+  //enable io needed for dataflash
+  enableDataflash();
+
+  suspendErase();
+
+  result = programData(address, data, length);
+
+  resumeErase();
+
+  //disable io again
+  disableDataflash();
+
+  return result;
 }
 
 /**
@@ -228,26 +536,58 @@ int8_t readPageFromDataflash(uint32_t pageAddress, uint8_t * data, uint32_t leng
   }
 
   //enable io needed for dataflash
-  setup_io_for_dataflash(true);
+  enableDataflash();
+
+  suspendErase();
 
   standardflashReadArrayLowFreq(pageAddress, data, length);
 
+  resumeErase();
+
   //disable io again
-  setup_io_for_dataflash(false);
+  disableDataflash();
 
   return 0;
 }
 
 /**
- * @fn int8_t readMeasurementFromDataflash(uint32_t, uint8_t*, uint32_t)
- * @brief function to read a measurement from flash
+ * @fn int8_t startReadDataflash(uint32_t)
+ * @brief function to start a continuous read, the I/O stays enabled and the chip selected until \ref stopReadDataflash.
+ * No other dataflash operations are allowed while the read is active.
  *
- * @param measurementId : number of measurement record to write
- * @param data : pointer to data buffer to write
- * @param length : length of data to write, must be > 0
- * @return < 0 is error, 0 is success.
+ * @param address : start address, the read continues over page boundaries
+ * @return 0 = successful, -1 = address out of range.
+ */
+int8_t startReadDataflash(uint32_t address)
+{
+  assert_param(address <= MAX_ADDRESS_OF_DATAFLASH ); //check address is in range
+
+  if( address > MAX_ADDRESS_OF_DATAFLASH ) //check address is out of range
+  {
+    return -1;
+  }
+
+  //enable io needed for dataflash
+  enableDataflash();
+
+  suspendErase();
+
+  standardflashReadArrayStart(address);
+
+  readActive = true;
+
+  return 0;
+}
+
+/**
+ * @fn int8_t continueReadDataflash(uint8_t*, uint32_t)
+ * @brief function to read the next bytes of a continuous read started by \ref startReadDataflash
+ *
+ * @param data : pointer to data buffer, no zero.
+ * @param length : length of data to read, must be > 0
+ * @return 0 = successful, -1 = data pointer is zero, -2 = length is zero.
  */
-int8_t readMeasurementFromDataflash(uint32_t measurementId, uint8_t * data, uint32_t length)
+int8_t continueReadDataflash(uint8_t * data, uint32_t length)
 {
   assert_param(data != 0 ); //check pointer is not zero
   assert_param(length != 0 ); //check length is not zero
@@ -262,10 +602,26 @@ int8_t readMeasurementFromDataflash(uint32_t measurementId, uint8_t * data, uint
     return -2;
   }
 
-  uint64_t pageAddress = (measurementId * PAGE_SIZE_DATAFLASH);
-  pageAddress %= MEASUREMENT_MEMEORY_SIZE;
+  standardflashReadArrayContinue(data, length);
+
+  return 0;
+}
+
+/**
+ * @fn void stopReadDataflash(void)
+ * @brief function to stop a continuous read started by \ref startReadDataflash
+ *
+ */
+void stopReadDataflash(void)
+{
+  standardflashReadArrayStop();
 
-  return readPageFromDataflash(pageAddress, data, length);
+  readActive = false;
+
+  resumeErase();
+
+  //disable io again
+  disableDataflash();
 }
 
 /**
@@ -278,7 +634,10 @@ int8_t readMeasurementFromDataflash(uint32_t measurementId, uint8_t * data, uint
 int8_t blockErase4kDataflash( uint32_t address )
 {
   //enable io needed for dataflash
-  setup_io_for_dataflash(true);
+  enableDataflash();
+
+  //wait on background erase
+  finishErase();
 
   //enable write
   standardflashWriteEnable();
@@ -287,10 +646,87 @@ int8_t blockErase4kDataflash( uint32_t address )
   standardflashBlockErase4K( address );
 
   //wait ready
-  standardflashWaitOnReadyWithTimeout_printResult();
+  waitReadyDataflash(ERASE_TIMEOUT_4K_DATAFLASH);
 
   //disable io again
-  setup_io_for_dataflash(false);
+  disableDataflash();
+
+  return 0;
+}
+
+/**
+ * @fn int8_t startBlockErase4kDataflash(uint32_t)
+ * @brief function to start the erase of a block of 4k, without waiting until it is finished.
+ * Reads and programs of other blocks suspend the erase, the dataflash supply must stay on until \ref finishEraseDataflash.
+ *
+ * @param address of memory in block
+ * @return 0 is successful
+ */
+int8_t startBlockErase4kDataflash( uint32_t address )
+{
+  //enable io needed for dataflash
+  enableDataflash();
+
+  //wait on previous background erase
+  finishErase();
+
+  //enable write
+  standardflashWriteEnable();
+
+  //block erase
+  standardflashBlockErase4K( address );
+
+  eraseBusy = true;
+
+  //disable io again
+  disableDataflash();
+
+  return 0;
+}
+
+/**
+ * @fn bool isEraseBusyDataflash(void)
+ * @brief function to check a background erase started by \ref startBlockErase4kDataflash is busy
+ *
+ * @return true = erase busy, false = no erase busy
+ */
+bool isEraseBusyDataflash( void )
+{
+  if( eraseBusy )
+  {
+    //enable io needed for dataflash
+    setup_io_for_dataflash(true);
+
+    if( (standardflashReadSRB1() & STATUS_BUSY_DATAFLASH) == 0 )
+    {
+      eraseBusy = false;
+    }
+
+    //disable io again
+    setup_io_for_dataflash(false);
+  }
+
+  return eraseBusy;
+}
+
+/**
+ * @fn int8_t finishEraseDataflash(void)
+ * @brief function to wait until a background erase started by \ref startBlockErase4kDataflash is finished
+ *
+ * @return 0 is successful
+ */
+int8_t finishEraseDataflash( void )
+{
+  if( eraseBusy )
+  {
+    //enable io needed for dataflash
+    setup_io_for_dataflash(true);
+
+    finishErase();
+
+    //disable io again
+    setup_io_for_dataflash(false);
+  }
 
   return 0;
 }
@@ -305,7 +741,10 @@ int8_t blockErase4kDataflash( uint32_t address )
 int8_t blockErase32kDataflash( uint32_t address )
 {
   //enable io needed for dataflash
-  setup_io_for_dataflash(true);
+  enableDataflash();
+
+  //wait on background erase
+  finishErase();
 
   //enable write
   standardflashWriteEnable();
@@ -314,10 +753,10 @@ int8_t blockErase32kDataflash( uint32_t address )
   standardflashBlockErase32K( address );
 
   //wait ready
-  standardflashWaitOnReadyWithTimeout_printResult();
+  waitReadyDataflash(ERASE_TIMEOUT_32K_DATAFLASH);
 
   //disable io again
-  setup_io_for_dataflash(false);
+  disableDataflash();
 
   return 0;
 }
@@ -332,7 +771,10 @@ int8_t blockErase32kDataflash( uint32_t address )
 int8_t blockErase64kDataflash( uint32_t address )
 {
   //enable io needed for dataflash
-  setup_io_for_dataflash(true);
+  enableDataflash();
+
+  //wait on background erase
+  finishErase();
 
   //enable write
   standardflashWriteEnable();
@@ -341,10 +783,10 @@ int8_t blockErase64kDataflash( uint32_t address )
   standardflashBlockErase64K( address );
 
   //wait ready
-  standardflashWaitOnReadyWithTimeout_printResult();
+  waitReadyDataflash(ERASE_TIMEOUT_64K_DATAFLASH);
 
   //disable io again
-  setup_io_for_dataflash(false);
+  disableDataflash();
 
   return 0;
 }
@@ -358,7 +800,10 @@ int8_t blockErase64kDataflash( uint32_t address )
 const int8_t chipEraseDataflash(void)
 {
   //enable io needed for dataflash
-  setup_io_for_dataflash(true);
+  enableDataflash();
+
+  //wait on background erase
+  finishErase();
 
   //enable write
   standardflashWriteEnable();
@@ -367,32 +812,14 @@ const int8_t chipEraseDataflash(void)
   standardflashChipErase1();
 
   //wait ready
-  standardflashWaitOnReadyWithTimeout_printResult();
+  waitReadyDataflash(ERASE_TIMEOUT_CHIP_DATAFLASH);
 
   //disable io again
-  setup_io_for_dataflash(false);
-
-  return 0;
-}
-
-/**
- * @fn int8_t clearMeasurementsInDataflash(uint32_t)
- * @brief function to clear a 4k block of the measurementId
- *
- * @param measurementId sequence number of measurement.
- * @return 0 is successful
- */
-int8_t clearMeasurementsInDataflash(uint32_t measurementId)
-{
-  uint64_t pageAddress = (measurementId * PAGE_SIZE_DATAFLASH);
-  pageAddress %= MEASUREMENT_MEMEORY_SIZE;
-
-  blockErase4kDataflash((uint32_t)pageAddress);
+  disableDataflash();
 
   return 0;
 }
 
-
 /**
  * @fn int8_t testCompleteDataflash(bool)
  * @brief test function to verify the whole dataflash.
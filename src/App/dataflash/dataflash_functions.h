@@ -23,21 +23,36 @@
 #define NUMBER_OF_PAGES_IN_64K_BLOCK_DATAFLASH  ( BLOCK_64K_SIZE_DATAFLASH / PAGE_SIZE_DATAFLASH )
 
 #define MAX_ADDRESS_OF_DATAFLASH      ( 0x7FFFFFUL )
-#define NUMBER_PAGES_FOR_MEASUREMENTS      ( NUMBER_PAGES_DATAFLASH - NUMBER_OF_PAGES_IN_32K_BLOCK_DATAFLASH )
-#define NUMBER_OF_RESERVED_PAGES      ( NUMBER_PAGES_DATAFLASH - NUMBER_PAGES_FOR_MEASUREMENTS )
+#define NUMBER_OF_RESERVED_PAGES      ( NUMBER_OF_PAGES_IN_32K_BLOCK_DATAFLASH )
+#define NUMBER_PAGES_FOR_MEASUREMENTS      ( NUMBER_PAGES_DATAFLASH - NUMBER_OF_RESERVED_PAGES )
 #define MEASUREMENT_MEMEORY_SIZE              ( PAGE_SIZE_DATAFLASH * NUMBER_PAGES_FOR_MEASUREMENTS )
+#define RESERVED_MEMORY_ADDRESS       ( MEASUREMENT_MEMEORY_SIZE ) //last 32K of the dataflash
 #define RESERVED_MEMORY               ( PAGE_SIZE_DATAFLASH * NUMBER_OF_RESERVED_PAGES )
 
+/*
+ * Reserved memory: 20K key-value store, 8K rollup log and the 4K wear journal of the measurement log in the last block.
+ * The measurement ring is the same with and without rollups, rollups can be enabled at runtime.
+ */
+#define ROLLUP_MEMORY_ADDRESS         ( RESERVED_MEMORY_ADDRESS + 5 * BLOCK_4K_SIZE_DATAFLASH )
+#define ROLLUP_MEMORY                 ( 2 * BLOCK_4K_SIZE_DATAFLASH ) //128 rollups, at least 64 are kept when the next block is erased
+
 int8_t init_dataflash(void);
-int8_t writeMeasurementInDataflash(uint32_t logId, uint8_t * data, uint32_t length);
-bool checkMeasurementMemoryTurnoverAndErase(uint32_t logId);
+int8_t writePageInDataflash(uint32_t pageAddress, uint8_t * data, uint32_t length);
+int8_t writeDataInDataflash(uint32_t address, uint8_t * data, uint32_t length);
+int8_t programDataInDataflash(uint32_t address, uint8_t * data, uint32_t length);
 int8_t readPageFromDataflash(uint32_t pageAddress, uint8_t * data, uint32_t length);
-int8_t readMeasurementFromDataflash(uint32_t logId, uint8_t * data, uint32_t length);
+int8_t startReadDataflash(uint32_t address);
+int8_t continueReadDataflash(uint8_t * data, uint32_t length);
+void stopReadDataflash(void);
 int8_t blockErase4kDataflash( uint32_t address );
+int8_t startBlockErase4kDataflash( uint32_t address );
+bool isEraseBusyDataflash( void );
+int8_t finishEraseDataflash( void );
 int8_t blockErase32kDataflash( uint32_t address );
 int8_t blockErase64kDataflash( uint32_t address );
 const int8_t chipEraseDataflash(void);
 int8_t testCompleteDataflash(bool restoreOrinalData );
+void getPowerStatisticsDataflash( uint32_t * enterCount, uint32_t * exitCount, uint32_t * timeInDeepPowerDown );
 const int8_t testDataflash(uint8_t test, uint32_t * status);
 
 #endif /* DATAFLASH_DATAFLASH_FUNCTIONS_H_ */
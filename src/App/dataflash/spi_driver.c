@@ -39,6 +39,9 @@
  * @brief   Definitions of spi_driver functions.
  */
 #include "spi_driver.h"
+#ifdef USE_HAL_SPI
+#include "../common/spi_async.h"
+#endif
 
 void SPI_PinInit(uint32_t port, uint32_t pin, enum directionIO direction)
 {
@@ -406,12 +409,11 @@ uint8_t SPI_QuadReceiveByte()
 #endif
 
 #ifdef USE_HAL_SPI
-void SPI_Exchange(uint8_t *txBuffer,
+void SPI_ExchangeStart(uint8_t *txBuffer,
 				  uint32_t txNumBytes,
-				  uint8_t *rxBuffer,
-				  uint32_t rxNumBytes,
 				  uint32_t dummyNumBytes)
 {
+	uint8_t dummy = 0;
 
 	// Begin data exchange
 	// Select chip
@@ -421,18 +423,25 @@ void SPI_Exchange(uint8_t *txBuffer,
 	dataflash_EnableChipSelect();
 #endif
 
-	// Send each byte
+	// Send each byte, long transfers with DMA
 	if(txNumBytes > 0)
-	  HAL_SPI_Transmit(HSPI_DATAFLASH, txBuffer, txNumBytes, 100);
+	  transferSpiAsync(HSPI_DATAFLASH, txBuffer, NULL, txNumBytes);
 
-	// Receive each byte
-	if(dummyNumBytes > 0)
-	  HAL_SPI_Receive(HSPI_DATAFLASH, NULL, dummyNumBytes, 100);
+	// Send dummy bytes, clock is only generated with a valid buffer
+	for(uint32_t i = 0; i < dummyNumBytes; i++)
+	  HAL_SPI_Transmit(HSPI_DATAFLASH, &dummy, 1, 100);
+}
 
-	// Receive each byte
+void SPI_ExchangeContinue(uint8_t *rxBuffer,
+				  uint32_t rxNumBytes)
+{
+	// Receive each byte, long transfers with DMA
 	if(rxNumBytes > 0)
-	  HAL_SPI_Receive(HSPI_DATAFLASH, rxBuffer, rxNumBytes, 100);
+	  transferSpiAsync(HSPI_DATAFLASH, NULL, rxBuffer, rxNumBytes);
+}
 
+void SPI_ExchangeStop(void)
+{
 	// End data exchange
 	// Deselect chip
 #ifndef USE_CS_ON_IO_EXPANDER
@@ -440,7 +449,17 @@ void SPI_Exchange(uint8_t *txBuffer,
 #else
 	dataflash_DisableChipSelect();
 #endif
+}
 
+void SPI_Exchange(uint8_t *txBuffer,
+				  uint32_t txNumBytes,
+				  uint8_t *rxBuffer,
+				  uint32_t rxNumBytes,
+				  uint32_t dummyNumBytes)
+{
+	SPI_ExchangeStart(txBuffer, txNumBytes, dummyNumBytes);
+	SPI_ExchangeContinue(rxBuffer, rxNumBytes);
+	SPI_ExchangeStop();
 }
 #else
 void SPI_Exchange(uint8_t *txBuffer,
@@ -472,6 +491,43 @@ void SPI_Exchange(uint8_t *txBuffer,
   // Deselect chip
   SPI_PinSet(SPI_CSB_PORT, SPI_CSB_PIN);
 }
+
+void SPI_ExchangeStart(uint8_t *txBuffer,
+          uint32_t txNumBytes,
+          uint32_t dummyNumBytes)
+{
+  uint32_t i = 0;
+  // Begin data exchange
+  // Set clock to low
+  SPI_PinClear(SPI_SCK_PORT, SPI_SCK_PIN);
+  // Select chip
+  SPI_PinClear(SPI_CSB_PORT, SPI_CSB_PIN);
+
+  // Send each byte
+  for(i = 0; i < txNumBytes; i = i+1)
+    SPI_SendByte(txBuffer[i]);
+  // Receive each byte
+  for(i = 0; i < dummyNumBytes; i = i+1)
+    SPI_ReceiveByte();
+}
+
+void SPI_ExchangeContinue(uint8_t *rxBuffer,
+          uint32_t rxNumBytes)
+{
+  uint32_t i = 0;
+  // Receive each byte
+  for(i = 0; i < rxNumBytes; i = i+1)
+    rxBuffer[i] = SPI_ReceiveByte();
+}
+
+void SPI_ExchangeStop(void)
+{
+  // End data exchange
+  // Set clock to low
+  SPI_PinClear(SPI_SCK_PORT, SPI_SCK_PIN);
+  // Deselect chip
+  SPI_PinSet(SPI_CSB_PORT, SPI_CSB_PIN);
+}
 #endif
 
 void SPI_DualExchange(uint8_t standardSPINumBytes,
@@ -183,6 +183,41 @@ void SPI_Exchange(uint8_t *txBuffer,
 				  uint32_t rxNumBytes,
 				  uint32_t dummyNumBytes);
 
+/*!
+ * @brief Selects the chip and sends the opcode, address and dummy bytes, the chip stays selected.
+ * Used for continuous reads, data is received with SPI_ExchangeContinue() and the
+ * exchange is ended with SPI_ExchangeStop().
+ *
+ * @param *txBuffer A pointer to the tx byte array to be transmitted.
+ * Should have tx_bytes elements.
+ * @param txNumBytes The number of bytes to be transmitted.
+ * @param dummyNumBytes The number of dummy bytes to be sent.
+ *
+ * @retval void
+ */
+void SPI_ExchangeStart(uint8_t *txBuffer,
+				  uint32_t txNumBytes,
+				  uint32_t dummyNumBytes);
+
+/*!
+ * @brief Receives bytes of an exchange started by SPI_ExchangeStart().
+ *
+ * @param *rxBuffer A pointer to the rx byte array where received data will be stored.
+ * Should have rx_bytes elements.
+ * @param rxNumBytes The number of bytes to be received.
+ *
+ * @retval void
+ */
+void SPI_ExchangeContinue(uint8_t *rxBuffer,
+				  uint32_t rxNumBytes);
+
+/*!
+ * @brief Deselects the chip, ends an exchange started by SPI_ExchangeStart().
+ *
+ * @retval void
+ */
+void SPI_ExchangeStop(void);
+
 /*!
  * @brief Sends and receives bytes based on the function parameters.
  * MOSI is used for the opcode and address, then MISO or MOSI are switched for transmission
@@ -243,6 +243,19 @@ void standardflashReadArrayHighFreq(uint32_t address, uint8_t *rxBuffer, uint32_
 		printSPIExchange(txStandardflashInternalBuffer, 4, rxBuffer, rxNumBytes);
 	}
 }
+void standardflashReadArrayStart(uint32_t address)
+{
+	load4BytesToTxBuffer(txStandardflashInternalBuffer, CMD_STANDARDFLASH_READ_ARRAY_HF, address);
+	SPI_ExchangeStart(txStandardflashInternalBuffer, 4, 1);
+}
+void standardflashReadArrayContinue(uint8_t *rxBuffer, uint32_t rxNumBytes)
+{
+	SPI_ExchangeContinue(rxBuffer, rxNumBytes);
+}
+void standardflashReadArrayStop()
+{
+	SPI_ExchangeStop();
+}
 
 void standardflashBytePageProgram(uint32_t address, uint8_t *txBuffer, uint32_t txNumBytes)
 {
@@ -175,6 +175,36 @@ void standardflashReadArrayLowFreq(uint32_t address, uint8_t *rxBuffer, uint32_t
  */
 void standardflashReadArrayHighFreq(uint32_t address, uint8_t *rxBuffer, uint32_t rxNumBytes);
 
+/*!
+ * @brief OPCODE: 0x0B <br>
+ * Starts a continuous read from location 'address', the chip stays selected.
+ * The internal address wraps past page boundaries, data is read with
+ * standardflashReadArrayContinue() until standardflashReadArrayStop() is called.
+ *
+ * @param address 3 byte address starting from which the data in memory will be read.
+ *
+ * @retval void
+ */
+void standardflashReadArrayStart(uint32_t address);
+
+/*!
+ * @brief Reads the next rxNumBytes of a continuous read started by standardflashReadArrayStart().
+ *
+ * @param rxBuffer Pointer to the byte array in which the read data will be stored.
+ * Must have at least rxNumBytes elements.
+ * @param rxNumBytes Number of bytes to be read from the memory.
+ *
+ * @retval void
+ */
+void standardflashReadArrayContinue(uint8_t *rxBuffer, uint32_t rxNumBytes);
+
+/*!
+ * @brief Ends a continuous read started by standardflashReadArrayStart().
+ *
+ * @retval void
+ */
+void standardflashReadArrayStop();
+
 /*!
  * @brief OPCODE: 0x02 <br>
  * Programs 'txNumBytes' bytes of data starting at the address indicated by address.
@@ -0,0 +1,672 @@
+/**
+  ******************************************************************************
+  * @addtogroup     : App
+  * @{
+  * @file           : keyValueStore.c
+  * @brief          : append-only key-value store in the reserved memory of the dataflash.
+  * The store is a ring of 4K segments, a changed value is appended to the head segment.
+  * The index in RAM with the address of the latest record of each key is rebuilt at the
+  * first access after a reset, so a wake without access does not read the dataflash.
+  * When a new segment is opened and too many segments are used, the live records of
+  * the oldest segment are copied to the new segment and the oldest segment is erased.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  * @}
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "main.h"
+#include "sys_app.h"
+#include "common/crc16.h"
+#include "common/common.h"
+#include "dataflash/dataflash_functions.h"
+#include "keyValueStore.h"
+
+#define KEY_VALUE_NONE              UINT32_MAX //no record or segment
+#define KEY_VALUE_SEGMENT_SIZE      BLOCK_4K_SIZE_DATAFLASH
+#define KEY_VALUE_SEGMENT_FORMAT    0x4B //segment contains key-value records
+#define KEY_VALUE_ERASED            0xFF //no record, erased part of the segment
+#define KEY_VALUE_MAX_USED_SEGMENTS 3    //segments read to rebuild the index, a compaction interrupted by power loss leaves free segments
+#define KEY_VALUE_RECORD_MAX_SIZE   ( sizeof(struct_keyValueRecordHeader) + KEY_VALUE_MAX_LENGTH )
+
+/**
+ * @brief header at the start of each segment, the segment with the highest sequence is the head
+ */
+typedef struct __attribute__((packed))
+{
+  uint16_t crc16;     //CRC of the header, without this field
+  uint8_t format;     //KEY_VALUE_SEGMENT_FORMAT
+  uint8_t spare;
+  uint32_t sequence;  //incremented for each opened segment
+}struct_keyValueSegmentHeader;
+
+/**
+ * @brief header of each record, followed by the value. A record without value deletes the key.
+ */
+typedef struct __attribute__((packed))
+{
+  uint16_t crc16;     //CRC of key, length and value, programmed after them to commit the record
+  uint8_t key;        //ENUM_keyValueKey
+  uint8_t length;     //length of the value, 0 = key is deleted
+}struct_keyValueRecordHeader;
+
+/**
+ * @brief index in RAM of the latest record of a key
+ */
+typedef struct
+{
+  uint32_t address;   //address of the record, KEY_VALUE_NONE = key not available
+  uint8_t length;     //length of the value
+}struct_keyValueIndex;
+
+static_assert (KEY_VALUE_STORE_SIZE % KEY_VALUE_SEGMENT_SIZE == 0, "Size key-value store must be a multiple of the segment size");
+static_assert (KEY_VALUE_NUMBER_OF_SEGMENTS > KEY_VALUE_MAX_USED_SEGMENTS + 1, "Key-value store has too few segments");
+static_assert ((KEY_VALUE_NUMBER_OF_KEYS + 1) * KEY_VALUE_RECORD_MAX_SIZE <= KEY_VALUE_SEGMENT_SIZE - sizeof(struct_keyValueSegmentHeader), "Live records of all keys must fit in one segment");
+static_assert (KEY_VALUE_MAX_LENGTH <= UINT8_MAX, "Length of key-value record is 8 bits");
+
+static struct_keyValueIndex keyValueIndex[KEY_VALUE_NUMBER_OF_KEYS];
+static bool indexValid = false;
+
+static bool segmentUsed[KEY_VALUE_NUMBER_OF_SEGMENTS];
+static uint32_t segmentSequence[KEY_VALUE_NUMBER_OF_SEGMENTS];
+static uint32_t headSegment = KEY_VALUE_NONE;
+static uint16_t headOffset = KEY_VALUE_SEGMENT_SIZE;
+
+static uint8_t recordBuffer[KEY_VALUE_RECORD_MAX_SIZE];
+
+/**
+ * @fn uint32_t getSegmentAddress(uint32_t)
+ * @brief helper function to get the dataflash address of a segment
+ *
+ * @param segment : index of segment
+ * @return address
+ */
+static uint32_t getSegmentAddress( uint32_t segment )
+{
+  return KEY_VALUE_STORE_ADDRESS + segment * KEY_VALUE_SEGMENT_SIZE;
+}
+
+/**
+ * @fn uint16_t calculateRecordCrc(const uint8_t*)
+ * @brief helper function to calculate the CRC of the record in a buffer.
+ * The CRC is never erased, a record of which the CRC is not programmed is not committed.
+ *
+ * @param record : record with header and value
+ * @return CRC
+ */
+static uint16_t calculateRecordCrc( const uint8_t * record )
+{
+  const struct_keyValueRecordHeader * header = (const struct_keyValueRecordHeader *)record;
+  uint16_t crc = calculateCRC_CCITT((uint8_t*)&header->key, sizeof(struct_keyValueRecordHeader) - sizeof(header->crc16) + header->length);
+
+  return crc == 0xFFFF ? 0x0000 : crc;
+}
+
+/**
+ * @fn bool checkErased(const uint8_t*, uint32_t)
+ * @brief helper function to check data is erased
+ *
+ * @param data : data
+ * @param length : number of bytes
+ * @return true = all bytes erased
+ */
+static bool checkErased( const uint8_t * data, uint32_t length )
+{
+  for( uint32_t i = 0; i < length; i++ )
+  {
+    if( data[i] != KEY_VALUE_ERASED )
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @fn int8_t programData(uint32_t, const uint8_t*, uint32_t)
+ * @brief helper function to program data in dataflash, the data is split at page boundaries.
+ *
+ * @param address : dataflash address
+ * @param data : data to program
+ * @param length : number of bytes
+ * @return 0 = successful, < 0 = program failed
+ */
+static int8_t programData( uint32_t address, const uint8_t * data, uint32_t length )
+{
+  while( length > 0 )
+  {
+    uint32_t pageLength = PAGE_SIZE_DATAFLASH - address % PAGE_SIZE_DATAFLASH;
+
+    if( pageLength > length )
+    {
+      pageLength = length;
+    }
+
+    if( programDataInDataflash(address, (uint8_t*)data, pageLength) != 0 )
+    {
+      return -1;
+    }
+
+    address += pageLength;
+    data += pageLength;
+    length -= pageLength;
+  }
+
+  return 0;
+}
+
+/**
+ * @fn bool readSegmentHeader(uint32_t, uint32_t*)
+ * @brief function to read the header of a segment
+ *
+ * @param segment : index of segment
+ * @param sequence : destination of sequence of the segment
+ * @return true = segment is used, false = segment is free
+ */
+static bool readSegmentHeader( uint32_t segment, uint32_t * sequence )
+{
+  struct_keyValueSegmentHeader header;
+
+  readPageFromDataflash(getSegmentAddress(segment), (uint8_t*)&header, sizeof(header));
+
+  if( header.format != KEY_VALUE_SEGMENT_FORMAT ||
+      header.crc16 != calculateCRC_CCITT((uint8_t*)&header.format, sizeof(header) - sizeof(header.crc16)) )
+  {
+    return false;
+  }
+
+  *sequence = header.sequence;
+
+  return true;
+}
+
+/**
+ * @fn uint16_t scanSegment(uint32_t)
+ * @brief function to add the records of a segment to the index, the records are read with one continuous read.
+ * A record interrupted by power loss ends the segment, the rest of the segment is not used.
+ *
+ * @param segment : index of segment
+ * @return offset of the first erased byte, \ref KEY_VALUE_SEGMENT_SIZE = segment full or closed
+ */
+static uint16_t scanSegment( uint32_t segment )
+{
+  struct_keyValueRecordHeader * record = (struct_keyValueRecordHeader *)recordBuffer;
+  uint32_t address = getSegmentAddress(segment);
+  uint16_t offset = sizeof(struct_keyValueSegmentHeader);
+
+  startReadDataflash(address + offset);
+
+  while( offset + sizeof(struct_keyValueRecordHeader) <= KEY_VALUE_SEGMENT_SIZE )
+  {
+    continueReadDataflash(recordBuffer, sizeof(struct_keyValueRecordHeader));
+
+    if( checkErased(recordBuffer, sizeof(struct_keyValueRecordHeader)) )
+    {
+      break; //end of records
+    }
+
+    if( record->key >= KEY_VALUE_NUMBER_OF_KEYS || record->length > KEY_VALUE_MAX_LENGTH ||
+        offset + sizeof(struct_keyValueRecordHeader) + record->length > KEY_VALUE_SEGMENT_SIZE )
+    {
+      offset = KEY_VALUE_SEGMENT_SIZE;
+      break;
+    }
+
+    if( record->length > 0 )
+    {
+      continueReadDataflash(&recordBuffer[sizeof(struct_keyValueRecordHeader)], record->length);
+    }
+
+    if( record->crc16 != calculateRecordCrc(recordBuffer) )
+    {
+      APP_LOG(TS_OFF, VLEVEL_H, "KEY VALUE: record at 0x%08x not committed, segment closed\r\n", address + offset);
+      offset = KEY_VALUE_SEGMENT_SIZE;
+      break;
+    }
+
+    keyValueIndex[record->key].address = record->length ? address + offset : KEY_VALUE_NONE;
+    keyValueIndex[record->key].length = record->length;
+
+    offset += sizeof(struct_keyValueRecordHeader) + record->length;
+  }
+
+  stopReadDataflash();
+
+  return offset < KEY_VALUE_SEGMENT_SIZE - sizeof(struct_keyValueRecordHeader) ? offset : KEY_VALUE_SEGMENT_SIZE;
+}
+
+/**
+ * @fn void rebuildIndex(void)
+ * @brief function to rebuild the index in RAM, the segments are scanned from the oldest to the newest.
+ *
+ */
+static void rebuildIndex( void )
+{
+  uint32_t previousSequence = 0;
+  uint32_t length;
+
+  for( int i = 0; i < KEY_VALUE_NUMBER_OF_KEYS; i++ )
+  {
+    keyValueIndex[i].address = KEY_VALUE_NONE;
+    keyValueIndex[i].length = 0;
+  }
+
+  for( uint32_t segment = 0; segment < KEY_VALUE_NUMBER_OF_SEGMENTS; segment++ )
+  {
+    segmentUsed[segment] = readSegmentHeader(segment, &segmentSequence[segment]);
+  }
+
+  headSegment = KEY_VALUE_NONE;
+  headOffset = KEY_VALUE_SEGMENT_SIZE;
+
+  for( uint32_t i = 0; i < KEY_VALUE_NUMBER_OF_SEGMENTS; i++ )
+  {
+    uint32_t next = KEY_VALUE_NONE;
+
+    //next segment in sequence order
+    for( uint32_t segment = 0; segment < KEY_VALUE_NUMBER_OF_SEGMENTS; segment++ )
+    {
+      if( segmentUsed[segment] && (headSegment == KEY_VALUE_NONE || segmentSequence[segment] > previousSequence) &&
+          (next == KEY_VALUE_NONE || segmentSequence[segment] < segmentSequence[next]) )
+      {
+        next = segment;
+      }
+    }
+
+    if( next == KEY_VALUE_NONE )
+    {
+      break;
+    }
+
+    headSegment = next;
+    headOffset = scanSegment(next);
+    previousSequence = segmentSequence[next];
+  }
+
+  //bytes after the last record are written by an interrupted write, the rest of the head segment is not used
+  if( headSegment != KEY_VALUE_NONE && headOffset < KEY_VALUE_SEGMENT_SIZE )
+  {
+    length = KEY_VALUE_SEGMENT_SIZE - headOffset;
+
+    if( length > sizeof(recordBuffer) )
+    {
+      length = sizeof(recordBuffer);
+    }
+
+    readPageFromDataflash(getSegmentAddress(headSegment) + headOffset, recordBuffer, length);
+
+    if( checkErased(recordBuffer, length) == false )
+    {
+      APP_LOG(TS_OFF, VLEVEL_H, "KEY VALUE: segment %u closed after offset %u\r\n", headSegment, headOffset);
+      headOffset = KEY_VALUE_SEGMENT_SIZE;
+    }
+  }
+
+  indexValid = true;
+
+  APP_LOG(TS_OFF, VLEVEL_H, "KEY VALUE: index rebuilt, head segment %d, offset %u\r\n", (int)headSegment, headOffset);
+}
+
+/**
+ * @fn int8_t readRecord(ENUM_keyValueKey)
+ * @brief function to read the latest record of a key in the record buffer
+ *
+ * @param key : key
+ * @return 0 = successful, -3 = record is corrupt
+ */
+static int8_t readRecord( ENUM_keyValueKey key )
+{
+  const struct_keyValueRecordHeader * record = (const struct_keyValueRecordHeader *)recordBuffer;
+
+  readPageFromDataflash(keyValueIndex[key].address, recordBuffer, sizeof(struct_keyValueRecordHeader) + keyValueIndex[key].length);
+
+  if( record->key != key || record->length != keyValueIndex[key].length || record->crc16 != calculateRecordCrc(recordBuffer) )
+  {
+    APP_LOG(TS_OFF, VLEVEL_H, "KEY VALUE: record of key %u is corrupt\r\n", key);
+    return -3;
+  }
+
+  return 0;
+}
+
+/**
+ * @fn int8_t appendRecord(ENUM_keyValueKey, uint8_t)
+ * @brief function to append the record in the record buffer to the head segment, the record is read back.
+ * The head segment is closed when the write fails.
+ *
+ * @param key : key
+ * @param length : length of the value in the record buffer, 0 = delete key
+ * @return 0 = successful, -5 = failed to write, -6 = read back not equal
+ */
+static int8_t appendRecord( ENUM_keyValueKey key, uint8_t length )
+{
+  struct_keyValueRecordHeader * record = (struct_keyValueRecordHeader *)recordBuffer;
+  uint32_t address = getSegmentAddress(headSegment) + headOffset;
+  uint16_t recordLength = sizeof(struct_keyValueRecordHeader) + length;
+
+  assert_param( headOffset + recordLength <= KEY_VALUE_SEGMENT_SIZE );
+
+  record->key = key;
+  record->length = length;
+  record->crc16 = calculateRecordCrc(recordBuffer);
+
+  //CRC is programmed after key, length and value, a record torn by power loss has no valid CRC
+  if( programData(address + sizeof(record->crc16), &recordBuffer[sizeof(record->crc16)], recordLength - sizeof(record->crc16)) != 0 ||
+      programData(address, recordBuffer, sizeof(record->crc16)) != 0 )
+  {
+    APP_LOG(TS_OFF, VLEVEL_H, "KEY VALUE: failed to write key %u\r\n", key);
+    headOffset = KEY_VALUE_SEGMENT_SIZE;
+    return -5;
+  }
+
+  headOffset += recordLength;
+
+  //read back the CRC of the record
+  readPageFromDataflash(address, recordBuffer, recordLength);
+
+  if( record->key != key || record->length != length || record->crc16 != calculateRecordCrc(recordBuffer) )
+  {
+    APP_LOG(TS_OFF, VLEVEL_H, "KEY VALUE: read back of key %u failed\r\n", key);
+    headOffset = KEY_VALUE_SEGMENT_SIZE;
+    return -6;
+  }
+
+  keyValueIndex[key].address = length ? address : KEY_VALUE_NONE;
+  keyValueIndex[key].length = length;
+
+  return 0;
+}
+
+/**
+ * @fn void compactSegment(uint32_t)
+ * @brief function to copy the live records of a segment to the head segment, the segment is erased after.
+ * A record that is deleted or changed later is not copied.
+ *
+ * @param segment : index of the oldest segment
+ */
+static void compactSegment( uint32_t segment )
+{
+  uint32_t address = getSegmentAddress(segment);
+
+  APP_LOG(TS_OFF, VLEVEL_H, "KEY VALUE: compaction of segment %u\r\n", segment);
+
+  for( int key = 0; key < KEY_VALUE_NUMBER_OF_KEYS; key++ )
+  {
+    if( keyValueIndex[key].address == KEY_VALUE_NONE || keyValueIndex[key].address < address ||
+        keyValueIndex[key].address >= address + KEY_VALUE_SEGMENT_SIZE )
+    {
+      continue;
+    }
+
+    if( readRecord(key) != 0 || appendRecord(key, keyValueIndex[key].length) != 0 )
+    {
+      //corrupt record is lost, a failed write keeps the old segment
+      if( headOffset >= KEY_VALUE_SEGMENT_SIZE )
+      {
+        return;
+      }
+      keyValueIndex[key].address = KEY_VALUE_NONE;
+    }
+  }
+
+  blockErase4kDataflash(address);
+  segmentUsed[segment] = false;
+}
+
+/**
+ * @fn int8_t openSegment(void)
+ * @brief function to start a new head segment after the current head, the oldest segment is compacted when too many segments are used.
+ *
+ * @return 0 = successful, -5 = failed to write, -7 = no free segment
+ */
+static int8_t openSegment( void )
+{
+  struct_keyValueSegmentHeader header;
+  uint32_t segment = headSegment == KEY_VALUE_NONE ? 0 : (headSegment + 1) % KEY_VALUE_NUMBER_OF_SEGMENTS;
+  uint32_t usedSegments;
+  uint32_t oldest;
+
+  if( segmentUsed[segment] )
+  {
+    APP_LOG(TS_OFF, VLEVEL_L, "KEY VALUE: no free segment\r\n");
+    return -7;
+  }
+
+  header.format = KEY_VALUE_SEGMENT_FORMAT;
+  header.spare = 0xFF;
+  header.sequence = headSegment == KEY_VALUE_NONE ? 1 : segmentSequence[headSegment] + 1;
+  header.crc16 = calculateCRC_CCITT((uint8_t*)&header.format, sizeof(header) - sizeof(header.crc16));
+
+  //free segment can contain a header or records of an interrupted erase
+  blockErase4kDataflash(getSegmentAddress(segment));
+
+  if( programData(getSegmentAddress(segment), (uint8_t*)&header, sizeof(header)) != 0 )
+  {
+    APP_LOG(TS_OFF, VLEVEL_H, "KEY VALUE: failed to open segment %u\r\n", segment);
+    return -5;
+  }
+
+  segmentUsed[segment] = true;
+  segmentSequence[segment] = header.sequence;
+  headSegment = segment;
+  headOffset = sizeof(header);
+
+  //segments left by compactions interrupted by power loss are compacted as well, all live records fit in the head segment
+  while( true )
+  {
+    usedSegments = 0;
+    oldest = KEY_VALUE_NONE;
+
+    for( uint32_t i = 0; i < KEY_VALUE_NUMBER_OF_SEGMENTS; i++ )
+    {
+      if( segmentUsed[i] == false )
+      {
+        continue;
+      }
+
+      usedSegments++;
+
+      if( oldest == KEY_VALUE_NONE || segmentSequence[i] < segmentSequence[oldest] )
+      {
+        oldest = i;
+      }
+    }
+
+    if( usedSegments <= KEY_VALUE_MAX_USED_SEGMENTS || oldest == headSegment )
+    {
+      break;
+    }
+
+    compactSegment(oldest);
+
+    if( segmentUsed[oldest] )
+    {
+      break; //compaction failed, head segment is closed
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @fn int8_t readKeyValue(ENUM_keyValueKey, void*, uint16_t*)
+ * @brief function to read the value of a key, the index is rebuilt at the first access.
+ *
+ * @param key : key
+ * @param value : destination of value
+ * @param length : size of destination, set to the length of the value
+ * @return 0 = successful, 1 = key not available, -1 = invalid argument, -2 = destination too small, -3 = record corrupt
+ */
+int8_t readKeyValue( ENUM_keyValueKey key, void * value, uint16_t * length )
+{
+  assert_param( key < KEY_VALUE_NUMBER_OF_KEYS );
+  assert_param( value != 0 );
+  assert_param( length != 0 );
+
+  if( key >= KEY_VALUE_NUMBER_OF_KEYS || value == 0 || length == 0 )
+  {
+    return -1;
+  }
+
+  if( indexValid == false )
+  {
+    rebuildIndex();
+  }
+
+  if( keyValueIndex[key].address == KEY_VALUE_NONE )
+  {
+    *length = 0;
+    return 1;
+  }
+
+  if( *length < keyValueIndex[key].length )
+  {
+    return -2;
+  }
+
+  if( readRecord(key) != 0 )
+  {
+    return -3;
+  }
+
+  *length = keyValueIndex[key].length;
+  memcpy(value, &recordBuffer[sizeof(struct_keyValueRecordHeader)], *length);
+
+  return 0;
+}
+
+/**
+ * @fn int8_t writeKeyValue(ENUM_keyValueKey, const void*, uint16_t)
+ * @brief function to write the value of a key, an unchanged value is not written again.
+ *
+ * @param key : key
+ * @param value : value
+ * @param length : length of value, 1 up to \ref KEY_VALUE_MAX_LENGTH
+ * @return 0 = successful, -1 = invalid argument, -2 = value too long, -5 = failed to write, -6 = read back not equal, -7 = no free segment
+ */
+int8_t writeKeyValue( ENUM_keyValueKey key, const void * value, uint16_t length )
+{
+  int8_t result;
+
+  assert_param( key < KEY_VALUE_NUMBER_OF_KEYS );
+  assert_param( value != 0 );
+  assert_param( length <= KEY_VALUE_MAX_LENGTH );
+
+  if( key >= KEY_VALUE_NUMBER_OF_KEYS || value == 0 || length == 0 )
+  {
+    return -1;
+  }
+
+  if( length > KEY_VALUE_MAX_LENGTH )
+  {
+    return -2;
+  }
+
+  if( indexValid == false )
+  {
+    rebuildIndex();
+  }
+
+  if( keyValueIndex[key].address != KEY_VALUE_NONE && keyValueIndex[key].length == length && readRecord(key) == 0 &&
+      memcmp(&recordBuffer[sizeof(struct_keyValueRecordHeader)], value, length) == 0 )
+  {
+    return 0; //unchanged
+  }
+
+  if( headSegment == KEY_VALUE_NONE || headOffset + sizeof(struct_keyValueRecordHeader) + length > KEY_VALUE_SEGMENT_SIZE )
+  {
+    result = openSegment();
+
+    if( result != 0 )
+    {
+      return result;
+    }
+  }
+
+  memcpy(&recordBuffer[sizeof(struct_keyValueRecordHeader)], value, length);
+
+  return appendRecord(key, length);
+}
+
+/**
+ * @fn int8_t deleteKeyValue(ENUM_keyValueKey)
+ * @brief function to delete a key, a record without value is written.
+ *
+ * @param key : key
+ * @return 0 = successful, -1 = invalid argument, -5 = failed to write, -6 = read back not equal, -7 = no free segment
+ */
+int8_t deleteKeyValue( ENUM_keyValueKey key )
+{
+  int8_t result;
+
+  assert_param( key < KEY_VALUE_NUMBER_OF_KEYS );
+
+  if( key >= KEY_VALUE_NUMBER_OF_KEYS )
+  {
+    return -1;
+  }
+
+  if( indexValid == false )
+  {
+    rebuildIndex();
+  }
+
+  if( keyValueIndex[key].address == KEY_VALUE_NONE )
+  {
+    return 0; //not available
+  }
+
+  if( headOffset + sizeof(struct_keyValueRecordHeader) > KEY_VALUE_SEGMENT_SIZE )
+  {
+    result = openSegment();
+
+    if( result != 0 )
+    {
+      return result;
+    }
+  }
+
+  return appendRecord(key, 0);
+}
+
+/**
+ * @fn int8_t eraseKeyValueStore(void)
+ * @brief function to erase all segments of the key-value store
+ *
+ * @return 0 = successful
+ */
+int8_t eraseKeyValueStore( void )
+{
+  for( uint32_t segment = 0; segment < KEY_VALUE_NUMBER_OF_SEGMENTS; segment++ )
+  {
+    blockErase4kDataflash(getSegmentAddress(segment));
+    segmentUsed[segment] = false;
+  }
+
+  for( int i = 0; i < KEY_VALUE_NUMBER_OF_KEYS; i++ )
+  {
+    keyValueIndex[i].address = KEY_VALUE_NONE;
+    keyValueIndex[i].length = 0;
+  }
+
+  headSegment = KEY_VALUE_NONE;
+  headOffset = KEY_VALUE_SEGMENT_SIZE;
+  indexValid = true;
+
+  return 0;
+}
+
+/**
+ * @fn void invalidateKeyValueIndex(void)
+ * @brief function to rebuild the index at the next access, f.e. after the RAM is lost or the dataflash is changed.
+ *
+ */
+void invalidateKeyValueIndex( void )
+{
+  indexValid = false;
+}
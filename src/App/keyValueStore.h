@@ -0,0 +1,49 @@
+/**
+  ******************************************************************************
+  * @file           : keyValueStore.h
+  * @brief          : Header for keyValueStore.c file.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  ******************************************************************************
+  */
+#ifndef KEYVALUESTORE_H_
+#define KEYVALUESTORE_H_
+
+#include <stddef.h>
+
+#define KEY_VALUE_STORE_ADDRESS     ( RESERVED_MEMORY_ADDRESS ) //start of the reserved memory of the dataflash
+#define KEY_VALUE_STORE_SIZE        ( ROLLUP_MEMORY_ADDRESS - KEY_VALUE_STORE_ADDRESS ) //reserved memory before the rollup log
+#define KEY_VALUE_NUMBER_OF_SEGMENTS  ( KEY_VALUE_STORE_SIZE / BLOCK_4K_SIZE_DATAFLASH )
+
+#define KEY_VALUE_MAX_LENGTH        200 //maximum length of a value, all values of all keys fit in one segment for compaction
+#define KEY_VALUE_VERSION_LENGTH    10  //length of sensor module firmware version string, without null terminator
+
+/**
+ * @brief keys of the key-value store, only for large data that is rarely written
+ */
+typedef enum
+{
+  KEY_VALUE_SENSOR_FIRMWARE_1 = 0,  //firmware version string of sensor module slot 1
+  KEY_VALUE_SENSOR_FIRMWARE_2,
+  KEY_VALUE_SENSOR_FIRMWARE_3,
+  KEY_VALUE_SENSOR_FIRMWARE_4,
+  KEY_VALUE_SENSOR_FIRMWARE_5,
+  KEY_VALUE_SENSOR_FIRMWARE_6,
+  KEY_VALUE_CALIBRATION_1,          //calibration table of sensor module slot 1
+  KEY_VALUE_CALIBRATION_2,
+  KEY_VALUE_CALIBRATION_3,
+  KEY_VALUE_CALIBRATION_4,
+  KEY_VALUE_CALIBRATION_5,
+  KEY_VALUE_CALIBRATION_6,
+  KEY_VALUE_DIAGNOSTIC_HISTORY,     //history of diagnostic events
+  KEY_VALUE_NUMBER_OF_KEYS
+}ENUM_keyValueKey;
+
+int8_t readKeyValue( ENUM_keyValueKey key, void * value, uint16_t * length );
+int8_t writeKeyValue( ENUM_keyValueKey key, const void * value, uint16_t length );
+int8_t deleteKeyValue( ENUM_keyValueKey key );
+int8_t eraseKeyValueStore( void );
+void invalidateKeyValueIndex( void );
+
+#endif /* KEYVALUESTORE_H_ */
@@ -16,6 +16,8 @@
 #include "utilities.h"
 #include "common/common.h"
 #include "common/app_types.h"
+#include "common/spi_bus.h"
+#include "common/crc16.h"
 #include "utilities_def.h"
 #include "stm32_seq.h"
 #include "stm32_timer.h"
@@ -30,10 +32,15 @@
 #include "IO/board_io_functions.h"
 #include "IO/led.h"
 #include "FRAM/FRAM_functions.h"
+#include "dataflash/dataflash_functions.h"
 #include "I2CMaster/SensorFunctions.h"
 #include "measurement.h"
+#include "rollup.h"
+#include "sdMirror.h"
+#include "keyValueStore.h"
 #include "BatMon_BQ35100/BatMon_functions.h"
 #include "RTC_AM1805/RTC_functions.h"
+#include "RTC_AM1805/RTC_retention.h"
 #include "CommConfig.h"
 #include "CommConfig_usr.h"
 #include "MFMconfiguration.h"
@@ -104,7 +111,9 @@ static uint8_t sensorProtocol;
 
 static uint8_t waitForBatteryMonitorDataCounter = 0;
 static struct_FRAM_settings FRAM_Settings;
+static struct_FRAM_settings FRAM_SettingsSaved; //FRAM settings as in FRAM, to detect a change
 static struct_wakeupSource stWakeupSource;
+static bool framSettingsRestored = false; //false = wake without measurement, FRAM settings not read
 static int32_t countRetryI2C_error;
 
 const void setDevNonce(uint16_t devNonce)__attribute__((unused));
@@ -667,8 +676,9 @@ const UNION_diagnosticStatusBits getDiagnostics(void)
   diagnosticStatusBits.bit.batteryLow = readInput_board_io(EXT_IOBAT_ALERT);
   diagnosticStatusBits.bit.usbConnected = readInput_board_io(EXT_IOUSB_CONNECTED);
   diagnosticStatusBits.bit.lightSensorActive = readInput_board_io(INT_IO_BOX_OPEN);
+  diagnosticStatusBits.bit.dataflashWearLimit = getMeasurementWearWarning();
 
-  APP_LOG(TS_OFF, VLEVEL_H, "Diagnostic: BAT: %d, USB: %d, BOX: %d\r\n", diagnosticStatusBits.bit.batteryLow, diagnosticStatusBits.bit.usbConnected, diagnosticStatusBits.bit.lightSensorActive);
+  APP_LOG(TS_OFF, VLEVEL_H, "Diagnostic: BAT: %d, USB: %d, BOX: %d, WEAR: %d\r\n", diagnosticStatusBits.bit.batteryLow, diagnosticStatusBits.bit.usbConnected, diagnosticStatusBits.bit.lightSensorActive, diagnosticStatusBits.bit.dataflashWearLimit);
 
   return diagnosticStatusBits;
 }
@@ -831,6 +841,109 @@ struct_wakeupSource getWakeupSource(void)
   return wakeupSource;
 }
 
+/**
+ * @fn const bool checkLoggingWake(void)
+ * @brief function to check the wake continues with a measurement, at boot before FRAM and dataflash are used.
+ * A wake by USB, the light sensor or a sensor IRQ before the alarm is not a logging wake, the LoRaWAN context,
+ * the measurement log and the settings in FRAM are restored by \ref restoreLoggingState when USB is connected.
+ * The interval is taken from the retention, the settings are not yet read. The result is kept for this wake.
+ *
+ * @return true = logging wake, false = wake without measurement
+ */
+const bool checkLoggingWake(void)
+{
+  static int8_t loggingWake = -1; //-1 = not yet checked
+
+  if( loggingWake < 0 )
+  {
+    uint8_t wakeReason;
+    uint32_t currentAlarm;
+    uint32_t currentTime;
+
+    stWakeupSource = getWakeupSource(); //get the wakeup source
+
+    restoreRtcRetention(); //state of previous wakes in RAM of RTC
+    memcpy(&wakeReason, &stWakeupSource, sizeof(wakeReason));
+    addWakeReasonRtcRetention(wakeReason);
+
+    loggingWake = true;
+
+    //reset, RTC battery flag and test modes restore all state, as well as a lost retention
+    if( !stWakeupSource.byAlarm && !stWakeupSource.byReset && !stWakeupSource.byLowBattery && isRtcRetentionValid() &&
+        getRtcRetention()->loraInterval != 0 && !getStatusRegister().testmodeActive && !getStatusRegister().testmodeBatteryGauge )
+    {
+      syncSystemTime_withRTC();
+      currentAlarm = get_current_alarm();
+      currentTime = SysTimeGet().Seconds;
+
+      //same conditions as alarmNotYetTriggered()
+      if( currentTime >= UNIX_TIME_START_APP && currentAlarm >= UNIX_TIME_START_APP && currentAlarm > currentTime &&
+          getRtcRetention()->loraInterval * TM_SECONDS_IN_1MINUTE > currentAlarm - currentTime )
+      {
+        loggingWake = false;
+      }
+    }
+
+    APP_LOG(TS_OFF, VLEVEL_H, "Logging wake: %d\r\n", loggingWake);
+  }
+
+  return loggingWake;
+}
+
+/**
+ * @fn void restoreFramSettingsAtWake(void)
+ * @brief helper function to restore the FRAM settings, with the diagnostic bits and sensor module kept in the retention
+ *
+ */
+static void restoreFramSettingsAtWake(void)
+{
+  restoreFramSettingsStruct(&FRAM_Settings, sizeof(FRAM_Settings)); //read settings from FRAM
+  memcpy(&FRAM_SettingsSaved, &FRAM_Settings, sizeof(FRAM_SettingsSaved));
+  framSettingsRestored = true;
+
+  //diagnostic of wakes without FRAM write
+  FRAM_Settings.diagnosticBits.uint32 |= getRtcRetention()->pendingDiagnosticBits;
+
+  if( isRtcRetentionValid() == false ) //RTC supply lost, continue with the sensor module in FRAM
+  {
+    getRtcRetention()->currentSensorModuleIndex = FRAM_Settings.currentSensorModuleIndex;
+    getRtcRetention()->numberOfSensorModule = FRAM_Settings.numberOfSensorModule;
+  }
+}
+
+/**
+ * @fn const void restoreLoggingState(void)
+ * @brief function to restore the state in FRAM and dataflash that is not restored at boot of a wake without measurement,
+ * f.e. when USB is connected. Nothing is done after a logging wake or a previous call.
+ *
+ */
+const void restoreLoggingState(void)
+{
+  if( checkLoggingWake() || framSettingsRestored )
+  {
+    return;
+  }
+
+  APP_LOG(TS_OFF, VLEVEL_H, "Restore logging state\r\n");
+
+  LoRaWAN_Init(); //NVM context is restored from FRAM
+  init_dataflash();
+
+  acquireSpiBus(SPI_BUS_DATAFLASH);
+  restoreLatestMeasurementId();
+  releaseSpiBus();
+
+  reloadSettingsFromVirtualEEPROM(true);
+
+  //diagnostic bits of this wake are added to the restored bits
+  {
+    uint32_t diagnosticBits = FRAM_Settings.diagnosticBits.uint32;
+
+    restoreFramSettingsAtWake();
+    FRAM_Settings.diagnosticBits.uint32 |= diagnosticBits;
+  }
+}
+
 /**
  * @brief override function getSoftwareSensorboard(), needs to be override by real functions
  *
@@ -838,25 +951,35 @@ struct_wakeupSource getWakeupSource(void)
  */
 const char * getSoftwareSensorboard(int sensorModuleId)
 {
+  static struct_sensorModuleFirmwareVersion sensorModuleVersion;
+  uint16_t length = sizeof(sensorModuleVersion.version);
+
   //check valid argument
-  if( sensorModuleId < 0 ||  sensorModuleId >= sizeof(FRAM_Settings.modules) / sizeof(FRAM_Settings.modules[0]) )
+  if( sensorModuleId < 0 ||  sensorModuleId >= NR_SENSOR_MODULE )
+  {
+    return NO_VERSION;
+  }
+
+  //version is read from the key-value store in dataflash
+  memset(&sensorModuleVersion, 0x00, sizeof(sensorModuleVersion));
+  if( readKeyValue(KEY_VALUE_SENSOR_FIRMWARE_1 + sensorModuleId, sensorModuleVersion.version, &length) != 0 )
   {
     return NO_VERSION;
   }
 
   //check on control character, not printable
-  if( iscntrl( (int) FRAM_Settings.modules[sensorModuleId].version[0] ) )
+  if( iscntrl( (int) sensorModuleVersion.version[0] ) )
   {
     return NO_VERSION;
   }
 
   //check on 0xFF, default value of not written flash
-  if( FRAM_Settings.modules[sensorModuleId].version[0] == 0xFF )
+  if( sensorModuleVersion.version[0] == 0xFF )
   {
     return NO_VERSION;
   }
 
-  return FRAM_Settings.modules[sensorModuleId].version;
+  return sensorModuleVersion.version;
 }
 
 /**
@@ -866,7 +989,7 @@ const char * getSoftwareSensorboard(int sensorModuleId)
  */
 const uint8_t getProtocolSensorboard(int sensorModuleId)
 {
-  if( sensorModuleId < 0 ||  sensorModuleId >= sizeof(FRAM_Settings.modules) / sizeof(FRAM_Settings.modules[0]) )
+  if( sensorModuleId < 0 ||  sensorModuleId >= NR_SENSOR_MODULE )
   {
     return 0;
   }
@@ -970,30 +1093,6 @@ static const void printSensorModulePressureKeller(structDataPressureSensor * pSe
       ); //print sensor data
 }
 
-/**
- * @fn const float getPressureHuba(uint16_t)
- * @brief helper function to get real pressure from rough Huba measurement data
- *
- * @param pressureData
- * @return pressure in bar
- */
-static const float getPressureHuba(uint16_t pressureData)
-{
-  return ((pressureData - 3000) / 8000.0) * 0.6;
-}
-
-/**
- * @fn const float getTemperatureHuba(uint8_t)
- * @brief helper function to get real temperature from rough Huba measurement data
- *
- * @param tempData
- * @return temperature in degree Celsius
- */
-static const float getTemperatureHuba(uint8_t tempData)
-{
-  return ((tempData * 200.0) / 255) - 50;
-}
-
 /**
  * @fn const void printSensorModulePressureHuba(structDataPressureSensorOneWire*)
  * @brief helper function to print senosr module data for oneWIre Huba to debug port
@@ -1091,11 +1190,12 @@ static const void printCounters(void)
 }
 
 /**
- * @fn const void printFirmwareVersionInfo(void)
+ * @fn const void printFirmwareVersionInfo(bool)
  * @brief function to print firmware info to debug port.
  *
+ * @param sensorModules : true = print versions of sensor modules, they are read from the dataflash
  */
-static const void printFirmwareVersionInfo(void)
+static const void printFirmwareVersionInfo(bool sensorModules)
 {
   int length = 40;
   int lengthPre = 3;
@@ -1110,7 +1210,7 @@ static const void printFirmwareVersionInfo(void)
   printSeparatorLine(TS_OFF, VerboseLevel, character, lengthPre, false);
   APP_LOG(TS_OFF, VerboseLevel,  " MFM main protocol: %s\r\n", getProtocolVersionConfig());
 
-  for(int i = 0; i<MAX_SENSOR_MODULE; i++)
+  for(int i = 0; i<MAX_SENSOR_MODULE && sensorModules; i++)
   {
     printSeparatorLine(TS_OFF, VerboseLevel, character, lengthPre, false);
     APP_LOG(TS_OFF, VerboseLevel, " MFM SensorModule %d: %s, protocol: %d\r\n", i+1, getSoftwareSensorboard(i), getProtocolSensorboard(i));
@@ -1192,6 +1292,24 @@ static bool checkIntervalChanged(void)
   return false;
 }
 
+/**
+ * @fn void enableSensorModuleMetadataRead(int)
+ * @brief helper function to invalidate the cached metadata of a sensor module in FRAM settings struct (not yet FRAM saved).
+ * The metadata is read again from the module at the next measurement.
+ *
+ * @param sensorModuleIndex : index of the sensor module 0-5, -1 = all sensor modules
+ */
+void enableSensorModuleMetadataRead(int sensorModuleIndex)
+{
+  for( int i=0; i < MAX_SENSOR_MODULE; i++)
+  {
+    if( sensorModuleIndex < 0 || sensorModuleIndex == i )
+    {
+      FRAM_Settings.sensorModuleSettings[i].item.sensorModuleMetadataValid = false;
+    }
+  }
+}
+
 /**
  * @fn void enableForcedInitSensorInFramSettings(bool)
  * @brief helper function to enable force sensor init in FRAM settings struct (not yet FRAM saved).
@@ -1206,6 +1324,8 @@ void enableForcedInitSensorInFramSettings(bool forceInitSensor)
     {
       FRAM_Settings.sensorModuleSettings[i].item.sensorModuleInitRequest = true; //enable request for each sensor.
     }
+
+    enableSensorModuleMetadataRead(-1); //read metadata again after init
   }
 }
 
@@ -1269,7 +1389,9 @@ const void mainTask(void)
   {
     case INIT_POWERUP: //init Powerup
 
-      stWakeupSource = getWakeupSource(); //get the wakeup source
+      checkLoggingWake(); //wakeup source and RTC retention, checked at boot
+      APP_LOG(TS_OFF, VLEVEL_H, "RTC retention: wake %u, last awake %ums, max awake %ums\r\n", getRtcRetention()->wakeCounter, getRtcRetention()->lastAwakeTime, getRtcRetention()->maxAwakeTime);
+      APP_LOG(TS_OFF, VLEVEL_H, "RTC retention: last uplink airtime %ums, DR%u, %u bytes\r\n", getRtcRetention()->lastTxTimeOnAir, getRtcRetention()->lastTxDatarate, getRtcRetention()->lastTxSize);
 
       if( getWakeupBatStatus(1) )
       {
@@ -1296,15 +1418,32 @@ const void mainTask(void)
 
       MainPeriodSleep = getLoraInterval() * TM_SECONDS_IN_1MINUTE * 1000; //set default
 
-      restoreFramSettingsStruct(&FRAM_Settings, sizeof(FRAM_Settings)); //read settings from FRAM
+      if( checkLoggingWake() )
+      {
+        restoreFramSettingsAtWake();
+      }
+      else
+      {
+        //FRAM not read, the diagnostic bits are kept in the retention and the modules follow from the settings
+        FRAM_Settings.diagnosticBits.uint32 |= getRtcRetention()->pendingDiagnosticBits;
+        FRAM_Settings.numberOfActiveSensorModules = getNumberOfActiveSensorModules();
+      }
+
+      if( stWakeupSource.byReset )
+      {
+        enableSensorModuleMetadataRead(-1); //modules can be swapped while the board is without power, read metadata again
+      }
 
-      printFirmwareVersionInfo(); //print firmware versions, after restore FRAM
+      printFirmwareVersionInfo(stWakeupSource.byReset); //print firmware versions, after restore FRAM. Sensor modules only after reset, no dataflash read each wake
 
       APP_LOG(TS_OFF, VLEVEL_H, "Restore diagnostic: BAT: %d, USB: %d, BOX: %d\r\n", FRAM_Settings.diagnosticBits.bit.batteryLow, FRAM_Settings.diagnosticBits.bit.usbConnected, FRAM_Settings.diagnosticBits.bit.lightSensorActive);
 
       mainTask_state = INIT_SLEEP; //Wake-up by alarm or normal power-up.
 
-      printCounters();
+      if( checkLoggingWake() )
+      {
+        printCounters(); //LoRaWAN context is not restored at a wake without measurement
+      }
 
       //check a forcedRejoinByReset is active
       if( forceRejoinByReset == true )
@@ -1320,6 +1459,11 @@ const void mainTask(void)
         mainTask_state = CHECK_USB_CONNECTED; //other wake-up, USB or other (not implemented) go to wait state
       }
 
+      if( mainTask_state == INIT_SLEEP )
+      {
+        restoreLoggingState(); //measurement follows, in case the check at boot found a wake without measurement
+      }
+
       break;
 
     case INIT_SLEEP: //init after Sleep
@@ -1415,12 +1559,27 @@ const void mainTask(void)
 
       //check if at least one sensor module is enabled
       numberOfActivesensorModules = getNumberOfActiveSensorModules();
+      for( int i = 0; i < MAX_SENSOR_MODULE; i++ )
+      {
+        if( getSensorStatus(i + 1) == false )
+        {
+          enableSensorModuleMetadataRead(i); //slot is not powered for measurements, module can be swapped
+        }
+      }
       enableForcedInitSensorInFramSettings(getForceInitSensor());
       setForceInitSensor( false ); //reset after processed.
 
       FRAM_Settings.numberOfActiveSensorModules = numberOfActivesensorModules;
-      currentSensorModuleIndex = FRAM_Settings.currentSensorModuleIndex; //get latest value.
-      currentNumberOfSensorModule = FRAM_Settings.numberOfSensorModule; //get latest value.
+      if( isRtcRetentionValid() ) //latest value from RAM of RTC, FRAM after loss of RTC supply
+      {
+        currentSensorModuleIndex = getRtcRetention()->currentSensorModuleIndex;
+        currentNumberOfSensorModule = getRtcRetention()->numberOfSensorModule;
+      }
+      else
+      {
+        currentSensorModuleIndex = FRAM_Settings.currentSensorModuleIndex; //get latest value.
+        currentNumberOfSensorModule = FRAM_Settings.numberOfSensorModule; //get latest value.
+      }
 
       if( FRAM_Settings.numberOfActiveSensorModules > 0 ) //check sensorModule is enabled, found one module or more.
       {
@@ -1622,24 +1781,74 @@ const void mainTask(void)
         memset(stMFM_sensorModuleData.sensorModuleData, 0x00, sizeof(stMFM_sensorModuleData.sensorModuleData));
         stMFM_sensorModuleData.sensorModuleSlotId = currentSensorModuleIndex + 1; //save slotId, convert (+1) from 0-5 -> 1-6
 
-        memset(dataBuffer, 0x00, sizeof(dataBuffer));
-        sensorFirmwareVersion(currentSensorModuleIndex, dataBuffer, sizeof(dataBuffer));
+        sensorType = 0; //reset first
+        result = sensorReadType(currentSensorModuleIndex, &sensorType); //identity check of the module, other metadata is cached in FRAM
+        APP_LOG(TS_OFF, VLEVEL_H, "Sensor module type: %d, %d\r\n", currentSensorModuleIndex + 1, sensorType ); //print sensor type
 
-        #pragma GCC diagnostic ignored "-Wstringop-truncation" //disable truncation warning for next line
-        strncpy(FRAM_Settings.modules[currentSensorModuleIndex].version, (char*)dataBuffer, sizeof(FRAM_Settings.modules[currentSensorModuleIndex].version)); //copy data to save to FRAM
-        #pragma GCC diagnostic warning "-Wstringop-truncation" //enable truncation warning for next
+        struct_sensorModuleMetadata * metadata = &FRAM_Settings.sensorModuleMetadata[currentSensorModuleIndex];
+        uint16_t measureTime = 0;
 
-        APP_LOG(TS_OFF, VLEVEL_H, "Sensor module firmware: %d, %s\r\n", currentSensorModuleIndex + 1, dataBuffer ); //print VERSION
+        if( FRAM_Settings.sensorModuleSettings[currentSensorModuleIndex].item.sensorModuleMetadataValid &&
+            (result != SENSOR_OK || metadata->type != sensorType || metadata->samples != numberOfSamples) )
+        {
+          APP_LOG(TS_OFF, VLEVEL_H, "Sensor module %d changed, metadata is read again\r\n", currentSensorModuleIndex + 1 ); //print info
+          FRAM_Settings.sensorModuleSettings[currentSensorModuleIndex].item.sensorModuleMetadataValid = false;
+        }
 
-        sensorProtocol = 0; //reset first
-        result = sensorProtocolVersion(currentSensorModuleIndex, &sensorProtocol);
-        APP_LOG(TS_OFF, VLEVEL_H, "Sensor module protocol version: %d, %d\r\n", currentSensorModuleIndex + 1, result == SENSOR_OK ? sensorProtocol : -1); //print protocol version
-        stMFM_sensorModuleData.sensorModuleProtocolId = sensorProtocol; //save value
-        FRAM_Settings.sensorModuleProtocol[currentSensorModuleIndex] = sensorProtocol; //save value to FRAM
+        if( FRAM_Settings.sensorModuleSettings[currentSensorModuleIndex].item.sensorModuleMetadataValid == false )
+        {
+          uint8_t metadataResult = result;
 
-        sensorType = 0; //reset first
-        result = sensorReadType(currentSensorModuleIndex, &sensorType);
-        APP_LOG(TS_OFF, VLEVEL_H, "Sensor module type: %d, %d\r\n", currentSensorModuleIndex + 1, sensorType ); //print sensor type
+          memset(dataBuffer, 0x00, sizeof(dataBuffer));
+          metadataResult |= sensorFirmwareVersion(currentSensorModuleIndex, dataBuffer, sizeof(dataBuffer));
+
+          //version is saved in the key-value store when it is changed, only the CRC is kept in FRAM
+          {
+            uint16_t versionCrc = calculateCRC_CCITT(dataBuffer, KEY_VALUE_VERSION_LENGTH);
+
+            if( FRAM_Settings.sensorModuleFirmwareCrc[currentSensorModuleIndex] != versionCrc &&
+                writeKeyValue(KEY_VALUE_SENSOR_FIRMWARE_1 + currentSensorModuleIndex, dataBuffer, KEY_VALUE_VERSION_LENGTH) == 0 )
+            {
+              FRAM_Settings.sensorModuleFirmwareCrc[currentSensorModuleIndex] = versionCrc;
+            }
+          }
+
+          APP_LOG(TS_OFF, VLEVEL_H, "Sensor module firmware: %d, %s\r\n", currentSensorModuleIndex + 1, dataBuffer ); //print VERSION
+
+          sensorProtocol = 0; //reset first
+          result = sensorProtocolVersion(currentSensorModuleIndex, &sensorProtocol);
+          APP_LOG(TS_OFF, VLEVEL_H, "Sensor module protocol version: %d, %d\r\n", currentSensorModuleIndex + 1, result == SENSOR_OK ? sensorProtocol : -1); //print protocol version
+          FRAM_Settings.sensorModuleProtocol[currentSensorModuleIndex] = sensorProtocol; //save value to FRAM
+          metadataResult |= result;
+
+          result = sensorReadSetupTime(currentSensorModuleIndex, &measureTime); //get measureTime for sensorModule
+          APP_LOG(TS_OFF, VLEVEL_H, "Sensor module measure time: %d, %u\r\n", currentSensorModuleIndex + 1, measureTime ); //print sensor measure time
+          metadataResult |= result;
+
+          result = sensorReadAmount(currentSensorModuleIndex, &numberOfSensorsOfCurrentModule);
+          APP_LOG(TS_OFF, VLEVEL_H, "Sensor module %d with %d sensors. Result: %s\r\n", currentSensorModuleIndex + 1, numberOfSensorsOfCurrentModule, result == 0 ? "OK" : "FAILED" ); //print number of sensors
+          metadataResult |= result;
+
+          //cache only complete metadata of a module
+          if( metadataResult == SENSOR_OK && measureTime != 65535 )
+          {
+            metadata->type = sensorType;
+            metadata->setupTime = measureTime;
+            metadata->samples = numberOfSamples;
+            metadata->amount = numberOfSensorsOfCurrentModule;
+            FRAM_Settings.sensorModuleSettings[currentSensorModuleIndex].item.sensorModuleMetadataValid = true;
+          }
+        }
+
+        else
+        {
+          sensorProtocol = FRAM_Settings.sensorModuleProtocol[currentSensorModuleIndex];
+          measureTime = metadata->setupTime;
+          numberOfSensorsOfCurrentModule = metadata->amount;
+          APP_LOG(TS_OFF, VLEVEL_H, "Sensor module %d cached: protocol %d, measure time %u, %d sensors\r\n", currentSensorModuleIndex + 1, sensorProtocol, measureTime, numberOfSensorsOfCurrentModule ); //print cached metadata
+        }
+
+        stMFM_sensorModuleData.sensorModuleProtocolId = sensorProtocol; //save value
         stMFM_sensorModuleData.sensorModuleTypeId = sensorType; //save value
         if( getSensorType(currentSensorModuleIndex + 1) != sensorType )
         {
@@ -1647,10 +1856,6 @@ const void mainTask(void)
           saveSettingsToVirtualEEPROM();
         }
 
-        uint16_t measureTime = 0;
-        result = sensorReadSetupTime(currentSensorModuleIndex, &measureTime); //get measureTime for sensorModule
-        APP_LOG(TS_OFF, VLEVEL_H, "Sensor module measure time: %d, %u\r\n", currentSensorModuleIndex + 1, measureTime ); //print sensor measure time
-
         if( measureTime == 65535) //check error value
         {
           measureTime = 100; //use default wait time
@@ -1659,13 +1864,10 @@ const void mainTask(void)
         setWait(measureTime);  //set wait time of sensor
         setTimeout(1000 + measureTime); //+1sec timeout
 
-        APP_LOG(TS_OFF, VLEVEL_H, "Sensor wait %ums, samples: %d\r\n", measureTime, getNumberOfSamples(currentSensorModuleIndex + 1) ); //print measure time
+        APP_LOG(TS_OFF, VLEVEL_H, "Sensor wait %ums, samples: %d\r\n", measureTime, numberOfSamples ); //print measure time
 
         sensorStartMeasurement(currentSensorModuleIndex); //start measure
 
-        result = sensorReadAmount(currentSensorModuleIndex, &numberOfSensorsOfCurrentModule);
-        APP_LOG(TS_OFF, VLEVEL_H, "Sensor module %d with %d sensors. Result: %s\r\n", currentSensorModuleIndex + 1, numberOfSensorsOfCurrentModule, result == 0 ? "OK" : "FAILED" ); //print number of sensors
-
         mainTask_state = WAIT_FOR_SENSOR_DATA; //next state
       }
 
@@ -1731,6 +1933,7 @@ const void mainTask(void)
           stMFM_sensorModuleData.sensorModuleTypeId = 0; //reset
           stMFM_sensorModuleData.sensorModuleProtocolId = 0; //reset
           stMFM_sensorModuleData.sensorModuleDataSize = 0; //reset
+          enableSensorModuleMetadataRead(currentSensorModuleIndex); //module removed or reset, read metadata again
 
           printSensorModuleError( newstatus ); //print error status to debug port.
         }
@@ -1878,7 +2081,17 @@ const void mainTask(void)
 
         printBaseData(&stMFM_baseData);
 
+        setMeasurementLogVerify(getMeasurementVerify()); //read back of record from MFM settings
+        setMeasurementLogStaging(getMeasurementStaging()); //measurements collected in FRAM from MFM settings
+        setRollupLogWindow(getRollupWindow()); //rollup window from MFM settings
+        setRollupLogUplink(getRollupUplink()); //rollups by LoRa from MFM settings
+
+        acquireSpiBus(SPI_BUS_DATAFLASH); //one bus acquisition for all dataflash and FRAM operations of the write
         writeNewMeasurement(0, &stMFM_sensorModuleData, &stMFM_baseData);
+        updateRollup(stMFM_sensorModuleData.sensorModuleSlotId); //closes window of slot, rollup in dataflash
+        mirrorMeasurementsToSd(getSdMirrorBatch()); //append a batch of measurements on the SD card
+        preEraseMeasurementBlock(); //erase next block in background while LoRa is transmitting
+        releaseSpiBus();
 
         setOrangeLedOnOf(true); //enable led
         mainTask_state = SEND_LORA_DATA; //next state
@@ -1928,13 +2141,10 @@ const void mainTask(void)
           currentNumberOfSensorModule %= FRAM_Settings.numberOfActiveSensorModules; //limit from 0 to numberOfActiveSensorModules.
 
           nextSensorInSameMeasureRound = currentNumberOfSensorModule ? true : false; //check if next is first, then not the same round
-
-          for( int i = 0; i< (sizeof( FRAM_Settings.modules) / sizeof( FRAM_Settings.modules[0])); i++ )
-          {
-            FRAM_Settings.modules[i].nullTerminator = 0; //force null terminators
-          }
           FRAM_Settings.currentSensorModuleIndex = currentSensorModuleIndex; //copy to save.
           FRAM_Settings.numberOfSensorModule = currentNumberOfSensorModule; //copy to save
+          getRtcRetention()->currentSensorModuleIndex = currentSensorModuleIndex;
+          getRtcRetention()->numberOfSensorModule = currentNumberOfSensorModule;
         }
 
         APP_LOG(TS_OFF, VLEVEL_H, "Sensor module new: %d, %d, %d\r\n", currentSensorModuleIndex + 1, currentNumberOfSensorModule, nextSensorInSameMeasureRound ); //print sensor module index
@@ -2005,6 +2215,8 @@ const void mainTask(void)
           FRAM_Settings.diagnosticBits.uint32 = 0; //reset status.
         }
         saveFramSettingsStruct(&FRAM_Settings, sizeof(FRAM_Settings)); //save FRAM data after last change
+        memcpy(&FRAM_SettingsSaved, &FRAM_Settings, sizeof(FRAM_SettingsSaved));
+        getRtcRetention()->pendingDiagnosticBits = 0; //saved in FRAM
 
 #ifndef RTC_USED_FOR_SHUTDOWN_PROCESSOR
         setNewMeasureTime(newLoraInterval); //set new interval to trigger new measurement
@@ -2044,6 +2256,7 @@ const void mainTask(void)
 
     case SWITCH_OFF_VSYS: //switch off for low power oparation
 
+      finishPreEraseMeasurementBlock(); //dataflash erase must be ready before supply is switched off
       deinit_IO_Expander(IO_EXPANDER_BUS_EXT);
       deinit_IO_Expander(IO_EXPANDER_BUS_INT);
       disableVsys();
@@ -2121,6 +2334,12 @@ const void mainTask(void)
         {
           APP_LOG(TS_OFF, VLEVEL_H, "USB connected, no off mode.\r\n" );
 
+          restoreLoggingState(); //USB supplies the device, FRAM and dataflash are used from now on
+
+          acquireSpiBus(SPI_BUS_DATAFLASH);
+          flushMeasurementLog(); //measurements staged in FRAM are programmed while USB supplies the device
+          releaseSpiBus();
+
           UTIL_TIMER_Time_t sleepTime = getNextMeasureInterval(nextSensorInSameMeasureRound, MAX(ForcedPeriodSleep, MainPeriodSleep), FRAM_Settings.numberOfActiveSensorModules);
           uint32_t nextWakeTime = getNextWake( sleepTime, systemActiveTime_sec);
           setNewMeasureTime(nextWakeTime * 1000L); //set measure time
@@ -2171,7 +2390,32 @@ const void mainTask(void)
         //make sure diagnostic is read before sleep and saved to FRAM
         diagnosticsStatusBits = getDiagnostics(); //read current diagnostics
         FRAM_Settings.diagnosticBits.uint32 |= diagnosticsStatusBits.uint32; //OR the new reads with previous value from
-        saveFramSettingsStruct(&FRAM_Settings, sizeof(FRAM_Settings)); //save FRAM data after last change
+
+        //no FRAM write when only diagnostic bits are changed, the new bits are kept in RAM of RTC
+        {
+          struct_FRAM_settings compare = FRAM_Settings;
+          compare.diagnosticBits = FRAM_SettingsSaved.diagnosticBits;
+
+          if( framSettingsRestored == false )
+          {
+            getRtcRetention()->pendingDiagnosticBits = FRAM_Settings.diagnosticBits.uint32; //FRAM not read at this wake
+          }
+          else if( isRtcRetentionValid() && memcmp(&compare, &FRAM_SettingsSaved, sizeof(compare)) == 0 )
+          {
+            getRtcRetention()->pendingDiagnosticBits = FRAM_Settings.diagnosticBits.uint32 & ~FRAM_SettingsSaved.diagnosticBits.uint32;
+          }
+          else
+          {
+            saveFramSettingsStruct(&FRAM_Settings, sizeof(FRAM_Settings)); //save FRAM data after last change
+            getRtcRetention()->pendingDiagnosticBits = 0; //saved in FRAM
+          }
+        }
+
+#ifdef RTC_USED_FOR_SHUTDOWN_PROCESSOR
+        addAwakeTimeRtcRetention(HAL_GetTick()); //processor starts at every wake, tick is the awake time
+#endif
+        getRtcRetention()->loraInterval = getLoraInterval(); //for the wake check at next boot
+        saveRtcRetention();
 
         control_supercap(false); //disable supercap before sleep
 
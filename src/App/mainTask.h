@@ -55,4 +55,7 @@ const void disable_vAlwaysOn(void);
 
 const void setDelayReJoin(int periodMs);
 
+const bool checkLoggingWake(void);
+const void restoreLoggingState(void);
+
 #endif /* MAINTASK_H_ */
@@ -12,6 +12,7 @@
   */
 
 #include <stdio.h>
+#include <string.h>
 
 #include "main.h"
 #include "sys_app.h"
@@ -19,478 +20,2489 @@
 #include "common/crc16.h"
 #include "common/common.h"
 #include "dataflash/dataflash_functions.h"
+#include "FRAM/FRAM_functions.h"
 #include "measurement.h"
+#include "measurementStaging.h"
+#include "measurementWear.h"
+
+#define MEASUREMENT_PAGE_NONE   UINT32_MAX //no page selected
+
+#define MEASUREMENT_CHECKPOINT_PROTOCOL_ID  0x01
+#define MEASUREMENT_CHECKPOINT_COPIES       2 //copies are written alternately, a write interrupted by power loss leaves the other copy valid
+
+
+
+typedef struct
+{
+  uint32_t pageAddress;         //address of the page new records are written to
+  uint32_t firstMeasurementId;  //measurement ID of the first record in this page
+  uint16_t offset;              //offset of the next record in this page
+  uint16_t count;               //number of records in this page
+}struct_measurementLogHead;
+
+typedef struct __attribute__((packed))
+{
+  uint32_t address;             //address of the latest key-frame of the slot in the head block
+  uint8_t count;                //number of records written for this key-frame, including the key-frame
+}struct_measurementKeyFrame;
+
+typedef struct __attribute__((packed))
+{
+  uint16_t crc16;               //CRC over all fields after this field
+  uint8_t protocolId;           //\ref MEASUREMENT_CHECKPOINT_PROTOCOL_ID
+  uint8_t keyFramesValid;       //1 = key-frames of slots are stored
+  uint32_t generation;          //incremented every save, copy with the highest generation is used
+  uint32_t newMeasurementId;
+  uint32_t oldestMeasurementId;
+  uint32_t tailPageAddress;
+  uint32_t headPageAddress;
+  struct_measurementKeyFrame keyFrames[MEASUREMENT_NUMBER_OF_SLOTS];
+  uint32_t eraseBlockAddress;   //block with an erase that is not yet finished, erased again after power loss, MEASUREMENT_PAGE_NONE = none
+}struct_measurementLogCheckpoint;
+
+typedef struct
+{
+  uint32_t address;             //address of the key-frame in dataflash
+  STRUCT_measurementRecord record;
+}struct_measurementRangeKeyFrame;
+
+typedef struct
+{
+  uint32_t timestamp;           //timestamp to find
+  uint32_t measurementId;       //ID of first measurement at or after timestamp
+}struct_measurementTimeContext;
+
+typedef struct
+{
+  uint8_t * buffer;             //destination of packed records
+  uint32_t bufferLength;
+  uint32_t length;              //number of bytes packed
+  uint32_t firstMeasurementId;  //ID of first packed record
+  uint32_t nextMeasurementId;   //ID to start the next block
+  uint16_t numberOfRecords;     //number of packed records
+  uint8_t slotId;               //packed slot, 0 = all slots
+}struct_measurementPackContext;
+
+static_assert (sizeof(struct_measurementLogCheckpoint) * MEASUREMENT_CHECKPOINT_COPIES <= MAX_SIZE_MEASUREMENT_LOG, "Size struct_measurementLogCheckpoint is too large");
 
 static STRUCT_measurementData measurement;
 static bool readyForMeasurement = 0;
 
-static uint32_t newMeasurementId = 0;
+static uint32_t newMeasurementId = 0;
+static uint32_t oldestMeasurementId = 0;
+static uint32_t tailPageAddress = 0;
+static struct_measurementLogHead logHead;
+
+static uint8_t pageBuffer[PAGE_SIZE_DATAFLASH];
+static uint32_t pageBufferAddress = MEASUREMENT_PAGE_NONE;
+static bool tornPageCheck = false; //next page is checked for a program torn by power loss before it is written
+
+static struct_measurementKeyFrame keyFrames[MEASUREMENT_NUMBER_OF_SLOTS];
+static bool keyFramesRestored = false;
+static STRUCT_measurementRecord keyFrameBuffer;
+static uint32_t keyFrameBufferAddress = MEASUREMENT_PAGE_NONE;
+
+static uint32_t checkpointGeneration = 0;
+
+static uint8_t measurementVerify = MEASUREMENT_VERIFY_DEFAULT;
+
+static uint32_t preEraseBlockAddress = MEASUREMENT_PAGE_NONE;
+static uint32_t eraseBlockAddress = MEASUREMENT_PAGE_NONE; //erase started, but not yet finished
+
+static struct_measurementRangeKeyFrame rangeKeyFrames[MEASUREMENT_NUMBER_OF_SLOTS];
+
+
+/**
+ * @fn uint32_t getNextPageAddress(uint32_t)
+ * @brief helper function to get the next page in the measurement ringbuffer
+ *
+ * @param pageAddress : current page address
+ * @return address of next page
+ */
+static uint32_t getNextPageAddress( uint32_t pageAddress )
+{
+  return (pageAddress + PAGE_SIZE_DATAFLASH) % MEASUREMENT_MEMEORY_SIZE;
+}
+
+/**
+ * @fn uint32_t getNextBlockAddress(uint32_t)
+ * @brief helper function to get the first page of the next 4K block in the measurement ringbuffer
+ *
+ * @param pageAddress : current page address
+ * @return address of first page in next block
+ */
+static uint32_t getNextBlockAddress( uint32_t pageAddress )
+{
+  return ((pageAddress / BLOCK_4K_SIZE_DATAFLASH + 1) * BLOCK_4K_SIZE_DATAFLASH) % MEASUREMENT_MEMEORY_SIZE;
+}
+
+/**
+ * @fn bool checkErased(const uint8_t*, uint32_t)
+ * @brief helper function to check data is erased (0xFF)
+ *
+ * @param data : data to check
+ * @param length : number of bytes
+ * @return true = all bytes are erased
+ */
+static bool checkErased( const uint8_t * data, uint32_t length )
+{
+  while( length-- )
+  {
+    if( *data++ != 0xFF )
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @fn uint16_t calculatePageHeaderCrc(const STRUCT_measurementPageHeader*)
+ * @brief helper function to calculate the CRC of a page header
+ *
+ * @param header : pointer to page header
+ * @return CRC
+ */
+static uint16_t calculatePageHeaderCrc( const STRUCT_measurementPageHeader * header )
+{
+  return calculateCRC_CCITT((uint8_t*)header, offsetof(STRUCT_measurementPageHeader, crc));
+}
+
+/**
+ * @fn int8_t readLogData(uint32_t, uint8_t*, uint32_t)
+ * @brief function to read data of the measurement log, the bytes staged in FRAM are included.
+ * The dataflash is not read when all bytes are staged or the page header is staged, the rest of that page is erased.
+ *
+ * @param address : dataflash address, the data may not cross a page boundary
+ * @param data : destination
+ * @param length : number of bytes
+ * @return 0 = successful, -1 = read failed
+ */
+static int8_t readLogData( uint32_t address, uint8_t * data, uint32_t length )
+{
+  if( checkLogDataStaged(address, length) == true )
+  {
+    memset(data, 0xFF, length);
+  }
+  else if( readPageFromDataflash(address, data, length) != 0 )
+  {
+    return -1;
+  }
+
+  overlayStagedData(address, data, length);
+
+  return 0;
+}
+
+/**
+ * @fn bool readPageHeader(uint32_t, STRUCT_measurementPageHeader*)
+ * @brief function to read the header of a measurement page, uses the page buffer when available.
+ *
+ * @param pageAddress : address of the page
+ * @param header : destination of header
+ * @return true = valid header, false = erased or invalid page
+ */
+static bool readPageHeader( uint32_t pageAddress, STRUCT_measurementPageHeader * header )
+{
+  if( pageAddress == pageBufferAddress )
+  {
+    memcpy(header, pageBuffer, sizeof(STRUCT_measurementPageHeader)); //already in buffer
+  }
+  else
+  {
+    readLogData(pageAddress, (uint8_t*)header, sizeof(STRUCT_measurementPageHeader));
+  }
+
+  return header->format == MEASUREMENT_PAGE_FORMAT_PACKED && header->crc == calculatePageHeaderCrc(header);
+}
+
+/**
+ * @fn bool readCommittedPageHeader(uint32_t*, uint32_t, STRUCT_measurementPageHeader*)
+ * @brief function to read the header of a measurement page, void pages are skipped.
+ * A void page has no records, the measurement IDs continue in the next page.
+ *
+ * @param pageAddress : address of the page, is moved to the first page which is not void
+ * @param lastPageAddress : last page that may be read
+ * @param header : destination of header
+ * @return true = valid header, false = erased, torn or invalid page
+ */
+static bool readCommittedPageHeader( uint32_t * pageAddress, uint32_t lastPageAddress, STRUCT_measurementPageHeader * header )
+{
+  while( readPageHeader(*pageAddress, header) == false )
+  {
+    if( header->format != MEASUREMENT_PAGE_FORMAT_VOID || *pageAddress == lastPageAddress )
+    {
+      return false;
+    }
+    *pageAddress = getNextPageAddress(*pageAddress);
+  }
+
+  return true;
+}
+
+/**
+ * @fn int8_t loadPage(uint32_t)
+ * @brief function to load a complete page in the page buffer, skipped if the page is already loaded.
+ *
+ * @param pageAddress : address of the page
+ * @return 0 = successful, -1 = read failed
+ */
+static int8_t loadPage( uint32_t pageAddress )
+{
+  if( pageAddress != pageBufferAddress )
+  {
+    if( readLogData(pageAddress, pageBuffer, sizeof(pageBuffer)) != 0 )
+    {
+      pageBufferAddress = MEASUREMENT_PAGE_NONE;
+      return -1;
+    }
+    pageBufferAddress = pageAddress;
+  }
+
+  return 0;
+}
+
+/**
+ * @fn bool nextRecordInPage(const uint8_t*, uint16_t*)
+ * @brief function to check the record framing at offset in page and step over it.
+ *
+ * @param page : page data
+ * @param offset : offset of record in page, is incremented to the next record when valid.
+ * @return true = record available, false = end of records in page
+ */
+static bool nextRecordInPage( const uint8_t * page, uint16_t * offset )
+{
+  const STRUCT_measurementRecord * record = (const STRUCT_measurementRecord *)&page[*offset];
+
+  if( *offset >= PAGE_SIZE_DATAFLASH ) //end of page
+  {
+    return false;
+  }
+
+  if( record->length == MEASUREMENT_RECORD_ERASED ) //end of written records
+  {
+    return false;
+  }
+
+  if( record->length <= MEASUREMENT_RECORD_CRC_OFFSET || *offset + record->length > PAGE_SIZE_DATAFLASH ) //framing error
+  {
+    APP_LOG(TS_OFF, VLEVEL_H, "MEASUREMENT: invalid record length %u at offset %u\r\n", record->length, *offset);
+    return false;
+  }
+
+  if( record->recordType == MEASUREMENT_RECORD_VOID ) //write interrupted by power loss
+  {
+    return false;
+  }
+
+  *offset += record->length;
+
+  return true;
+}
+
+/**
+ * @fn uint16_t scanPage(const uint8_t*, uint16_t*)
+ * @brief function to count the records in a page and find the free space.
+ *
+ * @param page : page data
+ * @param endOffset : destination of offset of first free byte
+ * @return number of records in page
+ */
+static uint16_t scanPage( const uint8_t * page, uint16_t * endOffset )
+{
+  uint16_t offset = sizeof(STRUCT_measurementPageHeader);
+  uint16_t count = 0;
+
+  while( nextRecordInPage(page, &offset) )
+  {
+    count++;
+  }
+
+  *endOffset = offset;
+
+  return count;
+}
+
+/**
+ * @fn int16_t getRecordOffset(const uint8_t*, uint32_t)
+ * @brief function to find the offset of record with index in a page
+ *
+ * @param page : page data
+ * @param index : index of record in page, 0 is first record
+ * @return offset of record, -1 = not available
+ */
+static int16_t getRecordOffset( const uint8_t * page, uint32_t index )
+{
+  uint16_t offset = sizeof(STRUCT_measurementPageHeader);
+  uint16_t recordOffset = offset;
+
+  do
+  {
+    recordOffset = offset;
+    if( nextRecordInPage(page, &offset) == false )
+    {
+      return -1;
+    }
+  } while( index-- );
+
+  return recordOffset;
+}
+
+/**
+ * @fn void encodeFullRecord(STRUCT_measurementRecord*, uint32_t, uint8_t, const struct_MFM_sensorModuleData*, const struct_MFM_baseData*)
+ * @brief function to pack a measurement in a full record.
+ *
+ * @param record : destination
+ * @param timestamp : time of measurement
+ * @param MFM_protocol : protocol of MFM
+ * @param sensorModuleData : sensor module data, only the used data is copied
+ * @param MFM_data : MFM base data
+ */
+static void encodeFullRecord( STRUCT_measurementRecord * record, uint32_t timestamp, uint8_t MFM_protocol, const struct_MFM_sensorModuleData * sensorModuleData, const struct_MFM_baseData * MFM_data )
+{
+  record->length = MEASUREMENT_RECORD_HEADER_SIZE + sensorModuleData->sensorModuleDataSize;
+  record->recordType = MEASUREMENT_RECORD_FULL;
+  record->timestamp = timestamp;
+  record->protocolMFM = MFM_protocol;
+  memcpy( &record->MFM_baseData.stBaseData, MFM_data, sizeof(struct_MFM_baseData)); //copy MFM base data.
+  record->sensorModuleSlotId = sensorModuleData->sensorModuleSlotId;
+  record->sensorModuleTypeId = sensorModuleData->sensorModuleTypeId;
+  record->sensorModuleProtocolId = sensorModuleData->sensorModuleProtocolId;
+  record->sensorModuleDataSize = sensorModuleData->sensorModuleDataSize;
+  memcpy(record->sensorModuleData, sensorModuleData->sensorModuleData, sensorModuleData->sensorModuleDataSize); //copy only used sensor module data.
+  record->crc = calculateCRC_CCITT((uint8_t*)&record->timestamp, record->length - MEASUREMENT_RECORD_CRC_OFFSET); //calculate CRC on record
+}
+
+/**
+ * @fn int8_t checkFullRecord(const STRUCT_measurementRecord*)
+ * @brief function to verify a full record
+ *
+ * @param record : packed record
+ * @return 0 = valid, -1 = unknown record type, -2 = invalid size, -3 = CRC error
+ */
+static int8_t checkFullRecord( const STRUCT_measurementRecord * record )
+{
+  if( record->recordType != MEASUREMENT_RECORD_FULL )
+  {
+    return -1;
+  }
+
+  if( record->sensorModuleDataSize > MAX_SENSOR_DATASIZE || record->length != MEASUREMENT_RECORD_HEADER_SIZE + record->sensorModuleDataSize )
+  {
+    return -2;
+  }
+
+  if( record->crc != calculateCRC_CCITT((uint8_t*)&record->timestamp, record->length - MEASUREMENT_RECORD_CRC_OFFSET) )
+  {
+    return -3;
+  }
+
+  return 0;
+}
+
+/**
+ * @fn bool checkRecordCommitted(const STRUCT_measurementRecord*)
+ * @brief function to check a record is completely written, the CRC is programmed together with the record.
+ * The fields after the CRC are checked as well, a record torn after its first bytes has an erased key-frame offset or data size.
+ *
+ * @param record : packed record, full or delta record
+ * @return true = committed, false = write interrupted by power loss
+ */
+static bool checkRecordCommitted( const STRUCT_measurementRecord * record )
+{
+  if( record->recordType == MEASUREMENT_RECORD_FULL )
+  {
+    return checkFullRecord(record) == 0;
+  }
+
+  if( record->recordType != MEASUREMENT_RECORD_DELTA )
+  {
+    return false;
+  }
+
+  if( ((const STRUCT_measurementDeltaRecord *)record)->keyFrameOffset >= BLOCK_4K_SIZE_DATAFLASH )
+  {
+    return false;
+  }
+
+  return record->crc == calculateCRC_CCITT((uint8_t*)&record->timestamp, record->length - MEASUREMENT_RECORD_CRC_OFFSET);
+}
+
+/**
+ * @fn void decodeFullRecord(const STRUCT_measurementRecord*, uint32_t, STRUCT_measurementData*)
+ * @brief function to unpack a verified full record to the measurement data struct.
+ *
+ * @param record : packed record
+ * @param measurementId : ID of the record
+ * @param dest : destination
+ */
+static void decodeFullRecord( const STRUCT_measurementRecord * record, uint32_t measurementId, STRUCT_measurementData * dest )
+{
+  memset(dest, 0xFF, sizeof(STRUCT_measurementData)); //unused bytes are blank
+
+  dest->measurementId = measurementId;
+  dest->timestamp = record->timestamp;
+  dest->protocolMFM = record->protocolMFM;
+  dest->sensorModuleData.sensorModuleSlotId = record->sensorModuleSlotId;
+  dest->sensorModuleData.sensorModuleTypeId = record->sensorModuleTypeId;
+  dest->sensorModuleData.sensorModuleProtocolId = record->sensorModuleProtocolId;
+  dest->sensorModuleData.sensorModuleDataSize = record->sensorModuleDataSize;
+  memcpy(dest->sensorModuleData.sensorModuleData, record->sensorModuleData, record->sensorModuleDataSize);
+  dest->sensorModuleData_crc = calculateCRC_CCITT(dest->sensorModuleData.sensorModuleData, dest->sensorModuleData.sensorModuleDataSize);
+  memcpy(&dest->MFM_baseData, &record->MFM_baseData, sizeof(dest->MFM_baseData));
+}
+
+/**
+ * @fn int8_t loadKeyFrame(uint32_t)
+ * @brief function to load a key-frame record in the key-frame buffer, skipped if already loaded.
+ *
+ * @param address : address of key-frame record in dataflash
+ * @return 0 = successful, -4 = read failed, other < 0 not a valid key-frame
+ */
+static int8_t loadKeyFrame( uint32_t address )
+{
+  int8_t result;
+  uint16_t length;
+
+  if( address == keyFrameBufferAddress )
+  {
+    return 0;
+  }
+
+  length = PAGE_SIZE_DATAFLASH - address % PAGE_SIZE_DATAFLASH; //record does not span pages
+
+  if( length > sizeof(keyFrameBuffer) )
+  {
+    length = sizeof(keyFrameBuffer);
+  }
+
+  if( address - address % PAGE_SIZE_DATAFLASH == pageBufferAddress )
+  {
+    memcpy(&keyFrameBuffer, &pageBuffer[address % PAGE_SIZE_DATAFLASH], length);
+  }
+  else if( readLogData(address, (uint8_t*)&keyFrameBuffer, length) != 0 )
+  {
+    keyFrameBufferAddress = MEASUREMENT_PAGE_NONE;
+    return -4;
+  }
+
+  result = checkFullRecord(&keyFrameBuffer);
+
+  keyFrameBufferAddress = result == 0 ? address : MEASUREMENT_PAGE_NONE;
+
+  return result;
+}
+
+/**
+ * @fn void getDeltaBytes(const STRUCT_measurementRecord*, uint8_t*)
+ * @brief helper function to collect the bytes compared in a delta record, MFM base data followed by sensor module data.
+ *
+ * @param record : full record
+ * @param dest : destination, size \ref MEASUREMENT_DELTA_BYTES
+ */
+static void getDeltaBytes( const STRUCT_measurementRecord * record, uint8_t * dest )
+{
+  memcpy(dest, record->MFM_baseData.data, sizeof(record->MFM_baseData.data));
+  memcpy(&dest[sizeof(record->MFM_baseData.data)], record->sensorModuleData, record->sensorModuleDataSize);
+}
+
+/**
+ * @fn uint32_t getKeyFrameAddress(const STRUCT_measurementDeltaRecord*, uint32_t)
+ * @brief helper function to get the address of the key-frame of a delta record, the key-frame is in the same 4K block.
+ *
+ * @param record : delta record
+ * @param recordAddress : address of the delta record in dataflash
+ * @return address of key-frame
+ */
+static uint32_t getKeyFrameAddress( const STRUCT_measurementDeltaRecord * record, uint32_t recordAddress )
+{
+  return recordAddress - recordAddress % BLOCK_4K_SIZE_DATAFLASH + record->keyFrameOffset;
+}
+
+/**
+ * @fn int8_t decodeDeltaRecord(const STRUCT_measurementDeltaRecord*, const STRUCT_measurementRecord*, uint32_t, STRUCT_measurementData*)
+ * @brief function to unpack a delta record.
+ *
+ * @param record : delta record
+ * @param keyFrame : verified key-frame of the delta record
+ * @param measurementId : ID of the record
+ * @param dest : destination
+ * @return 0 = successful, -3 = CRC error, -5 = invalid size
+ */
+static int8_t decodeDeltaRecord( const STRUCT_measurementDeltaRecord * record, const STRUCT_measurementRecord * keyFrame, uint32_t measurementId, STRUCT_measurementData * dest )
+{
+  uint8_t deltaBytes[MEASUREMENT_DELTA_BYTES];
+  const uint8_t * data = record->data;
+  const uint8_t * bitmap;
+  uint32_t timeDifference = 0;
+  uint8_t shift = 0;
+  uint8_t numberOfBytes;
+
+  if( record->crc != calculateCRC_CCITT((uint8_t*)&record->keyFrameOffset, record->length - MEASUREMENT_RECORD_CRC_OFFSET) )
+  {
+    return -3;
+  }
+
+  decodeFullRecord(keyFrame, measurementId, dest);
+
+  //timestamp difference
+  do
+  {
+    timeDifference |= (uint32_t)(*data & 0x7F) << shift;
+    shift += 7;
+  } while( (*data++ & 0x80) && shift < 35 );
+
+  dest->timestamp += timeDifference;
+
+  //changed bytes
+  numberOfBytes = sizeof(keyFrame->MFM_baseData.data) + keyFrame->sensorModuleDataSize;
+  bitmap = data;
+  data += (numberOfBytes + 7) / 8;
+
+  getDeltaBytes(keyFrame, deltaBytes);
+
+  for( int i = 0; i < numberOfBytes; i++ )
+  {
+    if( bitmap[i / 8] & (1 << (i % 8)) )
+    {
+      if( data >= (uint8_t*)record + record->length )
+      {
+        return -5;
+      }
+      deltaBytes[i] ^= *data++;
+    }
+  }
+
+  memcpy(dest->MFM_baseData.data, deltaBytes, sizeof(dest->MFM_baseData.data));
+  memcpy(dest->sensorModuleData.sensorModuleData, &deltaBytes[sizeof(dest->MFM_baseData.data)], dest->sensorModuleData.sensorModuleDataSize);
+  dest->sensorModuleData_crc = calculateCRC_CCITT(dest->sensorModuleData.sensorModuleData, dest->sensorModuleData.sensorModuleDataSize);
+
+  return 0;
+}
+
+/**
+ * @fn int8_t decodeRecord(const uint8_t*, uint32_t, uint32_t, STRUCT_measurementData*)
+ * @brief function to unpack a measurement record to the measurement data struct.
+ *
+ * @param record : packed record
+ * @param recordAddress : address of the record in dataflash
+ * @param measurementId : ID of the record
+ * @param dest : destination
+ * @return 0 = successful, < 0 = corrupt record
+ */
+static int8_t decodeRecord( const uint8_t * record, uint32_t recordAddress, uint32_t measurementId, STRUCT_measurementData * dest )
+{
+  int8_t result;
+
+  switch( ((const STRUCT_measurementRecord *)record)->recordType )
+  {
+    case MEASUREMENT_RECORD_FULL:
+
+      result = checkFullRecord((const STRUCT_measurementRecord *)record);
+      if( result == 0 )
+      {
+        decodeFullRecord((const STRUCT_measurementRecord *)record, measurementId, dest);
+      }
+      return result;
+
+    case MEASUREMENT_RECORD_DELTA:
+
+      if( loadKeyFrame(getKeyFrameAddress((const STRUCT_measurementDeltaRecord *)record, recordAddress)) != 0 )
+      {
+        return -4;
+      }
+      return decodeDeltaRecord((const STRUCT_measurementDeltaRecord *)record, &keyFrameBuffer, measurementId, dest);
+
+    default:
+
+      return -1;
+  }
+}
+
+/**
+ * @fn void restoreKeyFrames(void)
+ * @brief function to find the latest key-frame of each slot in the head block.
+ * The pages of the head block are scanned from the start until the head page.
+ *
+ */
+static void restoreKeyFrames( void )
+{
+  uint32_t blockAddress = logHead.pageAddress - logHead.pageAddress % BLOCK_4K_SIZE_DATAFLASH;
+  uint16_t offset;
+  uint16_t recordOffset;
+
+  for( int i = 0; i < MEASUREMENT_NUMBER_OF_SLOTS; i++ )
+  {
+    keyFrames[i].address = MEASUREMENT_PAGE_NONE;
+    keyFrames[i].count = 0;
+  }
+
+  keyFramesRestored = true;
+
+  for( uint32_t pageAddress = blockAddress; pageAddress <= logHead.pageAddress; pageAddress += PAGE_SIZE_DATAFLASH )
+  {
+    if( loadPage(pageAddress) != 0 || ((STRUCT_measurementPageHeader *)pageBuffer)->format != MEASUREMENT_PAGE_FORMAT_PACKED )
+    {
+      continue; //page not in use
+    }
+
+    offset = sizeof(STRUCT_measurementPageHeader);
+    recordOffset = offset;
+
+    while( nextRecordInPage(pageBuffer, &offset) )
+    {
+      const STRUCT_measurementRecord * record = (const STRUCT_measurementRecord *)&pageBuffer[recordOffset];
+
+      if( record->recordType == MEASUREMENT_RECORD_FULL && (uint8_t)(record->sensorModuleSlotId - 1) < MEASUREMENT_NUMBER_OF_SLOTS )
+      {
+        keyFrames[record->sensorModuleSlotId - 1].address = pageAddress + recordOffset;
+        keyFrames[record->sensorModuleSlotId - 1].count = 1;
+      }
+      else if( record->recordType == MEASUREMENT_RECORD_DELTA )
+      {
+        uint32_t keyFrameAddress = getKeyFrameAddress((const STRUCT_measurementDeltaRecord *)record, pageAddress);
+
+        for( int i = 0; i < MEASUREMENT_NUMBER_OF_SLOTS; i++ )
+        {
+          if( keyFrames[i].address == keyFrameAddress )
+          {
+            keyFrames[i].count++;
+          }
+        }
+      }
+
+      recordOffset = offset;
+    }
+  }
+}
+
+/**
+ * @fn uint8_t encodeDeltaRecord(const STRUCT_measurementRecord*, STRUCT_measurementDeltaRecord*)
+ * @brief function to encode a record as delta against the latest key-frame of the same slot.
+ *
+ * @param record : full record to encode
+ * @param delta : destination of delta record
+ * @return length of delta record, 0 = a key-frame must be written.
+ */
+static uint8_t encodeDeltaRecord( const STRUCT_measurementRecord * record, STRUCT_measurementDeltaRecord * delta )
+{
+  uint8_t currentBytes[MEASUREMENT_DELTA_BYTES];
+  uint8_t keyFrameBytes[MEASUREMENT_DELTA_BYTES];
+  uint8_t slot = record->sensorModuleSlotId - 1;
+  uint8_t * data = delta->data;
+  uint8_t * bitmap;
+  uint32_t timeDifference;
+  uint8_t numberOfBytes;
+
+  //check key-frame of slot is available and interval not passed
+  if( slot >= MEASUREMENT_NUMBER_OF_SLOTS || keyFrames[slot].address == MEASUREMENT_PAGE_NONE || keyFrames[slot].count >= MEASUREMENT_KEYFRAME_INTERVAL )
+  {
+    return 0;
+  }
+
+  if( loadKeyFrame(keyFrames[slot].address) != 0 )
+  {
+    return 0;
+  }
+
+  //check static fields are equal
+  if( keyFrameBuffer.protocolMFM != record->protocolMFM ||
+      keyFrameBuffer.sensorModuleSlotId != record->sensorModuleSlotId ||
+      keyFrameBuffer.sensorModuleTypeId != record->sensorModuleTypeId ||
+      keyFrameBuffer.sensorModuleProtocolId != record->sensorModuleProtocolId ||
+      keyFrameBuffer.sensorModuleDataSize != record->sensorModuleDataSize ||
+      keyFrameBuffer.timestamp > record->timestamp )
+  {
+    return 0;
+  }
+
+  //timestamp difference
+  timeDifference = record->timestamp - keyFrameBuffer.timestamp;
+  do
+  {
+    *data = timeDifference & 0x7F;
+    timeDifference >>= 7;
+    if( timeDifference )
+    {
+      *data |= 0x80;
+    }
+    data++;
+  } while( timeDifference );
+
+  //changed bytes
+  numberOfBytes = sizeof(record->MFM_baseData.data) + record->sensorModuleDataSize;
+  bitmap = data;
+  memset(bitmap, 0, (numberOfBytes + 7) / 8);
+  data += (numberOfBytes + 7) / 8;
+
+  getDeltaBytes(record, currentBytes);
+  getDeltaBytes(&keyFrameBuffer, keyFrameBytes);
+
+  for( int i = 0; i < numberOfBytes; i++ )
+  {
+    if( currentBytes[i] != keyFrameBytes[i] )
+    {
+      bitmap[i / 8] |= 1 << (i % 8);
+      *data++ = currentBytes[i] ^ keyFrameBytes[i];
+    }
+  }
+
+  delta->length = data - (uint8_t*)delta;
+  delta->recordType = MEASUREMENT_RECORD_DELTA;
+  delta->keyFrameOffset = keyFrames[slot].address % BLOCK_4K_SIZE_DATAFLASH;
+  delta->crc = calculateCRC_CCITT((uint8_t*)&delta->keyFrameOffset, delta->length - MEASUREMENT_RECORD_CRC_OFFSET);
+
+  if( delta->length >= record->length )
+  {
+    return 0; //no gain
+  }
+
+  return delta->length;
+}
+
+/**
+ * @fn uint32_t getRingPageAddress(uint32_t)
+ * @brief helper function to get the address of a page counted from the start of the ring
+ *
+ * @param index : number of the page from the start of the ring
+ * @return address of page
+ */
+static uint32_t getRingPageAddress( uint32_t index )
+{
+  return (getMeasurementRingStart() + index * PAGE_SIZE_DATAFLASH) % MEASUREMENT_MEMEORY_SIZE;
+}
+
+/**
+ * @fn uint32_t getWearFrontierBlock(void)
+ * @brief helper function to get the latest block erased by the ring, the head block or the block after it when already erased.
+ *
+ * @return block number
+ */
+static uint32_t getWearFrontierBlock( void )
+{
+  STRUCT_measurementPageHeader header;
+  uint32_t blockAddress = getNextBlockAddress(logHead.pageAddress);
+
+  if( preEraseBlockAddress != blockAddress )
+  {
+    readPageFromDataflash(blockAddress, (uint8_t*)&header, sizeof(header));
+
+    if( checkErased((uint8_t*)&header, sizeof(header)) == false )
+    {
+      blockAddress = logHead.pageAddress - logHead.pageAddress % BLOCK_4K_SIZE_DATAFLASH;
+    }
+  }
+
+  return blockAddress / BLOCK_4K_SIZE_DATAFLASH;
+}
+
+/**
+ * @fn void resetMeasurementLog(void)
+ * @brief function to set the administration of the measurement log to an empty dataflash.
+ * The head is set to a full page before the start of the ring, so the first record starts at the first page of the ring.
+ *
+ */
+static void resetMeasurementLog( void )
+{
+  logHead.pageAddress = getRingPageAddress(NUMBER_PAGES_FOR_MEASUREMENTS - 1);
+  logHead.firstMeasurementId = 0;
+  logHead.offset = PAGE_SIZE_DATAFLASH;
+  logHead.count = 0;
+
+  tailPageAddress = getMeasurementRingStart();
+  oldestMeasurementId = 0;
+  newMeasurementId = 0;
+
+  pageBufferAddress = MEASUREMENT_PAGE_NONE;
+  keyFrameBufferAddress = MEASUREMENT_PAGE_NONE;
+  keyFramesRestored = false;
+  preEraseBlockAddress = MEASUREMENT_PAGE_NONE;
+  eraseBlockAddress = MEASUREMENT_PAGE_NONE;
+}
+
+/**
+ * @fn void restoreMeasurementLogTail(void)
+ * @brief function to find the oldest page in the ringbuffer, based on the current head.
+ * After a turnover the oldest page is the first page of the block after the head.
+ *
+ */
+static void restoreMeasurementLogTail( void )
+{
+  STRUCT_measurementPageHeader header;
+  uint32_t pageAddress = getNextBlockAddress(logHead.pageAddress);
+
+  //check the next two blocks, the next block is only erased when power failed during the block change.
+  for( int i = 0; i < 2; i++ )
+  {
+    if( pageAddress / BLOCK_4K_SIZE_DATAFLASH != logHead.pageAddress / BLOCK_4K_SIZE_DATAFLASH &&
+        readPageHeader(pageAddress, &header) && header.firstMeasurementId < logHead.firstMeasurementId )
+    {
+      tailPageAddress = pageAddress;
+      oldestMeasurementId = header.firstMeasurementId;
+      return;
+    }
+    pageAddress = getNextBlockAddress(pageAddress);
+  }
+
+  //no turnover, oldest is the start of the ringbuffer
+  if( readPageHeader(getMeasurementRingStart(), &header) )
+  {
+    tailPageAddress = getMeasurementRingStart();
+    oldestMeasurementId = header.firstMeasurementId;
+  }
+  else
+  {
+    tailPageAddress = logHead.pageAddress;
+    oldestMeasurementId = logHead.firstMeasurementId;
+  }
+}
+
+/**
+ * @fn bool restoreMeasurementLogHead(uint32_t)
+ * @brief function to restore the head administration from the given page.
+ * The last record is only written partly when power failed during the write, it is made void and the page is closed.
+ *
+ * @param pageAddress : page of the head
+ * @return true = successful, false = page has no valid header
+ */
+static bool restoreMeasurementLogHead( uint32_t pageAddress )
+{
+  STRUCT_measurementPageHeader * header = (STRUCT_measurementPageHeader *)pageBuffer;
+
+  //head is restored from the records staged in FRAM, the dataflash is not read
+  if( pageAddress != MEASUREMENT_PAGE_NONE && pageAddress == getStagingPageAddress() )
+  {
+    logHead.pageAddress = pageAddress;
+    getStagedLogHead(&logHead.firstMeasurementId, &logHead.count, &logHead.offset);
+
+    newMeasurementId = logHead.firstMeasurementId + logHead.count;
+    tornPageCheck = true;
+
+    return true;
+  }
+
+  if( pageAddress >= MEASUREMENT_MEMEORY_SIZE || (pageAddress % PAGE_SIZE_DATAFLASH) != 0 || loadPage(pageAddress) != 0 )
+  {
+    return false;
+  }
+
+  if( header->format != MEASUREMENT_PAGE_FORMAT_PACKED || header->crc != calculatePageHeaderCrc(header) )
+  {
+    return false;
+  }
+
+  logHead.pageAddress = pageAddress;
+  logHead.firstMeasurementId = header->firstMeasurementId;
+  logHead.count = scanPage(pageBuffer, &logHead.offset);
+
+  //last record of the log is not committed when power failed during the write
+  if( logHead.count > 0 )
+  {
+    int16_t recordOffset = getRecordOffset(pageBuffer, logHead.count - 1);
+
+    if( checkRecordCommitted((const STRUCT_measurementRecord *)&pageBuffer[recordOffset]) == false )
+    {
+      APP_LOG(TS_OFF, VLEVEL_H, "MEASUREMENT: record at offset %u not committed, made void\r\n", recordOffset);
+
+      pageBuffer[recordOffset + offsetof(STRUCT_measurementRecord, recordType)] = MEASUREMENT_RECORD_VOID;
+      programDataInDataflash(pageAddress + recordOffset + offsetof(STRUCT_measurementRecord, recordType),
+                             &pageBuffer[recordOffset + offsetof(STRUCT_measurementRecord, recordType)], 1);
+      logHead.count--;
+      logHead.offset = recordOffset;
+    }
+  }
+
+  //bytes after the last committed record are written by an interrupted write, the rest of the page is not used
+  if( checkErased(&pageBuffer[logHead.offset], PAGE_SIZE_DATAFLASH - logHead.offset) == false )
+  {
+    APP_LOG(TS_OFF, VLEVEL_H, "MEASUREMENT: page 0x%08x closed after offset %u\r\n", pageAddress, logHead.offset);
+    logHead.offset = PAGE_SIZE_DATAFLASH;
+  }
+
+  newMeasurementId = logHead.firstMeasurementId + logHead.count;
+  tornPageCheck = true;
+
+  return true;
+}
+
+/**
+ * @fn void saveMeasurementLogCheckpoint(void)
+ * @brief function to save head, tail and key-frames of the measurement log in FRAM.
+ *
+ */
+static void saveMeasurementLogCheckpoint( void )
+{
+  struct_measurementLogCheckpoint checkpoint;
+
+  checkpointGeneration++;
+
+  checkpoint.protocolId = MEASUREMENT_CHECKPOINT_PROTOCOL_ID;
+  checkpoint.keyFramesValid = keyFramesRestored;
+  checkpoint.generation = checkpointGeneration;
+  checkpoint.newMeasurementId = newMeasurementId;
+  checkpoint.oldestMeasurementId = oldestMeasurementId;
+  checkpoint.tailPageAddress = tailPageAddress;
+  checkpoint.headPageAddress = logHead.pageAddress;
+  checkpoint.eraseBlockAddress = eraseBlockAddress;
+  memcpy(checkpoint.keyFrames, keyFrames, sizeof(checkpoint.keyFrames));
+  checkpoint.crc16 = calculateCRC_CCITT((uint8_t*)&checkpoint.protocolId, sizeof(checkpoint) - sizeof(checkpoint.crc16));
+
+  saveMeasurementLogState((checkpointGeneration % MEASUREMENT_CHECKPOINT_COPIES) * sizeof(checkpoint), &checkpoint, sizeof(checkpoint));
+}
+
+/**
+ * @fn bool restoreMeasurementLogCheckpoint(void)
+ * @brief function to restore the measurement log from the checkpoint in FRAM.
+ * The head page is read to verify the checkpoint matches the dataflash.
+ *
+ * @return true = restored, false = no valid checkpoint
+ */
+static bool restoreMeasurementLogCheckpoint( void )
+{
+  struct_measurementLogCheckpoint checkpoint[MEASUREMENT_CHECKPOINT_COPIES];
+  struct_measurementLogCheckpoint * newest = NULL;
+  STRUCT_measurementPageHeader header;
+  uint32_t pageAddress;
+  int validCopies = 0;
+
+  restoreMeasurementLogState(0, checkpoint, sizeof(checkpoint));
+
+  for( int i = 0; i < MEASUREMENT_CHECKPOINT_COPIES; i++ )
+  {
+    if( checkpoint[i].crc16 != calculateCRC_CCITT((uint8_t*)&checkpoint[i].protocolId, sizeof(checkpoint[i]) - sizeof(checkpoint[i].crc16)) ||
+        checkpoint[i].protocolId != MEASUREMENT_CHECKPOINT_PROTOCOL_ID )
+    {
+      continue;
+    }
+
+    validCopies++;
+
+    if( newest == NULL || (int32_t)(checkpoint[i].generation - newest->generation) > 0 )
+    {
+      newest = &checkpoint[i];
+    }
+  }
+
+  if( newest == NULL )
+  {
+    APP_LOG(TS_OFF, VLEVEL_H, "MEASUREMENT: no valid checkpoint\r\n");
+    return false;
+  }
+
+  checkpointGeneration = newest->generation;
+
+  if( restoreMeasurementLogHead(newest->headPageAddress) == false || newMeasurementId < newest->newMeasurementId ||
+      newest->tailPageAddress >= MEASUREMENT_MEMEORY_SIZE )
+  {
+    APP_LOG(TS_OFF, VLEVEL_H, "MEASUREMENT: checkpoint does not match dataflash\r\n");
+    return false;
+  }
+
+  //erase interrupted by power loss, the block can look erased but must be erased again
+  if( newest->eraseBlockAddress < MEASUREMENT_MEMEORY_SIZE )
+  {
+    eraseBlockAddress = newest->eraseBlockAddress;
+    preEraseBlockAddress = MEASUREMENT_PAGE_NONE;
+  }
+
+  //checkpoint can be one write behind when power failed, follow pages written after the checkpoint
+  //staged records are always the latest of the log, there are no pages after them
+  pageAddress = getNextPageAddress(logHead.pageAddress);
+  while( logHead.pageAddress != getStagingPageAddress() &&
+         readCommittedPageHeader(&pageAddress, logHead.pageAddress, &header) && header.firstMeasurementId == newMeasurementId )
+  {
+    if( restoreMeasurementLogHead(pageAddress) == false )
+    {
+      break;
+    }
+    pageAddress = getNextPageAddress(logHead.pageAddress);
+  }
+
+  //head page can be changed by a write interrupted by power loss, without a new measurement
+  if( newMeasurementId != newest->newMeasurementId || logHead.pageAddress != newest->headPageAddress )
+  {
+    restoreMeasurementLogTail(); //key-frames are restored on first write
+    return true;
+  }
+
+  tailPageAddress = newest->tailPageAddress;
+  oldestMeasurementId = newest->oldestMeasurementId;
+
+  //an older copy can be used when the newest is corrupted, its tail block may be erased since
+  if( validCopies < MEASUREMENT_CHECKPOINT_COPIES &&
+      (readPageHeader(tailPageAddress, &header) == false || header.firstMeasurementId != oldestMeasurementId) )
+  {
+    restoreMeasurementLogTail();
+  }
+
+  if( newest->keyFramesValid == true )
+  {
+    memcpy(keyFrames, newest->keyFrames, sizeof(keyFrames));
+    keyFramesRestored = true;
+  }
+
+  return true;
+}
+
+/**
+ * @fn int8_t searchLatestMeasurementInDataflash(uint32_t*)
+ * @brief function to search the latest measurement record.
+ * a derivative of binary search algorithm is used on the page headers, counted from the start of the ring.
+ * All pages from the first page until the head have a first measurement ID equal or higher then the first page,
+ * the pages after the head are erased or contain older measurements of the previous turnover.
+ * Void pages are part of the sequence of the page after it, a torn page after the head is not.
+ * When the head page is found, the records in the page are counted.
+ *
+ * @param measurementId destination of found measurement record
+ * @return 0 = successful found, 1 = empty dataflash
+ */
+int8_t searchLatestMeasurementInDataflash( uint32_t * measurementId )
+{
+  uint32_t boundaryStart = 0;
+  uint32_t boundaryEnd = NUMBER_PAGES_FOR_MEASUREMENTS - 1;
+  uint32_t newReadingId;
+  uint32_t headPage;
+  uint32_t lastPage = NUMBER_PAGES_FOR_MEASUREMENTS - 1;
+  uint32_t pageAddress;
+  bool firstPageValid;
+  bool lastPageValid;
+
+  STRUCT_measurementPageHeader firstPage;
+  STRUCT_measurementPageHeader header;
+
+  //read first and last page
+  firstPageValid = readPageHeader(getRingPageAddress(0), &firstPage);
+  lastPageValid = readPageHeader(getRingPageAddress(lastPage), &header);
+
+  //last page can be void or torn by power loss, the head is then before it in the same block
+  while( lastPageValid == false && checkErased((uint8_t*)&header, sizeof(header)) == false && (lastPage % NUMBER_OF_PAGES_IN_4K_BLOCK_DATAFLASH) != 0 )
+  {
+    lastPage--;
+    lastPageValid = readPageHeader(getRingPageAddress(lastPage), &header);
+  }
+
+  if( firstPageValid == false && lastPageValid == false )
+  {
+    //empty dataflash
+    resetMeasurementLog();
+    *measurementId = 0;
+
+    APP_LOG(TS_OFF, VLEVEL_H, "Empty dataflash.\r\n");
+
+    return 1;
+  }
+
+  else if( firstPageValid == false )
+  {
+    //overflow, first block erased but not yet written, head is the last page
+    headPage = lastPage;
+
+    APP_LOG(TS_OFF, VLEVEL_H, "First page empty in dataflash, last page is head.\r\n");
+  }
+
+  else
+  {
+    //search the last page with an ID equal or higher then the first page
+    while( boundaryStart < boundaryEnd )
+    {
+      newReadingId = (boundaryStart + boundaryEnd + 1) >> 1;
+
+      pageAddress = getRingPageAddress(newReadingId);
+
+      if( readCommittedPageHeader(&pageAddress, getRingPageAddress(NUMBER_PAGES_FOR_MEASUREMENTS - 1), &header) &&
+          header.firstMeasurementId >= firstPage.firstMeasurementId )
+      {
+        boundaryStart = newReadingId; //page is part of the newest sequence, head is further
+      }
+      else
+      {
+        boundaryEnd = newReadingId - 1; //page is empty or older, head is before
+      }
+
+      APP_LOG(TS_OFF, VLEVEL_H, "Search between page %u and page %u\r\n", boundaryStart, boundaryEnd );
+    }
+
+    headPage = boundaryStart;
+  }
+
+  if( restoreMeasurementLogHead(getRingPageAddress(headPage)) == false )
+  {
+    APP_LOG(TS_OFF, VLEVEL_H, "Head page %u not valid\r\n", headPage);
+    return -1;
+  }
+
+  restoreMeasurementLogTail();
+
+  if( newMeasurementId == 0 )
+  {
+    //page header written, but no measurements
+    *measurementId = 0;
+    return 1;
+  }
+
+  *measurementId = newMeasurementId - 1;
+
+  APP_LOG(TS_OFF, VLEVEL_H, "Head page %u, latest ID %u, oldest ID %u.\r\n", headPage, *measurementId, oldestMeasurementId);
+
+  return 0;
+}
+
+/**
+ * @fn int8_t restoreLatestMeasurementId(void)
+ * @brief function to read the latest measurement ID from FRAM checkpoint, backup memory or dataflash
+ * result is stored locally in "measurement.c"
+ *
+ * @return 2 = successful from checkpoint, 1= successful from backup register, 0 = successful from dataflash search, -1 failed
+ */
+int8_t restoreLatestMeasurementId(void)
+{
+  uint32_t readLatestId = 0;
+  uint32_t readLatestIdFromBackupRegister = 0;
+  int8_t result;
+
+  keyFramesRestored = false; //key-frames of slots are restored on first write
+  pageBufferAddress = MEASUREMENT_PAGE_NONE; //page can be changed by a write interrupted by power loss
+  restoreStagedRecords(checkRecordCommitted);
+
+  //background erase that is not finished is started again, the supply can be lost before it is finished
+  if( eraseBlockAddress != MEASUREMENT_PAGE_NONE )
+  {
+    preEraseBlockAddress = MEASUREMENT_PAGE_NONE;
+  }
+
+  APP_LOG(TS_OFF, VLEVEL_H, "Reset cause: %x\r\n", getResetSource() );
+
+  if (getResetBackup())
+  {
+    APP_LOG(TS_OFF, VLEVEL_H, "VBACKUP: reset detect\r\n");
+  }
+
+  //checkpoint in FRAM survives power off
+  if( restoreMeasurementLogCheckpoint() )
+  {
+    readyForMeasurement = true;
+
+    writeBackupRegister(BACKUP_REGISTER_LATEST_MEASUREMENT_ID, newMeasurementId);
+    writeBackupRegister(BACKUP_REGISTER_LATEST_MEASUREMENT_PAGE, logHead.pageAddress);
+    writeBackupRegister(BACKUP_REGISTER_OLDEST_MEASUREMENT_ID, oldestMeasurementId);
+
+    APP_LOG(TS_OFF, VLEVEL_H, "New measurement ID from checkpoint: %u\r\n", newMeasurementId);
+
+    return 2;
+  }
+
+  //check no power on reset
+  if( getResetBackup() == false )
+  {
+    readLatestIdFromBackupRegister = readBackupRegister( BACKUP_REGISTER_LATEST_MEASUREMENT_ID ); //get value from backup register
+
+    //verify head page in dataflash
+    if( restoreMeasurementLogHead(readBackupRegister(BACKUP_REGISTER_LATEST_MEASUREMENT_PAGE)) && newMeasurementId == readLatestIdFromBackupRegister )
+    {
+      restoreMeasurementLogTail();
+      readyForMeasurement = true;
+
+      saveMeasurementLogCheckpoint();
+
+      APP_LOG(TS_OFF, VLEVEL_H, "New measurement ID from backup register: %u\r\n", newMeasurementId);
+
+      return 1;
+    }
+
+    else
+    {
+      APP_LOG(TS_OFF, VLEVEL_H, "Mismatch in backup register\r\n" );
+    }
+  }
+
+  else
+  {
+    //nothing
+    APP_LOG(TS_OFF, VLEVEL_H, "PowerOnReset\r\n" );
+  }
+
+
+  //Power on reset or backup register corrupted
+  result = searchLatestMeasurementInDataflash( &readLatestId );
+
+  if( result < 0 ) //check on error
+  {
+    assert_param(1);
+    APP_LOG(TS_OFF, VLEVEL_H, "Restore measurement ID failes\r\n" );
+    return -1;
+  }
+
+  readyForMeasurement = true;
+
+  writeBackupRegister(BACKUP_REGISTER_LATEST_MEASUREMENT_ID, newMeasurementId); //save new value in backup register
+  writeBackupRegister(BACKUP_REGISTER_LATEST_MEASUREMENT_PAGE, logHead.pageAddress);
+  writeBackupRegister(BACKUP_REGISTER_OLDEST_MEASUREMENT_ID, oldestMeasurementId);
+  saveMeasurementLogCheckpoint();
+
+  APP_LOG(TS_OFF, VLEVEL_H, "New measurement ID by searching: %u\r\n", newMeasurementId);
+
+  return 0;
+}
+
+/**
+ * @fn int8_t locateMeasurementPage(uint32_t, uint32_t*, uint32_t*)
+ * @brief function to find the page containing a measurement ID.
+ * The pages between the tail and the head have increasing IDs, a binary search on the page headers is used.
+ *
+ * @param measurementId : ID to find
+ * @param pageAddress : destination of page address
+ * @param firstMeasurementId : destination of the first ID in the page
+ * @return 0 = found, -1 = ID not available in dataflash
+ */
+static int8_t locateMeasurementPage( uint32_t measurementId, uint32_t * pageAddress, uint32_t * firstMeasurementId )
+{
+  STRUCT_measurementPageHeader header;
+  uint32_t boundaryStart = 0;
+  uint32_t boundaryEnd = ((logHead.pageAddress + MEASUREMENT_MEMEORY_SIZE - tailPageAddress) % MEASUREMENT_MEMEORY_SIZE) / PAGE_SIZE_DATAFLASH;
+  uint32_t newReadingId;
+  uint32_t readAddress;
+
+  if( measurementId >= newMeasurementId || measurementId < oldestMeasurementId )
+  {
+    return -1;
+  }
+
+  //check head page
+  if( measurementId >= logHead.firstMeasurementId )
+  {
+    *pageAddress = logHead.pageAddress;
+    *firstMeasurementId = logHead.firstMeasurementId;
+    return 0;
+  }
+
+  //check page in buffer, or the page after it for sequential reads
+  if( pageBufferAddress != MEASUREMENT_PAGE_NONE && readPageHeader(pageBufferAddress, &header) && measurementId >= header.firstMeasurementId )
+  {
+    uint16_t endOffset;
+    uint32_t nextFirstMeasurementId = header.firstMeasurementId + scanPage(pageBuffer, &endOffset);
+
+    if( measurementId < nextFirstMeasurementId )
+    {
+      *pageAddress = pageBufferAddress;
+      *firstMeasurementId = header.firstMeasurementId;
+      return 0;
+    }
+
+    if( measurementId == nextFirstMeasurementId && readPageHeader(getNextPageAddress(pageBufferAddress), &header) && header.firstMeasurementId == measurementId )
+    {
+      *pageAddress = getNextPageAddress(pageBufferAddress);
+      *firstMeasurementId = header.firstMeasurementId;
+      return 0;
+    }
+  }
+
+  //binary search between tail and head
+  while( boundaryStart < boundaryEnd )
+  {
+    newReadingId = (boundaryStart + boundaryEnd + 1) >> 1;
+    readAddress = (tailPageAddress + newReadingId * PAGE_SIZE_DATAFLASH) % MEASUREMENT_MEMEORY_SIZE;
+
+    if( readCommittedPageHeader(&readAddress, logHead.pageAddress, &header) && header.firstMeasurementId <= measurementId )
+    {
+      boundaryStart = newReadingId;
+    }
+    else
+    {
+      boundaryEnd = newReadingId - 1;
+    }
+  }
+
+  *pageAddress = (tailPageAddress + boundaryStart * PAGE_SIZE_DATAFLASH) % MEASUREMENT_MEMEORY_SIZE;
+
+  if( readPageHeader(*pageAddress, &header) == false || header.firstMeasurementId > measurementId )
+  {
+    return -1;
+  }
+
+  *firstMeasurementId = header.firstMeasurementId;
+
+  return 0;
+}
+
+/**
+ * @fn int8_t restoreLatestTimeFromMeasurement(void)
+ * @brief function to load system time from latest dataflash measurement
+ *
+ * @return 0 = successful.
+ */
+int8_t restoreLatestTimeFromMeasurement(void)
+{
+  assert_param( readyForMeasurement == false ); //check saving measurements is possible
+  assert_param( newMeasurementId == 0 ); //check previous measurement ID exist.
+
+  //check saving measurements is possible
+  if( readyForMeasurement == false )
+  {
+    return -1;
+  }
+
+  //check current measurement ID is not zero, then no previous registrations
+  if( newMeasurementId == 0 )
+  {
+    return -2;
+  }
+
+  //read the previous measurementId.
+  if( readMeasurement(newMeasurementId - 1, (uint8_t*)&measurement, sizeof(measurement)) == 0)
+  {
+    //check the ID is not zero and not 0xFFFFFFFF
+    if( measurement.measurementId > 0 && measurement.measurementId != 0xFFFFFFFF )
+    {
+      //check saved timestamp is larger than current time
+      if( measurement.timestamp > SysTimeGet().Seconds )
+      {
+        SysTime_t newTime;
+        newTime.Seconds = measurement.timestamp;
+        newTime.SubSeconds = 0;
+        SysTimeSet( newTime );
+
+#if VERBOSE_LEVEL == VLEVEL_H
+
+         char timeStringNow[20] = {0};
+         struct tm stTime;
+         SysTimeLocalTime(SysTimeGet().Seconds, &stTime); //get system time
+         strftime(timeStringNow, sizeof(timeStringNow), "%d-%m-%Y %H:%M:%S", &stTime); //make date/time string
+         APP_LOG(TS_OFF, VLEVEL_H, "Time: restored from latest measurement: %s\r\n", timeStringNow);
+
+#endif
+      }
+      else
+      { //current time is newer, do not restore old time
+        APP_LOG(TS_OFF, VLEVEL_H, "Time: current time is newer, time not restored\r\n");
+        return -5;
+      }
+    }
+    else
+    { //no valid ID
+      APP_LOG(TS_OFF, VLEVEL_H, "Time: ERROR, no valid dataflash ID \r\n");
+      return -4;
+    }
+  }
+  else
+  { //failed to read
+    APP_LOG(TS_OFF, VLEVEL_H, "Time: ERROR, failed to read from dataflash\r\n");
+    return -3;
+  }
+
+  return 0;
+}
+/**
+ * @fn void releaseMeasurementBlock(uint32_t)
+ * @brief function to remove a 4K block from the ringbuffer before it is erased.
+ * The buffers of the block are invalidated and the oldest measurements are moved to the next block, the erase is counted for the wear statistics.
+ *
+ * @param blockAddress : address of the block
+ */
+static void releaseMeasurementBlock( uint32_t blockAddress )
+{
+  STRUCT_measurementPageHeader header;
+
+  if( pageBufferAddress / BLOCK_4K_SIZE_DATAFLASH == blockAddress / BLOCK_4K_SIZE_DATAFLASH )
+  {
+    pageBufferAddress = MEASUREMENT_PAGE_NONE; //buffered page is erased
+  }
+
+  if( keyFrameBufferAddress / BLOCK_4K_SIZE_DATAFLASH == blockAddress / BLOCK_4K_SIZE_DATAFLASH )
+  {
+    keyFrameBufferAddress = MEASUREMENT_PAGE_NONE; //buffered key-frame is erased
+  }
+
+  //oldest measurements are now in the next block
+  if( tailPageAddress / BLOCK_4K_SIZE_DATAFLASH == blockAddress / BLOCK_4K_SIZE_DATAFLASH )
+  {
+    tailPageAddress = getNextBlockAddress(blockAddress);
+    if( readPageHeader(tailPageAddress, &header) )
+    {
+      oldestMeasurementId = header.firstMeasurementId;
+    }
+    writeBackupRegister(BACKUP_REGISTER_OLDEST_MEASUREMENT_ID, oldestMeasurementId);
+  }
+
+  countMeasurementBlockErase(blockAddress, newMeasurementId);
+}
+
+/**
+ * @fn int8_t preEraseMeasurementBlock(void)
+ * @brief function to start the erase of the next 4K block when the current block is almost full, see \ref MEASUREMENT_PRE_ERASE_PAGE.
+ * The erase runs in background, reads and writes of other blocks suspend it.
+ * The dataflash supply must stay on until \ref finishPreEraseMeasurementBlock is called.
+ *
+ * @return 0 = erase started or block already erased, 1 = block not yet almost full, -1 = saving measurements not possible
+ */
+int8_t preEraseMeasurementBlock( void )
+{
+  STRUCT_measurementPageHeader header;
+  uint32_t blockAddress = getNextBlockAddress(logHead.pageAddress);
+
+  if( readyForMeasurement == false )
+  {
+    return -1;
+  }
+
+  if( preEraseBlockAddress == blockAddress )
+  {
+    return 0; //already started
+  }
+
+  if( (logHead.pageAddress % BLOCK_4K_SIZE_DATAFLASH) / PAGE_SIZE_DATAFLASH < MEASUREMENT_PRE_ERASE_PAGE )
+  {
+    return 1;
+  }
+
+  readPageFromDataflash(blockAddress, (uint8_t*)&header, sizeof(header));
+
+  if( checkErased((uint8_t*)&header, sizeof(header)) == false || eraseBlockAddress == blockAddress )
+  {
+    releaseMeasurementBlock(blockAddress);
+    eraseBlockAddress = blockAddress;
+    saveMeasurementLogCheckpoint();
+
+    startBlockErase4kDataflash(blockAddress);
+
+    APP_LOG(TS_OFF, VLEVEL_H, "MEASUREMENT: erase block 0x%08x started\r\n", blockAddress );
+  }
+
+  preEraseBlockAddress = blockAddress;
+
+  return 0;
+}
+
+/**
+ * @fn void finishPreEraseMeasurementBlock(void)
+ * @brief function to wait until the erase started by \ref preEraseMeasurementBlock is finished, call before the dataflash supply is switched off.
+ * The finished erase is saved in the checkpoint, an erase interrupted by power loss is repeated after restore.
+ *
+ */
+void finishPreEraseMeasurementBlock( void )
+{
+  if( preEraseBlockAddress != MEASUREMENT_PAGE_NONE )
+  {
+    finishEraseDataflash();
+
+    if( eraseBlockAddress == preEraseBlockAddress )
+    {
+      eraseBlockAddress = MEASUREMENT_PAGE_NONE;
+      saveMeasurementLogCheckpoint();
+    }
+  }
+}
+
+/**
+ * @fn int8_t setMeasurementLogVerify(uint8_t)
+ * @brief function to set the read back of new records after writing.
+ *
+ * @param verify : \ref MEASUREMENT_VERIFY_NONE, \ref MEASUREMENT_VERIFY_HEADER, \ref MEASUREMENT_VERIFY_CRC or \ref MEASUREMENT_VERIFY_FULL
+ * @return 0 = successful, -1 = verify not valid
+ */
+int8_t setMeasurementLogVerify( uint8_t verify )
+{
+  if( verify > MEASUREMENT_VERIFY_FULL )
+  {
+    return -1;
+  }
+
+  measurementVerify = verify;
+
+  return 0;
+}
+
+/**
+ * @fn int8_t verifyRecord(uint32_t, const STRUCT_measurementRecord*, uint32_t, const uint8_t*, uint16_t)
+ * @brief function to read back a written record, depending on \ref measurementVerify.
+ *
+ * @param recordAddress : address of the record in dataflash
+ * @param record : written record, full or delta
+ * @param programAddress : address of programmed data, including page header
+ * @param programData : programmed data
+ * @param programLength : number of programmed bytes
+ * @return 0 = successful, -1 = record not equal
+ */
+static int8_t verifyRecord( uint32_t recordAddress, const STRUCT_measurementRecord * record, uint32_t programAddress, const uint8_t * programData, uint16_t programLength )
+{
+  uint8_t * readBack = (uint8_t *)&measurement;
+
+  switch( measurementVerify )
+  {
+    case MEASUREMENT_VERIFY_HEADER:
+      readPageFromDataflash(recordAddress, readBack, MEASUREMENT_RECORD_CRC_OFFSET);
+      if( memcmp(readBack, record, MEASUREMENT_RECORD_CRC_OFFSET) != 0 )
+      {
+        return -1;
+      }
+      break;
+
+    case MEASUREMENT_VERIFY_CRC:
+      readPageFromDataflash(recordAddress, readBack, record->length);
+      if( readBack[0] != record->length || readBack[1] != record->recordType ||
+          ((const STRUCT_measurementRecord *)readBack)->crc != calculateCRC_CCITT(&readBack[MEASUREMENT_RECORD_CRC_OFFSET], record->length - MEASUREMENT_RECORD_CRC_OFFSET) )
+      {
+        return -1;
+      }
+      break;
+
+    case MEASUREMENT_VERIFY_FULL:
+      readPageFromDataflash(programAddress, readBack, programLength);
+      if( memcmp(readBack, programData, programLength) != 0 )
+      {
+        return -1;
+      }
+      break;
+
+    default: //no read back
+      break;
+  }
+
+  return 0;
+}
+
+/**
+ * @fn int8_t flushStagedRecords(void)
+ * @brief function to program the staged records in dataflash with one page program.
+ * The staged records are kept in FRAM when programming fails, they are programmed again at the next flush.
+ *
+ * @return 0 = successful, -5 = program failed, -6 = read back of the last record not equal
+ */
+static int8_t flushStagedRecords( void )
+{
+  const STRUCT_measurementRecord * record;
+  uint8_t * stagedData;
+  uint32_t stagingAddress;
+  uint32_t recordAddress;
+  uint16_t stagingLength;
+  uint8_t stagingCount = getStagedRecordCount();
+  int8_t result;
+
+  if( stagingCount == 0 )
+  {
+    return 0;
+  }
+
+  stagedData = getStagedData(&stagingAddress, &stagingLength);
+
+  if( measurementVerify == MEASUREMENT_VERIFY_FULL )
+  {
+    result = writeDataInDataflash(stagingAddress, stagedData, stagingLength);
+  }
+  else
+  {
+    result = programDataInDataflash(stagingAddress, stagedData, stagingLength);
+  }
+
+  if( result != 0 )
+  {
+    APP_LOG(TS_OFF, VLEVEL_H, "MEASUREMENT: staged records not written to dataflash\r\n");
+    return -5;
+  }
+
+  APP_LOG(TS_OFF, VLEVEL_H, "Measurement ID %u until %u written to dataflash\r\n", newMeasurementId - stagingCount, newMeasurementId - 1);
+
+  //the last record is read back, a full verify compares all programmed bytes
+  record = getStagedRecord(stagingCount - 1, &recordAddress);
+  result = verifyRecord(recordAddress, record, stagingAddress, stagedData, stagingLength);
+
+  discardStagedRecords();
+
+  if( result != 0 )
+  {
+    APP_LOG(TS_OFF, VLEVEL_H, "Measurement failed to write dataflash: %u\r\n", newMeasurementId - 1);
+    return -6;
+  }
+
+  return 0;
+}
+
+/**
+ * @fn int8_t flushMeasurementLog(void)
+ * @brief function to program the measurements staged in FRAM in dataflash, f.e. when USB is connected.
+ *
+ * @return 0 = successful, < 0 = error
+ */
+int8_t flushMeasurementLog( void )
+{
+  return flushStagedRecords();
+}
+
+/**
+ * @fn uint32_t skipTornPages(uint32_t)
+ * @brief function to check the header of the next page of the log is erased before it is written.
+ * A page written by an interrupted write is made void and skipped.
+ *
+ * @param pageAddress : next page of the log
+ * @return page to write
+ */
+static uint32_t skipTornPages( uint32_t pageAddress )
+{
+  STRUCT_measurementPageHeader header;
+  uint8_t format = MEASUREMENT_PAGE_FORMAT_VOID;
+
+  //first page of a block is checked before the block is used
+  while( (pageAddress % BLOCK_4K_SIZE_DATAFLASH) != 0 )
+  {
+    readPageFromDataflash(pageAddress, (uint8_t*)&header, sizeof(header));
+
+    if( checkErased((uint8_t*)&header, sizeof(header)) )
+    {
+      break;
+    }
+
+    APP_LOG(TS_OFF, VLEVEL_H, "MEASUREMENT: torn page 0x%08x made void\r\n", pageAddress);
+
+    if( header.format != MEASUREMENT_PAGE_FORMAT_VOID )
+    {
+      programDataInDataflash(pageAddress, &format, sizeof(format));
+    }
+
+    pageAddress = getNextPageAddress(pageAddress);
+  }
+
+  return pageAddress;
+}
+
+/**
+ * @fn int8_t writeNewMeasurement(uint8_t, uint8_t*, uint8_t)
+ * @brief function to write a new measurement
+ *
+ * @param sensorModuleType
+ * @param sensorData
+ * @param dataLength
+ * @return 0 = successful, -5 = failed to write, -6 = written but verify failed
+ */
+int8_t writeNewMeasurement( uint8_t MFM_protocol, struct_MFM_sensorModuleData * sensorModuleData, struct_MFM_baseData * MFM_data)
+{
+  int8_t result;
+  uint8_t programBuffer[sizeof(STRUCT_measurementPageHeader) + sizeof(STRUCT_measurementRecord)];
+  uint16_t programLength;
+  uint32_t programAddress;
+  uint32_t recordAddress;
+  int8_t verifyResult;
+  STRUCT_measurementDeltaRecord delta;
+  uint8_t slot;
+  struct_measurementLogHead previousHead = logHead;
+  bool staging = getMeasurementLogStaging() > 1;
+
+  static_assert (sizeof(struct_MFM_sensorModuleData) == MAX_SENSOR_MODULE_DATA, "Size struct_MFM_sensorModuleData is not correct");
+  static_assert (sizeof(struct_MFM_baseData) == MAX_BASE_MODULE_DATA, "Size struct_MFM_baseData is not correct");
+  static_assert (sizeof(STRUCT_measurementData) == MAX_SIZE_MEASUREMENTDATA, "Size STRUCT_measurementData is not correct");
+  static_assert (sizeof(STRUCT_measurementPageHeader) + sizeof(STRUCT_measurementRecord) <= PAGE_SIZE_DATAFLASH, "Size STRUCT_measurementRecord is too large");
+
+  assert_param( readyForMeasurement == true ); //check saving measurements is possible
+  assert_param( sensorModuleData != 0 ); //check pointer is not zero
+  assert_param( MFM_data != 0 ); //check pointer is not zero
+  assert_param( sensorModuleData->sensorModuleDataSize <= sizeof(sensorModuleData->sensorModuleData) ); //check maximum supported datasize.
+
+  if (sensorModuleData == 0)
+  {
+    APP_LOG(TS_OFF, VLEVEL_H, "MEASUREMENT: sensor module data pointer is zero\r\n");
+    return -1;
+  }
+
+  if (sensorModuleData->sensorModuleDataSize > sizeof(sensorModuleData->sensorModuleData))
+  {
+    APP_LOG(TS_OFF, VLEVEL_H, "MEASUREMENT: sensor module data too large\r\n");
+    return -2;
+  }
 
-/**
- * @fn int8_t searchLatestMeasurementInDataflash(uint32_t*)
- * @brief function to search the latest measurement record.
- * a derivative of binary search algorithm is used.
- * Based on the first item in dataflash and latest item is filled the algorithm start searching for the highest.
- * When the item is found a check is done to make sure the next item is smaller or empty.
- *
- * @param measurementId destionation of found measurement record
- * @return 0 = succesfull found, 1 = empty dataflash
- */
-int8_t searchLatestMeasurementInDataflash( uint32_t * measurementId )
-{
-  uint32_t boundaryStart = 0;
-  uint32_t boundaryEnd = NUMBER_PAGES_FOR_MEASUREMENTS;
+  if( readyForMeasurement == false )
+  {
+    APP_LOG(TS_OFF, VLEVEL_H, "MEASUREMENT: saving measurements is not possible\r\n");
+    return -3;
+  }
 
-  uint32_t highestMeasurementId;
-  uint32_t firstRecordMeasurementId;
-  uint32_t lastRecordMeasurementId;
-  uint32_t newReadingId;
+  if (MFM_data == 0)
+  {
+    APP_LOG(TS_OFF, VLEVEL_H, "MEASUREMENT: MFM_data pointer is zero\r\n");
+    return -4;
+  }
 
-  UNION_measurementData * pMeasurment = (UNION_measurementData *)&measurement;
+  STRUCT_measurementRecord * record = (STRUCT_measurementRecord *)&programBuffer[sizeof(STRUCT_measurementPageHeader)];
+  uint8_t * programData = (uint8_t *)record;
 
-  //read first record
-  readMeasurementFromDataflash(0, (uint8_t *) &measurement, sizeof(measurement));
-  firstRecordMeasurementId = pMeasurment->measurementData.measurementId;
+  //fill in record, get system time, if time not yet in sync start from 0, otherwise unix timestamp
+  encodeFullRecord(record, SysTimeGet().Seconds, MFM_protocol, sensorModuleData, MFM_data);
 
-  //read latest record
-  readMeasurementFromDataflash(NUMBER_PAGES_FOR_MEASUREMENTS - 1, (uint8_t *) &measurement, sizeof(measurement));
-  lastRecordMeasurementId = pMeasurment->measurementData.measurementId;
+  slot = record->sensorModuleSlotId - 1;
 
-  //determine ringbuffer is in overflow
-  if( firstRecordMeasurementId == 0xFFFFFFFFUL && lastRecordMeasurementId == 0xFFFFFFFFUL )
+  //try to encode record as delta against latest key-frame of slot
+  if( keyFramesRestored == false )
   {
-    //empty dataflash
-    *measurementId = 0;
-
-    APP_LOG(TS_OFF, VLEVEL_H, "Empty dataflash.\r\n");
+    restoreKeyFrames();
+  }
 
-    return 1;
+  if( encodeDeltaRecord(record, &delta) == 0 )
+  {
+    delta.length = 0; //write full record
   }
 
-  else if ( lastRecordMeasurementId == 0xFFFFFFFFUL )
+  programLength = delta.length ? delta.length : record->length;
+
+  //check record fits in current page, otherwise start a new page
+  if( logHead.offset + programLength > PAGE_SIZE_DATAFLASH )
   {
-    //no overflow first line filled, last not yet
-    highestMeasurementId = firstRecordMeasurementId;
+    STRUCT_measurementPageHeader * header = (STRUCT_measurementPageHeader *)programBuffer;
+    uint32_t pageAddress = getNextPageAddress(logHead.pageAddress);
+
+    //staged records belong to the head page, they are programmed before a new page is started
+    if( flushStagedRecords() == -5 )
+    {
+      return -5;
+    }
+
+    //first new page after a restore can be torn by power loss
+    if( tornPageCheck == true )
+    {
+      pageAddress = skipTornPages(pageAddress);
+      tornPageCheck = false;
+    }
+
+    //check page is first of new block, then block must be erased after turnover
+    if( (pageAddress % BLOCK_4K_SIZE_DATAFLASH) == 0 )
+    {
+      //key-frames are only referenced within a block, first record of each slot in new block is a key-frame
+      for( int i = 0; i < MEASUREMENT_NUMBER_OF_SLOTS; i++ )
+      {
+        keyFrames[i].address = MEASUREMENT_PAGE_NONE;
+      }
+      delta.length = 0;
+      programLength = record->length;
 
-    APP_LOG(TS_OFF, VLEVEL_H, "No overflow in dataflash.\r\n");
+      //block is normally erased in background by preEraseMeasurementBlock()
+      if( preEraseBlockAddress == pageAddress )
+      {
+        finishEraseDataflash();
+      }
+      else
+      {
+        readPageFromDataflash(pageAddress, (uint8_t*)header, sizeof(STRUCT_measurementPageHeader));
+
+        if( checkErased((uint8_t*)header, sizeof(STRUCT_measurementPageHeader)) == false || eraseBlockAddress == pageAddress )
+        {
+          releaseMeasurementBlock(pageAddress);
+          eraseBlockAddress = pageAddress;
+          saveMeasurementLogCheckpoint();
+          blockErase4kDataflash(pageAddress);
+        }
+      }
+      preEraseBlockAddress = MEASUREMENT_PAGE_NONE;
+      eraseBlockAddress = MEASUREMENT_PAGE_NONE; //saved with the checkpoint of this record
+    }
+
+    //new page header, written together with the first record
+    header->format = MEASUREMENT_PAGE_FORMAT_PACKED;
+    header->spare = 0xFF;
+    header->firstMeasurementId = newMeasurementId;
+    header->firstTimestamp = record->timestamp;
+    header->crc = calculatePageHeaderCrc(header);
+
+    logHead.pageAddress = pageAddress;
+    logHead.firstMeasurementId = newMeasurementId;
+    logHead.offset = sizeof(STRUCT_measurementPageHeader);
+    logHead.count = 0;
+
+    programData = programBuffer;
+    programLength += sizeof(STRUCT_measurementPageHeader);
   }
 
-  else if ( firstRecordMeasurementId == 0xFFFFFFFFUL )
+  if( delta.length != 0 )
   {
-    //overflow, first line empty
-    *measurementId = lastRecordMeasurementId;
+    memcpy(record, &delta, delta.length); //replace full record by delta record
+  }
 
-    APP_LOG(TS_OFF, VLEVEL_H, "First line empty in dataflash, last line %u with ID %u.\r\n", NUMBER_PAGES_FOR_MEASUREMENTS - 1, lastRecordMeasurementId);
+  recordAddress = logHead.pageAddress + logHead.offset;
+  programAddress = recordAddress + record->length - programLength;
 
-    return 0;
-  }
+  if( staging == true )
+  {
+    //staging area full, the staged records are programmed and a new staging cycle is started
+    if( checkStagingSpace(programLength) == false && flushStagedRecords() == -5 )
+    {
+      return -5;
+    }
 
+    //record is collected in FRAM, programmed in dataflash together with the next records
+    stageLogData(programAddress, programData, programLength, logHead.firstMeasurementId, logHead.count);
+    result = 0;
+  }
   else
   {
-    //overflow, first and last line filled.
-    highestMeasurementId = firstRecordMeasurementId;
+    //records staged with a previous setting are programmed first
+    if( flushStagedRecords() == -5 )
+    {
+      return -5;
+    }
 
-    APP_LOG(TS_OFF, VLEVEL_H, "Overflow in dataflash.\r\n");
+    //write new measurement to dataflash, the erased check before writing is only done as diagnostic
+    if( measurementVerify == MEASUREMENT_VERIFY_FULL )
+    {
+      result = writeDataInDataflash(programAddress, programData, programLength);
+    }
+    else
+    {
+      result = programDataInDataflash(programAddress, programData, programLength);
+    }
   }
 
-  while( boundaryStart <= boundaryEnd )
+  //check result
+  if( result == 0 ) //success
   {
-    newReadingId = (boundaryStart + boundaryEnd) >> 1;
-
-    //read page
-    readMeasurementFromDataflash(newReadingId, (uint8_t *) &measurement, sizeof(measurement));
+    if( staging == true )
+    {
+      APP_LOG(TS_OFF, VLEVEL_H, "Measurement ID %u staged in FRAM\r\n", newMeasurementId );
 
-    if( pMeasurment->measurementData.measurementId != 0xFFFFFFFF )
+      verifyResult = 0; //staged records are verified when they are programmed
+    }
+    else
     {
-      //page contain measurement, new value is further
-      if (pMeasurment->measurementData.measurementId < highestMeasurementId)
-      {
-        //value on newReadingId is smaller, then decrease the end boundary
-        boundaryEnd = newReadingId - 1;
-      }
+      APP_LOG(TS_OFF, VLEVEL_H, "Measurement ID %u written to dataflash\r\n", newMeasurementId );
+
+      //verify record, the record is kept when verify fails, a corrupt record is skipped at reading
+      verifyResult = verifyRecord(recordAddress, record, programAddress, programData, programLength);
 
-      else if (pMeasurment->measurementData.measurementId > highestMeasurementId)
+      if( verifyResult != 0 )
       {
-        //value larger then previous, then increase the start boundary.
-        highestMeasurementId = pMeasurment->measurementData.measurementId;
-        boundaryStart = newReadingId + 1;
+        APP_LOG(TS_OFF, VLEVEL_H, "Measurement failed to write dataflash: %u\r\n", newMeasurementId );
       }
+    }
 
-      else
-      { //no change, item found
-        int8_t timeout = NUMBER_OF_PAGES_IN_4K_BLOCK_DATAFLASH; //max of one block can be erased in between.
+    if( pageBufferAddress == logHead.pageAddress )
+    {
+      pageBufferAddress = MEASUREMENT_PAGE_NONE; //buffered page is changed
+    }
 
-        //verify next item is not higher
-        do
-        {
-          readMeasurementFromDataflash(newReadingId + 1, (uint8_t *) &measurement, sizeof(measurement));
-          if (pMeasurment->measurementData.measurementId != 0xFFFFFFFF && pMeasurment->measurementData.measurementId > highestMeasurementId)
-          {
-            //value larger then previous, then take over this value
-            highestMeasurementId = pMeasurment->measurementData.measurementId;
-            newReadingId++;
-          }
-          timeout--;
-        } while( pMeasurment->measurementData.measurementId != 0xFFFFFFFF && pMeasurment->measurementData.measurementId >= highestMeasurementId && timeout >=0);
+    logHead.offset += record->length;
+    logHead.count++;
 
+    //update key-frame of slot
+    if( slot < MEASUREMENT_NUMBER_OF_SLOTS )
+    {
+      if( record->recordType == MEASUREMENT_RECORD_FULL )
+      {
+        keyFrames[slot].address = recordAddress;
+        keyFrames[slot].count = 1;
 
-        *measurementId = highestMeasurementId;
-        return 0;
+        memcpy(&keyFrameBuffer, record, record->length);
+        keyFrameBufferAddress = recordAddress;
+      }
+      else
+      {
+        keyFrames[slot].count++;
       }
     }
 
-    else
+    newMeasurementId++;
+    writeBackupRegister(BACKUP_REGISTER_LATEST_MEASUREMENT_ID, newMeasurementId);
+    writeBackupRegister(BACKUP_REGISTER_LATEST_MEASUREMENT_PAGE, logHead.pageAddress);
+    saveMeasurementLogCheckpoint();
+
+    //staged records are programmed in dataflash with one page program
+    if( getStagedRecordCount() >= getMeasurementLogStaging() )
     {
-      //page contain no data, new value is in upper half, decrease the end boundary
-      boundaryEnd = newReadingId - 1;
+      verifyResult = flushStagedRecords();
     }
 
+    if( verifyResult == -5 )
+    {
+      return -5; //staged in FRAM, programming is retried at the next flush
+    }
 
-    APP_LOG(TS_OFF, VLEVEL_H, "Search between address %u and address %u, highest found ID %u, last read ID %u.\r\n", boundaryStart, boundaryEnd, highestMeasurementId, pMeasurment->measurementData.measurementId );
+    if( verifyResult != 0 )
+    {
+      return -6; //written, but read back is not equal
+    }
   }
 
-  *measurementId = highestMeasurementId;
+  else //failed
+  {
+    assert_param(1);
+    APP_LOG(TS_OFF, VLEVEL_H, "Restore measurement ID failes\r\n" );
+
+    //record can be programmed partly, the rest of the page is not used and a new page is checked before it is used
+    logHead = previousHead;
+    logHead.offset = PAGE_SIZE_DATAFLASH;
+    pageBufferAddress = MEASUREMENT_PAGE_NONE;
+    tornPageCheck = true;
 
-  return 0;
+    return -5;//failed to write measurement
+  }
 
+  return 0;
 }
 
 /**
- * @fn int8_t restoreLatestMeasurementId(void)
- * @brief function to read the latest measurement ID from backup memory or dataflash
- * result is stored locally in "measurement.c"
+ * @fn int8_t readMeasurement(uint32_t, uint8_t*, uint32_t)
+ * @brief function to read measurement data from dataflash, the packed record is unpacked to \ref STRUCT_measurementData
  *
- * @return 1= successful from backup register, 0 = successful from dataflash search, -1 failed
+ * @param measurementId
+ * @param buffer
+ * @param bufferLength
+ * @return 0 = successful, < 0 is error
  */
-int8_t restoreLatestMeasurementId(void)
+int8_t readMeasurement( uint32_t measurementId, uint8_t * buffer, uint32_t bufferLength )
 {
-  uint32_t readLatestId = 0;
-  uint32_t readLatestIdFromBackupRegister = 0;
-  int8_t result;
+  uint32_t pageAddress;
+  uint32_t firstMeasurementId;
+  int16_t recordOffset;
+  const uint8_t * record;
+  uint32_t recordAddress;
+  STRUCT_measurementData * dest = (STRUCT_measurementData *)buffer;
 
-  UNION_measurementData * pUnMeasurement = (UNION_measurementData *)&measurement;
+  assert_param( buffer == 0);
+  assert_param( bufferLength == 0);
 
-  APP_LOG(TS_OFF, VLEVEL_H, "Reset cause: %x\r\n", getResetSource() );
+  if (buffer == 0)
+  {
+    return -1;
+  }
 
-  if (getResetBackup())
+  if (bufferLength == 0 )
   {
-    APP_LOG(TS_OFF, VLEVEL_H, "VBACKUP: reset detect\r\n");
+    return -2;
   }
 
-  //check no power on reset
-  if( getResetBackup() == false )
+  if( bufferLength < sizeof(STRUCT_measurementData) )
   {
-    readLatestIdFromBackupRegister = readBackupRegister( BACKUP_REGISTER_LATEST_MEASUREMENT_ID ); //get value from backup register
+    dest = &measurement; //unpack in local buffer first
+  }
 
-    //verify dataflash read
-    readMeasurementFromDataflash(readLatestIdFromBackupRegister - 1, (uint8_t *) &measurement, sizeof(measurement));
-    if( pUnMeasurement->measurementData.measurementId == readLatestIdFromBackupRegister - 1)
+  //latest records are staged in FRAM, the page is not read from dataflash
+  if( measurementId < newMeasurementId && measurementId >= newMeasurementId - getStagedRecordCount() )
+  {
+    record = (const uint8_t *)getStagedRecord(measurementId - (newMeasurementId - getStagedRecordCount()), &recordAddress);
+  }
+  else
+  {
+    if( locateMeasurementPage(measurementId, &pageAddress, &firstMeasurementId) != 0 )
     {
-      newMeasurementId = readLatestIdFromBackupRegister;
-      readyForMeasurement = true;
+      return -3; //not available
+    }
 
-      APP_LOG(TS_OFF, VLEVEL_H, "New measurement ID from backup register: %u\r\n", newMeasurementId);
+    if( loadPage(pageAddress) != 0 )
+    {
+      return -4;
+    }
 
-      return 1;
+    recordOffset = getRecordOffset(pageBuffer, measurementId - firstMeasurementId);
+    if( recordOffset < 0 )
+    {
+      return -5;
     }
 
-    else
+    record = &pageBuffer[recordOffset];
+    recordAddress = pageAddress + recordOffset;
+  }
+
+  if( decodeRecord(record, recordAddress, measurementId, dest) != 0 )
+  {
+    APP_LOG(TS_OFF, VLEVEL_H, "MEASUREMENT: record %u is corrupt\r\n", measurementId );
+    return -6;
+  }
+
+  if( dest == &measurement )
+  {
+    memcpy(buffer, &measurement, bufferLength);
+  }
+
+  return 0;
+}
+
+/**
+ * @fn int32_t printMeasurementData(uint32_t, uint8_t*, uint32_t)
+ * @brief function to print a measurement to a given buffer
+ *
+ * @param measurementId
+ * @param buffer
+ * @param bufferLength
+ * @return
+ */
+int32_t printMeasurementData( uint32_t measurementId, uint8_t * buffer, uint32_t bufferLength )
+{
+  if( readMeasurement(measurementId, (uint8_t*)&measurement, sizeof(measurement)) != 0 )
+  {
+    return -1;
+  }
+
+  uint32_t length = 0;
+
+  length += snprintf((char*) buffer + length, bufferLength - length, "%lu;", (unsigned long)measurement.measurementId);
+  length += snprintf((char*) buffer + length, bufferLength - length, "%lu;", (unsigned long)measurement.timestamp);
+  length += snprintf((char*) buffer + length, bufferLength - length, "%u;", measurement.sensorModuleData.sensorModuleSlotId);
+  length += snprintf((char*) buffer + length, bufferLength - length, "%u;", measurement.sensorModuleData.sensorModuleTypeId);
+  length += snprintf((char*) buffer + length, bufferLength - length, "%u;", measurement.sensorModuleData.sensorModuleProtocolId);
+  length += snprintf((char*) buffer + length, bufferLength - length, "%u;", measurement.sensorModuleData.sensorModuleDataSize);
+
+  if( length >= bufferLength )
+    return -1;
+
+  for (int i = 0; i < measurement.sensorModuleData.sensorModuleDataSize; i++)
+  {
+    length += snprintf((char*) buffer + length, bufferLength - length, "0x%02x", measurement.sensorModuleData.sensorModuleData[i]);
+
+    if( length >= bufferLength )
+        return -1;
+
+    if (i < (measurement.sensorModuleData.sensorModuleDataSize - 1))
     {
-      APP_LOG(TS_OFF, VLEVEL_H, "Mismatch in backup register\r\n" );
-      readMeasurementFromDataflash(readLatestIdFromBackupRegister - 1, (uint8_t *) &measurement, sizeof(measurement));
+      length += snprintf((char*) buffer + length, bufferLength, ",");
     }
+
+    if( length >= bufferLength )
+        return -1;
   }
 
-  else
+  length += snprintf((char*) buffer + length, bufferLength - length, ";");
+  length += snprintf((char*) buffer + length, bufferLength - length, "%u;", measurement.MFM_baseData.stBaseData.messageType);
+  length += snprintf((char*) buffer + length, bufferLength - length, "%u;", measurement.MFM_baseData.stBaseData.batteryStateEos);
+  length += snprintf((char*) buffer + length, bufferLength - length, "%d;", measurement.MFM_baseData.stBaseData.temperatureGauge);
+  length += snprintf((char*) buffer + length, bufferLength - length, "%d;", measurement.MFM_baseData.stBaseData.temperatureController);
+  length += snprintf((char*) buffer + length, bufferLength - length, "%u;", measurement.MFM_baseData.stBaseData.diagnosticBits);
+  for( uint32_t i = 0; i<sizeof(measurement.MFM_baseData.stBaseData.spare); i++ )
   {
-    //nothing
-    APP_LOG(TS_OFF, VLEVEL_H, "PowerOnReset\r\n" );
+    length += snprintf((char*) buffer + length, bufferLength - length, "%u;", measurement.MFM_baseData.stBaseData.spare[i]);
   }
 
+  length += snprintf((char*) buffer + length, bufferLength - length, "\r\n");
 
-  //Power on reset or backup register corrupted
-  result = searchLatestMeasurementInDataflash( &readLatestId );
+  if( length >= bufferLength )
+      return -1;
+
+  return length;
+}
 
-  readMeasurementFromDataflash(readLatestId, (uint8_t *) &measurement, sizeof(measurement));
+/**
+ * @fn int8_t decodeRangeRecord(uint32_t, uint16_t, uint32_t, uint8_t, STRUCT_measurementData*)
+ * @brief function to unpack a record of the page buffer during a continuous read.
+ * Key-frames are kept for each slot, only a key-frame before the start of the range is read separately.
+ * The slot of a delta record is the slot of its key-frame, records of other slots are not unpacked.
+ *
+ * @param pageAddress : address of page in buffer, continuous read is restarted at the next page when a key-frame is read.
+ * @param recordOffset : offset of the record in the page buffer
+ * @param measurementId : ID of the record
+ * @param slotId : sensor module slot to unpack, 0 = all slots
+ * @param dest : destination, NULL = record is only used as key-frame
+ * @return 0 = successful, 1 = record of other slot, < 0 = corrupt record
+ */
+static int8_t decodeRangeRecord( uint32_t pageAddress, uint16_t recordOffset, uint32_t measurementId, uint8_t slotId, STRUCT_measurementData * dest )
+{
+  const STRUCT_measurementRecord * record = (const STRUCT_measurementRecord *)&pageBuffer[recordOffset];
+  const STRUCT_measurementRecord * keyFrame = NULL;
+  uint32_t keyFrameAddress;
+  uint8_t slot;
+  int8_t result;
 
-  if( result < 0 ) //check on error
+  if( record->recordType == MEASUREMENT_RECORD_FULL )
+  {
+    slot = record->sensorModuleSlotId - 1;
+
+    //only the address is kept of key-frames of other slots, it is used to find the slot of delta records
+    if( slotId != 0 && record->sensorModuleSlotId != slotId )
+    {
+      if( slot < MEASUREMENT_NUMBER_OF_SLOTS )
+      {
+        rangeKeyFrames[slot].address = pageAddress + recordOffset;
+      }
+      return 1;
+    }
+
+    result = checkFullRecord(record);
+
+    if( result == 0 && slot < MEASUREMENT_NUMBER_OF_SLOTS )
+    {
+      rangeKeyFrames[slot].address = pageAddress + recordOffset;
+      memcpy(&rangeKeyFrames[slot].record, record, record->length);
+    }
+
+    if( result == 0 && dest != NULL )
+    {
+      decodeFullRecord(record, measurementId, dest);
+    }
+
+    return result;
+  }
+
+  if( dest == NULL )
+  {
+    return 0;
+  }
+
+  if( record->recordType != MEASUREMENT_RECORD_DELTA )
   {
-    assert_param(1);
-    APP_LOG(TS_OFF, VLEVEL_H, "Restore measurement ID failes\r\n" );
     return -1;
   }
 
-  else if ( result > 0 ) //check on empty dataflash
+  keyFrameAddress = getKeyFrameAddress((const STRUCT_measurementDeltaRecord *)record, pageAddress);
+
+  for( int i = 0; i < MEASUREMENT_NUMBER_OF_SLOTS; i++ )
   {
-    newMeasurementId = 0;
-    readyForMeasurement = true;
+    if( rangeKeyFrames[i].address == keyFrameAddress )
+    {
+      if( slotId != 0 && slotId != i + 1 )
+      {
+        return 1;
+      }
+      keyFrame = &rangeKeyFrames[i].record;
+    }
   }
 
-  else //okay, used read id.
-  {
-    newMeasurementId = readLatestId + 1;
-    readyForMeasurement = true;
-  }
+  //key-frame is before start of range, read it separately
+  if( keyFrame == NULL )
+  {
+    stopReadDataflash();
+    result = loadKeyFrame(keyFrameAddress);
+    startReadDataflash(getNextPageAddress(pageAddress));
+
+    if( result != 0 )
+    {
+      return -4;
+    }
+
+    slot = keyFrameBuffer.sensorModuleSlotId - 1;
+    if( slot < MEASUREMENT_NUMBER_OF_SLOTS )
+    {
+      rangeKeyFrames[slot].address = keyFrameAddress;
+      memcpy(&rangeKeyFrames[slot].record, &keyFrameBuffer, keyFrameBuffer.length);
+    }
 
-  writeBackupRegister(BACKUP_REGISTER_LATEST_MEASUREMENT_ID, newMeasurementId); //save new value in backup register
+    if( slotId != 0 && keyFrameBuffer.sensorModuleSlotId != slotId )
+    {
+      return 1;
+    }
 
-  APP_LOG(TS_OFF, VLEVEL_H, "New measurement ID by searching: %u\r\n", newMeasurementId);
+    keyFrame = &keyFrameBuffer;
+  }
 
-  return 0;
+  return decodeDeltaRecord((const STRUCT_measurementDeltaRecord *)record, keyFrame, measurementId, dest);
 }
 
 /**
- * @fn int8_t restoreLatestTimeFromMeasurement(void)
- * @brief function to load system time from latest dataflash measurement
+ * @fn int8_t readRange(uint32_t, uint32_t, uint8_t, measurementRangeCallback, void*)
+ * @brief function to read measurements [firstMeasurementId, endMeasurementId) with one continuous read of the dataflash.
+ * The dataflash I/O is enabled once, only the ring-buffer wrap restarts the read.
+ * Corrupt records are skipped. The callback must not use the dataflash.
  *
- * @return 0 = successful.
+ * @param firstMeasurementId : ID of first measurement
+ * @param endMeasurementId : ID after the last measurement, limited to the latest measurement ID
+ * @param slotId : sensor module slot to read, 0 = all slots
+ * @param callback : function called for each measurement, return < 0 to stop reading
+ * @param context : pointer passed to callback
+ * @return 0 = successful, 1 = stopped by callback, -1 = callback is zero, -2 = ID not available, -3 = page header not valid
  */
-int8_t restoreLatestTimeFromMeasurement(void)
+static int8_t readRange( uint32_t firstMeasurementId, uint32_t endMeasurementId, uint8_t slotId, measurementRangeCallback callback, void * context )
 {
-  assert_param( readyForMeasurement == false ); //check saving measurements is possible
-  assert_param( newMeasurementId == 0 ); //check previous measurement ID exist.
-
-  //check saving measurements is possible
-  if( readyForMeasurement == false )
+  STRUCT_measurementPageHeader * header = (STRUCT_measurementPageHeader *)pageBuffer;
+  STRUCT_measurementData data;
+  uint32_t pageAddress;
+  uint32_t measurementId;
+  uint16_t offset;
+  uint16_t recordOffset;
+  int8_t decodeResult;
+  int8_t result = 0;
+
+  assert_param( callback != 0 );
+
+  if( callback == 0 )
   {
     return -1;
   }
 
-  //check current measurement ID is not zero, then no previous registrations
-  if( newMeasurementId == 0 )
+  if( endMeasurementId > newMeasurementId )
+  {
+    endMeasurementId = newMeasurementId;
+  }
+
+  if( firstMeasurementId >= endMeasurementId )
+  {
+    return 0; //nothing to read
+  }
+
+  if( locateMeasurementPage(firstMeasurementId, &pageAddress, &measurementId) != 0 )
   {
     return -2;
   }
 
-  //read the previous measurementId.
-  if( readMeasurementFromDataflash(newMeasurementId - 1, (uint8_t*)&measurement, sizeof(measurement)) == 0)
+  for( int i = 0; i < MEASUREMENT_NUMBER_OF_SLOTS; i++ )
   {
-    //check the ID is not zero and not 0xFFFFFFFF
-    if( measurement.measurementId > 0 && measurement.measurementId != 0xFFFFFFFF )
+    rangeKeyFrames[i].address = MEASUREMENT_PAGE_NONE;
+  }
+
+  pageBufferAddress = MEASUREMENT_PAGE_NONE; //page buffer is used for continuous read
+
+  startReadDataflash(pageAddress);
+
+  while( measurementId < endMeasurementId && result == 0 )
+  {
+    continueReadDataflash(pageBuffer, sizeof(pageBuffer));
+    overlayStagedData(pageAddress, pageBuffer, sizeof(pageBuffer)); //latest records can be staged in FRAM
+
+    if( header->format == MEASUREMENT_PAGE_FORMAT_VOID ) //page torn by power loss, no records
     {
-      //check saved timestamp is larger than current time
-      if( measurement.timestamp > SysTimeGet().Seconds )
-      {
-        SysTime_t newTime;
-        newTime.Seconds = measurement.timestamp;
-        newTime.SubSeconds = 0;
-        SysTimeSet( newTime );
+      pageBufferAddress = MEASUREMENT_PAGE_NONE;
+      offset = PAGE_SIZE_DATAFLASH;
+    }
+    else if( header->format != MEASUREMENT_PAGE_FORMAT_PACKED || header->crc != calculatePageHeaderCrc(header) || header->firstMeasurementId != measurementId )
+    {
+      APP_LOG(TS_OFF, VLEVEL_H, "MEASUREMENT: page header not valid at 0x%08x\r\n", pageAddress );
+      result = -3;
+      break;
+    }
+    else
+    {
+      pageBufferAddress = pageAddress;
+      offset = sizeof(STRUCT_measurementPageHeader);
+    }
 
-#if VERBOSE_LEVEL == VLEVEL_H
+    recordOffset = offset;
 
-         char timeStringNow[20] = {0};
-         struct tm stTime;
-         SysTimeLocalTime(SysTimeGet().Seconds, &stTime); //get system time
-         strftime(timeStringNow, sizeof(timeStringNow), "%d-%m-%Y %H:%M:%S", &stTime); //make date/time string
-         APP_LOG(TS_OFF, VLEVEL_H, "Time: restored from latest measurement: %s\r\n", timeStringNow);
+    while( measurementId < endMeasurementId && nextRecordInPage(pageBuffer, &offset) )
+    {
+      decodeResult = decodeRangeRecord(pageAddress, recordOffset, measurementId, slotId, measurementId >= firstMeasurementId ? &data : NULL);
 
-#endif
+      if( decodeResult < 0 )
+      {
+        APP_LOG(TS_OFF, VLEVEL_H, "MEASUREMENT: record %u is corrupt\r\n", measurementId );
       }
-      else
-      { //current time is newer, do not restore old time
-        APP_LOG(TS_OFF, VLEVEL_H, "Time: current time is newer, time not restored\r\n");
-        return -5;
+      else if( decodeResult == 0 && measurementId >= firstMeasurementId && callback(&data, context) < 0 )
+      {
+        result = 1;
+        break;
       }
+
+      measurementId++;
+      recordOffset = offset;
     }
-    else
-    { //no valid ID
-      APP_LOG(TS_OFF, VLEVEL_H, "Time: ERROR, no valid dataflash ID \r\n");
-      return -4;
+
+    pageAddress = getNextPageAddress(pageAddress);
+
+    //ring-buffer wrap, restart read at start of measurement memory
+    if( pageAddress == 0 )
+    {
+      stopReadDataflash();
+      startReadDataflash(pageAddress);
     }
   }
-  else
-  { //failed to read
-    APP_LOG(TS_OFF, VLEVEL_H, "Time: ERROR, failed to read from dataflash\r\n");
-    return -3;
-  }
 
-  return 0;
+  stopReadDataflash();
+
+  return result;
 }
+
 /**
- * @fn int8_t writeNewMeasurement(uint8_t, uint8_t*, uint8_t)
- * @brief function to write a new measurement
+ * @fn int8_t readMeasurementRange(uint32_t, uint32_t, measurementRangeCallback, void*)
+ * @brief function to read measurements [firstMeasurementId, endMeasurementId) with one continuous read of the dataflash.
+ * The dataflash I/O is enabled once, only the ring-buffer wrap restarts the read.
+ * Corrupt records are skipped. The callback must not use the dataflash.
  *
- * @param sensorModuleType
- * @param sensorData
- * @param dataLength
- * @return 0 = successful
+ * @param firstMeasurementId : ID of first measurement
+ * @param endMeasurementId : ID after the last measurement, limited to the latest measurement ID
+ * @param callback : function called for each measurement, return < 0 to stop reading
+ * @param context : pointer passed to callback
+ * @return 0 = successful, 1 = stopped by callback, -1 = callback is zero, -2 = ID not available, -3 = page header not valid
  */
-int8_t writeNewMeasurement( uint8_t MFM_protocol, struct_MFM_sensorModuleData * sensorModuleData, struct_MFM_baseData * MFM_data)
+int8_t readMeasurementRange( uint32_t firstMeasurementId, uint32_t endMeasurementId, measurementRangeCallback callback, void * context )
 {
-  int8_t result;
-  bool turnoverAndErased = false;
-
-  static_assert (sizeof(struct_MFM_sensorModuleData) == MAX_SENSOR_MODULE_DATA, "Size struct_MFM_sensorModuleData is not correct");
-  static_assert (sizeof(struct_MFM_baseData) == MAX_BASE_MODULE_DATA, "Size struct_MFM_baseData is not correct");
-  static_assert (sizeof(STRUCT_measurementData) == MAX_SIZE_MEASUREMENTDATA, "Size STRUCT_measurementData is not correct");
-
-  assert_param( readyForMeasurement == true ); //check saving measurements is possible
-  assert_param( sensorModuleData != 0 ); //check pointer is not zero
-  assert_param( MFM_data != 0 ); //check pointer is not zero
-  assert_param( sensorModuleData->sensorModuleDataSize <= sizeof(sensorModuleData->sensorModuleData) ); //check maximum supported datasize.
+  return readRange(firstMeasurementId, endMeasurementId, 0, callback, context);
+}
 
-  if (sensorModuleData == 0)
+/**
+ * @fn int8_t readMeasurementSlotRange(uint8_t, uint32_t, uint32_t, measurementRangeCallback, void*)
+ * @brief function to read the measurements of one sensor module slot in [firstMeasurementId, endMeasurementId).
+ * Records of other slots are skipped without unpacking, the callback is only called for the slot.
+ *
+ * @param slotId : sensor module slot, 1 to \ref MEASUREMENT_NUMBER_OF_SLOTS
+ * @param firstMeasurementId : ID of first measurement
+ * @param endMeasurementId : ID after the last measurement, limited to the latest measurement ID
+ * @param callback : function called for each measurement of the slot, return < 0 to stop reading
+ * @param context : pointer passed to callback
+ * @return 0 = successful, 1 = stopped by callback, -1 = callback is zero or slot not valid, -2 = ID not available, -3 = page header not valid
+ */
+int8_t readMeasurementSlotRange( uint8_t slotId, uint32_t firstMeasurementId, uint32_t endMeasurementId, measurementRangeCallback callback, void * context )
+{
+  if( slotId == 0 || slotId > MEASUREMENT_NUMBER_OF_SLOTS )
   {
-    APP_LOG(TS_OFF, VLEVEL_H, "MEASUREMENT: sensor module data pointer is zero\r\n");
     return -1;
   }
 
-  if (sensorModuleData->sensorModuleDataSize > sizeof(sensorModuleData->sensorModuleData))
-  {
-    APP_LOG(TS_OFF, VLEVEL_H, "MEASUREMENT: sensor module data too large\r\n");
-    return -2;
-  }
+  return readRange(firstMeasurementId, endMeasurementId, slotId, callback, context);
+}
 
-  if( readyForMeasurement == false )
-  {
-    APP_LOG(TS_OFF, VLEVEL_H, "MEASUREMENT: saving measurements is not possible\r\n");
-    return -3;
-  }
+/**
+ * @fn int8_t findTimeCallback(const STRUCT_measurementData*, void*)
+ * @brief callback of \ref readMeasurementRange to find the first measurement at or after a timestamp.
+ *
+ * @param data : measurement
+ * @param context : \ref struct_measurementTimeContext
+ * @return 0 = continue, -1 = found
+ */
+static int8_t findTimeCallback( const STRUCT_measurementData * data, void * context )
+{
+  struct_measurementTimeContext * search = (struct_measurementTimeContext *)context;
 
-  if (MFM_data == 0)
+  if( data->timestamp >= search->timestamp )
   {
-    APP_LOG(TS_OFF, VLEVEL_H, "MEASUREMENT: MFM_data pointer is zero\r\n");
-    return -4;
+    search->measurementId = data->measurementId;
+    return -1;
   }
 
-  measurement.measurementId = newMeasurementId; //set new measurement ID.
-  measurement.timestamp = SysTimeGet().Seconds; //get system time, if time not yet in sync start from 0, otherwise unix timestamp
-
-  measurement.protocolMFM = MFM_protocol;
-
-  memcpy( &measurement.MFM_baseData.stBaseData, MFM_data, sizeof(struct_MFM_baseData)); //copy MFM base data.
+  return 0;
+}
 
-  memcpy(&measurement.sensorModuleData, sensorModuleData, sizeof(measurement.sensorModuleData)); //copy sensor module data.
+/**
+ * @fn int8_t findMeasurementByTime(uint32_t, uint32_t*)
+ * @brief function to find the first measurement at or after a timestamp.
+ * A binary search on the first timestamp in the page headers is used, then the records of the found page are read.
+ * Timestamps are expected to increase, measurements before time synchronization start from 0.
+ *
+ * @param timestamp : unix time
+ * @param measurementId : destination of measurement ID, latest measurement ID when all measurements are older.
+ * @return 0 = successful, -1 = no measurements available
+ */
+int8_t findMeasurementByTime( uint32_t timestamp, uint32_t * measurementId )
+{
+  STRUCT_measurementPageHeader header;
+  struct_measurementTimeContext search = { timestamp, newMeasurementId };
+  uint32_t boundaryStart = 0;
+  uint32_t boundaryEnd = ((logHead.pageAddress + MEASUREMENT_MEMEORY_SIZE - tailPageAddress) % MEASUREMENT_MEMEORY_SIZE) / PAGE_SIZE_DATAFLASH;
+  uint32_t newReadingId;
+  uint32_t readAddress;
 
-  //check if not all bytes are used in sensorModuleData buffer
-  if( sensorModuleData->sensorModuleDataSize < sizeof(measurement.sensorModuleData) )
+  if( newMeasurementId == oldestMeasurementId )
   {
-    memset(&measurement.sensorModuleData.sensorModuleData[sensorModuleData->sensorModuleDataSize], 0xFF, sizeof(measurement.sensorModuleData.sensorModuleData) - sensorModuleData->sensorModuleDataSize); //fill in remaining empty sensor data.
+    return -1;
   }
 
-  measurement.sensorModuleData_crc = calculateCRC_CCITT(measurement.sensorModuleData.sensorModuleData, measurement.sensorModuleData.sensorModuleDataSize); //calculate CRC on sensordata
+  //binary search the last page starting before timestamp
+  while( boundaryStart < boundaryEnd )
+  {
+    newReadingId = (boundaryStart + boundaryEnd + 1) >> 1;
+    readAddress = (tailPageAddress + newReadingId * PAGE_SIZE_DATAFLASH) % MEASUREMENT_MEMEORY_SIZE;
 
-  memset( measurement.spare, 0xFF, sizeof(measurement.spare)); //set 0xFF (blank) in spare array
+    if( readCommittedPageHeader(&readAddress, logHead.pageAddress, &header) && header.firstTimestamp < timestamp )
+    {
+      boundaryStart = newReadingId;
+    }
+    else
+    {
+      boundaryEnd = newReadingId - 1;
+    }
+  }
 
-  turnoverAndErased = checkMeasurementMemoryTurnoverAndErase(measurement.measurementId); //check dataflash ringbuffer is turnover and a block of 4k is erased.
-  if( turnoverAndErased == true )
+  if( readPageHeader((tailPageAddress + boundaryStart * PAGE_SIZE_DATAFLASH) % MEASUREMENT_MEMEORY_SIZE, &header) == false )
   {
-    writeBackupRegister(BACKUP_REGISTER_OLDEST_MEASUREMENT_ID, readBackupRegister(BACKUP_REGISTER_OLDEST_MEASUREMENT_ID) + NUMBER_OF_PAGES_IN_4K_BLOCK_DATAFLASH);  //increment oldest pointer
+    return -1;
   }
 
-  result = writeMeasurementInDataflash(measurement.measurementId, (uint8_t*)&measurement, sizeof(measurement)); //write new measurement to dataflash
-
-  //check result
-  if( result == 0 ) //success
+  if( header.firstMeasurementId < oldestMeasurementId )
   {
-    APP_LOG(TS_OFF, VLEVEL_H, "Measurement ID %u written to dataflash\r\n", newMeasurementId );
-    uint32_t measurementId = measurement.measurementId;
-    readMeasurementFromDataflash(measurementId, (uint8_t*)&measurement, sizeof(measurement));
-
-    if( measurementId != measurement.measurementId)
-    {
-      APP_LOG(TS_OFF, VLEVEL_H, "Measurement failed to write dataflash: %u vs %u\r\n", measurementId, measurement.measurementId );
-    }
-
-    newMeasurementId++;
-    writeBackupRegister(BACKUP_REGISTER_LATEST_MEASUREMENT_ID, newMeasurementId);
+    header.firstMeasurementId = oldestMeasurementId;
   }
 
-  else //failed
+  if( header.firstTimestamp >= timestamp ) //all measurements are newer
   {
-    assert_param(1);
-    APP_LOG(TS_OFF, VLEVEL_H, "Restore measurement ID failes\r\n" );
-    return -5;//failed to write measurement
+    *measurementId = header.firstMeasurementId;
+    return 0;
   }
 
+  //first measurement at or after timestamp is in this page, or is the first of the next page
+  readMeasurementRange(header.firstMeasurementId, newMeasurementId, findTimeCallback, &search);
+
+  *measurementId = search.measurementId;
+
   return 0;
 }
 
 /**
- * @fn int8_t readMeasurement(uint32_t, uint8_t*, uint32_t)
- * @brief function to read measurement data from dataflash
+ * @fn int8_t packMeasurementCallback(const STRUCT_measurementData*, void*)
+ * @brief callback of \ref readMeasurementRange to pack a measurement in a block.
+ * When one slot is packed each record is preceded by its measurement ID.
  *
- * @param measurementId
- * @param buffer
- * @param bufferLength
- * @return
+ * @param data : measurement
+ * @param context : \ref struct_measurementPackContext
+ * @return 0 = packed, -1 = block is full or record is not consecutive
  */
-int8_t readMeasurement( uint32_t measurementId, uint8_t * buffer, uint32_t bufferLength )
+static int8_t packMeasurementCallback( const STRUCT_measurementData * data, void * context )
 {
-  assert_param( buffer == 0);
-  assert_param( bufferLength == 0);
+  struct_measurementPackContext * pack = (struct_measurementPackContext *)context;
+  uint32_t idLength = (pack->slotId != 0) ? sizeof(uint32_t) : 0;
 
-  if (buffer == 0)
+  if( pack->numberOfRecords == 0 )
   {
-    return -1;
+    pack->firstMeasurementId = data->measurementId;
+  }
+  else if( pack->slotId == 0 && data->measurementId != pack->firstMeasurementId + pack->numberOfRecords )
+  {
+    pack->nextMeasurementId = data->measurementId;
+    return -1; //records in block must be consecutive, skipped record starts a new block
   }
 
-  if (bufferLength == 0 )
+  if( pack->length + idLength + MEASUREMENT_RECORD_HEADER_SIZE + data->sensorModuleData.sensorModuleDataSize > pack->bufferLength )
   {
-    return -2;
+    pack->nextMeasurementId = data->measurementId;
+    return -1; //block is full
+  }
+
+  if( idLength )
+  {
+    memcpy(&pack->buffer[pack->length], &data->measurementId, idLength);
+    pack->length += idLength;
   }
 
-  return readMeasurementFromDataflash(measurementId, buffer, bufferLength);
+  encodeFullRecord((STRUCT_measurementRecord *)&pack->buffer[pack->length], data->timestamp, data->protocolMFM, &data->sensorModuleData, &data->MFM_baseData.stBaseData);
+
+  pack->length += MEASUREMENT_RECORD_HEADER_SIZE + data->sensorModuleData.sensorModuleDataSize;
+  pack->numberOfRecords++;
+
+  return 0;
 }
 
 /**
- * @fn int32_t printMeasurementData(uint32_t, uint8_t*, uint32_t)
- * @brief function to print a measurement to a given buffer
+ * @fn int32_t packMeasurementBlock(uint8_t, uint32_t, uint32_t, uint8_t*, uint32_t, uint32_t*, uint32_t*, uint16_t*)
+ * @brief function to pack measurements as full records (\ref STRUCT_measurementRecord) in a buffer.
+ * Delta records are unpacked, the records in the buffer can be decoded without key-frames.
+ * With all slots the records in the buffer are consecutive, with one slot each record is preceded by its measurement ID (uint32_t).
  *
- * @param measurementId
- * @param buffer
- * @param bufferLength
- * @return
+ * @param slotId : sensor module slot to pack, 0 = all slots
+ * @param measurementId : ID of first measurement to pack
+ * @param endMeasurementId : ID after the last measurement to pack
+ * @param buffer : destination
+ * @param bufferLength : size of destination
+ * @param firstMeasurementId : destination of ID of the first packed record
+ * @param nextMeasurementId : destination of ID to start the next block
+ * @param numberOfRecords : destination of number of packed records, 0 = no more records
+ * @return number of bytes packed, < 0 = error
  */
-int32_t printMeasurementData( uint32_t measurementId, uint8_t * buffer, uint32_t bufferLength )
+int32_t packMeasurementBlock( uint8_t slotId, uint32_t measurementId, uint32_t endMeasurementId, uint8_t * buffer, uint32_t bufferLength,
+                              uint32_t * firstMeasurementId, uint32_t * nextMeasurementId, uint16_t * numberOfRecords )
 {
-  readMeasurement(measurementId, (uint8_t*)&measurement, sizeof(measurement));
-
-  int length = 0;
-
-  length += snprintf((char*) buffer + length, bufferLength - length, "%lu;", measurement.measurementId);
-  length += snprintf((char*) buffer + length, bufferLength - length, "%lu;", measurement.timestamp);
-  length += snprintf((char*) buffer + length, bufferLength - length, "%u;", measurement.sensorModuleData.sensorModuleSlotId);
-  length += snprintf((char*) buffer + length, bufferLength - length, "%u;", measurement.sensorModuleData.sensorModuleTypeId);
-  length += snprintf((char*) buffer + length, bufferLength - length, "%u;", measurement.sensorModuleData.sensorModuleProtocolId);
-  length += snprintf((char*) buffer + length, bufferLength - length, "%u;", measurement.sensorModuleData.sensorModuleDataSize);
-
-  if( length >= bufferLength )
-    return -1;
+  struct_measurementPackContext pack = { buffer, bufferLength, 0, measurementId, endMeasurementId, 0, slotId };
+  int8_t result;
 
-  for (int i = 0; i < measurement.sensorModuleData.sensorModuleDataSize; i++)
+  if( measurementId < oldestMeasurementId )
   {
-    length += snprintf((char*) buffer + length, bufferLength - length, "0x%02x", measurement.sensorModuleData.sensorModuleData[i]);
-
-    if( length >= bufferLength )
-        return -1;
-
-    if (i < (measurement.sensorModuleData.sensorModuleDataSize - 1))
-    {
-      length += snprintf((char*) buffer + length, bufferLength, ",");
-    }
-
-    if( length >= bufferLength )
-        return -1;
+    measurementId = oldestMeasurementId; //oldest measurements are overwritten
   }
 
-  length += snprintf((char*) buffer + length, bufferLength - length, ";");
-  length += snprintf((char*) buffer + length, bufferLength - length, "%u;", measurement.MFM_baseData.stBaseData.messageType);
-  length += snprintf((char*) buffer + length, bufferLength - length, "%u;", measurement.MFM_baseData.stBaseData.batteryStateEos);
-  length += snprintf((char*) buffer + length, bufferLength - length, "%d;", measurement.MFM_baseData.stBaseData.temperatureGauge);
-  length += snprintf((char*) buffer + length, bufferLength - length, "%d;", measurement.MFM_baseData.stBaseData.temperatureController);
-  length += snprintf((char*) buffer + length, bufferLength - length, "%u;", measurement.MFM_baseData.stBaseData.diagnosticBits);
-  for( int i = 0; i<sizeof(measurement.MFM_baseData.stBaseData.spare); i++ )
+  if( slotId != 0 )
   {
-    length += snprintf((char*) buffer + length, bufferLength - length, "%u;", measurement.MFM_baseData.stBaseData.spare[i]);
+    result = readMeasurementSlotRange(slotId, measurementId, endMeasurementId, packMeasurementCallback, &pack);
+  }
+  else
+  {
+    result = readMeasurementRange(measurementId, endMeasurementId, packMeasurementCallback, &pack);
   }
 
-  length += snprintf((char*) buffer + length, bufferLength - length, "\r\n");
+  *firstMeasurementId = pack.firstMeasurementId;
+  *nextMeasurementId = pack.nextMeasurementId;
+  *numberOfRecords = pack.numberOfRecords;
 
-  if( length >= bufferLength )
-      return -1;
+  if( result < 0 && pack.numberOfRecords == 0 )
+  {
+    return result;
+  }
 
-  return length;
+  return pack.length;
 }
 
 /**
@@ -512,44 +2524,39 @@ uint32_t getLatestMeasurementId(void)
  */
 uint32_t getOldestMeasurementId(void)
 {
-  if( newMeasurementId < NUMBER_PAGES_FOR_MEASUREMENTS )
-  {
-    return 0;
-  }
-  else
+  return oldestMeasurementId;
+}
+
+/**
+ * @fn int8_t getMeasurementWear(uint32_t*, uint32_t*, uint32_t*)
+ * @brief function to get the erase cycles of the 4K blocks of the measurement memory, counted since the wear journal is started.
+ *
+ * @param minimum : destination of the lowest erase cycles of a block
+ * @param maximum : destination of the highest erase cycles of a block
+ * @param average : destination of the average erase cycles, rounded
+ * @return 0 = successful, -1 = measurement log not restored
+ */
+int8_t getMeasurementWear( uint32_t * minimum, uint32_t * maximum, uint32_t * average )
+{
+  if( readyForMeasurement == false )
   {
-    //todo return real measurement items, skip erased block,
-    return NUMBER_PAGES_FOR_MEASUREMENTS;
+    return -1;
   }
+
+  calculateMeasurementWear(getWearFrontierBlock(), minimum, maximum, average);
+
+  return 0;
 }
 
 /**
- * @fn const uint16_t getNumberOfMeasures(void)
+ * @fn const uint32_t getNumberOfMeasures(void)
  * @brief override function to return the number of measurement items
- * todo skip erased remaining block which is empty.
  *
  * @return  number of measurement items
  */
-const uint16_t getNumberOfMeasures(void)
+const uint32_t getNumberOfMeasures(void)
 {
-  uint32_t latestId = newMeasurementId; //newMeasurementId is the next ID, start with 0, so when newMeasurementId = 1, there is 1 measurement item.
-  uint32_t oldestId = readBackupRegister(BACKUP_REGISTER_OLDEST_MEASUREMENT_ID);
-  if( latestId > NUMBER_PAGES_FOR_MEASUREMENTS )
-  {
-    if( latestId >= oldestId)
-    {
-      return latestId - oldestId;
-    }
-    else
-    {
-      APP_LOG(TS_OFF, VLEVEL_H, "Measurement latestId is smaller then oldest, not possible!\r\n" );
-      return NUMBER_PAGES_FOR_MEASUREMENTS;
-    }
-  }
-  else
-  {
-    return latestId;
-  }
+  return newMeasurementId - oldestMeasurementId;
 }
 
 /**
@@ -562,6 +2569,9 @@ const uint8_t eraseCompleteMeasurementMemory( void )
 {
   int returnValue = -1;
 
+  discardStagedRecords(); //staged records are erased with the measurements
+  startMeasurementWearEpoch(getWearFrontierBlock());
+
   if( NUMBER_PAGES_FOR_MEASUREMENTS == NUMBER_PAGES_DATAFLASH ) //complete flash is used, chip erase can be executed
   {
     chipEraseDataflash();
@@ -569,7 +2579,7 @@ const uint8_t eraseCompleteMeasurementMemory( void )
   }
   else if( (NUMBER_PAGES_FOR_MEASUREMENTS % NUMBER_OF_PAGES_IN_64K_BLOCK_DATAFLASH) == 0 )
   {
-    for(int i = 0; i< NUMBER_PAGES_FOR_MEASUREMENTS/NUMBER_OF_PAGES_IN_64K_BLOCK_DATAFLASH; i++)
+    for(uint32_t i = 0; i< NUMBER_PAGES_FOR_MEASUREMENTS/NUMBER_OF_PAGES_IN_64K_BLOCK_DATAFLASH; i++)
     {
       blockErase64kDataflash( i * PAGE_SIZE_DATAFLASH * NUMBER_OF_PAGES_IN_64K_BLOCK_DATAFLASH );
     }
@@ -600,9 +2610,11 @@ const uint8_t eraseCompleteMeasurementMemory( void )
 
   if( returnValue >= 0 )
   {
+    resetMeasurementLog();
     writeBackupRegister(BACKUP_REGISTER_LATEST_MEASUREMENT_ID, 0);
+    writeBackupRegister(BACKUP_REGISTER_LATEST_MEASUREMENT_PAGE, logHead.pageAddress);
     writeBackupRegister(BACKUP_REGISTER_OLDEST_MEASUREMENT_ID, 0);
-    newMeasurementId = 0;
+    saveMeasurementLogCheckpoint();
   }
 
   return returnValue;
@@ -619,6 +2631,12 @@ const int8_t eraseCompleteMeasurementBlockByBlock( uint32_t * startAddress )
 {
   int returnValue = -1;
 
+  if( *startAddress == 0 )
+  {
+    discardStagedRecords(); //staged records are erased with the measurements
+    startMeasurementWearEpoch(getWearFrontierBlock());
+  }
+
   if( NUMBER_PAGES_FOR_MEASUREMENTS == NUMBER_PAGES_DATAFLASH ) //complete flash is used, chip erase can be executed
   {
     chipEraseDataflash();
@@ -660,9 +2678,11 @@ const int8_t eraseCompleteMeasurementBlockByBlock( uint32_t * startAddress )
   {
     if( *startAddress >= NUMBER_PAGES_FOR_MEASUREMENTS * PAGE_SIZE_DATAFLASH )
     {
+      resetMeasurementLog();
       writeBackupRegister(BACKUP_REGISTER_LATEST_MEASUREMENT_ID, 0);
+      writeBackupRegister(BACKUP_REGISTER_LATEST_MEASUREMENT_PAGE, logHead.pageAddress);
       writeBackupRegister(BACKUP_REGISTER_OLDEST_MEASUREMENT_ID, 0);
-      newMeasurementId = 0;
+      saveMeasurementLogCheckpoint();
       returnValue = 1;
     }
   }
@@ -11,12 +11,36 @@
 #ifndef MEASUREMENT_MEASUREMENT_H_
 #define MEASUREMENT_MEASUREMENT_H_
 
+#include <stddef.h>
+
 #define MAX_SENSOR_DATASIZE     36
 #define MAX_SENSOR_MODULE_DATA (MAX_SENSOR_DATASIZE + 4 ) //36 databytes + 4 bytes header
 #define MAX_BASE_MODULE_DATA    9 // + 1 byte protocol type
 
 #define MAX_SIZE_MEASUREMENTDATA  0x100 //max of 256 bytes, pagesize of flash
 
+#define MEASUREMENT_NUMBER_OF_SLOTS     6  //number of sensor module slots, slot ID 1-6
+#define MEASUREMENT_KEYFRAME_INTERVAL   16 //maximum number of records of one slot for each key-frame, including the key-frame
+#define MEASUREMENT_PRE_ERASE_PAGE      12 //page in 4K block from which the next block is erased in background
+
+#define MEASUREMENT_PAGE_FORMAT_PACKED  0x4E //page contains packed measurement records, header with first timestamp
+#define MEASUREMENT_PAGE_FORMAT_VOID    0x00 //page torn by power loss, contains no records and is skipped
+#define MEASUREMENT_RECORD_FULL         0x01 //record contains a complete measurement, also used as key-frame
+#define MEASUREMENT_RECORD_DELTA        0x02 //record contains the changes against the key-frame of the same slot
+#define MEASUREMENT_RECORD_ERASED       0xFF //no record, erased part of the page
+#define MEASUREMENT_RECORD_VOID         0x00 //record of a write interrupted by power loss, ends the records in the page
+
+#define MEASUREMENT_VERIFY_NONE         0  //no read back, only the dataflash status is checked
+#define MEASUREMENT_VERIFY_HEADER       1  //read back length, type and CRC of the record
+#define MEASUREMENT_VERIFY_CRC          2  //read back the record and check its CRC
+#define MEASUREMENT_VERIFY_FULL         3  //diagnostic, check location is erased before and compare all programmed bytes after writing
+#define MEASUREMENT_VERIFY_DEFAULT      MEASUREMENT_VERIFY_HEADER
+
+#define MEASUREMENT_STAGING_DEFAULT     8  //measurements collected in FRAM before they are programmed in dataflash, 1 = no staging
+#define MEASUREMENT_STAGING_MAX         16 //maximum measurements in FRAM, the staging area can be full before
+
+#define MEASUREMENT_WEAR_WARNING_CYCLES 80000 //erase cycles of a 4K block from which the wear diagnostic is set, the dataflash endurance is 100000 cycles
+
 
 typedef struct __attribute__((packed))
 {
@@ -58,12 +82,87 @@ typedef union{
   STRUCT_measurementData measurementData;
 }UNION_measurementData;
 
+/**
+ * Header at the start of each dataflash page of the measurement log.
+ * The page is followed by packed records of variable length (\ref STRUCT_measurementRecord).
+ */
+typedef struct __attribute__((packed))
+{
+  uint8_t format;               //page format \ref MEASUREMENT_PAGE_FORMAT_PACKED, 0xFF = erased page
+  uint8_t spare;                //not used, keep 0xFF
+  uint32_t firstMeasurementId;  //measurement ID of the first record in this page
+  uint32_t firstTimestamp;      //timestamp of the first record in this page, used as time index
+  uint16_t crc;                 //CRC over all fields before this field
+}STRUCT_measurementPageHeader;
+
+/**
+ * Packed measurement record, only the first sensorModuleDataSize bytes of sensorModuleData are stored.
+ * The measurement ID is not stored, it follows from the position after the page header.
+ * A record is committed when its CRC is valid, the last record of the log is checked at restore.
+ * A record of a write interrupted by power loss is made void and ends the records in the page.
+ */
+typedef struct __attribute__((packed))
+{
+  uint8_t length;               //total length of this record in bytes, 0xFF = end of records in page
+  uint8_t recordType;           //\ref MEASUREMENT_RECORD_FULL
+  uint16_t crc;                 //CRC over all record bytes after this field
+  uint32_t timestamp;
+  uint8_t protocolMFM;
+  UNION_MFM_baseData MFM_baseData;
+  uint8_t sensorModuleSlotId;
+  uint8_t sensorModuleTypeId;
+  uint8_t sensorModuleProtocolId;
+  uint8_t sensorModuleDataSize;
+  uint8_t sensorModuleData[MAX_SENSOR_DATASIZE];
+}STRUCT_measurementRecord;
+
+#define MEASUREMENT_RECORD_HEADER_SIZE  ( offsetof(STRUCT_measurementRecord, sensorModuleData) )
+#define MEASUREMENT_RECORD_CRC_OFFSET   ( offsetof(STRUCT_measurementRecord, timestamp) )
+
+#define MEASUREMENT_DELTA_BYTES         ( MAX_BASE_MODULE_DATA + MAX_SENSOR_DATASIZE ) //base data and sensor data are compared
+#define MEASUREMENT_DELTA_MAX_DATA      ( 5 + (MEASUREMENT_DELTA_BYTES + 7) / 8 + MEASUREMENT_DELTA_BYTES ) //timestamp, bitmap and changed bytes
+
+/**
+ * Delta record, stores the changes against the latest key-frame of the same slot in the same 4K block.
+ * Slot, type, protocol and data size are equal to the key-frame.
+ * data contains:
+ *  - timestamp difference with the key-frame, 7 bits per byte, bit 7 set when more bytes follow.
+ *  - bitmap of changed bytes, one bit for each byte of MFM base data followed by the sensor module data.
+ *  - XOR value of each changed byte.
+ */
+typedef struct __attribute__((packed))
+{
+  uint8_t length;               //total length of this record in bytes
+  uint8_t recordType;           //\ref MEASUREMENT_RECORD_DELTA
+  uint16_t crc;                 //CRC over all record bytes after this field
+  uint16_t keyFrameOffset;      //offset of the key-frame in the 4K block
+  uint8_t data[MEASUREMENT_DELTA_MAX_DATA];
+}STRUCT_measurementDeltaRecord;
+
+/**
+ * Callback for each measurement of \ref readMeasurementRange and \ref readMeasurementSlotRange, return < 0 to stop reading.
+ */
+typedef int8_t (*measurementRangeCallback)( const STRUCT_measurementData * measurement, void * context );
+
 int8_t restoreLatestMeasurementId(void);
 int8_t restoreLatestTimeFromMeasurement(void);
 int8_t searchLatestMeasurementInDataflash( uint32_t * logId );
 int8_t writeNewMeasurement( uint8_t MFM_protocol, struct_MFM_sensorModuleData * sensorModuleData, struct_MFM_baseData * MFM_data);
+int8_t setMeasurementLogVerify( uint8_t verify );
+int8_t setMeasurementLogStaging( uint8_t records );
+int8_t flushMeasurementLog( void );
+int8_t preEraseMeasurementBlock( void );
+void finishPreEraseMeasurementBlock( void );
 int8_t readMeasurement( uint32_t logId, uint8_t * buffer, uint32_t bufferLength );
+int8_t readMeasurementRange( uint32_t firstMeasurementId, uint32_t endMeasurementId, measurementRangeCallback callback, void * context );
+int8_t readMeasurementSlotRange( uint8_t slotId, uint32_t firstMeasurementId, uint32_t endMeasurementId, measurementRangeCallback callback, void * context );
+int8_t findMeasurementByTime( uint32_t timestamp, uint32_t * measurementId );
+int32_t packMeasurementBlock( uint8_t slotId, uint32_t measurementId, uint32_t endMeasurementId, uint8_t * buffer, uint32_t bufferLength,
+                              uint32_t * firstMeasurementId, uint32_t * nextMeasurementId, uint16_t * numberOfRecords );
 uint32_t getLatestMeasurementId(void);
 uint32_t getOldestMeasurementId(void);
+int8_t getMeasurementWear( uint32_t * minimum, uint32_t * maximum, uint32_t * average );
+bool getMeasurementWearWarning( void );
+const uint32_t getNumberOfMeasures(void);
 
 #endif /* LOGGING_LOGGING_H_ */
@@ -0,0 +1,364 @@
+/**
+  ******************************************************************************
+  * @addtogroup     : App
+  * @{
+  * @file           : measurementStaging.c
+  * @brief          : staging area in FRAM for the latest records of the measurement log.
+  * Records are collected in FRAM and programmed in dataflash with one page program, this saves
+  * a wake of the dataflash for every measurement. The staged records always belong to the head page.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  * @}
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "main.h"
+#include "sys_app.h"
+#include "common/crc16.h"
+#include "dataflash/dataflash_functions.h"
+#include "FRAM/FRAM_functions.h"
+#include "measurement.h"
+#include "measurementStaging.h"
+
+#define MEASUREMENT_STAGING_DATA_SIZE       ( MAX_SIZE_MEASUREMENT_STAGING - sizeof(struct_measurementStagingHeader) )
+
+/**
+ * Header of the staging area in FRAM, followed by the staged bytes of the head page.
+ * The staged bytes are a page header with records, or records appended to the page, and end with an erased length.
+ */
+typedef struct __attribute__((packed))
+{
+  uint16_t crc16;               //CRC over all fields after this field
+  uint32_t address;             //dataflash address of the first staged byte
+  uint32_t firstMeasurementId;  //measurement ID of the first record in the head page
+  uint16_t count;               //number of records in the head page before the staged bytes
+}struct_measurementStagingHeader;
+
+static_assert (MEASUREMENT_STAGING_DATA_SIZE > sizeof(STRUCT_measurementPageHeader) + sizeof(STRUCT_measurementRecord), "Size measurement staging area is too small");
+
+static uint8_t stagingBuffer[MAX_SIZE_MEASUREMENT_STAGING]; //copy of the staging area in FRAM
+static uint8_t * const stagedData = &stagingBuffer[sizeof(struct_measurementStagingHeader)];
+static uint32_t stagingAddress = MEASUREMENT_STAGING_NONE; //dataflash address of the first staged byte
+static uint16_t stagingLength = 0;  //number of staged bytes
+static uint8_t stagingCount = 0;    //number of staged records, the latest records of the log
+static uint8_t measurementStaging = MEASUREMENT_STAGING_DEFAULT;
+
+/**
+ * @fn uint16_t calculateStagingHeaderCrc(const struct_measurementStagingHeader*)
+ * @brief helper function to calculate the CRC of the staging header.
+ *
+ * @param header : staging header
+ * @return CRC
+ */
+static uint16_t calculateStagingHeaderCrc( const struct_measurementStagingHeader * header )
+{
+  return calculateCRC_CCITT((uint8_t*)&header->address, sizeof(struct_measurementStagingHeader) - sizeof(header->crc16));
+}
+
+/**
+ * @fn uint32_t getStagingPageAddress(void)
+ * @brief helper function to get the page of the staged bytes, this is always the head page.
+ *
+ * @return page address, MEASUREMENT_STAGING_NONE = nothing staged
+ */
+uint32_t getStagingPageAddress( void )
+{
+  if( stagingAddress == MEASUREMENT_STAGING_NONE )
+  {
+    return MEASUREMENT_STAGING_NONE;
+  }
+
+  return stagingAddress - stagingAddress % PAGE_SIZE_DATAFLASH;
+}
+
+/**
+ * @fn bool checkLogDataStaged(uint32_t, uint32_t)
+ * @brief function to check the dataflash has to be read for data of the log.
+ * The dataflash is not read when all bytes are staged or the page header is staged, the rest of that page is erased.
+ *
+ * @param address : dataflash address, the data may not cross a page boundary
+ * @param length : number of bytes
+ * @return true = dataflash does not contain the data, false = data has to be read from dataflash
+ */
+bool checkLogDataStaged( uint32_t address, uint32_t length )
+{
+  if( getStagingPageAddress() != address - address % PAGE_SIZE_DATAFLASH )
+  {
+    return false;
+  }
+
+  return (stagingAddress % PAGE_SIZE_DATAFLASH) == 0 || (address >= stagingAddress && address + length <= stagingAddress + stagingLength);
+}
+
+/**
+ * @fn void overlayStagedData(uint32_t, uint8_t*, uint32_t)
+ * @brief function to replace the bytes read from dataflash by the staged bytes that are not yet programmed.
+ *
+ * @param address : dataflash address of data
+ * @param data : data read from dataflash
+ * @param length : number of bytes
+ */
+void overlayStagedData( uint32_t address, uint8_t * data, uint32_t length )
+{
+  uint32_t start;
+  uint32_t end;
+
+  if( stagingAddress == MEASUREMENT_STAGING_NONE )
+  {
+    return;
+  }
+
+  start = address > stagingAddress ? address : stagingAddress;
+  end = address + length < stagingAddress + stagingLength ? address + length : stagingAddress + stagingLength;
+
+  if( start < end )
+  {
+    memcpy(&data[start - address], &stagedData[start - stagingAddress], end - start);
+  }
+}
+
+/**
+ * @fn void restoreStagedRecords(bool(*)(const STRUCT_measurementRecord*))
+ * @brief function to restore the staged records from FRAM.
+ * The records are committed by their CRC, a record interrupted by power loss and the bytes after it are not used.
+ *
+ * @param checkRecord : function to check a record is committed
+ */
+void restoreStagedRecords( bool (*checkRecord)(const STRUCT_measurementRecord *) )
+{
+  const struct_measurementStagingHeader * header = (const struct_measurementStagingHeader *)stagingBuffer;
+  const STRUCT_measurementPageHeader * pageHeader = (const STRUCT_measurementPageHeader *)stagedData;
+  uint16_t pageOffset;
+  uint16_t offset = 0;
+  uint8_t count = 0;
+
+  assert_param( checkRecord != NULL );
+
+  stagingAddress = MEASUREMENT_STAGING_NONE;
+  stagingLength = 0;
+  stagingCount = 0;
+
+  restoreMeasurementStaging(0, stagingBuffer, sizeof(stagingBuffer));
+
+  if( header->crc16 != calculateStagingHeaderCrc(header) || header->address >= MEASUREMENT_MEMEORY_SIZE )
+  {
+    return; //nothing staged
+  }
+
+  pageOffset = header->address % PAGE_SIZE_DATAFLASH;
+
+  //new page, the page header is staged with the first record
+  if( pageOffset == 0 )
+  {
+    if( pageHeader->format != MEASUREMENT_PAGE_FORMAT_PACKED ||
+        pageHeader->crc != calculateCRC_CCITT((uint8_t*)pageHeader, offsetof(STRUCT_measurementPageHeader, crc)) )
+    {
+      return;
+    }
+    offset = sizeof(STRUCT_measurementPageHeader);
+  }
+
+  while( stagedData[offset] != MEASUREMENT_RECORD_ERASED )
+  {
+    const STRUCT_measurementRecord * record = (const STRUCT_measurementRecord *)&stagedData[offset];
+
+    if( record->length <= MEASUREMENT_RECORD_CRC_OFFSET || offset + record->length >= MEASUREMENT_STAGING_DATA_SIZE ||
+        pageOffset + offset + record->length > PAGE_SIZE_DATAFLASH || checkRecord(record) == false )
+    {
+      break;
+    }
+
+    offset += record->length;
+    count++;
+  }
+
+  if( count == 0 )
+  {
+    return;
+  }
+
+  stagingAddress = header->address;
+  stagingLength = offset;
+  stagingCount = count;
+
+  APP_LOG(TS_OFF, VLEVEL_H, "MEASUREMENT: %u records staged in FRAM\r\n", stagingCount);
+}
+
+/**
+ * @fn void discardStagedRecords(void)
+ * @brief function to clear the staged records, after they are programmed or when the measurements are erased.
+ *
+ */
+void discardStagedRecords( void )
+{
+  struct_measurementStagingHeader * header = (struct_measurementStagingHeader *)stagingBuffer;
+
+  if( stagingAddress == MEASUREMENT_STAGING_NONE )
+  {
+    return;
+  }
+
+  header->crc16 = ~header->crc16;
+  saveMeasurementStaging(0, &header->crc16, sizeof(header->crc16));
+
+  stagingAddress = MEASUREMENT_STAGING_NONE;
+  stagingLength = 0;
+  stagingCount = 0;
+}
+
+/**
+ * @fn uint8_t getStagedRecordCount(void)
+ * @brief function to get the number of staged records, these are the latest records of the log.
+ *
+ * @return number of records
+ */
+uint8_t getStagedRecordCount( void )
+{
+  return stagingCount;
+}
+
+/**
+ * @fn const STRUCT_measurementRecord getStagedRecord*(uint32_t, uint32_t*)
+ * @brief function to get a staged record.
+ *
+ * @param index : index of the staged record, 0 is first record
+ * @param address : dataflash address of the record
+ * @return record
+ */
+const STRUCT_measurementRecord * getStagedRecord( uint32_t index, uint32_t * address )
+{
+  uint16_t offset = (stagingAddress % PAGE_SIZE_DATAFLASH) == 0 ? sizeof(STRUCT_measurementPageHeader) : 0;
+
+  assert_param( index < stagingCount );
+
+  while( index-- )
+  {
+    offset += stagedData[offset];
+  }
+
+  *address = stagingAddress + offset;
+
+  return (const STRUCT_measurementRecord *)&stagedData[offset];
+}
+
+/**
+ * @fn uint8_t getStagedData*(uint32_t*, uint16_t*)
+ * @brief function to get the staged bytes, to program them in dataflash.
+ *
+ * @param address : dataflash address of the first staged byte, MEASUREMENT_STAGING_NONE = nothing staged
+ * @param length : number of staged bytes
+ * @return staged bytes
+ */
+uint8_t * getStagedData( uint32_t * address, uint16_t * length )
+{
+  *address = stagingAddress;
+  *length = stagingLength;
+
+  return stagedData;
+}
+
+/**
+ * @fn void getStagedLogHead(uint32_t*, uint16_t*, uint16_t*)
+ * @brief function to get the head of the log from the staged records, the dataflash is not read.
+ *
+ * @param firstMeasurementId : measurement ID of the first record in the head page
+ * @param count : number of records in the head page, including the staged records
+ * @param offset : offset in the head page after the staged records
+ */
+void getStagedLogHead( uint32_t * firstMeasurementId, uint16_t * count, uint16_t * offset )
+{
+  const struct_measurementStagingHeader * header = (const struct_measurementStagingHeader *)stagingBuffer;
+
+  *firstMeasurementId = header->firstMeasurementId;
+  *count = header->count + stagingCount;
+  *offset = stagingAddress % PAGE_SIZE_DATAFLASH + stagingLength;
+}
+
+/**
+ * @fn bool checkStagingSpace(uint16_t)
+ * @brief function to check the staging area has space for the data, with the erased length after it.
+ *
+ * @param length : number of bytes
+ * @return true = data fits, false = staging area full
+ */
+bool checkStagingSpace( uint16_t length )
+{
+  return (uint32_t)(stagingLength + length + 1) <= MEASUREMENT_STAGING_DATA_SIZE;
+}
+
+/**
+ * @fn void stageLogData(uint32_t, const uint8_t*, uint16_t, uint32_t, uint16_t)
+ * @brief function to add a record to the staging area in FRAM, instead of programming it in dataflash.
+ * The staged bytes are followed by an erased length, so an older record after them is not restored.
+ *
+ * @param address : dataflash address of the data
+ * @param data : record, with page header for a new page
+ * @param length : number of bytes
+ * @param firstMeasurementId : measurement ID of the first record in the head page
+ * @param count : number of records in the head page before this record
+ */
+void stageLogData( uint32_t address, const uint8_t * data, uint16_t length, uint32_t firstMeasurementId, uint16_t count )
+{
+  struct_measurementStagingHeader * header = (struct_measurementStagingHeader *)stagingBuffer;
+
+  assert_param( checkStagingSpace(length) );
+
+  if( stagingAddress == MEASUREMENT_STAGING_NONE )
+  {
+    header->address = address;
+    header->firstMeasurementId = firstMeasurementId;
+    header->count = count;
+    header->crc16 = calculateStagingHeaderCrc(header);
+
+    memcpy(stagedData, data, length);
+    stagedData[length] = MEASUREMENT_RECORD_ERASED;
+
+    saveMeasurementStaging(0, stagingBuffer, sizeof(struct_measurementStagingHeader) + length + 1);
+
+    stagingAddress = address;
+  }
+  else
+  {
+    memcpy(&stagedData[stagingLength], data, length);
+    stagedData[stagingLength + length] = MEASUREMENT_RECORD_ERASED;
+
+    saveMeasurementStaging(sizeof(struct_measurementStagingHeader) + stagingLength, &stagedData[stagingLength], length + 1);
+  }
+
+  stagingLength += length;
+  stagingCount++;
+}
+
+/**
+ * @fn int8_t setMeasurementLogStaging(uint8_t)
+ * @brief function to set the number of measurements collected in FRAM before they are programmed in dataflash.
+ *
+ * @param records : 1 = every measurement is programmed directly, up to \ref MEASUREMENT_STAGING_MAX
+ * @return 0 = successful, -1 = out of range
+ */
+int8_t setMeasurementLogStaging( uint8_t records )
+{
+  if( records == 0 || records > MEASUREMENT_STAGING_MAX )
+  {
+    return -1;
+  }
+
+  measurementStaging = records;
+
+  return 0;
+}
+
+/**
+ * @fn uint8_t getMeasurementLogStaging(void)
+ * @brief function to get the number of measurements collected in FRAM before they are programmed in dataflash.
+ *
+ * @return number of measurements, 1 = no staging
+ */
+uint8_t getMeasurementLogStaging( void )
+{
+  return measurementStaging;
+}
@@ -0,0 +1,28 @@
+/**
+  ******************************************************************************
+  * @file           : measurementStaging.h
+  * @brief          : Header for measurementStaging.c file.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  ******************************************************************************
+  */
+#ifndef MEASUREMENTSTAGING_H_
+#define MEASUREMENTSTAGING_H_
+
+#define MEASUREMENT_STAGING_NONE    UINT32_MAX //nothing staged
+
+uint32_t getStagingPageAddress( void );
+bool checkLogDataStaged( uint32_t address, uint32_t length );
+void overlayStagedData( uint32_t address, uint8_t * data, uint32_t length );
+void restoreStagedRecords( bool (*checkRecord)(const STRUCT_measurementRecord *) );
+void discardStagedRecords( void );
+uint8_t getStagedRecordCount( void );
+const STRUCT_measurementRecord * getStagedRecord( uint32_t index, uint32_t * address );
+uint8_t * getStagedData( uint32_t * address, uint16_t * length );
+void getStagedLogHead( uint32_t * firstMeasurementId, uint16_t * count, uint16_t * offset );
+bool checkStagingSpace( uint16_t length );
+void stageLogData( uint32_t address, const uint8_t * data, uint16_t length, uint32_t firstMeasurementId, uint16_t count );
+uint8_t getMeasurementLogStaging( void );
+
+#endif /* MEASUREMENTSTAGING_H_ */
@@ -0,0 +1,437 @@
+/**
+  ******************************************************************************
+  * @addtogroup     : App
+  * @{
+  * @file           : measurementWear.c
+  * @brief          : erase counters of the 4K blocks of the measurement ring.
+  * The erase cycles are tracked in a small journal in the last 4K block of the reserved dataflash area.
+  * The journal only stores events: an erase of the complete measurement memory (start of a new epoch)
+  * and every wrap of the ring. Per block counts are derived from these records, when the journal is
+  * full it is compacted into a single base record.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  * @}
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "main.h"
+#include "sys_app.h"
+#include "common/crc16.h"
+#include "dataflash/dataflash_functions.h"
+#include "measurement.h"
+#include "measurementWear.h"
+
+#define MEASUREMENT_WEAR_NONE               UINT32_MAX //no turnover since the start of the epoch
+#define NUMBER_OF_MEASUREMENT_BLOCKS        ( MEASUREMENT_MEMEORY_SIZE / BLOCK_4K_SIZE_DATAFLASH )
+#define MEASUREMENT_WEAR_JOURNAL_ADDRESS    ( RESERVED_MEMORY_ADDRESS + RESERVED_MEMORY - BLOCK_4K_SIZE_DATAFLASH ) //last 4K block of the reserved memory
+#define MEASUREMENT_WEAR_JOURNAL_RECORDS    ( BLOCK_4K_SIZE_DATAFLASH / sizeof(struct_measurementWearRecord) )
+#define MEASUREMENT_WEAR_MAX_EPOCHS         8 //epochs kept for the statistics, older epochs are merged in the base erase count
+#define MEASUREMENT_WEAR_RECORD_ERASE       0x45 //complete measurement memory erased, ring starts at startBlock
+#define MEASUREMENT_WEAR_RECORD_WRAP        0x57 //start block of the ring is erased again
+#define MEASUREMENT_WEAR_RECORD_BASE        0x42 //journal restarted, all blocks have at least value erase cycles
+
+/**
+ * Record of the wear journal in the reserved memory.
+ * The ring erases the 4K blocks in order, so the erase count of every block follows from the start block of the ring
+ * and the number of blocks erased since. Only a complete erase and every turnover of the ring add a record.
+ */
+typedef struct __attribute__((packed))
+{
+  uint8_t type;                 //\ref MEASUREMENT_WEAR_RECORD_ERASE, \ref MEASUREMENT_WEAR_RECORD_WRAP or \ref MEASUREMENT_WEAR_RECORD_BASE, 0xFF = erased
+  uint8_t spare;                //not used, keep 0xFF
+  uint16_t startBlock;          //first block of the ring
+  uint32_t value;               //ERASE: blocks erased by the ring before, WRAP: new measurement ID, BASE: erase cycles of all blocks
+  uint32_t wraps;               //BASE: turnovers of the ring since the start block, otherwise 0xFFFFFFFF
+  uint16_t spare2;              //not used, keep 0xFFFF
+  uint16_t crc;                 //CRC over all fields before this field
+}struct_measurementWearRecord;
+
+typedef struct
+{
+  uint16_t startBlock;          //first block of the ring in this epoch
+  uint8_t erased;               //1 = epoch started with an erase of all blocks
+  uint32_t ringErases;          //blocks erased by the ring in this epoch, not used for the current epoch
+}struct_measurementWearEpoch;
+
+typedef struct
+{
+  uint32_t baseErases;          //erase cycles of all blocks before the first epoch
+  uint32_t wraps;               //turnovers of the ring in the current epoch
+  uint32_t wrapMeasurementId;   //new measurement ID of the latest turnover
+  uint16_t numberOfRecords;     //used records in the journal
+  uint16_t numberOfEpochs;
+  struct_measurementWearEpoch epoch[MEASUREMENT_WEAR_MAX_EPOCHS];
+}struct_measurementWear;
+
+static_assert (PAGE_SIZE_DATAFLASH % sizeof(struct_measurementWearRecord) == 0, "Size struct_measurementWearRecord must fit in a page");
+
+static struct_measurementWear wear;
+static bool wearRestored = false;
+static bool wearWarning = false;
+
+/**
+ * @fn bool checkErased(const uint8_t*, uint32_t)
+ * @brief helper function to check data is erased (0xFF)
+ *
+ * @param data : data to check
+ * @param length : number of bytes
+ * @return true = all bytes are erased
+ */
+static bool checkErased( const uint8_t * data, uint32_t length )
+{
+  while( length-- )
+  {
+    if( *data++ != 0xFF )
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @fn uint16_t calculateWearRecordCrc(const struct_measurementWearRecord*)
+ * @brief helper function to calculate the CRC of a wear journal record
+ *
+ * @param record : pointer to record
+ * @return CRC
+ */
+static uint16_t calculateWearRecordCrc( const struct_measurementWearRecord * record )
+{
+  return calculateCRC_CCITT((uint8_t*)record, offsetof(struct_measurementWearRecord, crc));
+}
+
+/**
+ * @fn void mergeOldestWearEpoch(void)
+ * @brief helper function to merge the oldest epoch in the base erase count, the highest erase count of the epoch is used for all blocks.
+ *
+ */
+static void mergeOldestWearEpoch( void )
+{
+  wear.baseErases += wear.epoch[0].erased + (wear.epoch[0].ringErases + NUMBER_OF_MEASUREMENT_BLOCKS - 1) / NUMBER_OF_MEASUREMENT_BLOCKS;
+
+  memmove(&wear.epoch[0], &wear.epoch[1], (wear.numberOfEpochs - 1) * sizeof(wear.epoch[0]));
+  wear.numberOfEpochs--;
+}
+
+/**
+ * @fn void restoreMeasurementWear(void)
+ * @brief function to read the wear journal from the reserved memory.
+ * Without records the ring starts at block 0 and the erase counts start at 0.
+ *
+ */
+static void restoreMeasurementWear( void )
+{
+  struct_measurementWearRecord record;
+
+  memset(&wear, 0, sizeof(wear));
+  wear.numberOfEpochs = 1;
+  wear.wrapMeasurementId = MEASUREMENT_WEAR_NONE;
+
+  startReadDataflash(MEASUREMENT_WEAR_JOURNAL_ADDRESS);
+
+  while( wear.numberOfRecords < MEASUREMENT_WEAR_JOURNAL_RECORDS )
+  {
+    continueReadDataflash((uint8_t*)&record, sizeof(record));
+
+    if( checkErased((uint8_t*)&record, sizeof(record)) )
+    {
+      break; //end of journal
+    }
+
+    wear.numberOfRecords++;
+
+    if( record.crc != calculateWearRecordCrc(&record) || record.startBlock >= NUMBER_OF_MEASUREMENT_BLOCKS )
+    {
+      continue; //write of record interrupted
+    }
+
+    switch( record.type )
+    {
+      case MEASUREMENT_WEAR_RECORD_ERASE:
+        wear.epoch[wear.numberOfEpochs - 1].ringErases = record.value;
+
+        if( wear.numberOfEpochs == MEASUREMENT_WEAR_MAX_EPOCHS )
+        {
+          mergeOldestWearEpoch();
+        }
+
+        wear.epoch[wear.numberOfEpochs].startBlock = record.startBlock;
+        wear.epoch[wear.numberOfEpochs].erased = 1;
+        wear.epoch[wear.numberOfEpochs].ringErases = 0;
+        wear.numberOfEpochs++;
+        wear.wraps = 0;
+        wear.wrapMeasurementId = MEASUREMENT_WEAR_NONE;
+        break;
+
+      case MEASUREMENT_WEAR_RECORD_WRAP:
+        wear.wraps++;
+        wear.wrapMeasurementId = record.value;
+        break;
+
+      case MEASUREMENT_WEAR_RECORD_BASE:
+        wear.baseErases = record.value;
+        wear.wraps = record.wraps;
+        wear.numberOfEpochs = 1;
+        wear.epoch[0].startBlock = record.startBlock;
+        wear.epoch[0].erased = 0;
+        wear.epoch[0].ringErases = 0;
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  stopReadDataflash();
+
+  wearRestored = true;
+
+  APP_LOG(TS_OFF, VLEVEL_H, "MEASUREMENT: wear journal %u records, ring start block %u, turnovers %u\r\n", wear.numberOfRecords, wear.epoch[wear.numberOfEpochs - 1].startBlock, wear.wraps);
+}
+
+/**
+ * @fn uint32_t getMeasurementRingStart(void)
+ * @brief helper function to get the first page of the ring, the page the first measurement after an erase of all blocks is written to.
+ *
+ * @return address of first page
+ */
+uint32_t getMeasurementRingStart( void )
+{
+  if( wearRestored == false )
+  {
+    restoreMeasurementWear();
+  }
+
+  return wear.epoch[wear.numberOfEpochs - 1].startBlock * BLOCK_4K_SIZE_DATAFLASH;
+}
+
+/**
+ * @fn void appendWearRecord(uint8_t, uint16_t, uint32_t)
+ * @brief function to add a record to the wear journal.
+ * A full journal is erased and restarted with a base record, the epochs before the current epoch are merged with their highest erase count.
+ *
+ * @param type : \ref MEASUREMENT_WEAR_RECORD_ERASE or \ref MEASUREMENT_WEAR_RECORD_WRAP
+ * @param startBlock : first block of the ring
+ * @param value : value of the record
+ */
+static void appendWearRecord( uint8_t type, uint16_t startBlock, uint32_t value )
+{
+  struct_measurementWearRecord record;
+
+  memset(&record, 0xFF, sizeof(record));
+
+  if( wear.numberOfRecords >= MEASUREMENT_WEAR_JOURNAL_RECORDS )
+  {
+    while( wear.numberOfEpochs > 1 )
+    {
+      mergeOldestWearEpoch();
+    }
+
+    wear.baseErases += wear.epoch[0].erased;
+    wear.epoch[0].erased = 0;
+
+    blockErase4kDataflash(MEASUREMENT_WEAR_JOURNAL_ADDRESS);
+
+    record.type = MEASUREMENT_WEAR_RECORD_BASE;
+    record.startBlock = wear.epoch[0].startBlock;
+    record.value = wear.baseErases;
+    record.wraps = wear.wraps;
+    record.crc = calculateWearRecordCrc(&record);
+
+    writeDataInDataflash(MEASUREMENT_WEAR_JOURNAL_ADDRESS, (uint8_t*)&record, sizeof(record));
+    wear.numberOfRecords = 1;
+
+    memset(&record, 0xFF, sizeof(record));
+  }
+
+  record.type = type;
+  record.startBlock = startBlock;
+  record.value = value;
+  record.crc = calculateWearRecordCrc(&record);
+
+  writeDataInDataflash(MEASUREMENT_WEAR_JOURNAL_ADDRESS + wear.numberOfRecords * sizeof(record), (uint8_t*)&record, sizeof(record));
+  wear.numberOfRecords++;
+}
+
+/**
+ * @fn uint32_t getRingErases(uint32_t)
+ * @brief helper function to get the number of blocks erased by the ring in the current epoch.
+ * The first erase of the ring is the start block after the first turnover.
+ *
+ * @param frontierBlock : latest block erased by the ring
+ * @return number of erased blocks
+ */
+static uint32_t getRingErases( uint32_t frontierBlock )
+{
+  uint32_t startBlock = wear.epoch[wear.numberOfEpochs - 1].startBlock;
+
+  if( wear.wraps == 0 )
+  {
+    return 0;
+  }
+
+  return (wear.wraps - 1) * NUMBER_OF_MEASUREMENT_BLOCKS + (frontierBlock + NUMBER_OF_MEASUREMENT_BLOCKS - startBlock) % NUMBER_OF_MEASUREMENT_BLOCKS + 1;
+}
+
+/**
+ * @fn uint32_t getBlockEraseCount(uint32_t, uint32_t)
+ * @brief helper function to calculate the erase cycles of a block from the epochs of the wear journal
+ *
+ * @param block : block number in the measurement memory
+ * @param ringErases : blocks erased by the ring in the current epoch, see \ref getRingErases
+ * @return erase cycles
+ */
+static uint32_t getBlockEraseCount( uint32_t block, uint32_t ringErases )
+{
+  uint32_t count = wear.baseErases;
+
+  for( int i = 0; i < wear.numberOfEpochs; i++ )
+  {
+    uint32_t erases = (i == wear.numberOfEpochs - 1) ? ringErases : wear.epoch[i].ringErases;
+    uint32_t position = (block + NUMBER_OF_MEASUREMENT_BLOCKS - wear.epoch[i].startBlock) % NUMBER_OF_MEASUREMENT_BLOCKS;
+
+    count += wear.epoch[i].erased;
+
+    if( erases > position )
+    {
+      count += (erases - position - 1) / NUMBER_OF_MEASUREMENT_BLOCKS + 1;
+    }
+  }
+
+  return count;
+}
+
+/**
+ * @fn void countMeasurementBlockErase(uint32_t, uint32_t)
+ * @brief function to register the erase of a block by the ring.
+ * A turnover is added to the wear journal when the start block is erased, the wear warning is set when the block reaches \ref MEASUREMENT_WEAR_WARNING_CYCLES.
+ *
+ * @param blockAddress : address of the block
+ * @param measurementId : ID of the next measurement of the log
+ */
+void countMeasurementBlockErase( uint32_t blockAddress, uint32_t measurementId )
+{
+  uint32_t block = blockAddress / BLOCK_4K_SIZE_DATAFLASH;
+
+  if( wearRestored == false )
+  {
+    restoreMeasurementWear();
+  }
+
+  //an erase repeated after power loss is not a new turnover, a turnover writes at least all pages
+  if( block == wear.epoch[wear.numberOfEpochs - 1].startBlock &&
+      (wear.wrapMeasurementId == MEASUREMENT_WEAR_NONE || measurementId - wear.wrapMeasurementId >= NUMBER_PAGES_FOR_MEASUREMENTS) )
+  {
+    appendWearRecord(MEASUREMENT_WEAR_RECORD_WRAP, block, measurementId);
+    wear.wraps++;
+    wear.wrapMeasurementId = measurementId;
+  }
+
+  if( getBlockEraseCount(block, getRingErases(block)) >= MEASUREMENT_WEAR_WARNING_CYCLES )
+  {
+    wearWarning = true;
+  }
+}
+
+/**
+ * @fn void startMeasurementWearEpoch(uint32_t)
+ * @brief function to register the erase of all blocks of the measurement memory.
+ * The new ring starts at the block with the lowest erase count, searched from the block after the latest erased block.
+ *
+ * @param frontierBlock : latest block erased by the ring
+ */
+void startMeasurementWearEpoch( uint32_t frontierBlock )
+{
+  uint32_t ringErases;
+  uint32_t minimum = UINT32_MAX;
+  uint32_t startBlock = 0;
+
+  if( wearRestored == false )
+  {
+    restoreMeasurementWear();
+  }
+
+  ringErases = getRingErases(frontierBlock);
+
+  for( uint32_t i = 1; i <= NUMBER_OF_MEASUREMENT_BLOCKS; i++ )
+  {
+    uint32_t block = (frontierBlock + i) % NUMBER_OF_MEASUREMENT_BLOCKS;
+    uint32_t count = getBlockEraseCount(block, ringErases);
+
+    if( count < minimum )
+    {
+      minimum = count;
+      startBlock = block;
+    }
+  }
+
+  appendWearRecord(MEASUREMENT_WEAR_RECORD_ERASE, startBlock, ringErases);
+
+  wear.epoch[wear.numberOfEpochs - 1].ringErases = ringErases;
+
+  if( wear.numberOfEpochs == MEASUREMENT_WEAR_MAX_EPOCHS )
+  {
+    mergeOldestWearEpoch();
+  }
+
+  wear.epoch[wear.numberOfEpochs].startBlock = startBlock;
+  wear.epoch[wear.numberOfEpochs].erased = 1;
+  wear.epoch[wear.numberOfEpochs].ringErases = 0;
+  wear.numberOfEpochs++;
+  wear.wraps = 0;
+  wear.wrapMeasurementId = MEASUREMENT_WEAR_NONE;
+
+  APP_LOG(TS_OFF, VLEVEL_H, "MEASUREMENT: ring restarts at block %u, %u erase cycles\r\n", startBlock, minimum + 1);
+}
+
+/**
+ * @fn void calculateMeasurementWear(uint32_t, uint32_t*, uint32_t*, uint32_t*)
+ * @brief function to calculate the erase cycles of the 4K blocks of the measurement memory, counted since the wear journal is started.
+ *
+ * @param frontierBlock : latest block erased by the ring
+ * @param minimum : destination of the lowest erase cycles of a block
+ * @param maximum : destination of the highest erase cycles of a block
+ * @param average : destination of the average erase cycles, rounded
+ */
+void calculateMeasurementWear( uint32_t frontierBlock, uint32_t * minimum, uint32_t * maximum, uint32_t * average )
+{
+  uint32_t ringErases;
+  uint64_t total = 0;
+
+  if( wearRestored == false )
+  {
+    restoreMeasurementWear();
+  }
+
+  ringErases = getRingErases(frontierBlock);
+
+  *minimum = UINT32_MAX;
+  *maximum = 0;
+
+  for( uint32_t block = 0; block < NUMBER_OF_MEASUREMENT_BLOCKS; block++ )
+  {
+    uint32_t count = getBlockEraseCount(block, ringErases);
+
+    *minimum = count < *minimum ? count : *minimum;
+    *maximum = count > *maximum ? count : *maximum;
+    total += count;
+  }
+
+  *average = (total + NUMBER_OF_MEASUREMENT_BLOCKS / 2) / NUMBER_OF_MEASUREMENT_BLOCKS;
+}
+
+/**
+ * @fn bool getMeasurementWearWarning(void)
+ * @brief function to get the wear warning, set when a block erased since boot reached \ref MEASUREMENT_WEAR_WARNING_CYCLES.
+ *
+ * @return true = wear limit reached
+ */
+bool getMeasurementWearWarning( void )
+{
+  return wearWarning;
+}
@@ -0,0 +1,18 @@
+/**
+  ******************************************************************************
+  * @file           : measurementWear.h
+  * @brief          : Header for measurementWear.c file.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  ******************************************************************************
+  */
+#ifndef MEASUREMENTWEAR_H_
+#define MEASUREMENTWEAR_H_
+
+uint32_t getMeasurementRingStart( void );
+void countMeasurementBlockErase( uint32_t blockAddress, uint32_t measurementId );
+void startMeasurementWearEpoch( uint32_t frontierBlock );
+void calculateMeasurementWear( uint32_t frontierBlock, uint32_t * minimum, uint32_t * maximum, uint32_t * average );
+
+#endif /* MEASUREMENTWEAR_H_ */
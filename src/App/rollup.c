@@ -0,0 +1,727 @@
+/**
+  ******************************************************************************
+  * @addtogroup     : App
+  * @{
+  * @file           : rollup.c
+  * @brief          : aggregation of the measurements in rollups, minimum, maximum and mean per slot and window.
+  * The open window of each slot is kept in FRAM by its start and its first measurement ID, RAM is lost in off mode.
+  * When the first measurement of a slot after the window arrives, the measurements of the window are read once
+  * from the measurement log and the rollup is appended to the rollup log, a ring of fixed size records in dataflash.
+  * A rollup interrupted by power loss is made again with the same measurements at the next measurement of the slot.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  * @}
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "main.h"
+#include "sys_app.h"
+#include "stm32_systime.h"
+#include "common/crc16.h"
+#include "common/common.h"
+#include "dataflash/dataflash_functions.h"
+#include "FRAM/FRAM_functions.h"
+#include "I2CMaster/SensorRegister.h"
+#include "measurement.h"
+#include "rollup.h"
+
+#define ROLLUP_STATE_PROTOCOL_ID    0x00
+#define ROLLUP_WINDOW_NONE          UINT32_MAX //no open window
+#define ROLLUP_NUMBER_OF_RECORDS    ( ROLLUP_MEMORY / sizeof(STRUCT_rollupRecord) )
+#define ROLLUP_RECORDS_IN_BLOCK     ( BLOCK_4K_SIZE_DATAFLASH / sizeof(STRUCT_rollupRecord) )
+
+/**
+ * @brief open window of a slot
+ */
+typedef struct __attribute__((packed))
+{
+  uint32_t windowStart;         //timestamp of the start of the window, ROLLUP_WINDOW_NONE = no open window
+  uint32_t firstMeasurementId;  //ID of the first measurement of the window
+}struct_rollupWindow;
+
+/**
+ * @brief state of the aggregation in FRAM
+ */
+typedef struct __attribute__((packed))
+{
+  uint16_t crc16;               //CRC over all fields after this field
+  uint8_t protocolId;           //\ref ROLLUP_STATE_PROTOCOL_ID
+  uint8_t spare;
+  uint32_t nextRollupId;        //ID of the next rollup in the rollup log
+  uint32_t uplinkRollupId;      //ID of the next rollup to send by LoRa
+  struct_rollupWindow window[MEASUREMENT_NUMBER_OF_SLOTS];
+}struct_rollupState;
+
+/**
+ * @brief context of \ref aggregateCallback
+ */
+typedef struct
+{
+  uint32_t windowEnd;           //timestamp after the window
+  uint32_t nextMeasurementId;   //ID of the first measurement after the window
+  uint32_t nextTimestamp;       //timestamp of the first measurement after the window
+  float sum[ROLLUP_NUMBER_OF_VALUES];
+  STRUCT_rollupRecord rollup;
+}struct_rollupContext;
+
+static_assert (sizeof(STRUCT_rollupRecord) == 64, "Size STRUCT_rollupRecord is not correct");
+static_assert (PAGE_SIZE_DATAFLASH % sizeof(STRUCT_rollupRecord) == 0, "Size STRUCT_rollupRecord must fit in a page");
+static_assert (sizeof(struct_rollupState) <= MAX_SIZE_ROLLUP_STATE, "Size struct_rollupState is too large");
+static_assert (ROLLUP_MEMORY % BLOCK_4K_SIZE_DATAFLASH == 0, "Size rollup log must be a multiple of 4K blocks");
+static_assert (ROLLUP_MEMORY >= 2 * BLOCK_4K_SIZE_DATAFLASH, "Rollup log must have a block with rollups while the next block is erased");
+static_assert (ROLLUP_MEMORY_ADDRESS + ROLLUP_MEMORY <= RESERVED_MEMORY_ADDRESS + RESERVED_MEMORY - BLOCK_4K_SIZE_DATAFLASH, "Rollup log overlaps the wear journal");
+
+static struct_rollupState rollupState;
+static bool rollupStateValid = false;
+static uint16_t rollupWindow = ROLLUP_WINDOW_DEFAULT;
+static bool rollupUplink = false;
+static uint32_t uplinkPendingId = ROLLUP_WINDOW_NONE;
+
+static STRUCT_measurementData measurement;
+static STRUCT_rollupRecord rollupBuffer;
+
+/**
+ * @fn uint32_t getRollupAddress(uint32_t)
+ * @brief helper function to get the dataflash address of a rollup
+ *
+ * @param rollupId : rollup ID
+ * @return address
+ */
+static uint32_t getRollupAddress( uint32_t rollupId )
+{
+  return ROLLUP_MEMORY_ADDRESS + (rollupId % ROLLUP_NUMBER_OF_RECORDS) * sizeof(STRUCT_rollupRecord);
+}
+
+/**
+ * @fn uint16_t calculateRollupCrc(const STRUCT_rollupRecord*)
+ * @brief helper function to calculate the CRC of a rollup
+ *
+ * @param rollup : rollup
+ * @return CRC
+ */
+static uint16_t calculateRollupCrc( const STRUCT_rollupRecord * rollup )
+{
+  return calculateCRC_CCITT((uint8_t*)&rollup->slotId, sizeof(STRUCT_rollupRecord) - sizeof(rollup->crc));
+}
+
+/**
+ * @fn bool checkRollup(const STRUCT_rollupRecord*, uint32_t)
+ * @brief helper function to check a rollup read from dataflash
+ *
+ * @param rollup : rollup
+ * @param rollupId : expected rollup ID
+ * @return true = valid
+ */
+static bool checkRollup( const STRUCT_rollupRecord * rollup, uint32_t rollupId )
+{
+  return rollup->rollupId == rollupId && rollup->crc == calculateRollupCrc(rollup) &&
+         rollup->slotId >= 1 && rollup->slotId <= MEASUREMENT_NUMBER_OF_SLOTS && rollup->numberOfValues <= ROLLUP_NUMBER_OF_VALUES;
+}
+
+/**
+ * @fn void saveState(void)
+ * @brief helper function to save the state in FRAM
+ *
+ */
+static void saveState( void )
+{
+  rollupState.protocolId = ROLLUP_STATE_PROTOCOL_ID;
+  rollupState.crc16 = calculateCRC_CCITT((uint8_t*)&rollupState.protocolId, sizeof(rollupState) - sizeof(rollupState.crc16));
+
+  saveRollupState(&rollupState, sizeof(rollupState));
+}
+
+/**
+ * @fn uint32_t searchNextRollupId(void)
+ * @brief helper function to find the next rollup ID in the rollup log, used when the state in FRAM is not valid.
+ * The block with the highest rollup ID in its first record is searched, then the records of that block are read.
+ *
+ * @return next rollup ID
+ */
+static uint32_t searchNextRollupId( void )
+{
+  uint32_t nextRollupId = 0;
+  uint32_t headBlock = ROLLUP_WINDOW_NONE;
+
+  for( uint32_t block = 0; block < ROLLUP_NUMBER_OF_RECORDS / ROLLUP_RECORDS_IN_BLOCK; block++ )
+  {
+    readPageFromDataflash(ROLLUP_MEMORY_ADDRESS + block * BLOCK_4K_SIZE_DATAFLASH, (uint8_t*)&rollupBuffer, sizeof(rollupBuffer));
+
+    if( (rollupBuffer.rollupId % ROLLUP_NUMBER_OF_RECORDS) == block * ROLLUP_RECORDS_IN_BLOCK && checkRollup(&rollupBuffer, rollupBuffer.rollupId) &&
+        (headBlock == ROLLUP_WINDOW_NONE || rollupBuffer.rollupId >= nextRollupId) )
+    {
+      headBlock = block;
+      nextRollupId = rollupBuffer.rollupId + 1;
+    }
+  }
+
+  if( headBlock == ROLLUP_WINDOW_NONE )
+  {
+    return 0;
+  }
+
+  //records of the head block are written in order
+  for( uint32_t i = 1; i < ROLLUP_RECORDS_IN_BLOCK; i++ )
+  {
+    readPageFromDataflash(getRollupAddress(nextRollupId), (uint8_t*)&rollupBuffer, sizeof(rollupBuffer));
+
+    if( checkRollup(&rollupBuffer, nextRollupId) == false )
+    {
+      break;
+    }
+
+    nextRollupId++;
+  }
+
+  return nextRollupId;
+}
+
+/**
+ * @fn int8_t restoreRollupLog(void)
+ * @brief function to restore the state of the aggregation from FRAM, done at the first use after a reset.
+ * When the state is not valid, the next rollup is searched in dataflash and all windows start again.
+ *
+ * @return 0 = restored, 1 = state not valid, rollup log searched
+ */
+int8_t restoreRollupLog( void )
+{
+  restoreRollupState(&rollupState, sizeof(rollupState));
+
+  rollupStateValid = true;
+  uplinkPendingId = ROLLUP_WINDOW_NONE;
+
+  if( rollupState.protocolId == ROLLUP_STATE_PROTOCOL_ID &&
+      rollupState.crc16 == calculateCRC_CCITT((uint8_t*)&rollupState.protocolId, sizeof(rollupState) - sizeof(rollupState.crc16)) )
+  {
+    return 0;
+  }
+
+  APP_LOG(TS_OFF, VLEVEL_M, "ROLLUP: state not valid, search rollup log\r\n");
+
+  memset(&rollupState, 0x00, sizeof(rollupState));
+  rollupState.nextRollupId = searchNextRollupId();
+  rollupState.uplinkRollupId = rollupState.nextRollupId; //older rollups are not sent again
+
+  for( int i = 0; i < MEASUREMENT_NUMBER_OF_SLOTS; i++ )
+  {
+    rollupState.window[i].windowStart = ROLLUP_WINDOW_NONE;
+  }
+
+  saveState();
+
+  return 1;
+}
+
+/**
+ * @fn int8_t setRollupLogWindow(uint16_t)
+ * @brief function to set the length of the aggregation window, an open window closes with the new length.
+ *
+ * @param minutes : length of the window, 0 = no rollups
+ * @return 0 = successful, -1 = out of range
+ */
+int8_t setRollupLogWindow( uint16_t minutes )
+{
+  if( minutes > ROLLUP_WINDOW_MAX )
+  {
+    return -1;
+  }
+
+  rollupWindow = minutes;
+
+  return 0;
+}
+
+/**
+ * @fn void setRollupLogUplink(bool)
+ * @brief function to enable the uplink of rollups, \ref packRollupUplink
+ *
+ * @param enabled : true = a rollup that is not sent replaces the latest measurement in the uplink
+ */
+void setRollupLogUplink( bool enabled )
+{
+  rollupUplink = enabled;
+}
+
+/**
+ * @fn int8_t decodeValues(const struct_MFM_sensorModuleData*, float*)
+ * @brief helper function to decode the values of the known sensor module data layouts
+ *
+ * @param sensorModuleData : sensor module data of a measurement
+ * @param values : destination of ROLLUP_NUMBER_OF_VALUES values
+ * @return number of values, 0 = unknown layout, -1 = data not valid
+ */
+static int8_t decodeValues( const struct_MFM_sensorModuleData * sensorModuleData, float * values )
+{
+  structDataPressureSensor keller;
+  structDataPressureSensorOneWire huba;
+
+  switch( sensorModuleData->sensorModuleTypeId )
+  {
+    case MFM_PRESSURE_RS485:
+
+      if( sensorModuleData->sensorModuleDataSize < sizeof(keller) - sizeof(keller.dataLength) )
+      {
+        return -1;
+      }
+
+      memcpy(&keller, &sensorModuleData->sensorModuleDataSize, sizeof(keller));
+      values[0] = keller.pressure1;
+      values[1] = keller.temperature1;
+      values[2] = keller.pressure2;
+      values[3] = keller.temperature2;
+
+      break;
+
+    case MFM_PRESSURE_ONEWIRE:
+
+      if( sensorModuleData->sensorModuleDataSize < sizeof(huba) - sizeof(huba.dataLength) )
+      {
+        return -1;
+      }
+
+      memcpy(&huba, &sensorModuleData->sensorModuleDataSize, sizeof(huba));
+      values[0] = getPressureHuba(huba.pressure1);
+      values[1] = getTemperatureHuba(huba.temperature1);
+      values[2] = getPressureHuba(huba.pressure2);
+      values[3] = getTemperatureHuba(huba.temperature2);
+
+      break;
+
+    default:
+      return 0;
+  }
+
+  for( int i = 0; i < ROLLUP_NUMBER_OF_VALUES; i++ )
+  {
+    if( isfinite(values[i]) == false )
+    {
+      return -1;
+    }
+  }
+
+  return ROLLUP_NUMBER_OF_VALUES;
+}
+
+/**
+ * @fn int8_t aggregateCallback(const STRUCT_measurementData*, void*)
+ * @brief callback of \ref readMeasurementSlotRange to add the measurements of a window to the rollup.
+ * Measurements of which the data is not valid are not counted.
+ *
+ * @param data : measurement
+ * @param context : \ref struct_rollupContext
+ * @return 0 = continue, -1 = first measurement after the window
+ */
+static int8_t aggregateCallback( const STRUCT_measurementData * data, void * context )
+{
+  struct_rollupContext * aggregate = (struct_rollupContext *)context;
+  STRUCT_rollupRecord * rollup = &aggregate->rollup;
+  float values[ROLLUP_NUMBER_OF_VALUES];
+  int8_t numberOfValues;
+
+  if( data->timestamp >= aggregate->windowEnd )
+  {
+    aggregate->nextMeasurementId = data->measurementId;
+    aggregate->nextTimestamp = data->timestamp;
+    return -1;
+  }
+
+  numberOfValues = decodeValues(&data->sensorModuleData, values);
+
+  if( data->timestamp < rollup->windowStart || numberOfValues < 0 || rollup->count == UINT16_MAX )
+  {
+    return 0;
+  }
+
+  if( rollup->count == 0 )
+  {
+    rollup->numberOfValues = numberOfValues;
+
+    for( int i = 0; i < numberOfValues; i++ )
+    {
+      rollup->minimum[i] = values[i];
+      rollup->maximum[i] = values[i];
+    }
+  }
+  else if( numberOfValues != rollup->numberOfValues )
+  {
+    return 0; //other sensor module in slot
+  }
+
+  for( int i = 0; i < numberOfValues; i++ )
+  {
+    rollup->minimum[i] = values[i] < rollup->minimum[i] ? values[i] : rollup->minimum[i];
+    rollup->maximum[i] = values[i] > rollup->maximum[i] ? values[i] : rollup->maximum[i];
+    aggregate->sum[i] += values[i];
+  }
+
+  rollup->count++;
+
+  return 0;
+}
+
+/**
+ * @fn int8_t writeRollup(STRUCT_rollupRecord*)
+ * @brief helper function to append a rollup to the rollup log, the first rollup in a block erases the block.
+ * A rollup written before power loss is found equal and not programmed again.
+ *
+ * @param rollup : rollup, the rollup ID and CRC are filled in
+ * @return 0 = successful, -5 = failed to write, -6 = written but verify failed
+ */
+static int8_t writeRollup( STRUCT_rollupRecord * rollup )
+{
+  uint32_t address;
+
+  rollup->rollupId = rollupState.nextRollupId;
+  rollup->crc = calculateRollupCrc(rollup);
+  address = getRollupAddress(rollup->rollupId);
+
+  if( (rollup->rollupId % ROLLUP_RECORDS_IN_BLOCK) == 0 )
+  {
+    //block can contain this rollup already, written before power loss, then the erase is repeated
+    readPageFromDataflash(address, (uint8_t*)&rollupBuffer, sizeof(rollupBuffer));
+
+    if( memcmp(&rollupBuffer, rollup, sizeof(rollupBuffer)) != 0 && blockErase4kDataflash(address) != 0 )
+    {
+      return -5;
+    }
+  }
+
+  readPageFromDataflash(address, (uint8_t*)&rollupBuffer, sizeof(rollupBuffer));
+
+  if( memcmp(&rollupBuffer, rollup, sizeof(rollupBuffer)) != 0 )
+  {
+    if( programDataInDataflash(address, (uint8_t*)rollup, sizeof(STRUCT_rollupRecord)) != 0 )
+    {
+      return -5;
+    }
+
+    readPageFromDataflash(address, (uint8_t*)&rollupBuffer, sizeof(rollupBuffer));
+
+    if( memcmp(&rollupBuffer, rollup, sizeof(rollupBuffer)) != 0 )
+    {
+      APP_LOG(TS_OFF, VLEVEL_H, "ROLLUP: verify of rollup %u failed\r\n", rollup->rollupId);
+      rollupState.nextRollupId++; //location is not used again
+      return -6;
+    }
+  }
+
+  rollupState.nextRollupId++;
+
+  return 0;
+}
+
+/**
+ * @fn int8_t updateRollup(uint8_t)
+ * @brief function to add the latest measurement to the aggregation, must be called after \ref writeNewMeasurement.
+ * The first measurement of a slot after its window closes the window, then the rollup of the window is written.
+ *
+ * @param slotId : slot of the latest measurement 1-6
+ * @return 0 = successful, 1 = rollup written, -1 = latest measurement not available, -5 = failed to write, -6 = written but verify failed
+ */
+int8_t updateRollup( uint8_t slotId )
+{
+  static struct_rollupContext context;
+  struct_rollupWindow * window;
+  uint32_t measurementId = getLatestMeasurementId();
+  uint32_t windowLength = rollupWindow * TM_SECONDS_IN_1MINUTE;
+  int8_t result = 0;
+
+  if( rollupWindow == 0 || slotId == 0 || slotId > MEASUREMENT_NUMBER_OF_SLOTS || measurementId == getOldestMeasurementId() )
+  {
+    return 0;
+  }
+
+  if( rollupStateValid == false )
+  {
+    restoreRollupLog();
+  }
+
+  measurementId--;
+
+  if( readMeasurement(measurementId, (uint8_t*)&measurement, sizeof(measurement)) != 0 ||
+      measurement.sensorModuleData.sensorModuleSlotId != slotId )
+  {
+    return -1;
+  }
+
+  window = &rollupState.window[slotId - 1];
+
+  //first measurement or time is set back, start a new window
+  if( window->windowStart == ROLLUP_WINDOW_NONE || measurement.timestamp < window->windowStart )
+  {
+    window->windowStart = measurement.timestamp - measurement.timestamp % windowLength;
+    window->firstMeasurementId = measurementId;
+    saveState();
+
+    return 0;
+  }
+
+  if( measurement.timestamp < window->windowStart + windowLength )
+  {
+    return 0; //window is still open
+  }
+
+  //window is closed, read its measurements once
+  memset(&context, 0x00, sizeof(context));
+  context.windowEnd = window->windowStart + windowLength;
+  context.nextMeasurementId = measurementId;
+  context.nextTimestamp = measurement.timestamp;
+  context.rollup.slotId = slotId;
+  context.rollup.windowStart = window->windowStart;
+  context.rollup.windowMinutes = rollupWindow;
+
+  if( window->firstMeasurementId < getOldestMeasurementId() )
+  {
+    window->firstMeasurementId = getOldestMeasurementId(); //measurements are overwritten or erased
+  }
+
+  if( readMeasurementSlotRange(slotId, window->firstMeasurementId, measurementId, aggregateCallback, &context) < 0 )
+  {
+    APP_LOG(TS_OFF, VLEVEL_H, "ROLLUP: read of window failed, slot %u\r\n", slotId);
+  }
+
+  if( context.rollup.count > 0 )
+  {
+    for( int i = 0; i < context.rollup.numberOfValues; i++ )
+    {
+      context.rollup.mean[i] = context.sum[i] / context.rollup.count;
+    }
+
+    result = writeRollup(&context.rollup);
+
+    if( result < 0 )
+    {
+      saveState(); //location of a failed verify is not used again
+      return result; //window is closed again at the next measurement
+    }
+
+    APP_LOG(TS_OFF, VLEVEL_H, "ROLLUP: %u, slot %u, count %u\r\n", context.rollup.rollupId, slotId, context.rollup.count);
+
+    result = 1;
+  }
+
+  window->windowStart = context.nextTimestamp - context.nextTimestamp % windowLength;
+  window->firstMeasurementId = context.nextMeasurementId;
+  saveState();
+
+  return result;
+}
+
+/**
+ * @fn int8_t readRollup(uint32_t, uint8_t*, uint32_t)
+ * @brief function to read a rollup from the rollup log
+ *
+ * @param rollupId : rollup ID
+ * @param buffer : destination of \ref STRUCT_rollupRecord
+ * @param bufferLength : size of buffer
+ * @return 0 = successful, -1 = not available, -2 = buffer too small, -3 = rollup corrupt
+ */
+int8_t readRollup( uint32_t rollupId, uint8_t * buffer, uint32_t bufferLength )
+{
+  if( bufferLength < sizeof(STRUCT_rollupRecord) )
+  {
+    return -2;
+  }
+
+  if( rollupId < getOldestRollupId() || rollupId >= getLatestRollupId() )
+  {
+    return -1;
+  }
+
+  readPageFromDataflash(getRollupAddress(rollupId), buffer, sizeof(STRUCT_rollupRecord));
+
+  if( checkRollup((STRUCT_rollupRecord *)buffer, rollupId) == false )
+  {
+    return -3;
+  }
+
+  return 0;
+}
+
+/**
+ * @fn int printValue(char*, uint32_t, float)
+ * @brief helper function to print a value with three decimals
+ *
+ * @param buffer : destination
+ * @param bufferLength : size of destination
+ * @param value : value
+ * @return number of characters
+ */
+static int printValue( char * buffer, uint32_t bufferLength, float value )
+{
+  uint32_t thousandths = (uint32_t)(fabsf(value) * 1000 + 0.5f);
+
+  return snprintf(buffer, bufferLength, "%s%lu.%03lu;", value < 0 ? "-" : "", (unsigned long)(thousandths / 1000), (unsigned long)(thousandths % 1000));
+}
+
+/**
+ * @fn int32_t printRollupData(uint32_t, uint8_t*, uint32_t)
+ * @brief function to print a rollup to a given buffer.
+ * Line: ID;slot;window start;window minutes;count;number of values;minimum;maximum;mean;... for each value
+ *
+ * @param rollupId
+ * @param buffer
+ * @param bufferLength
+ * @return number of characters, < 0 = rollup not available
+ */
+int32_t printRollupData( uint32_t rollupId, uint8_t * buffer, uint32_t bufferLength )
+{
+  uint32_t length = 0;
+
+  if( readRollup(rollupId, (uint8_t*)&rollupBuffer, sizeof(rollupBuffer)) != 0 )
+  {
+    return -1;
+  }
+
+  length += snprintf((char*) buffer + length, bufferLength - length, "%lu;", (unsigned long)rollupBuffer.rollupId);
+  length += snprintf((char*) buffer + length, bufferLength - length, "%u;", rollupBuffer.slotId);
+  length += snprintf((char*) buffer + length, bufferLength - length, "%lu;", (unsigned long)rollupBuffer.windowStart);
+  length += snprintf((char*) buffer + length, bufferLength - length, "%u;", rollupBuffer.windowMinutes);
+  length += snprintf((char*) buffer + length, bufferLength - length, "%u;", rollupBuffer.count);
+  length += snprintf((char*) buffer + length, bufferLength - length, "%u;", rollupBuffer.numberOfValues);
+
+  for( int i = 0; i < rollupBuffer.numberOfValues && length < bufferLength; i++ )
+  {
+    length += printValue((char*) buffer + length, bufferLength - length, rollupBuffer.minimum[i]);
+    length += printValue((char*) buffer + length, bufferLength - length, rollupBuffer.maximum[i]);
+    length += printValue((char*) buffer + length, bufferLength - length, rollupBuffer.mean[i]);
+  }
+
+  if( length >= bufferLength )
+    return -1;
+
+  length += snprintf((char*) buffer + length, bufferLength - length, "\r\n");
+
+  if( length >= bufferLength )
+      return -1;
+
+  return length;
+}
+
+/**
+ * @fn int32_t packRollupUplink(uint8_t*, uint32_t)
+ * @brief function to fill the LoRa payload with the oldest rollup that is not sent, when the uplink of rollups is enabled.
+ * Payload: slot, window start (4), window minutes (2), count (2), number of values, then minimum, maximum and mean (float) of each value.
+ * \ref confirmRollupUplink must be called when the payload is sent.
+ *
+ * @param buffer : destination of payload
+ * @param bufferLength : size of buffer, at least \ref ROLLUP_UPLINK_MAX_SIZE
+ * @return length of payload, 0 = no rollup to send
+ */
+int32_t packRollupUplink( uint8_t * buffer, uint32_t bufferLength )
+{
+  uint32_t rollupId;
+  uint32_t length = 0;
+
+  uplinkPendingId = ROLLUP_WINDOW_NONE;
+
+  if( rollupUplink == false || bufferLength < ROLLUP_UPLINK_MAX_SIZE )
+  {
+    return 0;
+  }
+
+  if( rollupStateValid == false )
+  {
+    restoreRollupLog();
+  }
+
+  rollupId = rollupState.uplinkRollupId;
+
+  if( rollupId < getOldestRollupId() )
+  {
+    rollupId = getOldestRollupId();
+  }
+
+  //skip rollups that are not readable
+  while( rollupId < getLatestRollupId() && readRollup(rollupId, (uint8_t*)&rollupBuffer, sizeof(rollupBuffer)) != 0 )
+  {
+    rollupId++;
+  }
+
+  if( rollupId >= getLatestRollupId() )
+  {
+    return 0;
+  }
+
+  buffer[length++] = rollupBuffer.slotId;
+  memcpy(&buffer[length], &rollupBuffer.windowStart, sizeof(rollupBuffer.windowStart));
+  length += sizeof(rollupBuffer.windowStart);
+  memcpy(&buffer[length], &rollupBuffer.windowMinutes, sizeof(rollupBuffer.windowMinutes));
+  length += sizeof(rollupBuffer.windowMinutes);
+  memcpy(&buffer[length], &rollupBuffer.count, sizeof(rollupBuffer.count));
+  length += sizeof(rollupBuffer.count);
+  buffer[length++] = rollupBuffer.numberOfValues;
+
+  for( int i = 0; i < rollupBuffer.numberOfValues; i++ )
+  {
+    memcpy(&buffer[length], &rollupBuffer.minimum[i], sizeof(float));
+    length += sizeof(float);
+    memcpy(&buffer[length], &rollupBuffer.maximum[i], sizeof(float));
+    length += sizeof(float);
+    memcpy(&buffer[length], &rollupBuffer.mean[i], sizeof(float));
+    length += sizeof(float);
+  }
+
+  uplinkPendingId = rollupId;
+
+  return length;
+}
+
+/**
+ * @fn void confirmRollupUplink(void)
+ * @brief function to mark the rollup of the latest \ref packRollupUplink as sent
+ *
+ */
+void confirmRollupUplink( void )
+{
+  if( uplinkPendingId == ROLLUP_WINDOW_NONE )
+  {
+    return;
+  }
+
+  rollupState.uplinkRollupId = uplinkPendingId + 1;
+  uplinkPendingId = ROLLUP_WINDOW_NONE;
+  saveState();
+}
+
+/**
+ * @fn uint32_t getLatestRollupId(void)
+ * @brief function to get the ID of the next rollup
+ *
+ * @return rollup ID after the latest rollup
+ */
+uint32_t getLatestRollupId( void )
+{
+  if( rollupStateValid == false )
+  {
+    restoreRollupLog();
+  }
+
+  return rollupState.nextRollupId;
+}
+
+/**
+ * @fn uint32_t getOldestRollupId(void)
+ * @brief function to get the ID of the oldest rollup in the rollup log, the first rollup in a block erases the oldest block
+ *
+ * @return rollup ID
+ */
+uint32_t getOldestRollupId( void )
+{
+  if( rollupStateValid == false )
+  {
+    restoreRollupLog();
+  }
+
+  if( rollupState.nextRollupId <= ROLLUP_NUMBER_OF_RECORDS )
+  {
+    return 0;
+  }
+
+  return ((rollupState.nextRollupId - 1) / ROLLUP_RECORDS_IN_BLOCK + 1) * ROLLUP_RECORDS_IN_BLOCK - ROLLUP_NUMBER_OF_RECORDS;
+}
@@ -0,0 +1,49 @@
+/**
+  ******************************************************************************
+  * @file           : rollup.h
+  * @brief          : Header for rollup.c file.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  ******************************************************************************
+  */
+#ifndef ROLLUP_H_
+#define ROLLUP_H_
+
+#include <stddef.h>
+
+#define ROLLUP_WINDOW_DEFAULT       0     //minutes, length of the aggregation window, 0 = no rollups
+#define ROLLUP_WINDOW_MAX           1440  //minutes, one day
+#define ROLLUP_NUMBER_OF_VALUES     4     //values of the known sensor module data layouts, pressure and temperature of two sensors
+#define ROLLUP_UPLINK_MAX_SIZE      ( 10 + ROLLUP_NUMBER_OF_VALUES * 3 * sizeof(float) ) //header and minimum, maximum and mean of each value
+
+/**
+ * Rollup record in the rollup log of the dataflash, aggregate of the measurements of one slot in one window.
+ * The records have a fixed size, the address follows from the rollup ID.
+ */
+typedef struct __attribute__((packed))
+{
+  uint16_t crc;                 //CRC over all fields after this field
+  uint8_t slotId;               //sensor module slot 1-6
+  uint8_t numberOfValues;       //decoded values, 0 = unknown sensor module data, only the count is available
+  uint32_t rollupId;
+  uint32_t windowStart;         //timestamp of the start of the window
+  uint16_t windowMinutes;       //length of the window
+  uint16_t count;               //number of measurements in the window
+  float minimum[ROLLUP_NUMBER_OF_VALUES];
+  float maximum[ROLLUP_NUMBER_OF_VALUES];
+  float mean[ROLLUP_NUMBER_OF_VALUES];
+}STRUCT_rollupRecord;
+
+int8_t restoreRollupLog( void );
+int8_t setRollupLogWindow( uint16_t minutes );
+void setRollupLogUplink( bool enabled );
+int8_t updateRollup( uint8_t slotId );
+int8_t readRollup( uint32_t rollupId, uint8_t * buffer, uint32_t bufferLength );
+int32_t printRollupData( uint32_t rollupId, uint8_t * buffer, uint32_t bufferLength );
+int32_t packRollupUplink( uint8_t * buffer, uint32_t bufferLength );
+void confirmRollupUplink( void );
+uint32_t getLatestRollupId( void );
+uint32_t getOldestRollupId( void );
+
+#endif /* ROLLUP_H_ */
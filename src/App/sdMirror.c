@@ -0,0 +1,389 @@
+/**
+  ******************************************************************************
+  * @addtogroup     : App
+  * @{
+  * @file           : sdMirror.c
+  * @brief          : append-only mirror of the measurement log on the SD card, to swap a card instead of a dump over UART.
+  * The mirror file is preallocated contiguous with f_expand, the blocks are written with multi-sector writes
+  * directly at their sector. The first sector of the file is kept in FRAM, a wake checks the file header and
+  * writes without a mount or walk of the FAT. The file system is only mounted for a new or swapped card.
+  * The measurements are written in batches, the SD card is not powered at each wake.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  * @}
+  ******************************************************************************
+  */
+
+#include <string.h>
+
+#include "main.h"
+#include "sys_app.h"
+#include "stm32_systime.h"
+#include "app_fatfs.h"
+#include "common/crc16.h"
+#include "FRAM/FRAM_functions.h"
+#include "measurement.h"
+#include "CommConfig.h"
+#include "sdMirror.h"
+
+#define SD_MIRROR_STATE_PROTOCOL_ID   0x00
+#define SD_MIRROR_HEADER_PROTOCOL_ID  0x00
+#define SD_MIRROR_DRIVE               0     //physical drive of the USER driver
+
+/**
+ * @brief state of the mirror in FRAM
+ */
+typedef struct __attribute__((packed))
+{
+  uint16_t crc16;               //CRC over all fields after this field
+  uint8_t protocolId;           //\ref SD_MIRROR_STATE_PROTOCOL_ID
+  uint8_t spare;
+  uint32_t fileId;              //file of the last written card
+  uint32_t startSector;         //first sector of the file of the last written card, 0 = no file
+  uint32_t nextMeasurementId;   //ID of the next measurement to mirror
+}struct_sdMirrorState;
+
+static_assert (sizeof(struct_sdMirrorState) <= MAX_SIZE_SD_MIRROR_STATE, "Size struct_sdMirrorState is too large");
+static_assert (sizeof(struct_sdMirrorHeader) <= SD_MIRROR_SECTOR_SIZE, "Size struct_sdMirrorHeader is too large");
+static_assert (SD_MIRROR_BLOCK_SIZE % SD_MIRROR_SECTOR_SIZE == 0, "Size of block must be a multiple of sectors");
+
+static struct_sdMirrorState mirrorState;
+static bool mirrorStateValid = false;
+static struct_sdMirrorHeader fileHeader;
+static uint8_t blockBuffer[SD_MIRROR_BLOCK_SIZE];
+
+/**
+ * @fn void saveState(void)
+ * @brief helper function to save the state in FRAM
+ *
+ */
+static void saveState( void )
+{
+  mirrorState.protocolId = SD_MIRROR_STATE_PROTOCOL_ID;
+  mirrorState.crc16 = calculateCRC_CCITT((uint8_t*)&mirrorState.protocolId, sizeof(mirrorState) - sizeof(mirrorState.crc16));
+
+  saveSdMirrorState(&mirrorState, sizeof(mirrorState));
+}
+
+/**
+ * @fn void restoreState(void)
+ * @brief helper function to restore the state from FRAM, when not valid the mirror starts at the oldest measurement on a new file
+ *
+ */
+static void restoreState( void )
+{
+  restoreSdMirrorState(&mirrorState, sizeof(mirrorState));
+
+  mirrorStateValid = true;
+
+  if( mirrorState.protocolId != SD_MIRROR_STATE_PROTOCOL_ID ||
+      mirrorState.crc16 != calculateCRC_CCITT((uint8_t*)&mirrorState.protocolId, sizeof(mirrorState) - sizeof(mirrorState.crc16)) )
+  {
+    APP_LOG(TS_OFF, VLEVEL_M, "SD MIRROR: state not valid\r\n");
+
+    memset(&mirrorState, 0x00, sizeof(mirrorState));
+    mirrorState.nextMeasurementId = getOldestMeasurementId();
+  }
+}
+
+/**
+ * @fn int8_t readFileHeader(uint32_t)
+ * @brief helper function to read and check the header of the mirror file
+ *
+ * @param startSector : first sector of the file
+ * @return 0 = valid, -1 = read failed, -2 = not a valid mirror file at this sector
+ */
+static int8_t readFileHeader( uint32_t startSector )
+{
+  if( disk_read(SD_MIRROR_DRIVE, blockBuffer, startSector, 1) != RES_OK )
+  {
+    return -1;
+  }
+
+  memcpy(&fileHeader, blockBuffer, sizeof(fileHeader));
+
+  if( memcmp(fileHeader.magic, SD_MIRROR_MAGIC, sizeof(fileHeader.magic)) != 0 || fileHeader.protocolId != SD_MIRROR_HEADER_PROTOCOL_ID ||
+      fileHeader.crc != calculateCRC_CCITT((uint8_t*)&fileHeader, sizeof(fileHeader) - sizeof(fileHeader.crc)) ||
+      fileHeader.startSector != startSector || fileHeader.blockSize != SD_MIRROR_BLOCK_SIZE ||
+      fileHeader.writeSector > fileHeader.numberOfSectors || fileHeader.writeSector % SD_MIRROR_BLOCK_SECTORS != 0 )
+  {
+    return -2;
+  }
+
+  return 0;
+}
+
+/**
+ * @fn int8_t writeFileHeader(void)
+ * @brief helper function to write the header of the mirror file, the sync point of the appended blocks
+ *
+ * @return 0 = successful, -4 = write failed
+ */
+static int8_t writeFileHeader( void )
+{
+  fileHeader.crc = calculateCRC_CCITT((uint8_t*)&fileHeader, sizeof(fileHeader) - sizeof(fileHeader.crc));
+
+  memset(blockBuffer, 0x00, SD_MIRROR_SECTOR_SIZE);
+  memcpy(blockBuffer, &fileHeader, sizeof(fileHeader));
+
+  if( disk_write(SD_MIRROR_DRIVE, blockBuffer, fileHeader.startSector, 1) != RES_OK )
+  {
+    return -4;
+  }
+
+  return 0;
+}
+
+/**
+ * @fn int8_t createMirrorFile(FIL*)
+ * @brief helper function to preallocate the opened empty file as one contiguous area and write its header.
+ * The size is halved until a contiguous area is found.
+ *
+ * @param file : opened empty file
+ * @return 0 = successful, -3 = no contiguous space, -4 = write failed
+ */
+static int8_t createMirrorFile( FIL * file )
+{
+  uint32_t size;
+
+  for( size = SD_MIRROR_FILE_SIZE; size >= SD_MIRROR_FILE_MINIMUM; size /= 2 )
+  {
+    if( f_expand(file, size, 1) == FR_OK )
+    {
+      break;
+    }
+  }
+
+  if( size < SD_MIRROR_FILE_MINIMUM )
+  {
+    return -3;
+  }
+
+  memset(&fileHeader, 0x00, sizeof(fileHeader));
+  memcpy(fileHeader.magic, SD_MIRROR_MAGIC, sizeof(fileHeader.magic));
+  fileHeader.protocolId = SD_MIRROR_HEADER_PROTOCOL_ID;
+  fileHeader.blockSize = SD_MIRROR_BLOCK_SIZE;
+  fileHeader.fileId = SysTimeGet().Seconds;
+  fileHeader.startSector = file->obj.fs->database + (file->obj.sclust - 2) * file->obj.fs->csize;
+  fileHeader.numberOfSectors = size / SD_MIRROR_SECTOR_SIZE;
+  fileHeader.writeSector = SD_MIRROR_BLOCK_SECTORS; //first block is the header
+  fileHeader.firstMeasurementId = mirrorState.nextMeasurementId;
+  fileHeader.nextMeasurementId = mirrorState.nextMeasurementId;
+
+  if( fileHeader.fileId == mirrorState.fileId )
+  {
+    fileHeader.fileId++; //file of a swapped card differs from the previous file
+  }
+
+  APP_LOG(TS_OFF, VLEVEL_M, "SD MIRROR: new file of %lu sectors at sector %lu\r\n", (unsigned long)fileHeader.numberOfSectors, (unsigned long)fileHeader.startSector);
+
+  return writeFileHeader();
+}
+
+/**
+ * @fn int8_t openMirrorFile(void)
+ * @brief helper function to find the mirror file. The file of the last wake is checked by its header only,
+ * a new or swapped card is mounted to open or create the file.
+ *
+ * @return 0 = successful, -1 = card not available, -2 = file not valid, -3 = no contiguous space, -4 = write failed
+ */
+static int8_t openMirrorFile( void )
+{
+  FRESULT fres;
+  int8_t result = 0;
+
+  //same card as the last wake, no file system access
+  if( mirrorState.startSector != 0 && readFileHeader(mirrorState.startSector) == 0 && fileHeader.fileId == mirrorState.fileId )
+  {
+    return 0;
+  }
+
+  fres = f_mount(&USERFatFs, USERPath, 1);
+
+  if( fres != FR_OK )
+  {
+    return -1;
+  }
+
+  fres = f_open(&USERFile, SD_MIRROR_FILE_NAME, FA_READ | FA_WRITE | FA_OPEN_ALWAYS);
+
+  if( fres != FR_OK )
+  {
+    result = -1;
+  }
+  else if( f_size(&USERFile) == 0 )
+  {
+    result = createMirrorFile(&USERFile);
+    f_close(&USERFile);
+  }
+  else
+  {
+    //file of an earlier wake, only the first sector is needed, the file is contiguous
+    result = readFileHeader(USERFatFs.database + (USERFile.obj.sclust - 2) * USERFatFs.csize);
+    f_close(&USERFile);
+  }
+
+  f_mount(NULL, USERPath, 0);
+
+  if( result == 0 )
+  {
+    mirrorState.fileId = fileHeader.fileId;
+    mirrorState.startSector = fileHeader.startSector;
+  }
+
+  return result;
+}
+
+/**
+ * @fn int8_t writeBlock(uint32_t*, uint32_t)
+ * @brief helper function to pack measurements in one block and append it to the mirror file
+ *
+ * @param measurementId : ID of first measurement, updated to the ID after the block
+ * @param endMeasurementId : ID after the last measurement
+ * @return 0 = successful, 1 = no records available, -3 = file full, -4 = write failed, -5 = read of measurements failed
+ */
+static int8_t writeBlock( uint32_t * measurementId, uint32_t endMeasurementId )
+{
+  struct_dumpBlockHeader * header = (struct_dumpBlockHeader *)blockBuffer;
+  uint32_t firstMeasurementId;
+  uint32_t nextMeasurementId;
+  uint16_t numberOfRecords;
+  uint16_t crc;
+  int32_t length;
+
+  if( fileHeader.writeSector + SD_MIRROR_BLOCK_SECTORS > fileHeader.numberOfSectors )
+  {
+    return -3; //swap card
+  }
+
+  length = packMeasurementBlock(0, *measurementId, endMeasurementId, &blockBuffer[sizeof(struct_dumpBlockHeader)],
+                                sizeof(blockBuffer) - sizeof(struct_dumpBlockHeader) - sizeof(crc), &firstMeasurementId, &nextMeasurementId, &numberOfRecords);
+
+  if( length < 0 )
+  {
+    return -5;
+  }
+
+  if( numberOfRecords == 0 )
+  {
+    *measurementId = endMeasurementId; //no more records available
+    return 1;
+  }
+
+  header->sync = DUMP_BLOCK_SYNC;
+  header->sequence = fileHeader.writeSector / SD_MIRROR_BLOCK_SECTORS - 1;
+  header->firstMeasurementId = firstMeasurementId;
+  header->numberOfRecords = numberOfRecords;
+  header->length = length;
+  header->slotId = 0;
+
+  crc = calculateCRC_CCITT(blockBuffer, sizeof(struct_dumpBlockHeader) + length);
+  memcpy(&blockBuffer[sizeof(struct_dumpBlockHeader) + length], &crc, sizeof(crc));
+  memset(&blockBuffer[sizeof(struct_dumpBlockHeader) + length + sizeof(crc)], 0x00, sizeof(blockBuffer) - sizeof(struct_dumpBlockHeader) - length - sizeof(crc));
+
+  if( disk_write(SD_MIRROR_DRIVE, blockBuffer, fileHeader.startSector + fileHeader.writeSector, SD_MIRROR_BLOCK_SECTORS) != RES_OK )
+  {
+    return -4;
+  }
+
+  fileHeader.writeSector += SD_MIRROR_BLOCK_SECTORS;
+  *measurementId = nextMeasurementId;
+
+  return 0;
+}
+
+/**
+ * @fn int8_t mirrorMeasurementsToSd(uint8_t)
+ * @brief function to append the new measurements to the mirror file on the SD card, when a batch of measurements is available.
+ * The blocks are written first, then the file header and the state in FRAM. After power loss the blocks are written again.
+ *
+ * @param batch : measurements collected before the SD card is written, 0 = no mirror
+ * @return number of blocks written, -1 = card not available, -2 = file not valid, -3 = file full or no contiguous space,
+ *         -4 = write failed, -5 = read of measurements failed
+ */
+int8_t mirrorMeasurementsToSd( uint8_t batch )
+{
+  uint32_t latestMeasurementId = getLatestMeasurementId();
+  uint32_t measurementId;
+  int8_t blocks = 0;
+  int8_t result;
+
+  if( batch == 0 )
+  {
+    return 0;
+  }
+
+  if( mirrorStateValid == false )
+  {
+    restoreState();
+  }
+
+  //measurements overwritten before mirrored or measurement memory erased
+  if( mirrorState.nextMeasurementId < getOldestMeasurementId() || mirrorState.nextMeasurementId > latestMeasurementId )
+  {
+    mirrorState.nextMeasurementId = getOldestMeasurementId();
+  }
+
+  if( latestMeasurementId - mirrorState.nextMeasurementId < batch )
+  {
+    return 0;
+  }
+
+  setup_io_for_SdCard(true);
+
+  result = (disk_initialize(SD_MIRROR_DRIVE) & STA_NOINIT) ? -1 : openMirrorFile();
+
+  measurementId = mirrorState.nextMeasurementId;
+
+  while( result == 0 && blocks < SD_MIRROR_MAX_BLOCKS && measurementId < latestMeasurementId )
+  {
+    result = writeBlock(&measurementId, latestMeasurementId);
+
+    if( result == 0 )
+    {
+      blocks++;
+    }
+  }
+
+  if( blocks > 0 )
+  {
+    fileHeader.nextMeasurementId = measurementId;
+
+    if( writeFileHeader() == 0 && disk_ioctl(SD_MIRROR_DRIVE, CTRL_SYNC, NULL) == RES_OK )
+    {
+      mirrorState.nextMeasurementId = measurementId;
+      saveState();
+    }
+    else
+    {
+      result = -4;
+    }
+  }
+
+  setup_io_for_SdCard(false);
+
+  if( result < 0 )
+  {
+    APP_LOG(TS_OFF, VLEVEL_M, "SD MIRROR: ERROR %d, measurement %lu\r\n", result, (unsigned long)measurementId);
+    return result;
+  }
+
+  return blocks;
+}
+
+/**
+ * @fn uint32_t getSdMirrorMeasurementId(void)
+ * @brief function to get the ID of the next measurement to write on the SD card
+ *
+ * @return measurement ID
+ */
+uint32_t getSdMirrorMeasurementId( void )
+{
+  if( mirrorStateValid == false )
+  {
+    restoreState();
+  }
+
+  return mirrorState.nextMeasurementId;
+}
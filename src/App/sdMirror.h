@@ -0,0 +1,49 @@
+/**
+  ******************************************************************************
+  * @file           : sdMirror.h
+  * @brief          : Header for sdMirror.c file.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  ******************************************************************************
+  */
+#ifndef SDMIRROR_H_
+#define SDMIRROR_H_
+
+#include <stdint.h>
+
+#define SD_MIRROR_FILE_NAME         "MFMLOG.BIN"
+#define SD_MIRROR_FILE_SIZE         ( 64UL * 1024 * 1024 )  //preallocated contiguous, halved until it fits
+#define SD_MIRROR_FILE_MINIMUM      ( 1UL * 1024 * 1024 )
+#define SD_MIRROR_SECTOR_SIZE       512
+#define SD_MIRROR_BLOCK_SIZE        2048  //one multi-sector write, aligned in the file, the first block holds the file header
+#define SD_MIRROR_BLOCK_SECTORS     ( SD_MIRROR_BLOCK_SIZE / SD_MIRROR_SECTOR_SIZE )
+#define SD_MIRROR_MAX_BLOCKS        8     //blocks in one wake, limits the time of a wake when the mirror catches up
+#define SD_MIRROR_BATCH_MAX         64    //measurements collected before the SD card is written
+
+#define SD_MIRROR_MAGIC             "MFMSDLOG"
+
+/**
+ * Header of the mirror file in its first sector.
+ * The blocks follow from the second block, each block is a \ref struct_dumpBlockHeader with the packed records of
+ * the binary DataDump and its CRC, padded with zeros. A block can repeat measurements of the previous block after power loss.
+ */
+typedef struct __attribute__((packed))
+{
+  char magic[8];                //\ref SD_MIRROR_MAGIC, not terminated
+  uint8_t protocolId;
+  uint8_t spare;
+  uint16_t blockSize;           //\ref SD_MIRROR_BLOCK_SIZE
+  uint32_t fileId;              //identification of the file, a swapped card has another file
+  uint32_t startSector;         //first sector of the file on the card
+  uint32_t numberOfSectors;     //preallocated sectors of the file
+  uint32_t writeSector;         //sector after the last block, relative to the start of the file
+  uint32_t firstMeasurementId;  //measurement ID of the first block
+  uint32_t nextMeasurementId;   //measurement ID after the last block
+  uint16_t crc;                 //CRC over all fields before this field
+}struct_sdMirrorHeader;
+
+int8_t mirrorMeasurementsToSd( uint8_t batch );
+uint32_t getSdMirrorMeasurementId( void );
+
+#endif /* SDMIRROR_H_ */
@@ -0,0 +1,213 @@
+/**
+  ******************************************************************************
+  * @addtogroup     : App
+  * @{
+  * @file           : sdOffload.c
+  * @brief          : offload of the complete measurement memory to a binary file on the SD card, to archive the log
+  * in seconds instead of a dump over UART. The file is preallocated contiguous with f_expand, the dataflash is read
+  * with continuous reads and written with multi-sector writes directly at the sectors of the file.
+  * The image starts aligned on the card, a write never crosses an allocation unit of the card.
+  * The dataflash and the SD card share SPI1, the card programs a write while the next buffer is read from the dataflash,
+  * the driver waits on the card at the start of the next command.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  * @}
+  ******************************************************************************
+  */
+
+#include <string.h>
+
+#include "main.h"
+#include "sys_app.h"
+#include "app_fatfs.h"
+#include "common/crc16.h"
+#include "dataflash/dataflash_functions.h"
+#include "measurement.h"
+#include "sdOffload.h"
+
+#define SD_OFFLOAD_HEADER_PROTOCOL_ID  0x00
+#define SD_OFFLOAD_DRIVE               0     //physical drive of the USER driver
+
+static_assert (sizeof(struct_sdOffloadHeader) <= SD_OFFLOAD_SECTOR_SIZE, "Size struct_sdOffloadHeader is too large");
+static_assert (MEASUREMENT_MEMEORY_SIZE % SD_OFFLOAD_BUFFER_SIZE == 0, "Size of measurement memory must be a multiple of buffers");
+
+static bool offloadActive = false;
+static uint32_t startSector;        //first sector of the file, header
+static uint32_t imageSector;        //first sector of the image
+static uint32_t startTick;
+static struct_sdOffloadHeader offloadHeader;
+static uint8_t offloadBuffer[SD_OFFLOAD_BUFFER_SIZE];
+
+/**
+ * @fn int8_t createOffloadFile(void)
+ * @brief helper function to create the offload file, preallocated as one contiguous area.
+ * The sectors before the image are cleared, a header of an old file in the same area is not valid.
+ *
+ * @return 0 = successful, -1 = card not available, -3 = no contiguous space, -4 = write failed
+ */
+static int8_t createOffloadFile( void )
+{
+  DWORD allocationUnit = 0;
+  uint32_t headerSectors;
+  int8_t result = 0;
+
+  if( f_mount(&USERFatFs, USERPath, 1) != FR_OK )
+  {
+    return -1;
+  }
+
+  if( f_open(&USERFile, SD_OFFLOAD_FILE_NAME, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK )
+  {
+    f_mount(NULL, USERPath, 0);
+    return -1;
+  }
+
+  //one buffer more for the header and alignment of the image
+  if( f_expand(&USERFile, SD_OFFLOAD_BUFFER_SIZE + MEASUREMENT_MEMEORY_SIZE, 1) != FR_OK )
+  {
+    result = -3;
+  }
+  else
+  {
+    startSector = USERFatFs.database + (USERFile.obj.sclust - 2) * USERFatFs.csize;
+
+    //image starts at a multiple of the buffer, allocation units are a multiple of the buffer
+    headerSectors = SD_OFFLOAD_BUFFER_SECTORS - startSector % SD_OFFLOAD_BUFFER_SECTORS;
+    imageSector = startSector + headerSectors;
+
+    disk_ioctl(SD_OFFLOAD_DRIVE, GET_BLOCK_SIZE, &allocationUnit);
+    APP_LOG(TS_OFF, VLEVEL_M, "SD OFFLOAD: file at sector %lu, image at sector %lu, allocation unit %lu sectors\r\n", (unsigned long)startSector, (unsigned long)imageSector, (unsigned long)allocationUnit);
+
+    memset(offloadBuffer, 0x00, sizeof(offloadBuffer));
+
+    if( disk_write(SD_OFFLOAD_DRIVE, offloadBuffer, startSector, headerSectors) != RES_OK )
+    {
+      result = -4;
+    }
+  }
+
+  f_close(&USERFile);
+  f_mount(NULL, USERPath, 0);
+
+  return result;
+}
+
+/**
+ * @fn int8_t writeOffloadHeader(void)
+ * @brief helper function to write the header of the offload file, the header is written after the image.
+ *
+ * @return 0 = successful, -4 = write failed
+ */
+static int8_t writeOffloadHeader( void )
+{
+  offloadHeader.milliseconds = HAL_GetTick() - startTick;
+  offloadHeader.crc = calculateCRC_CCITT((uint8_t*)&offloadHeader, sizeof(offloadHeader) - sizeof(offloadHeader.crc));
+
+  memset(offloadBuffer, 0x00, SD_OFFLOAD_SECTOR_SIZE);
+  memcpy(offloadBuffer, &offloadHeader, sizeof(offloadHeader));
+
+  if( disk_write(SD_OFFLOAD_DRIVE, offloadBuffer, startSector, 1) != RES_OK ||
+      disk_ioctl(SD_OFFLOAD_DRIVE, CTRL_SYNC, NULL) != RES_OK )
+  {
+    return -4;
+  }
+
+  return 0;
+}
+
+/**
+ * @fn int8_t offloadMeasurementMemoryToSd(uint32_t*)
+ * @brief function to offload the measurement memory to the SD card, buffer by buffer. Start with address 0 and
+ * call again while busy. The SD card stays acquired between the calls.
+ *
+ * @param address : address in the measurement memory, 0 = start, updated to the next address
+ * @return 0 = busy, 1 = ready, -1 = card not available, -3 = no contiguous space, -4 = write failed,
+ * -5 = measurements staged in FRAM not programmed
+ */
+const int8_t offloadMeasurementMemoryToSd( uint32_t * address )
+{
+  int8_t result = 0;
+
+  if( *address == 0 && offloadActive == false )
+  {
+    setup_io_for_SdCard(true);
+    offloadActive = true;
+
+    //measurements staged in FRAM are programmed first, the image and its header include them
+    if( flushMeasurementLog() != 0 )
+    {
+      result = -5;
+    }
+
+    startTick = HAL_GetTick();
+
+    memset(&offloadHeader, 0x00, sizeof(offloadHeader));
+    memcpy(offloadHeader.magic, SD_OFFLOAD_MAGIC, sizeof(offloadHeader.magic));
+    offloadHeader.protocolId = SD_OFFLOAD_HEADER_PROTOCOL_ID;
+    offloadHeader.pageSize = PAGE_SIZE_DATAFLASH;
+    offloadHeader.imageSize = MEASUREMENT_MEMEORY_SIZE;
+    offloadHeader.oldestMeasurementId = getOldestMeasurementId();
+    offloadHeader.latestMeasurementId = getLatestMeasurementId();
+
+    if( result == 0 )
+    {
+      result = (disk_initialize(SD_OFFLOAD_DRIVE) & STA_NOINIT) ? -1 : createOffloadFile();
+    }
+
+    offloadHeader.imageOffset = (imageSector - startSector) * SD_OFFLOAD_SECTOR_SIZE;
+  }
+
+  for( uint8_t i = 0; result == 0 && i < SD_OFFLOAD_BUFFERS_PER_CALL && *address < MEASUREMENT_MEMEORY_SIZE; i++ )
+  {
+    startReadDataflash(*address);
+    continueReadDataflash(offloadBuffer, sizeof(offloadBuffer));
+    stopReadDataflash();
+
+    if( disk_write(SD_OFFLOAD_DRIVE, offloadBuffer, imageSector + *address / SD_OFFLOAD_SECTOR_SIZE, SD_OFFLOAD_BUFFER_SECTORS) != RES_OK )
+    {
+      result = -4;
+    }
+    else
+    {
+      *address += SD_OFFLOAD_BUFFER_SIZE;
+    }
+  }
+
+  if( result == 0 && *address >= MEASUREMENT_MEMEORY_SIZE )
+  {
+    result = writeOffloadHeader();
+
+    if( result == 0 )
+    {
+      result = 1;
+      APP_LOG(TS_OFF, VLEVEL_M, "SD OFFLOAD: %lu bytes in %lu ms\r\n", (unsigned long)offloadHeader.imageSize, (unsigned long)offloadHeader.milliseconds);
+    }
+  }
+
+  if( result != 0 )
+  {
+    if( result < 0 )
+    {
+      APP_LOG(TS_OFF, VLEVEL_M, "SD OFFLOAD: ERROR %d, address %lu\r\n", result, (unsigned long)*address);
+    }
+
+    setup_io_for_SdCard(false);
+    offloadActive = false;
+  }
+
+  return result;
+}
+
+/**
+ * @fn void getSdOffloadResult(uint32_t*, uint32_t*)
+ * @brief function to get the size and time of the last offload
+ *
+ * @param bytes : bytes of the image
+ * @param milliseconds : time of the offload
+ */
+void getSdOffloadResult( uint32_t * bytes, uint32_t * milliseconds )
+{
+  *bytes = offloadHeader.imageSize;
+  *milliseconds = offloadHeader.milliseconds;
+}
@@ -0,0 +1,44 @@
+/**
+  ******************************************************************************
+  * @file           : sdOffload.h
+  * @brief          : Header for sdOffload.c file.
+  * @author         : agent
+  * @date           : Oct 17, 2026
+  * @copyright      : 2026 Dekimo Goes
+  ******************************************************************************
+  */
+#ifndef SDOFFLOAD_H_
+#define SDOFFLOAD_H_
+
+#include <stdint.h>
+
+#define SD_OFFLOAD_FILE_NAME        "MFMRING.BIN"
+#define SD_OFFLOAD_SECTOR_SIZE      512
+#define SD_OFFLOAD_BUFFER_SIZE      4096  //one continuous read of the dataflash and one multi-sector write, aligned on the card
+#define SD_OFFLOAD_BUFFER_SECTORS   ( SD_OFFLOAD_BUFFER_SIZE / SD_OFFLOAD_SECTOR_SIZE )
+#define SD_OFFLOAD_BUFFERS_PER_CALL 16    //buffers of one call, the config uart handler stays responsive
+
+#define SD_OFFLOAD_MAGIC            "MFMRING_"
+
+/**
+ * Header of the offload file in its first sector, written after the image as the last sector.
+ * The image of the measurement memory follows at imageOffset, the sectors before are zero.
+ */
+typedef struct __attribute__((packed))
+{
+  char magic[8];                //\ref SD_OFFLOAD_MAGIC, not terminated
+  uint8_t protocolId;
+  uint8_t spare;
+  uint16_t pageSize;            //page size of the dataflash
+  uint32_t imageOffset;         //bytes before the image in the file, the image starts aligned on the card
+  uint32_t imageSize;           //bytes of the measurement memory
+  uint32_t oldestMeasurementId; //at start of the offload
+  uint32_t latestMeasurementId; //at start of the offload
+  uint32_t milliseconds;        //time of the offload
+  uint16_t crc;                 //CRC over all fields before this field
+}struct_sdOffloadHeader;
+
+const int8_t offloadMeasurementMemoryToSd( uint32_t * address );
+void getSdOffloadResult( uint32_t * bytes, uint32_t * milliseconds );
+
+#endif /* SDOFFLOAD_H_ */
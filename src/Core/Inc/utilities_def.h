@@ -48,6 +48,7 @@ typedef enum
   CFG_LPM_APPLI_Id,
   CFG_LPM_UART_TX_Id,
   /* USER CODE BEGIN CFG_LPM_Id_t */
+  CFG_LPM_SPI_Id,
 
   /* USER CODE END CFG_LPM_Id_t */
 } CFG_LPM_Id_t;
@@ -84,11 +85,22 @@ typedef enum
   CFG_SEQ_Task_Main,
   CFG_SEQ_Task_UartConfig,
   CFG_SEQ_Task_SubGHz_Phy_App_Process,
+  CFG_SEQ_Task_DataflashPowerDown,
+  CFG_SEQ_Task_SpiTransferComplete,
   /* USER CODE END CFG_SEQ_Task_Id_t */
   CFG_SEQ_Task_NBR
 } CFG_SEQ_Task_Id_t;
 
 /* USER CODE BEGIN ET */
+/**
+  * This is the list of events used by the application
+  * Each Id shall be in the range 0..31
+  */
+typedef enum
+{
+  CFG_SEQ_Evt_SpiTransferComplete,
+  CFG_SEQ_Evt_NBR,
+} CFG_SEQ_Evt_Id_t;
 
 /* USER CODE END ET */
 
@@ -21,6 +21,7 @@
 /* Includes ------------------------------------------------------------------*/
 #include "main.h"
 #include "crc.h"
+#include "dma.h"
 #include "app_fatfs.h"
 #include "i2c.h"
 #include "iwdg.h"
@@ -117,6 +118,7 @@ int main(void)
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
+  MX_DMA_Init();
   MX_CRC_Init();
   MX_SPI1_Init();
   MX_I2C1_Init();
@@ -128,10 +130,15 @@ int main(void)
   /* USER CODE BEGIN 2 */
 
   uartInit_Config();
-  resultInitDataflash = init_dataflash();
+
+  //FRAM and dataflash are not used at a wake without measurement, restored by restoreLoggingState() when USB is connected
+  if( checkLoggingWake() )
+  {
+    resultInitDataflash = init_dataflash();
+  }
 
 #ifdef ERASE_DATAFLASH
-  if( chipErase )
+  if( chipErase && checkLoggingWake() )
   {
     chipEraseDataflash();
   }
@@ -144,8 +151,15 @@ int main(void)
   }
 #endif
 
-  restoreLatestMeasurementId();
-  reloadSettingsFromVirtualEEPROM();
+  if( checkLoggingWake() )
+  {
+    restoreLatestMeasurementId();
+    reloadSettingsFromVirtualEEPROM(true);
+  }
+  else
+  {
+    reloadSettingsFromVirtualEEPROM(false);
+  }
 
   APP_LOG(TS_OFF, VLEVEL_H, "Testmode: %d\r\n", getStatusRegister().testmodeActive);
 
@@ -33,6 +33,7 @@
 
 /* USER CODE BEGIN Includes */
 #include "../../App/IO/board_io.h"
+#include "../../App/common/spi_async.h"
 /* USER CODE END Includes */
 
 /* External variables ---------------------------------------------------------*/
@@ -134,6 +135,8 @@ void SystemApp_Init(void)
 
   init_board_io_device(IO_EXPANDER_SYS); //initialize board IO direct system I2C I/O expanders.
 
+  init_spiAsync(); //initialize asynchronous SPI transfers
+
   /* USER CODE END SystemApp_Init_2 */
 }
 
@@ -256,6 +259,24 @@ void GetDevAddr(uint32_t *devAddr)
 
 /* USER CODE BEGIN EF */
 
+/**
+  * @brief redefines __weak function in stm32_seq.c, no other tasks are executed while
+  *        waiting on a SPI transfer, they may use the same SPI bus. The CPU sleeps in UTIL_SEQ_Idle().
+  * @param TaskId_bm task waiting on the event
+  * @param EvtWaited_bm event waited on
+  */
+void UTIL_SEQ_EvtIdle(UTIL_SEQ_bm_t TaskId_bm, UTIL_SEQ_bm_t EvtWaited_bm)
+{
+  if (EvtWaited_bm & (1 << CFG_SEQ_Evt_SpiTransferComplete))
+  {
+    UTIL_SEQ_Run(0);
+  }
+  else
+  {
+    UTIL_SEQ_Run(~TaskId_bm);
+  }
+}
+
 /* USER CODE END EF */
 
 /* Private functions ---------------------------------------------------------*/
@@ -28,6 +28,7 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include <stdbool.h>
 
 /* USER CODE END Includes */
 
@@ -51,6 +52,7 @@ int32_t MX_FATFS_Init(void);
 int32_t MX_FATFS_Process(void);
 /* USER CODE BEGIN EFP */
 const int8_t SD_TEST(uint32_t * capacity, uint32_t * free);
+const void setup_io_for_SdCard(bool state);
 /* USER CODE END EFP */
 
 /* Private defines -----------------------------------------------------------*/
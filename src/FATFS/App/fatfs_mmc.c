@@ -28,6 +28,8 @@
 #include "spi.h"
 #include "diskio.h"
 #include "fatfs_mmc.h"
+#include "../../App/common/spi_async.h"
+#include "../../App/common/spi_bus.h"
 
 #define MMC_WP    0 /* Write protected (yes:true, no:false, default:false) */
 #define MMC_CD    1 /* Card detect (yes:true, no:false, default:true) */
@@ -42,8 +44,8 @@ static uint8_t PowerFlag = 0;       /* Power flag */
 #define CS_HIGH() SD_DisableChipSelect()
 #define CS_LOW() SD_EnableChipSelect()
 
-#define FCLK_SLOW() MX_SPI1_lowSpeed()
-#define FCLK_FAST() MX_SPI1_highSpeed()
+#define FCLK_SLOW() changeDeviceSpiBus(SPI_BUS_SDCARD_INIT)
+#define FCLK_FAST() changeDeviceSpiBus(SPI_BUS_SDCARD)
 
 
 /**
@@ -110,36 +112,28 @@ static uint8_t SPI_RxByte(void)
 
 /**
  * @fn void rcvr_spi_multi(uint8_t*, uint16_t)
- * @brief Receive multiple byte
+ * @brief Receive multiple byte, 0xFF is send. Long transfers with DMA
  *
  * @param buff Pointer to data buffer
  * @param btr Number of bytes to receive (even number)
  */
 static void rcvr_spi_multi(uint8_t *buff, uint16_t btr )
 {
-  while (btr--)
-  {
-    *buff++ = SPI_RxByte();
-  }
+  transferSpiAsync(HSPI_SDCARD, NULL, buff, btr);
 }
 
 
 #if FF_FS_READONLY == 0
 /**
  * @fn void xmit_spi_multi(const uint8_t*, uint16_t)
- * @brief Send multiple byte
+ * @brief Send multiple byte, long transfers with DMA
  *
  * @param buff : Pointer to the data
  * @param btx : Number of bytes to send (even number)
  */
 static void xmit_spi_multi(const uint8_t *buff, uint16_t btx)
 {
-	do
-  {
-	  xchg_spi(*buff++);
-  }
-  while(--btx);
-
+  transferSpiAsync(HSPI_SDCARD, buff, NULL, btx);
 }
 #endif
 
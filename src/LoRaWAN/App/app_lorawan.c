@@ -25,6 +25,7 @@
 #include "stm32_seq.h"
 
 /* USER CODE BEGIN Includes */
+#include "../../App/mainTask.h"
 
 /* USER CODE END Includes */
 
@@ -70,6 +71,11 @@ void MX_LoRaWAN_Init(void)
   SystemApp_Init();
   /* USER CODE BEGIN MX_LoRaWAN_Init_2 */
 
+  if( checkLoggingWake() == false )
+  {
+    return; //NVM context in FRAM not restored, LoRaWAN_Init() is called by restoreLoggingState() when the wake continues
+  }
+
   /* USER CODE END MX_LoRaWAN_Init_2 */
   LoRaWAN_Init();
   /* USER CODE BEGIN MX_LoRaWAN_Init_3 */
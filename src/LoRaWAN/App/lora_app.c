@@ -37,7 +37,11 @@
 #include "LoRaMac.h"
 
 /* USER CODE BEGIN Includes */
+#include <stddef.h>
+#include "utilities.h"
 #include "../../../App/measurement.h"
+#include "../../../App/rollup.h"
+#include "../../../App/RTC_AM1805/RTC_retention.h"
 #include "../../../App/common/common.h"
 #include "../../../App/FRAM/FRAM_functions.h"
 #include "../../../App/IO/board_io.h"
@@ -69,6 +73,16 @@ typedef enum TxEventType_e
 
 /* USER CODE BEGIN PTD */
 
+/**
+  * @brief group of the NVM context, the group ends with its CRC32 which is updated by the MAC when the group changes
+  */
+typedef struct
+{
+  uint16_t offset;          //offset in LoRaMacNvmData_t and in FRAM
+  uint16_t size;            //size including CRC32
+  const char * name;
+}struct_nvmGroup;
+
 /* USER CODE END PTD */
 
 /* Private define ------------------------------------------------------------*/
@@ -227,6 +241,20 @@ static void OnSystemReset(void);
 
 /* USER CODE BEGIN PFP */
 
+#ifdef FRAM_USED_FOR_NVM_DATA
+/**
+  * @brief  store the changed groups of the NVM context in FRAM
+  * @param  nvm ptr on nvm structure
+  */
+static void saveNvmGroups(const uint8_t *nvm);
+
+/**
+  * @brief  check the groups of the NVM context restored from FRAM
+  * @param  nvm ptr on nvm structure
+  */
+static void checkNvmGroups(const uint8_t *nvm);
+#endif
+
 /**
   * @brief  ReJoin switch timer callback function
   * @param  context ptr of Join switch context
@@ -238,6 +266,14 @@ static void OnReJoinTimerEvent(void *context);
   */
 static void ReJoin(void);
 
+/**
+  * @brief  pack the latest measurement in the MFM protocol, without padding
+  * @param  buffer ptr on the uplink buffer
+  * @param  size size of the uplink buffer
+  * @return number of bytes packed
+  */
+static uint32_t packMeasurementUplink(uint8_t *buffer, uint32_t size);
+
 /**
   * @brief  LED Tx timer callback function
   * @param  context ptr of LED context
@@ -365,6 +401,32 @@ static UTIL_TIMER_Object_t StopJoinTimer;
 
 /* USER CODE BEGIN PV */
 
+#ifdef FRAM_USED_FOR_NVM_DATA
+#define NVM_GROUP(group)  { offsetof(LoRaMacNvmData_t, group), sizeof(((LoRaMacNvmData_t *)0)->group), #group }
+
+/**
+  * @brief groups of the NVM context, stored separately in FRAM at the same offsets as LoRaMacNvmData_t
+  */
+static const struct_nvmGroup nvmGroups[] =
+{
+  NVM_GROUP(Crypto),
+  NVM_GROUP(MacGroup1),
+  NVM_GROUP(MacGroup2),
+  NVM_GROUP(SecureElement),
+  NVM_GROUP(RegionGroup1),
+  NVM_GROUP(RegionGroup2),
+  NVM_GROUP(ClassB),
+};
+
+#define NVM_NUMBER_OF_GROUPS  ( sizeof(nvmGroups) / sizeof(nvmGroups[0]) )
+
+/**
+  * @brief CRC32 of each group in FRAM, known after restore, a group is written when its CRC32 differs
+  */
+static uint32_t storedNvmGroupCrc[NVM_NUMBER_OF_GROUPS];
+static bool storedNvmGroupCrcValid = false;
+#endif
+
 /**
   * @brief ReJoin Timer period
   */
@@ -710,15 +772,78 @@ void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
 /* Private functions ---------------------------------------------------------*/
 /* USER CODE BEGIN PrFD */
 
+#ifdef FRAM_USED_FOR_NVM_DATA
+/**
+ * @fn void saveNvmGroups(const uint8_t*)
+ * @brief function to store only the groups of the NVM context with another CRC32 than in FRAM.
+ * The MAC updates the CRC32 of a group when it changed, the same check as the notify flags of NvmDataMgmtEvent().
+ * Mostly only Crypto and MacGroup1 are written after an uplink instead of the complete context.
+ *
+ * @param nvm : NVM context
+ */
+static void saveNvmGroups(const uint8_t *nvm)
+{
+  uint8_t changedGroups = 0;
+  uint16_t length = 0;
+  uint32_t crc;
+
+  for( uint8_t i = 0; i < NVM_NUMBER_OF_GROUPS; i++ )
+  {
+    memcpy(&crc, &nvm[nvmGroups[i].offset + nvmGroups[i].size - sizeof(crc)], sizeof(crc));
+
+    if( storedNvmGroupCrcValid == false || crc != storedNvmGroupCrc[i] )
+    {
+      saveLoraSettingsPart(nvmGroups[i].offset, &nvm[nvmGroups[i].offset], nvmGroups[i].size);
+      storedNvmGroupCrc[i] = crc;
+      changedGroups |= (1 << i);
+      length += nvmGroups[i].size;
+    }
+  }
+
+  storedNvmGroupCrcValid = true;
+
+  APP_LOG(TS_OFF, VLEVEL_M, "NVM groups stored: 0x%02x, %u bytes\r\n", changedGroups, length);
+}
+
+/**
+ * @fn void checkNvmGroups(const uint8_t*)
+ * @brief function to check the CRC32 of each group of the NVM context restored from FRAM.
+ * A group which is not valid is written again at the next store, the MAC does not accept the context and joins again.
+ *
+ * @param nvm : NVM context
+ */
+static void checkNvmGroups(const uint8_t *nvm)
+{
+  uint32_t crc;
+
+  for( uint8_t i = 0; i < NVM_NUMBER_OF_GROUPS; i++ )
+  {
+    memcpy(&crc, &nvm[nvmGroups[i].offset + nvmGroups[i].size - sizeof(crc)], sizeof(crc));
+
+    if( Crc32((uint8_t *)&nvm[nvmGroups[i].offset], nvmGroups[i].size - sizeof(crc)) == crc )
+    {
+      storedNvmGroupCrc[i] = crc;
+    }
+    else
+    {
+      APP_LOG(TS_OFF, VLEVEL_M, "NVM group %s not valid\r\n", nvmGroups[i].name);
+      storedNvmGroupCrc[i] = ~crc; //write again
+    }
+  }
+
+  storedNvmGroupCrcValid = true;
+}
+#endif
+
 /**
  * @fn const uint8_t getBufferSize(void)
- * @brief weak function to get maximum buffer side.
+ * @brief weak function to get the test payload size, the measurement uplink is filled up to this size.
  *
- * @return
+ * @return test payload size, 0 is no filling
  */
 __weak const uint8_t getBufferSize(void)
 {
-  return 50;
+  return 0;
 }
 
 /**
@@ -769,6 +894,81 @@ static void OnReJoinTimerEvent(void *context)
   }
 }
 
+/**
+ * @fn uint32_t packMeasurementUplink(uint8_t*, uint32_t)
+ * @brief pack the latest measurement in the MFM protocol. Only the bytes of the protocol are packed,
+ * the length of the uplink depends on the sensor data size and the message type of the base data.
+ *
+ * @param buffer ptr on the uplink buffer
+ * @param size size of the uplink buffer
+ * @return number of bytes packed
+ */
+static uint32_t packMeasurementUplink(uint8_t *buffer, uint32_t size)
+{
+  STRUCT_measurementData *measurementData = (STRUCT_measurementData *)&measurement[0];
+  uint32_t i = 0;
+
+  /* read latest measurement data */
+  readMeasurement(getLatestMeasurementId() > 0 ? getLatestMeasurementId() - 1 : 0, measurement, sizeof(measurement));
+
+  /* get sensor module data size */
+  uint8_t sensorDataSize = measurementData->sensorModuleData.sensorModuleDataSize;
+
+  /* check if size is within limit of 36 bytes */
+  if( sensorDataSize >= sizeof(measurementData->sensorModuleData) )
+  {
+    sensorDataSize = sizeof(measurementData->sensorModuleData); //Maximize on 36 bytes
+  }
+
+  /* header, sensor data and the largest base data must fit */
+  assert_param(size >= 5 + sizeof(measurementData->sensorModuleData) + 5);
+
+  /* fill in measurement data */
+  buffer[i++] = measurementData->protocolMFM; //protocol MFM
+  buffer[i++] = measurementData->sensorModuleData.sensorModuleSlotId;
+  buffer[i++] = measurementData->sensorModuleData.sensorModuleTypeId;
+  buffer[i++] = measurementData->sensorModuleData.sensorModuleProtocolId;
+  buffer[i++] = sensorDataSize;
+
+  /* copy sensordata max 36 bytes */
+  memcpy(&buffer[i],measurementData->sensorModuleData.sensorModuleData, sensorDataSize );
+  i+=sensorDataSize;
+
+  /* Base data, depends on messageType */
+  buffer[i++] = measurementData->MFM_baseData.stBaseData.messageType;
+  switch( measurementData->MFM_baseData.stBaseData.messageType )
+  {
+    case 0x00:
+      //nothing
+      break;
+
+    case 0x01:
+      buffer[i++] = measurementData->MFM_baseData.stBaseData.batteryStateEos;
+      buffer[i++] = measurementData->MFM_baseData.stBaseData.temperatureGauge;
+      buffer[i++] = measurementData->MFM_baseData.stBaseData.temperatureController;
+      buffer[i++] = measurementData->MFM_baseData.stBaseData.diagnosticBits;
+      break;
+
+    case 0x02:
+      buffer[i++] = measurementData->MFM_baseData.stBaseData.temperatureController;
+      buffer[i++] = measurementData->MFM_baseData.stBaseData.diagnosticBits;
+      break;
+
+    default:
+      //nothing
+      break;
+
+  }
+
+  /* test payload size, only set by the test command, never in normal operation */
+  while( i < getBufferSize() && i < size )
+  {
+    buffer[i++] = 0xAA;
+  }
+
+  return i;
+}
+
 /* USER CODE END PrFD */
 
 static void OnRxData(LmHandlerAppData_t *appData, LmHandlerRxParams_t *params)
@@ -868,7 +1068,9 @@ static void SendTxData(void)
   /* USER CODE BEGIN SendTxData_1 */
   LmHandlerErrorStatus_t status = LORAMAC_HANDLER_ERROR;
   UTIL_TIMER_Time_t nextTxIn = 0;
-  STRUCT_measurementData *measurementData = (STRUCT_measurementData *)&measurement[0];
+  LoRaMacTxInfo_t txInfo;
+  int8_t txDatarate = 0;
+  int32_t rollupLength;
 
   if (LmHandlerIsBusy() == false)
   {
@@ -876,64 +1078,18 @@ static void SendTxData(void)
 
     AppData.Port = LORAWAN_USER_APP_PORT;
 
-    /* read latest measurement data */
-    readMeasurement(getLatestMeasurementId() > 0 ? getLatestMeasurementId() - 1 : 0, measurement, sizeof(measurement));
+    /* rollup of a closed window that is not sent yet replaces the latest measurement, when enabled */
+    rollupLength = packRollupUplink(AppData.Buffer, sizeof(AppDataBuffer));
 
-    /* get sensor module data size */
-    uint8_t sensorDataSize = measurementData->sensorModuleData.sensorModuleDataSize;
-
-    /* check if size is within limit of 36 bytes */
-    if( sensorDataSize >= sizeof(measurementData->sensorModuleData) )
+    if( rollupLength > 0 )
     {
-      sensorDataSize = sizeof(measurementData->sensorModuleData); //Maximize on 36 bytes
+      AppData.Port = LORAWAN_ROLLUP_APP_PORT;
+      i = rollupLength;
     }
-
-    /* fill in measurement data */
-    AppData.Buffer[i++] = measurementData->protocolMFM; //protocol MFM
-    AppData.Buffer[i++] = measurementData->sensorModuleData.sensorModuleSlotId;
-    AppData.Buffer[i++] = measurementData->sensorModuleData.sensorModuleTypeId;
-    AppData.Buffer[i++] = measurementData->sensorModuleData.sensorModuleProtocolId;
-    AppData.Buffer[i++] = sensorDataSize;
-
-    /* copy sensordata max 36 bytes */
-    memcpy(&AppData.Buffer[i],measurementData->sensorModuleData.sensorModuleData, sensorDataSize );
-    i+=sensorDataSize;
-
-    /* Base data, depends on messageType */
-    AppData.Buffer[i++] = measurementData->MFM_baseData.stBaseData.messageType;
-    switch( measurementData->MFM_baseData.stBaseData.messageType )
-    {
-      case 0x00:
-        //nothing
-        break;
-
-      case 0x01:
-        AppData.Buffer[i++] = measurementData->MFM_baseData.stBaseData.batteryStateEos;
-        AppData.Buffer[i++] = measurementData->MFM_baseData.stBaseData.temperatureGauge;
-        AppData.Buffer[i++] = measurementData->MFM_baseData.stBaseData.temperatureController;
-        AppData.Buffer[i++] = measurementData->MFM_baseData.stBaseData.diagnosticBits;
-        break;
-
-      case 0x02:
-        AppData.Buffer[i++] = measurementData->MFM_baseData.stBaseData.temperatureController;
-        AppData.Buffer[i++] = measurementData->MFM_baseData.stBaseData.diagnosticBits;
-        break;
-
-      default:
-        //nothing
-        break;
-
-    }
-
-//////////////////////////////////////////////////////////////////
-//////////////////////////////////////////////////////////////////
-    //testcode to fill databuffer until 50 bytes.
-    while(i<getBufferSize())
+    else
     {
-      AppData.Buffer[i++] = 0xAA;
+      i = packMeasurementUplink(AppData.Buffer, sizeof(AppDataBuffer));
     }
-//////////////////////////////////////////////////////////////////
-/// //////////////////////////////////////////////////////////////////
 
     AppData.BufferSize = i;
 
@@ -969,10 +1125,30 @@ static void SendTxData(void)
       LmHandlerDeviceTimeReq(); //request the time
     }
 
+    /* rollup too large for the current datarate stays pending until the datarate allows it, the latest measurement is sent instead */
+    if( rollupLength > 0 && LoRaMacQueryTxPossible(AppData.BufferSize, &txInfo) != LORAMAC_STATUS_OK )
+    {
+      LmHandlerGetTxDatarate(&txDatarate); //datarate of the MAC, can be lowered by ADR
+      APP_LOG(TS_ON, VLEVEL_L, "SENDTXDATA: rollup %u bytes, max %u bytes at DR%d\r\n",
+              AppData.BufferSize, txInfo.CurrentPossiblePayloadSize, txDatarate);
+
+      rollupLength = 0;
+      AppData.Port = LORAWAN_USER_APP_PORT;
+      AppData.BufferSize = packMeasurementUplink(AppData.Buffer, sizeof(AppDataBuffer));
+    }
+
     status = LmHandlerSend(&AppData, LmHandlerParams.IsTxConfirmed, false);
     if (LORAMAC_HANDLER_SUCCESS == status)
     {
       APP_LOG(TS_ON, VLEVEL_L, "SEND REQUEST\r\n");
+      if( rollupLength > 0 )
+      {
+        confirmRollupUplink(); //rollup is sent, next rollup at next uplink
+      }
+    }
+    else if (LORAMAC_HANDLER_PAYLOAD_LENGTH_RESTRICTED == status)
+    {
+      APP_LOG(TS_ON, VLEVEL_L, "SENDTXDATA: measurement %u bytes too large for datarate, MAC commands sent\r\n", AppData.BufferSize);
     }
     else if (LORAMAC_HANDLER_DUTYCYCLE_RESTRICTED == status)
     {
@@ -1049,6 +1225,8 @@ static void OnTxData(LmHandlerTxParams_t *params)
       APP_LOG(TS_OFF, VLEVEL_M, "\r\n###### ========== MCPS-Confirm =============\r\n");
       APP_LOG(TS_OFF, VLEVEL_H, "###### U/L FRAME:%04d | PORT:%d | DR:%d | PWR:%d", params->UplinkCounter,
               params->AppData.Port, params->Datarate, params->TxPower);
+      APP_LOG(TS_OFF, VLEVEL_H, " | SIZE:%u | AIRTIME:%lums", params->AppData.BufferSize, params->TxTimeOnAir);
+      addUplinkRtcRetention(params->TxTimeOnAir, params->Datarate, params->AppData.BufferSize); //readable with Get+Airtime
 
       APP_LOG(TS_OFF, VLEVEL_H, " | MSG TYPE:");
       if (params->MsgType == LORAMAC_HANDLER_CONFIRMED_MSG)
@@ -1378,7 +1556,7 @@ static void OnStoreContextRequest(void *nvm, uint32_t nvm_size)
 #ifdef FRAM_USED_FOR_NVM_DATA
   //save data to FRAM
   static_assert (sizeof(LoRaMacNvmData_t) <= MAX_SIZE_LORA_SETTINGS, "Size LoRaMacNvmData_t is too large for reserved FRAM memory");
-  saveLoraSettings((const void *)nvm, nvm_size);
+  saveNvmGroups((const uint8_t *)nvm); //only the changed groups
   return; //prevent to execute write in internal flash, cycles of 10k too less
 #endif
 
@@ -1407,6 +1585,7 @@ static void OnRestoreContextRequest(void *nvm, uint32_t nvm_size)
 
   //read data to FRAM
   restoreLoraSettings((const void *)nvm, nvm_size);
+  checkNvmGroups((const uint8_t *)nvm);
   return; //prevent to execute read from internal flash, cycles of 10k too less
 #endif
 #endif
@@ -78,6 +78,12 @@ void LoRaWAN_deInit(void);
  */
 #define LORAWAN_SWITCH_CLASS_PORT                   3
 
+/*!
+ * LoRaWAN rollup application port, minimum, maximum and mean of a window
+ * @note do not use 224. It is reserved for certification
+ */
+#define LORAWAN_ROLLUP_APP_PORT                     4
+
 /*!
  * LoRaWAN default class
  */
@@ -1039,6 +1039,7 @@ static void McpsConfirm( McpsConfirm_t *mcpsConfirm )
     TxParams.UplinkCounter = mcpsConfirm->UpLinkCounter;
     TxParams.TxPower = mcpsConfirm->TxPower;
     TxParams.Channel = mcpsConfirm->Channel;
+    TxParams.TxTimeOnAir = mcpsConfirm->TxTimeOnAir;
     TxParams.AckReceived = mcpsConfirm->AckReceived;
 
     if( LmHandlerCallbacks->OnTxData != NULL )
@@ -76,6 +76,7 @@ typedef struct LmHandlerTxParams_s
     LmHandlerAppData_t AppData;
     int8_t TxPower;
     uint8_t Channel;
+    TimerTime_t TxTimeOnAir;
 } LmHandlerTxParams_t;
 
 /*!